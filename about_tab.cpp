@@ -1,4 +1,5 @@
 #include "about_tab.h"
+#include "lsv_style.h"
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QLabel>
@@ -29,18 +30,16 @@
 #include <QDialogButtonBox>
 #include <QFontDatabase>
 #include <QTextBrowser>
+#include <QStandardPaths>
+#include "collector_engine.h"
 #include "version.h"
 
 namespace {
-    // Try to detect the default browser desktop file via xdg-mime and
-    // return a pair(program, args) to launch a new visible window if
-    // possible. Returns an empty program on failure.
-    static QPair<QString, QStringList> detectDefaultBrowserNewWindow()
+    // Map the default browser desktop file (as reported by xdg-mime) to a
+    // pair(program, args) that launches a new visible window if possible.
+    // Returns an empty program on failure.
+    static QPair<QString, QStringList> browserForDesktopFile(const QString &desktopFile)
     {
-        QProcess p;
-        p.start(QStringLiteral("xdg-mime"), QStringList() << QStringLiteral("query") << QStringLiteral("default") << QStringLiteral("x-scheme-handler/http"));
-        if (!p.waitForFinished(500)) return {};
-        QString desktopFile = QString::fromUtf8(p.readAllStandardOutput()).trimmed();
         if (desktopFile.isEmpty()) return {};
 
         // Map known desktop files to a command and initial args. We prefer
@@ -70,10 +69,7 @@ namespace {
     // Check whether a helper program exists on PATH (fast, best-effort)
     static bool programExists(const QString &prog)
     {
-        QProcess p;
-        p.start(QStringLiteral("which"), QStringList() << prog);
-        if (!p.waitForFinished(300)) return false;
-        return p.exitCode() == 0;
+        return !QStandardPaths::findExecutable(prog).isEmpty();
     }
 
     // Best-effort: try to raise/activate any window(s) that belong to the
@@ -240,17 +236,16 @@ namespace {
         });
         Q_UNUSED(f);
     }
-    // Try to open a URL using QDesktopServices first, then fall back to
-    // a list of common desktop helpers. We keep this in an anonymous
-    // namespace to limit visibility to this translation unit.
-    static void openUrlRobust(const QString &link)
+    // Try to open a URL with the detected default browser, then
+    // QDesktopServices, then a list of common desktop helpers. We keep this
+    // in an anonymous namespace to limit visibility to this translation unit.
+    static void openUrlWith(const QString &link, const QPair<QString, QStringList> &brush)
     {
         // First try to launch the system default browser with a "new-window"
         // flag if we can detect it. This helps ensure a visible window/tab is
         // opened for portable AppImage users (some browsers open a tab in an
         // existing session without raising the window).
         {
-            auto brush = detectDefaultBrowserNewWindow();
             const QString &prog = brush.first;
             QStringList baseArgs = brush.second;
             if (!prog.isEmpty()) {
@@ -425,6 +420,19 @@ namespace {
             logFile.close();
         }
     }
+
+    // Ask xdg-mime for the default browser without blocking the GUI thread
+    // and open the link once it has answered (or failed).
+    static void openUrlRobust(const QString &link)
+    {
+        CollectorEngine::instance()->run(QStringLiteral("xdg-mime"),
+                                         QStringList() << QStringLiteral("query") << QStringLiteral("default") << QStringLiteral("x-scheme-handler/http"),
+                                         CollectorEngine::Visible, 500)
+            .then(QCoreApplication::instance(), [link](const CollectorResult &result) {
+                const bool answered = result.exitCode == 0 && !result.timedOut;
+                openUrlWith(link, browserForDesktopFile(answered ? QString::fromUtf8(result.standardOutput).trimmed() : QString()));
+            });
+    }
 }
 
 AboutTab::AboutTab(QWidget* parent)
@@ -560,29 +568,8 @@ QWidget* AboutTab::createUserFriendlyView()
 
 void AboutTab::createInfoSection(const QString& title, QGroupBox** groupBox, QLabel** contentLabel, QVBoxLayout* parentLayout)
 {
-    *groupBox = new QGroupBox(title);
-    (*groupBox)->setStyleSheet(
-        "QGroupBox {"
-        "  font-weight: bold;"
-        "  border: 2px solid #bdc3c7;"
-        "  border-radius: 8px;"
-        "  margin-top: 10px;"
-        "  padding-top: 10px;"
-        "}"
-        "QGroupBox::title {"
-        "  subcontrol-origin: margin;"
-        "  left: 10px;"
-        "  padding: 0 10px 0 10px;"
-        "}"
-    );
-    
-    QVBoxLayout* sectionLayout = new QVBoxLayout(*groupBox);
-    *contentLabel = new QLabel();
-    (*contentLabel)->setWordWrap(true);
-    (*contentLabel)->setStyleSheet("QLabel { padding: 15px; background-color: #f8f9fa; border-radius: 4px; line-height: 1.4; }");
-    sectionLayout->addWidget(*contentLabel);
-    
-    parentLayout->addWidget(*groupBox);
+    *groupBox = ::createInfoSection(title, contentLabel, parentLayout);
+    (*contentLabel)->setObjectName("aboutSectionContent");
 }
 
 void AboutTab::parseOutput(const QString& output)
@@ -0,0 +1,177 @@
+#include "agent_client.h"
+#include "log_helper.h"
+#include <QCborValue>
+#include <QCoreApplication>
+#include <QDeadlineTimer>
+#include <QLocalSocket>
+
+using namespace agent;
+
+AgentClient::AgentClient(QObject* parent)
+    : QObject(parent)
+    , m_socket(new QLocalSocket(this))
+{
+    connect(m_socket, &QLocalSocket::readyRead, this, &AgentClient::readFrames);
+    connect(m_socket, &QLocalSocket::disconnected, this, &AgentClient::disconnected);
+}
+
+bool AgentClient::isConnected() const
+{
+    return m_socket->state() == QLocalSocket::ConnectedState;
+}
+
+bool AgentClient::connectToAgent(const QString& path, int timeoutMs)
+{
+    m_socket->connectToServer(path);
+    if (!m_socket->waitForConnected(timeoutMs)) {
+        m_error = QString("no agent at %1 (%2)").arg(path, m_socket->errorString());
+        m_socket->abort();
+        return false;
+    }
+    const qint64 uid = peerUid(m_socket->socketDescriptor());
+    if (!trustedPeer(uid)) {
+        m_error = QString("%1 belongs to uid %2, not to this user or root; not using it").arg(path).arg(uid);
+        m_socket->abort();
+        return false;
+    }
+
+    Writer hello;
+    hello.stream() << ProtocolVersion << QCoreApplication::applicationName();
+    send(hello.frame(Hello));
+
+    QByteArray payload;
+    if (!waitForReply(Welcome, &payload, timeoutMs)) {
+        m_socket->abort();
+        return false;
+    }
+    QDataStream in(payload);
+    prepare(in);
+    quint16 version = 0;
+    qint64 startedMs = 0;
+    in >> version >> m_agentPid >> startedMs >> m_sections >> m_commands;
+    appendLog(QString("AgentClient: connected to lsv-agentd pid %1 at %2, protocol %3")
+                  .arg(m_agentPid).arg(path).arg(version));
+    return true;
+}
+
+bool AgentClient::fetchSnapshot(const QStringList& sections, QJsonObject* document, qint64 maxAgeMs, int timeoutMs)
+{
+    Writer request;
+    request.stream() << sections << maxAgeMs;
+    send(request.frame(GetSnapshot));
+
+    QByteArray payload;
+    if (!waitForReply(Snapshot, &payload, timeoutMs)) return false;
+    QDataStream in(payload);
+    prepare(in);
+    QByteArray cbor;
+    in >> cbor;
+    *document = QCborValue::fromCbor(cbor).toJsonValue().toObject();
+    return true;
+}
+
+bool AgentClient::fetchCommand(const QString& key, bool wait, QByteArray* output, int timeoutMs)
+{
+    Writer request;
+    request.stream() << key << wait;
+    send(request.frame(GetCommand));
+
+    QByteArray payload;
+    if (!waitForReply(Command, &payload, timeoutMs)) return false;
+    QDataStream in(payload);
+    prepare(in);
+    QString replyKey;
+    bool available = false;
+    in >> replyKey >> available >> *output;
+    if (!available) m_error = QString("agent has no output for '%1' yet").arg(key);
+    return available;
+}
+
+bool AgentClient::fetchHistory(TimeSeriesStore::Dump* dump, int timeoutMs)
+{
+    Writer request;
+    send(request.frame(GetHistory));
+
+    QByteArray payload;
+    if (!waitForReply(History, &payload, timeoutMs)) return false;
+    QDataStream in(payload);
+    prepare(in);
+    if (!readHistory(in, dump)) {
+        m_error = "malformed history from agent";
+        return false;
+    }
+    return true;
+}
+
+void AgentClient::subscribe(Sampler::Channels channels)
+{
+    Writer request;
+    request.stream() << qint32(channels.toInt());
+    send(request.frame(Subscribe));
+}
+
+void AgentClient::send(const QByteArray& frame)
+{
+    if (!isConnected()) return;
+    m_socket->write(frame);
+    m_socket->flush();
+}
+
+void AgentClient::readFrames()
+{
+    m_reader.append(m_socket->readAll());
+    MessageType type;
+    QByteArray payload;
+    while (m_reader.next(&type, &payload)) {
+        if (type != SampleFrame) {
+            m_replies.append(Reply{type, payload});
+            continue;
+        }
+        QDataStream in(payload);
+        prepare(in);
+        auto sample = std::make_shared<Sample>();
+        if (readSample(in, sample.get(), m_netState)) emit sampleReceived(sample);
+    }
+    if (m_reader.failed()) {
+        appendLog("AgentClient: malformed frame from agent, disconnecting");
+        m_socket->abort();
+    }
+}
+
+bool AgentClient::waitForReply(MessageType expected, QByteArray* payload, int timeoutMs)
+{
+    QDeadlineTimer deadline(timeoutMs);
+    while (m_replies.isEmpty()) {
+        if (!isConnected()) {
+            m_error = "connection to agent lost";
+            return false;
+        }
+        if (!m_socket->waitForReadyRead(int(deadline.remainingTime()))) {
+            readFrames(); // bytes may have arrived without a new readyRead
+            if (m_replies.isEmpty()) {
+                m_error = deadline.hasExpired() ? QString("agent did not answer within %1 ms").arg(timeoutMs)
+                                                : m_socket->errorString();
+                // A late reply would be taken for the answer to the next
+                // request; start over instead.
+                m_socket->abort();
+                return false;
+            }
+        }
+    }
+
+    const Reply reply = m_replies.takeFirst();
+    if (reply.type == Error) {
+        QDataStream in(reply.payload);
+        prepare(in);
+        QString message;
+        in >> message;
+        m_error = "agent: " + message;
+        return false;
+    }
+    if (reply.type != expected) {
+        m_error = QString("unexpected reply %1 from agent").arg(int(reply.type));
+        return false;
+    }
+    *payload = reply.payload;
+    return true;
+}
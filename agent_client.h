@@ -0,0 +1,85 @@
+#ifndef AGENT_CLIENT_H
+#define AGENT_CLIENT_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QJsonObject>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include "agent_protocol.h"
+#include "sampler.h"
+#include "timeseries_store.h"
+
+class QLocalSocket;
+
+// Client side of the lsv-agentd protocol (see agent_protocol.h).
+//
+// The fetch calls block the calling thread until the reply arrives or the
+// timeout expires, which keeps one-shot users (`lsv --json --agent`, GUI
+// start-up priming on a pool thread) simple. Samples of a subscription
+// arrive through sampleReceived() from the event loop, also while a fetch
+// is waiting.
+//
+// Only an agent running as this user or as root is talked to; the peer's
+// credentials are checked on connect, so a socket planted by somebody else
+// is refused.
+class AgentClient : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr int DefaultTimeoutMs = 2000;
+
+    explicit AgentClient(QObject* parent = nullptr);
+
+    // Connect and exchange Hello/Welcome. Fails fast when nobody listens.
+    bool connectToAgent(const QString& path = agent::socketPath(), int timeoutMs = DefaultTimeoutMs);
+    bool isConnected() const;
+    QString errorString() const { return m_error; }
+
+    // What the agent announced in its Welcome.
+    QStringList sections() const { return m_sections; }
+    QStringList commands() const { return m_commands; }
+    qint64 agentPid() const { return m_agentPid; }
+
+    // The `lsv --json` document for the given sections (empty: all). The
+    // agent recollects first if its copy is older than maxAgeMs (-1: any
+    // age is fine).
+    bool fetchSnapshot(const QStringList& sections, QJsonObject* document, qint64 maxAgeMs = -1,
+                       int timeoutMs = DefaultTimeoutMs);
+    // Cached output of an allowlisted command ("lshw -xml", ...). Returns
+    // false if the agent has none yet; with wait the agent runs it first,
+    // so allow for the command's own run time in timeoutMs.
+    bool fetchCommand(const QString& key, bool wait, QByteArray* output, int timeoutMs = DefaultTimeoutMs);
+    // The agent's sampler history.
+    bool fetchHistory(TimeSeriesStore::Dump* dump, int timeoutMs = DefaultTimeoutMs);
+
+    // Push samples of these channels from now on; no channels stops.
+    void subscribe(Sampler::Channels channels);
+
+signals:
+    void sampleReceived(const SamplePtr& sample);
+    void disconnected();
+
+private:
+    void send(const QByteArray& frame);
+    void readFrames();
+    bool waitForReply(agent::MessageType expected, QByteArray* payload, int timeoutMs);
+
+    struct Reply {
+        agent::MessageType type;
+        QByteArray payload;
+    };
+
+    QLocalSocket* m_socket = nullptr;
+    agent::FrameReader m_reader;
+    agent::NetDeltaState m_netState;
+    QList<Reply> m_replies;
+    QString m_error;
+    QStringList m_sections;
+    QStringList m_commands;
+    qint64 m_agentPid = 0;
+};
+
+#endif // AGENT_CLIENT_H
@@ -0,0 +1,316 @@
+#ifndef AGENT_PROTOCOL_H
+#define AGENT_PROTOCOL_H
+
+// Wire format between lsv-agentd and its clients (the GUI, `lsv --json
+// --agent`), over a Unix domain socket.
+//
+// Every message is one frame:
+//
+//     quint32 length      big endian, bytes that follow (type + payload)
+//     quint8  type        MessageType
+//     payload             QDataStream (Qt 6.0 format) of the fields below
+//
+// A client starts with Hello and waits for Welcome; after that requests may
+// be pipelined and replies come back in order. Samples of a subscription
+// are pushed between replies as they are taken.
+//
+//   Hello        c->a  quint16 version, QString client
+//   Welcome      a->c  quint16 version, qint64 pid, qint64 startedMs,
+//                      QStringList sections, QStringList commands
+//   GetSnapshot  c->a  QStringList sections (empty: all), qint64 maxAgeMs
+//   Snapshot     a->c  QByteArray cbor   the document `lsv --json` prints
+//   GetCommand   c->a  QString key, bool wait
+//   Command      a->c  QString key, bool available, QByteArray output
+//   GetHistory   c->a  -
+//   History      a->c  TimeSeriesStore::Dump (see writeHistory)
+//   Subscribe    c->a  qint32 Sampler channels (0: stop)
+//   SampleFrame  a->c  see writeSample; network counters are sent as deltas
+//   Error        a->c  QString message
+//
+// Header-only so the agent, the GUI and the CLI share one definition.
+
+#include <QByteArray>
+#include <QDataStream>
+#include <QHash>
+#include <QIODevice>
+#include <QString>
+#include <QStringList>
+#include <QtEndian>
+#include <iterator>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "sampler.h"
+#include "timeseries_store.h"
+
+namespace agent {
+
+constexpr quint16 ProtocolVersion = 2;
+
+// Frames larger than this are treated as a broken stream.
+constexpr quint32 MaxFrameBytes = 64u * 1024u * 1024u;
+
+enum MessageType : quint8 {
+    Hello = 1,
+    Welcome = 2,
+    GetSnapshot = 3,
+    Snapshot = 4,
+    GetCommand = 5,
+    Command = 6,
+    GetHistory = 7,
+    History = 8,
+    Subscribe = 9,
+    SampleFrame = 10,
+    Error = 15
+};
+
+// LSV_AGENT_SOCKET, else lsv-agent.sock in a directory only its owner can
+// write to, so nobody can put a socket there first: /run/lsv for root
+// (which sudo leaves without XDG_RUNTIME_DIR), /run/user/<uid> otherwise.
+inline QString socketPath()
+{
+    const QString env = qEnvironmentVariable("LSV_AGENT_SOCKET");
+    if (!env.isEmpty()) return env;
+    const uid_t uid = ::getuid();
+    if (uid == 0) return "/run/lsv/lsv-agent.sock";
+    return QString("/run/user/%1/lsv-agent.sock").arg(uid);
+}
+
+// User id of the process at the other end of a connected Unix socket, or
+// -1 if the kernel does not say.
+inline qint64 peerUid(qintptr descriptor)
+{
+    struct ucred credentials;
+    socklen_t length = sizeof(credentials);
+    if (descriptor < 0 || ::getsockopt(int(descriptor), SOL_SOCKET, SO_PEERCRED, &credentials, &length) != 0) {
+        return -1;
+    }
+    return qint64(credentials.uid);
+}
+
+// Peers whose data is taken as is and who may see everything: this user
+// and root.
+inline bool trustedPeer(qint64 uid)
+{
+    return uid == 0 || uid == qint64(::getuid());
+}
+
+// Stream set up the same way on both ends.
+inline void prepare(QDataStream& stream)
+{
+    stream.setVersion(QDataStream::Qt_6_0);
+    stream.setByteOrder(QDataStream::BigEndian);
+}
+
+// Payload writer: `Writer w; w.stream() << ...; socket->write(w.frame(T));`
+class Writer
+{
+public:
+    Writer() : m_stream(&m_payload, QIODevice::WriteOnly) { prepare(m_stream); }
+
+    QDataStream& stream() { return m_stream; }
+
+    QByteArray frame(MessageType type) const
+    {
+        QByteArray out;
+        out.resize(5);
+        qToBigEndian<quint32>(quint32(m_payload.size() + 1), out.data());
+        out[4] = char(type);
+        out.append(m_payload);
+        return out;
+    }
+
+private:
+    QByteArray m_payload;
+    QDataStream m_stream;
+};
+
+// Collects bytes from a socket and cuts them into frames.
+class FrameReader
+{
+public:
+    void append(const QByteArray& bytes) { m_buffer.append(bytes); }
+
+    // Next complete frame, if any. A frame announcing more than
+    // MaxFrameBytes (or none at all) marks the stream failed.
+    bool next(MessageType* type, QByteArray* payload)
+    {
+        if (m_failed || m_buffer.size() - m_offset < 4) return false;
+        const quint32 length = qFromBigEndian<quint32>(m_buffer.constData() + m_offset);
+        if (length == 0 || length > MaxFrameBytes) {
+            m_failed = true;
+            return false;
+        }
+        if (quint64(m_buffer.size() - m_offset) < 4ull + length) return false;
+        *type = MessageType(quint8(m_buffer.at(m_offset + 4)));
+        *payload = m_buffer.mid(m_offset + 5, qsizetype(length) - 1);
+        m_offset += 4 + qsizetype(length);
+        // Drop consumed bytes once they dominate the buffer.
+        if (m_offset > 65536 && m_offset * 2 > m_buffer.size()) {
+            m_buffer.remove(0, m_offset);
+            m_offset = 0;
+        }
+        return true;
+    }
+
+    bool failed() const { return m_failed; }
+
+private:
+    QByteArray m_buffer;
+    qsizetype m_offset = 0;
+    bool m_failed = false;
+};
+
+// ---- history ---------------------------------------------------------------
+
+inline void writeHistory(QDataStream& out, const TimeSeriesStore::Dump& dump)
+{
+    out << dump.firstRecordMs << dump.lastRecordMs << qint32(TimeSeriesStore::ResolutionCount);
+    for (const TimeSeriesStore::Dump::Series& series : dump.series) {
+        out << series.bucketMs << series.time << series.min << series.max << series.avg << series.samples;
+    }
+}
+
+inline bool readHistory(QDataStream& in, TimeSeriesStore::Dump* dump)
+{
+    qint32 resolutions = 0;
+    in >> dump->firstRecordMs >> dump->lastRecordMs >> resolutions;
+    if (resolutions != TimeSeriesStore::ResolutionCount) return false;
+    for (TimeSeriesStore::Dump::Series& series : dump->series) {
+        in >> series.bucketMs >> series.time >> series.min >> series.max >> series.avg >> series.samples;
+    }
+    return in.status() == QDataStream::Ok;
+}
+
+// ---- samples ---------------------------------------------------------------
+
+// Network counters last sent to (or received from) one peer. Interfaces
+// whose counters did not change since are left out of the next sample, and
+// the interface list itself is only repeated when it changes.
+struct NetDeltaState {
+    QStringList order;
+    QHash<QString, NetDevCounters> counters;
+};
+
+inline bool sameCounters(const NetDevCounters& a, const NetDevCounters& b)
+{
+    return a.rxBytes == b.rxBytes && a.rxPackets == b.rxPackets && a.rxErrors == b.rxErrors
+        && a.rxDropped == b.rxDropped && a.txBytes == b.txBytes && a.txPackets == b.txPackets
+        && a.txErrors == b.txErrors && a.txDropped == b.txDropped
+        && a.rxBytesPerSec == b.rxBytesPerSec && a.txBytesPerSec == b.txBytesPerSec;
+}
+
+inline void writeCpuTimes(QDataStream& out, const CpuTimes& t)
+{
+    out << t.user << t.nice << t.system << t.idle << t.iowait << t.irq << t.softirq << t.steal;
+}
+
+inline void readCpuTimes(QDataStream& in, CpuTimes& t)
+{
+    in >> t.user >> t.nice >> t.system >> t.idle >> t.iowait >> t.irq >> t.softirq >> t.steal;
+}
+
+// The groups of sample that are in channels.
+inline void writeSample(QDataStream& out, const Sample& sample, int channels, NetDeltaState& sent)
+{
+    channels &= sample.channels;
+    out << sample.sequence << sample.timestampMs << qint32(channels);
+
+    if (channels & Sampler::Cpu) {
+        writeCpuTimes(out, sample.cpuTotal);
+        out << qint32(sample.cpus.size());
+        for (const CpuTimes& t : sample.cpus) writeCpuTimes(out, t);
+        out << sample.cpuBusyPercent << sample.cpuBusyPercents;
+    }
+    if (channels & Sampler::Memory) {
+        out << sample.memTotal << sample.memFree << sample.memAvailable << sample.buffers
+            << sample.cached << sample.swapTotal << sample.swapFree;
+    }
+    if (channels & Sampler::Network) {
+        QStringList order;
+        order.reserve(sample.interfaces.size());
+        for (const NetDevCounters& c : sample.interfaces) order.append(c.name);
+        const bool orderChanged = order != sent.order;
+        out << orderChanged;
+        if (orderChanged) {
+            out << order;
+            sent.order = order;
+        }
+
+        QVector<const NetDevCounters*> changed;
+        for (const NetDevCounters& c : sample.interfaces) {
+            auto it = sent.counters.constFind(c.name);
+            if (it == sent.counters.constEnd() || !sameCounters(it.value(), c)) changed.append(&c);
+        }
+        out << qint32(changed.size());
+        for (const NetDevCounters* c : changed) {
+            out << c->name << c->rxBytes << c->rxPackets << c->rxErrors << c->rxDropped
+                << c->txBytes << c->txPackets << c->txErrors << c->txDropped
+                << c->rxBytesPerSec << c->txBytesPerSec;
+            sent.counters.insert(c->name, *c);
+        }
+        if (orderChanged) {
+            // Forget interfaces that went away.
+            for (auto it = sent.counters.begin(); it != sent.counters.end();) {
+                it = order.contains(it.key()) ? std::next(it) : sent.counters.erase(it);
+            }
+        }
+    }
+    if (channels & Sampler::CpuFreq) {
+        out << sample.curFreqKHz << sample.minFreqKHz << sample.maxFreqKHz;
+    }
+}
+
+inline bool readSample(QDataStream& in, Sample* sample, NetDeltaState& known)
+{
+    qint32 channels = 0;
+    in >> sample->sequence >> sample->timestampMs >> channels;
+    sample->channels = channels;
+
+    if (channels & Sampler::Cpu) {
+        readCpuTimes(in, sample->cpuTotal);
+        qint32 count = 0;
+        in >> count;
+        if (count < 0 || count > 65536) return false;
+        sample->cpus.resize(count);
+        for (CpuTimes& t : sample->cpus) readCpuTimes(in, t);
+        in >> sample->cpuBusyPercent >> sample->cpuBusyPercents;
+    }
+    if (channels & Sampler::Memory) {
+        in >> sample->memTotal >> sample->memFree >> sample->memAvailable >> sample->buffers
+           >> sample->cached >> sample->swapTotal >> sample->swapFree;
+    }
+    if (channels & Sampler::Network) {
+        bool orderChanged = false;
+        in >> orderChanged;
+        if (orderChanged) {
+            in >> known.order;
+            for (auto it = known.counters.begin(); it != known.counters.end();) {
+                it = known.order.contains(it.key()) ? std::next(it) : known.counters.erase(it);
+            }
+        }
+        qint32 changed = 0;
+        in >> changed;
+        if (changed < 0 || changed > 1 << 20) return false;
+        for (qint32 i = 0; i < changed; ++i) {
+            NetDevCounters c;
+            in >> c.name >> c.rxBytes >> c.rxPackets >> c.rxErrors >> c.rxDropped
+               >> c.txBytes >> c.txPackets >> c.txErrors >> c.txDropped
+               >> c.rxBytesPerSec >> c.txBytesPerSec;
+            known.counters.insert(c.name, c);
+        }
+        sample->interfaces.clear();
+        sample->interfaces.reserve(known.order.size());
+        for (const QString& name : known.order) {
+            auto it = known.counters.constFind(name);
+            if (it != known.counters.constEnd()) sample->interfaces.append(it.value());
+        }
+    }
+    if (channels & Sampler::CpuFreq) {
+        in >> sample->curFreqKHz >> sample->minFreqKHz >> sample->maxFreqKHz;
+    }
+    return in.status() == QDataStream::Ok;
+}
+
+} // namespace agent
+
+#endif // AGENT_PROTOCOL_H
@@ -0,0 +1,452 @@
+#include "agent_server.h"
+#include "agent_protocol.h"
+#include "log_helper.h"
+#include "lsv_headless.h"
+#include "sampler.h"
+#include "snapshot_cache.h"
+#include "timeseries_store.h"
+#include <QCborValue>
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QMetaObject>
+#include <QThreadPool>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace agent;
+
+namespace {
+
+// lshw walks every bus; dmidecode only reads firmware tables. Neither
+// changes much, so they are rerun far less often than the sections.
+constexpr int CommandDeadlineMs = 120000;
+constexpr int CommandRefreshMs = 60 * 60 * 1000;
+
+// A subscriber that stops reading does not get an unbounded backlog;
+// samples are dropped for it until its socket drains.
+constexpr qint64 MaxQueuedSampleBytes = 4 * 1024 * 1024;
+
+QByteArray errorFrame(const QString& message)
+{
+    Writer w;
+    w.stream() << message;
+    return w.frame(Error);
+}
+
+// Output that only root can collect and that identifies the hardware
+// (dmidecode serial numbers) is not handed to other users of a --shared
+// agent.
+bool isPrivateCommand(const QString& key)
+{
+    return key.startsWith("dmidecode");
+}
+
+bool isPrivateRow(const QJsonObject& row)
+{
+    const QString property = row.value("property").toString();
+    return property.contains("Serial", Qt::CaseInsensitive) || property.contains("UUID", Qt::CaseInsensitive)
+        || property.contains("Asset Tag", Qt::CaseInsensitive);
+}
+
+QJsonValue withoutPrivateRows(const QJsonValue& value)
+{
+    if (value.isArray()) {
+        QJsonArray rows;
+        for (const QJsonValue& row : value.toArray()) {
+            if (!(row.isObject() && isPrivateRow(row.toObject()))) rows.append(withoutPrivateRows(row));
+        }
+        return rows;
+    }
+    if (value.isObject()) {
+        QJsonObject object = value.toObject();
+        for (auto it = object.begin(); it != object.end(); ++it) it.value() = withoutPrivateRows(it.value());
+        return object;
+    }
+    return value;
+}
+
+// The socket's directory must not let anybody else create or replace
+// entries in it, or a squatter could stand in for the agent. The default
+// /run/lsv is created here for a root agent, readable by everybody so a
+// --shared socket stays reachable.
+bool checkSocketDirectory(const QString& path, QString* error)
+{
+    const QByteArray directory = QFileInfo(path).absolutePath().toLocal8Bit();
+    if (::mkdir(directory.constData(), 0755) != 0 && errno != EEXIST) {
+        *error = QString("cannot create %1: %2").arg(QString::fromLocal8Bit(directory), QString::fromLocal8Bit(strerror(errno)));
+        return false;
+    }
+    struct stat st;
+    if (::lstat(directory.constData(), &st) != 0 || !S_ISDIR(st.st_mode)) {
+        *error = QString("%1 is not a directory").arg(QString::fromLocal8Bit(directory));
+        return false;
+    }
+    if ((st.st_uid != ::geteuid() && st.st_uid != 0) || (st.st_mode & (S_IWGRP | S_IWOTH))) {
+        *error = QString("%1 is not owned by this user or root, or writable by others; choose another --socket").arg(QString::fromLocal8Bit(directory));
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+// One attached client. Requests are handled in arrival order; while a
+// reply is deferred (first collection, a command that is still running)
+// later requests stay queued, so replies keep the order of the requests.
+class AgentServer::Connection : public QObject
+{
+public:
+    Connection(AgentServer* server, QLocalSocket* socket, bool trusted)
+        : QObject(server)
+        , m_server(server)
+        , m_socket(socket)
+        , m_trusted(trusted)
+    {
+        m_socket->setParent(this);
+        connect(m_socket, &QLocalSocket::readyRead, this, &Connection::processFrames);
+        connect(m_socket, &QLocalSocket::disconnected, this, &QObject::deleteLater);
+    }
+
+    void send(const QByteArray& frame) { m_socket->write(frame); }
+
+    // This user or root; other users of a --shared agent do not get the
+    // private output.
+    bool trusted() const { return m_trusted; }
+
+    // Send a reply that was deferred and carry on with queued requests.
+    void finishDeferred(const QByteArray& frame)
+    {
+        send(frame);
+        m_deferred = false;
+        processFrames();
+    }
+
+private:
+    void processFrames()
+    {
+        m_reader.append(m_socket->readAll());
+        if (m_processing) return; // a reply sent from handle(); the loop below goes on
+        m_processing = true;
+        MessageType type;
+        QByteArray payload;
+        while (!m_deferred && m_reader.next(&type, &payload)) {
+            handle(type, payload);
+        }
+        m_processing = false;
+        if (m_reader.failed()) {
+            appendLog("AgentServer: malformed frame, dropping client");
+            m_socket->abort();
+        }
+    }
+
+    void handle(MessageType type, const QByteArray& payload)
+    {
+        QDataStream in(payload);
+        prepare(in);
+
+        if (!m_greeted) {
+            quint16 version = 0;
+            QString client;
+            if (type == Hello) in >> version >> client;
+            if (type != Hello || version != ProtocolVersion) {
+                send(errorFrame(QString("expected Hello for protocol version %1").arg(ProtocolVersion)));
+                m_socket->disconnectFromServer();
+                return;
+            }
+            m_greeted = true;
+            appendLog(QString("AgentServer: client '%1' attached").arg(client));
+            send(m_server->welcomeFrame(m_trusted));
+            return;
+        }
+
+        switch (type) {
+        case GetSnapshot: {
+            QStringList sections;
+            qint64 maxAgeMs = -1;
+            in >> sections >> maxAgeMs;
+            m_deferred = true;
+            m_server->requestSnapshot(this, sections, maxAgeMs);
+            break;
+        }
+        case GetCommand: {
+            QString key;
+            bool wait = false;
+            in >> key >> wait;
+            m_deferred = true;
+            m_server->requestCommand(this, key, wait);
+            break;
+        }
+        case GetHistory: {
+            Writer w;
+            writeHistory(w.stream(), TimeSeriesStore::instance()->dump());
+            send(w.frame(History));
+            break;
+        }
+        case Subscribe: {
+            qint32 channels = 0;
+            in >> channels;
+            setChannels(channels);
+            break;
+        }
+        default:
+            send(errorFrame(QString("unexpected message type %1").arg(int(type))));
+            break;
+        }
+    }
+
+    void setChannels(int channels)
+    {
+        Sampler* sampler = Sampler::instance();
+        if (channels == 0) {
+            sampler->unsubscribe(this);
+            disconnect(sampler, &Sampler::sampleReady, this, nullptr);
+        } else {
+            if (m_channels == 0) connect(sampler, &Sampler::sampleReady, this, &Connection::onSample);
+            sampler->subscribe(this, Sampler::Channels(channels));
+        }
+        m_channels = channels;
+    }
+
+    void onSample(const SamplePtr& sample)
+    {
+        if (m_socket->bytesToWrite() > MaxQueuedSampleBytes) return;
+        Writer w;
+        writeSample(w.stream(), *sample, m_channels, m_netState);
+        send(w.frame(SampleFrame));
+    }
+
+    AgentServer* m_server;
+    QLocalSocket* m_socket;
+    bool m_trusted;
+    FrameReader m_reader;
+    NetDeltaState m_netState;
+    int m_channels = 0;
+    bool m_greeted = false;
+    bool m_deferred = false;
+    bool m_processing = false;
+};
+
+AgentServer::AgentServer(const Options& options, QObject* parent)
+    : QObject(parent)
+    , m_options(options)
+    , m_server(new QLocalServer(this))
+{
+    connect(m_server, &QLocalServer::newConnection, this, &AgentServer::onNewConnection);
+    connect(&m_refreshTimer, &QTimer::timeout, this, &AgentServer::refreshSections);
+    connect(&m_commandTimer, &QTimer::timeout, this, &AgentServer::refreshCommands);
+    // Refreshes are seconds to an hour apart; one that comes late does not
+    // matter, and the kernel gets to batch the wakeups.
+    m_refreshTimer.setTimerType(Qt::VeryCoarseTimer);
+    m_commandTimer.setTimerType(Qt::VeryCoarseTimer);
+}
+
+AgentServer::~AgentServer()
+{
+    m_server->close();
+}
+
+QStringList AgentServer::allowedCommands()
+{
+    return { "lshw -xml", "dmidecode -t memory" };
+}
+
+bool AgentServer::listen()
+{
+    const QString& path = m_options.socketPath;
+    if (!checkSocketDirectory(path, &m_error)) return false;
+
+    // Only replace the socket file if nobody answers on it.
+    QLocalSocket probe;
+    probe.connectToServer(path);
+    if (probe.waitForConnected(200)) {
+        m_error = QString("another agent is already listening on %1").arg(path);
+        return false;
+    }
+    QLocalServer::removeServer(path);
+
+    m_server->setSocketOptions(m_options.shared ? QLocalServer::WorldAccessOption : QLocalServer::UserAccessOption);
+    if (!m_server->listen(path)) {
+        m_error = QString("cannot listen on %1: %2").arg(path, m_server->errorString());
+        return false;
+    }
+    m_startedMs = QDateTime::currentMSecsSinceEpoch();
+    appendLog(QString("AgentServer: listening on %1").arg(path));
+
+    // Output kept from an earlier run answers at once; it is revalidated
+    // below like everything else.
+    SnapshotCache* cache = SnapshotCache::instance();
+    for (const QString& key : allowedCommands()) {
+        CommandState& state = m_commands[key];
+        state.available = cache->lookup(key, &state.output);
+    }
+
+    refreshSections();
+    refreshCommands();
+    m_refreshTimer.start(qMax(1, m_options.refreshSeconds) * 1000);
+    m_commandTimer.start(CommandRefreshMs);
+    return true;
+}
+
+void AgentServer::onNewConnection()
+{
+    while (QLocalSocket* socket = m_server->nextPendingConnection()) {
+        // The socket's permissions already keep others out unless
+        // --shared; the credentials are checked as well.
+        const qint64 uid = peerUid(socket->socketDescriptor());
+        const bool trusted = trustedPeer(uid);
+        if (!trusted && !m_options.shared) {
+            appendLog(QString("AgentServer: refused a client of uid %1").arg(uid));
+            socket->abort();
+            socket->deleteLater();
+            continue;
+        }
+        new Connection(this, socket, trusted);
+    }
+}
+
+void AgentServer::refreshSections()
+{
+    if (m_collecting) return;
+    m_collecting = true;
+
+    // The collectors block on files and external programs; keep them off
+    // the thread that serves clients.
+    QPointer<AgentServer> self(this);
+    QThreadPool::globalInstance()->start([self]() {
+        QElapsedTimer clock;
+        clock.start();
+        const QJsonObject sections = collectHeadlessSections();
+        const qint64 collectMs = clock.elapsed();
+        QMetaObject::invokeMethod(QCoreApplication::instance(), [self, sections, collectMs]() {
+            if (self) self->onSectionsCollected(sections, collectMs);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void AgentServer::onSectionsCollected(const QJsonObject& sections, qint64 collectMs)
+{
+    m_sections = sections;
+    m_sectionsAtMs = QDateTime::currentMSecsSinceEpoch();
+    m_collectMs = collectMs;
+    m_collecting = false;
+    appendLog(QString("AgentServer: sections collected in %1 ms").arg(collectMs));
+
+    const QList<SnapshotWaiter> waiters = m_snapshotWaiters;
+    m_snapshotWaiters.clear();
+    for (const SnapshotWaiter& w : waiters) {
+        if (w.connection) w.connection->finishDeferred(snapshotFrame(w.sections, w.connection->trusted()));
+    }
+}
+
+void AgentServer::requestSnapshot(Connection* connection, const QStringList& sections, qint64 maxAgeMs)
+{
+    const qint64 age = QDateTime::currentMSecsSinceEpoch() - m_sectionsAtMs;
+    if (m_sectionsAtMs == 0 || (maxAgeMs >= 0 && age > maxAgeMs)) {
+        m_snapshotWaiters.append(SnapshotWaiter{QPointer<Connection>(connection), sections});
+        refreshSections();
+        return;
+    }
+    connection->finishDeferred(snapshotFrame(sections, connection->trusted()));
+}
+
+QByteArray AgentServer::snapshotFrame(const QStringList& sections, bool trusted) const
+{
+    QJsonObject selected;
+    for (auto it = m_sections.constBegin(); it != m_sections.constEnd(); ++it) {
+        if (!sections.isEmpty() && !sections.contains(it.key())) continue;
+        selected.insert(it.key(), trusted ? it.value() : withoutPrivateRows(it.value()));
+    }
+    QJsonObject document = headlessDocument(selected, m_collectMs);
+    // When the data was collected, not when it was asked for.
+    document.insert("generated", QDateTime::fromMSecsSinceEpoch(m_sectionsAtMs, Qt::UTC).toString(Qt::ISODate));
+
+    Writer w;
+    w.stream() << QCborValue::fromJsonValue(document).toCbor();
+    return w.frame(Snapshot);
+}
+
+void AgentServer::refreshCommands()
+{
+    SnapshotCache* cache = SnapshotCache::instance();
+    for (const QString& key : allowedCommands()) {
+        // Firmware tables cannot change without a reboot.
+        if (key.startsWith("dmidecode") && m_commands.value(key).available && cache->isFresh(key)) continue;
+        runCommand(key, CollectorEngine::Background);
+    }
+}
+
+void AgentServer::runCommand(const QString& key, CollectorEngine::Priority priority)
+{
+    CommandState& state = m_commands[key];
+    if (state.ticket != 0) {
+        CollectorEngine::instance()->promote(this, priority);
+        return;
+    }
+    QStringList arguments = key.split(' ', Qt::SkipEmptyParts);
+    const QString program = arguments.takeFirst();
+    state.ticket = CollectorEngine::instance()->submit(program, arguments, this,
+        [this, key](const CollectorResult& result) { onCommandFinished(key, result); }, priority, CommandDeadlineMs);
+}
+
+void AgentServer::onCommandFinished(const QString& key, const CollectorResult& result)
+{
+    CommandState& state = m_commands[key];
+    state.ticket = 0;
+    if (result.ok() && result.exitCode == 0 && !result.standardOutput.isEmpty()) {
+        state.output = result.standardOutput;
+        state.available = true;
+        state.collectedAtMs = QDateTime::currentMSecsSinceEpoch();
+        SnapshotCache::instance()->store(key, result.standardOutput);
+    }
+    appendLog(QString("AgentServer: %1 finished in %2 ms (exit %3)").arg(key).arg(result.elapsedMs).arg(result.exitCode));
+
+    const QList<QPointer<Connection>> waiters = state.waiters;
+    state.waiters.clear();
+    const QByteArray frame = commandFrame(key);
+    for (const QPointer<Connection>& c : waiters) {
+        if (c) c->finishDeferred(frame);
+    }
+}
+
+void AgentServer::requestCommand(Connection* connection, const QString& key, bool wait)
+{
+    if (!allowedCommands().contains(key) || (!connection->trusted() && isPrivateCommand(key))) {
+        connection->finishDeferred(errorFrame(QString("command '%1' is not served by this agent").arg(key)));
+        return;
+    }
+    CommandState& state = m_commands[key];
+    if (state.available || !wait) {
+        // Nothing cached yet: answer now, but have it ready next time.
+        if (!state.available) runCommand(key, CollectorEngine::Visible);
+        connection->finishDeferred(commandFrame(key));
+        return;
+    }
+    state.waiters.append(QPointer<Connection>(connection));
+    runCommand(key, CollectorEngine::Visible);
+}
+
+QByteArray AgentServer::commandFrame(const QString& key) const
+{
+    const CommandState state = m_commands.value(key);
+    Writer w;
+    w.stream() << key << state.available << state.output;
+    return w.frame(Command);
+}
+
+QByteArray AgentServer::welcomeFrame(bool trusted) const
+{
+    QStringList commands = allowedCommands();
+    if (!trusted) commands.erase(std::remove_if(commands.begin(), commands.end(), isPrivateCommand), commands.end());
+    Writer w;
+    w.stream() << ProtocolVersion << qint64(QCoreApplication::applicationPid()) << m_startedMs
+               << headlessSectionNames() << commands;
+    return w.frame(Welcome);
+}
@@ -0,0 +1,97 @@
+#ifndef AGENT_SERVER_H
+#define AGENT_SERVER_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QHash>
+#include <QJsonObject>
+#include <QList>
+#include <QPointer>
+#include <QString>
+#include <QStringList>
+#include <QTimer>
+#include "collector_engine.h"
+
+class QLocalServer;
+
+// The serving half of lsv-agentd: listens on the agent socket and answers
+// clients from what the agent keeps warm.
+//
+//  - The headless sections (`lsv --json`) are recollected on a pool thread
+//    every refreshSeconds; snapshot requests are answered from that copy.
+//  - A short allowlist of expensive commands (lshw, dmidecode) is run
+//    through the CollectorEngine at Background priority and kept in memory
+//    and in the SnapshotCache.
+//  - History comes from the TimeSeriesStore the agent records into, and
+//    live samples are pushed to subscribers as the Sampler takes them.
+class AgentServer : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Options {
+        QString socketPath;
+        bool shared = false;            // socket usable by every local user,
+                                        // without the private command output
+        int refreshSeconds = 30;
+    };
+
+    explicit AgentServer(const Options& options, QObject* parent = nullptr);
+    ~AgentServer() override;
+
+    // Start listening and warming the caches. A stale socket file left by
+    // a crashed agent is replaced; a socket directory that other users can
+    // write to is refused.
+    bool listen();
+    QString errorString() const { return m_error; }
+
+    // Commands clients may ask for, as keys ("lshw -xml").
+    static QStringList allowedCommands();
+
+private:
+    class Connection;
+
+    struct CommandState {
+        QByteArray output;
+        bool available = false;
+        quint64 ticket = 0;             // non-zero while running
+        qint64 collectedAtMs = 0;
+        QList<QPointer<Connection>> waiters;
+    };
+
+    struct SnapshotWaiter {
+        QPointer<Connection> connection;
+        QStringList sections;
+    };
+
+    void onNewConnection();
+    void refreshSections();
+    void onSectionsCollected(const QJsonObject& sections, qint64 collectMs);
+    void refreshCommands();
+    void runCommand(const QString& key, CollectorEngine::Priority priority);
+    void onCommandFinished(const QString& key, const CollectorResult& result);
+
+    // Request handlers, called by Connection.
+    void requestSnapshot(Connection* connection, const QStringList& sections, qint64 maxAgeMs);
+    void requestCommand(Connection* connection, const QString& key, bool wait);
+    QByteArray snapshotFrame(const QStringList& sections, bool trusted) const;
+    QByteArray commandFrame(const QString& key) const;
+    QByteArray welcomeFrame(bool trusted) const;
+
+    Options m_options;
+    QLocalServer* m_server = nullptr;
+    QString m_error;
+    qint64 m_startedMs = 0;
+
+    QJsonObject m_sections;
+    qint64 m_sectionsAtMs = 0;          // 0: not collected yet
+    qint64 m_collectMs = 0;
+    bool m_collecting = false;
+    QList<SnapshotWaiter> m_snapshotWaiters;
+    QTimer m_refreshTimer;
+
+    QHash<QString, CommandState> m_commands;
+    QTimer m_commandTimer;
+};
+
+#endif // AGENT_SERVER_H
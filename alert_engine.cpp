@@ -0,0 +1,376 @@
+#include "alert_engine.h"
+#include "log_helper.h"
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMetaObject>
+#include <QMutexLocker>
+#include <QProcess>
+#include <QStandardPaths>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+
+namespace {
+
+constexpr double NoValue = std::numeric_limits<double>::quiet_NaN();
+
+struct MetricInfo {
+    const char* key;            // name in the rules file
+    const char* unit;
+    Sampler::Channel channel;
+};
+
+const MetricInfo Metrics[AlertRule::MetricCount] = {
+    {"memory.used_percent", "%", Sampler::Memory},
+    {"swap.used_percent", "%", Sampler::Memory},
+    {"cpu.busy_percent", "%", Sampler::Cpu},
+    {"cpu.max_core_busy_percent", "%", Sampler::Cpu},
+    {"cpu.freq_avg_khz", "kHz", Sampler::CpuFreq},
+    {"network.rx_bytes_per_second", "B/s", Sampler::Network},
+    {"network.tx_bytes_per_second", "B/s", Sampler::Network},
+};
+
+bool isNetworkMetric(AlertRule::Metric metric)
+{
+    return metric == AlertRule::NetRxBytesPerSec || metric == AlertRule::NetTxBytesPerSec;
+}
+
+QString eventText(const AlertRule& rule, double value)
+{
+    QString unit = QLatin1String(Metrics[rule.metric].unit);
+    if (rule.rate) unit += "/s";
+    return QString("%1 (%2 %3)").arg(rule.message.isEmpty() ? rule.name : rule.message,
+                                     QString::number(value, 'f', 1), unit);
+}
+
+} // namespace
+
+AlertEngine* AlertEngine::instance()
+{
+    static AlertEngine* engine = new AlertEngine(QCoreApplication::instance());
+    return engine;
+}
+
+AlertEngine::AlertEngine(QObject* parent)
+    : QObject(parent)
+{
+}
+
+QString AlertEngine::rulesPath()
+{
+    const QString path = qEnvironmentVariable("LSV_ALERTS");
+    if (!path.isEmpty()) return path;
+    return QStandardPaths::writableLocation(QStandardPaths::GenericConfigLocation) + "/lsv/alerts.json";
+}
+
+QVector<AlertRule> AlertEngine::defaultRules()
+{
+    auto rule = [](const char* name, AlertRule::Metric metric, double raiseAt, double clearAt, qint64 forMs,
+                   AlertRule::Severity severity, const char* message) {
+        AlertRule r;
+        r.name = name;
+        r.metric = metric;
+        r.raiseAt = raiseAt;
+        r.clearAt = clearAt;
+        r.forMs = forMs;
+        r.severity = severity;
+        r.message = message;
+        return r;
+    };
+    // Memory and swap use the levels the usage bars have always shown.
+    return {
+        rule("memory-high", AlertRule::MemoryUsedPercent, 75, 70, 10000, AlertRule::Warning, "Memory usage high"),
+        rule("memory-critical", AlertRule::MemoryUsedPercent, 90, 85, 10000, AlertRule::Critical, "Memory almost exhausted"),
+        rule("swap-high", AlertRule::SwapUsedPercent, 75, 70, 30000, AlertRule::Warning, "Swap usage high"),
+        rule("swap-critical", AlertRule::SwapUsedPercent, 90, 85, 30000, AlertRule::Critical, "Swap almost full"),
+        rule("cpu-busy", AlertRule::CpuBusyPercent, 95, 80, 60000, AlertRule::Warning, "CPU busy for a minute"),
+    };
+}
+
+bool AlertEngine::parseRules(const QByteArray& json, QVector<AlertRule>* rules, QString* error)
+{
+    QJsonParseError parseError;
+    const QJsonDocument document = QJsonDocument::fromJson(json, &parseError);
+    if (document.isNull()) {
+        *error = parseError.errorString();
+        return false;
+    }
+    const QJsonArray entries = document.isArray() ? document.array() : document.object().value("rules").toArray();
+
+    QVector<AlertRule> parsed;
+    for (int i = 0; i < entries.size(); ++i) {
+        const QJsonObject entry = entries[i].toObject();
+        AlertRule rule;
+        rule.name = entry.value("name").toString();
+        if (rule.name.isEmpty()) rule.name = QString("rule-%1").arg(i + 1);
+        auto fail = [&](const QString& what) {
+            *error = QString("rule %1: %2").arg(rule.name, what);
+            return false;
+        };
+
+        const QString metric = entry.value("metric").toString();
+        int m = 0;
+        while (m < AlertRule::MetricCount && metric != QLatin1String(Metrics[m].key)) ++m;
+        if (m == AlertRule::MetricCount) return fail(QString("unknown metric \"%1\"").arg(metric));
+        rule.metric = AlertRule::Metric(m);
+        rule.interface = entry.value("interface").toString();
+        if (!rule.interface.isEmpty() && !isNetworkMetric(rule.metric)) return fail("\"interface\" only applies to network metrics");
+
+        if (entry.contains("above") == entry.contains("below")) return fail("needs one of \"above\" or \"below\"");
+        rule.above = entry.contains("above");
+        rule.raiseAt = entry.value(rule.above ? "above" : "below").toDouble();
+        rule.clearAt = entry.value("clear").toDouble(rule.raiseAt);
+        if (rule.above ? rule.clearAt > rule.raiseAt : rule.clearAt < rule.raiseAt) {
+            return fail("\"clear\" must be on the other side of the threshold");
+        }
+        rule.forMs = qint64(entry.value("for").toDouble(0) * 1000);
+        rule.rate = entry.value("rate").toBool(false);
+
+        const QString severity = entry.value("severity").toString("warning");
+        if (severity == "critical") rule.severity = AlertRule::Critical;
+        else if (severity == "warning") rule.severity = AlertRule::Warning;
+        else return fail(QString("unknown severity \"%1\"").arg(severity));
+        rule.message = entry.value("message").toString();
+        parsed.append(rule);
+    }
+    *rules = parsed;
+    return true;
+}
+
+void AlertEngine::start()
+{
+    QVector<AlertRule> rules = defaultRules();
+    const QString path = rulesPath();
+    QFile file(path);
+    if (file.exists()) {
+        QString error;
+        QVector<AlertRule> loaded;
+        if (!file.open(QIODevice::ReadOnly)) {
+            error = file.errorString();
+        } else if (parseRules(file.readAll(), &loaded, &error)) {
+            rules = loaded;
+        }
+        if (!error.isEmpty()) {
+            const QString message = QString("%1: %2; using the default rules").arg(path, error);
+            LSV_LOG_WARNING("alerts", "AlertEngine: " + message);
+            if (m_stderr) std::fprintf(stderr, "%s: alerts: %s\n", qPrintable(QCoreApplication::applicationName()), qPrintable(message));
+        }
+    }
+    m_started = true;
+    setRules(rules);
+    Sampler::instance()->setAlertEngine(this);
+    appendLog(QString("AlertEngine: %1 rules").arg(rules.size()));
+}
+
+void AlertEngine::setRules(const QVector<AlertRule>& rules)
+{
+    QVector<RuleState> states;
+    states.reserve(rules.size());
+    for (const AlertRule& rule : rules) states.append(RuleState{rule});
+    {
+        QMutexLocker lock(&m_mutex);
+        m_rules.swap(states);
+        m_events.reserve(m_rules.size());
+    }
+
+    // Firing rules that are gone are cleared.
+    for (auto it = m_active.begin(); it != m_active.end();) {
+        bool kept = false;
+        for (const AlertRule& rule : rules) kept = kept || rule.name == it.key();
+        if (kept) {
+            ++it;
+            continue;
+        }
+        AlertEvent event = it.value();
+        event.raised = false;
+        it = m_active.erase(it);
+        emit alertChanged(event);
+    }
+
+    if (m_started) {
+        if (rules.isEmpty()) Sampler::instance()->unsubscribe(this);
+        else Sampler::instance()->subscribe(this, channels(), Sampler::Background);
+    }
+}
+
+QVector<AlertRule> AlertEngine::rules() const
+{
+    QMutexLocker lock(&m_mutex);
+    QVector<AlertRule> rules;
+    rules.reserve(m_rules.size());
+    for (const RuleState& state : m_rules) rules.append(state.rule);
+    return rules;
+}
+
+Sampler::Channels AlertEngine::channels() const
+{
+    QMutexLocker lock(&m_mutex);
+    Sampler::Channels wanted;
+    for (const RuleState& state : m_rules) wanted |= Metrics[state.rule.metric].channel;
+    return wanted;
+}
+
+bool AlertEngine::thresholds(AlertRule::Metric metric, double* warningAt, double* criticalAt) const
+{
+    QMutexLocker lock(&m_mutex);
+    bool found = false;
+    for (const RuleState& state : m_rules) {
+        const AlertRule& rule = state.rule;
+        if (rule.metric != metric || !rule.above || rule.rate || !rule.interface.isEmpty()) continue;
+        double* level = rule.severity == AlertRule::Critical ? criticalAt : warningAt;
+        *level = rule.raiseAt;
+        found = true;
+    }
+    return found;
+}
+
+double AlertEngine::ruleValue(RuleState& state, const double* values, const Sample& sample) const
+{
+    const AlertRule& rule = state.rule;
+    if (rule.interface.isEmpty() || !isNetworkMetric(rule.metric)) return values[rule.metric];
+    if (!(sample.channels & Sampler::Network)) return NoValue;
+
+    // Interfaces keep their position between samples unless one comes or
+    // goes, so the name is compared once and searched for rarely.
+    const QVector<NetDevCounters>& interfaces = sample.interfaces;
+    if (state.interfaceIndex < 0 || state.interfaceIndex >= interfaces.size()
+        || interfaces[state.interfaceIndex].name != rule.interface) {
+        state.interfaceIndex = -1;
+        for (int i = 0; i < interfaces.size(); ++i) {
+            if (interfaces[i].name == rule.interface) {
+                state.interfaceIndex = i;
+                break;
+            }
+        }
+        if (state.interfaceIndex < 0) return NoValue;
+    }
+    const NetDevCounters& counters = interfaces[state.interfaceIndex];
+    return rule.metric == AlertRule::NetRxBytesPerSec ? counters.rxBytesPerSec : counters.txBytesPerSec;
+}
+
+void AlertEngine::evaluate(const Sample& sample)
+{
+    // Every metric once per sample; a missing channel leaves NoValue and
+    // the rules on it keep their state.
+    double values[AlertRule::MetricCount];
+    for (double& v : values) v = NoValue;
+    if (sample.channels & Sampler::Memory) {
+        if (sample.memTotal > 0) {
+            values[AlertRule::MemoryUsedPercent] =
+                100.0 * double(sample.memTotal - qMin(sample.memAvailable, sample.memTotal)) / double(sample.memTotal);
+        }
+        if (sample.swapTotal > 0) {
+            values[AlertRule::SwapUsedPercent] =
+                100.0 * double(sample.swapTotal - qMin(sample.swapFree, sample.swapTotal)) / double(sample.swapTotal);
+        }
+    }
+    if (sample.channels & Sampler::Cpu) {
+        values[AlertRule::CpuBusyPercent] = sample.cpuBusyPercent;
+        double busiest = 0;
+        for (double percent : sample.cpuBusyPercents) busiest = qMax(busiest, percent);
+        values[AlertRule::CpuMaxCoreBusyPercent] = busiest;
+    }
+    if (sample.channels & Sampler::CpuFreq) {
+        double sum = 0;
+        int n = 0;
+        for (qint64 kHz : sample.curFreqKHz) {
+            if (kHz > 0) {
+                sum += double(kHz);
+                ++n;
+            }
+        }
+        if (n > 0) values[AlertRule::CpuFreqAvgKHz] = sum / n;
+    }
+    if (sample.channels & Sampler::Network) {
+        double rx = 0;
+        double tx = 0;
+        for (const NetDevCounters& counters : sample.interfaces) {
+            rx += counters.rxBytesPerSec;
+            tx += counters.txBytesPerSec;
+        }
+        values[AlertRule::NetRxBytesPerSec] = rx;
+        values[AlertRule::NetTxBytesPerSec] = tx;
+    }
+
+    const qint64 now = sample.timestampMs;
+    QMutexLocker lock(&m_mutex);
+    for (RuleState& state : m_rules) {
+        const AlertRule& rule = state.rule;
+        double value = ruleValue(state, values, sample);
+        if (std::isnan(value)) continue;
+        if (rule.rate) {
+            const double previous = state.previous;
+            const qint64 previousMs = state.previousMs;
+            state.previous = value;
+            state.previousMs = now;
+            if (previousMs < 0 || now <= previousMs) continue;
+            value = (value - previous) * 1000.0 / double(now - previousMs);
+        }
+
+        if (!state.firing) {
+            const bool beyond = rule.above ? value >= rule.raiseAt : value <= rule.raiseAt;
+            if (!beyond) {
+                state.pendingSinceMs = -1;
+                continue;
+            }
+            if (state.pendingSinceMs < 0) state.pendingSinceMs = now;
+            if (now - state.pendingSinceMs < rule.forMs) continue;
+            state.firing = true;
+        } else {
+            const bool back = rule.above ? value < rule.clearAt : value > rule.clearAt;
+            if (!back) continue;
+            state.firing = false;
+            state.pendingSinceMs = -1;
+        }
+        m_events.append(AlertEvent{rule.name, rule.severity, state.firing, value, now, eventText(rule, value)});
+    }
+    if (m_events.isEmpty()) return;
+
+    QVector<AlertEvent> events;
+    events.swap(m_events);
+    m_events.reserve(m_rules.size());
+    QMetaObject::invokeMethod(this, [this, events]() { deliver(events); }, Qt::QueuedConnection);
+}
+
+void AlertEngine::deliver(const QVector<AlertEvent>& events)
+{
+    for (const AlertEvent& event : events) {
+        if (event.raised) {
+            m_active.insert(event.rule, event);
+            if (event.severity == AlertRule::Critical) LSV_LOG_ERROR("alerts", "Alert: " + event.text);
+            else LSV_LOG_WARNING("alerts", "Alert: " + event.text);
+            if (m_stderr) printEvent(event);
+            if (m_desktop) notifyDesktop(event);
+        } else {
+            // A rule dropped by setRules() in the meantime was cleared there.
+            if (m_active.remove(event.rule) == 0) continue;
+            LSV_LOG_INFO("alerts", "Cleared: " + event.text);
+            if (m_stderr) printEvent(event);
+        }
+        emit alertChanged(event);
+    }
+}
+
+// "lsv-agentd: critical: Memory used 93.1 %", one line per transition, for
+// the journal when the agent runs as a service.
+void AlertEngine::printEvent(const AlertEvent& event) const
+{
+    const char* state = !event.raised ? "cleared"
+                        : event.severity == AlertRule::Critical ? "critical" : "warning";
+    std::fprintf(stderr, "%s: %s: %s\n", qPrintable(QCoreApplication::applicationName()), state, qPrintable(event.text));
+}
+
+void AlertEngine::notifyDesktop(const AlertEvent& event)
+{
+    static const QString notifySend = QStandardPaths::findExecutable("notify-send");
+    if (notifySend.isEmpty()) return;
+    QProcess::startDetached(notifySend, QStringList()
+                            << "--app-name=Linux System Viewer"
+                            << (event.severity == AlertRule::Critical ? "--urgency=critical" : "--urgency=normal")
+                            << QString("Alert: %1").arg(event.rule)
+                            << event.text);
+}
@@ -0,0 +1,126 @@
+#ifndef ALERT_ENGINE_H
+#define ALERT_ENGINE_H
+
+#include <QHash>
+#include <QMutex>
+#include <QObject>
+#include <QString>
+#include <QVector>
+#include "sampler.h"
+
+// One threshold rule.
+//
+// The rule fires once `metric` has been at or beyond `raiseAt` (above or
+// below it, depending on `above`) for `forMs`, and clears once it is back
+// past `clearAt`; a gap between the two keeps a value that hovers around
+// the threshold from flapping. With `rate` set, the rule looks at the
+// metric's change per second instead of its value.
+struct AlertRule {
+    enum Metric {
+        MemoryUsedPercent,          // (total - available) / total
+        SwapUsedPercent,
+        CpuBusyPercent,             // all cpus
+        CpuMaxCoreBusyPercent,      // busiest single cpu
+        CpuFreqAvgKHz,
+        NetRxBytesPerSec,           // `interface`, or all of them when empty
+        NetTxBytesPerSec,
+        MetricCount
+    };
+    enum Severity { Warning, Critical };
+
+    QString name;
+    Metric metric = MemoryUsedPercent;
+    QString interface;
+    bool above = true;
+    double raiseAt = 0;
+    double clearAt = 0;
+    qint64 forMs = 0;
+    bool rate = false;
+    Severity severity = Warning;
+    QString message;                // shown with the value; the name when empty
+};
+
+// A rule starting or stopping to fire.
+struct AlertEvent {
+    QString rule;
+    AlertRule::Severity severity = AlertRule::Warning;
+    bool raised = false;            // false: cleared
+    double value = 0;
+    qint64 timestampMs = 0;
+    QString text;                   // message and value, for display
+};
+
+// Evaluates the alert rules against every sample, on the sampler thread
+// (Sampler::setAlertEngine()), so alerts need no collection of their own.
+// The derived values are computed once per sample and each rule is a few
+// comparisons on its own state; nothing is allocated unless a rule changes
+// state. Transitions are handed to the GUI thread, written to the log and,
+// when enabled, to stderr (lsv-agentd, where the debug log is usually
+// compiled out) and sent as desktop notifications (notify-send).
+//
+// Rules come from the JSON file rulesPath(); without one the defaults
+// apply (memory and swap at 75 / 90 %, as the usage bars show them, and a
+// cpu busy for a minute). See README "Alerts" for the format.
+class AlertEngine : public QObject
+{
+    Q_OBJECT
+
+public:
+    static AlertEngine* instance();
+
+    // $LSV_ALERTS, else lsv/alerts.json in the user's config directory.
+    static QString rulesPath();
+    static QVector<AlertRule> defaultRules();
+    // Rules of a JSON document; false with *error set on a bad document.
+    static bool parseRules(const QByteArray& json, QVector<AlertRule>* rules, QString* error);
+
+    // Load the rules, subscribe to the channels they need and start
+    // evaluating.
+    void start();
+    void setRules(const QVector<AlertRule>& rules);
+    QVector<AlertRule> rules() const;
+    void setDesktopNotifications(bool enabled) { m_desktop = enabled; }
+    // Also print transitions and a bad rules file on stderr.
+    void setStandardError(bool enabled) { m_stderr = enabled; }
+
+    // Warning and critical levels of the plain `above` rules on metric, for
+    // widgets that colour the same value. False when there is none.
+    bool thresholds(AlertRule::Metric metric, double* warningAt, double* criticalAt) const;
+
+    // Rules firing now, by rule name.
+    QVector<AlertEvent> active() const { return m_active.values(); }
+
+    // Called by the sampler thread for every sample.
+    void evaluate(const Sample& sample);
+
+signals:
+    void alertChanged(const AlertEvent& event);
+
+private:
+    explicit AlertEngine(QObject* parent = nullptr);
+
+    struct RuleState {
+        AlertRule rule;
+        bool firing = false;
+        qint64 pendingSinceMs = -1;     // beyond raiseAt since then
+        int interfaceIndex = -1;        // last position of rule.interface
+        double previous = 0;            // for rate rules
+        qint64 previousMs = -1;
+    };
+
+    Sampler::Channels channels() const;
+    double ruleValue(RuleState& state, const double* values, const Sample& sample) const;
+    void deliver(const QVector<AlertEvent>& events);
+    void notifyDesktop(const AlertEvent& event);
+    void printEvent(const AlertEvent& event) const;
+
+    mutable QMutex m_mutex;             // m_rules, between setRules() and evaluate()
+    QVector<RuleState> m_rules;
+    QVector<AlertEvent> m_events;       // sampler thread scratch
+    QHash<QString, AlertEvent> m_active;
+    bool m_desktop = false;
+    bool m_stderr = false;
+    bool m_started = false;
+};
+
+#endif // ALERT_ENGINE_H
@@ -0,0 +1,36 @@
+#include "alerts_panel.h"
+#include "alert_engine.h"
+#include <QDateTime>
+#include <algorithm>
+
+AlertsPanel::AlertsPanel(QWidget* parent)
+    : QListWidget(parent)
+{
+    setObjectName("alertsPanel");
+    setMaximumHeight(100);
+    setUniformItemSizes(true);
+    setFocusPolicy(Qt::NoFocus);
+    setSelectionMode(QAbstractItemView::NoSelection);
+    connect(AlertEngine::instance(), &AlertEngine::alertChanged, this, &AlertsPanel::refresh);
+    refresh();
+}
+
+void AlertsPanel::refresh()
+{
+    QVector<AlertEvent> alerts = AlertEngine::instance()->active();
+    std::sort(alerts.begin(), alerts.end(), [](const AlertEvent& a, const AlertEvent& b) {
+        if (a.severity != b.severity) return a.severity > b.severity;
+        return a.timestampMs < b.timestampMs;
+    });
+
+    clear();
+    for (const AlertEvent& alert : alerts) {
+        const bool critical = alert.severity == AlertRule::Critical;
+        const QString since = QDateTime::fromMSecsSinceEpoch(alert.timestampMs).toString("HH:mm:ss");
+        QListWidgetItem* item = new QListWidgetItem(QString("%1  %2 (since %3)")
+                                                    .arg(critical ? "Critical:" : "Warning:", alert.text, since), this);
+        item->setForeground(critical ? QColor("#c0392b") : QColor("#b9770e"));
+        item->setToolTip(alert.rule);
+    }
+    setVisible(!alerts.isEmpty());
+}
@@ -0,0 +1,20 @@
+#ifndef ALERTS_PANEL_H
+#define ALERTS_PANEL_H
+
+#include <QListWidget>
+
+// The alerts firing now (AlertEngine::active()), critical ones first, one
+// line each. Hidden while nothing fires; the caller places it in its
+// layout, between the title bar and the tabs.
+class AlertsPanel : public QListWidget
+{
+    Q_OBJECT
+
+public:
+    explicit AlertsPanel(QWidget* parent = nullptr);
+
+private:
+    void refresh();
+};
+
+#endif // ALERTS_PANEL_H
@@ -0,0 +1,597 @@
+// lsv_bench: micro-benchmarks for the parsers and collectors on the refresh
+// paths. Every case runs against stored sample inputs (bench/data) or inputs
+// generated from them, never against the machine it runs on, so numbers are
+// comparable between runs and hosts.
+//
+//   lsv_bench [--filter <substring>] [--min-time <ms>] [--replay <dir>]
+//
+// Reports ns/op and the malloc calls and bytes requested per op.
+//
+// "laptop" is an 8-thread notebook; "server" a 2-socket, 256-thread machine
+// with 5000 network interfaces. The collectors read /proc and /sys through
+// procfs::setRootDirectory(), pointed at a sysroot written to a temp dir.
+// --replay adds a "replay" profile that runs the same cases against an
+// archive recorded with LSV_CAPTURE (see capture.h) on some other machine.
+
+#include <QApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QRegularExpression>
+#include <QTableWidget>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <QVector>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+
+#include "cpu.h"
+#include "storage.h"
+#include "network.h"
+#include "gui_helpers.h"
+#include "summary_tab.h"
+#include "ports_tab.h"
+#include "screen_tab.h"
+#include "search_index.h"
+#include "fleet_aggregate.h"
+#include "info_table_model.h"
+#include "capture.h"
+#include "snapshot_diff.h"
+#include "snapshot_file.h"
+#include "lshw_probe.h"
+#include "metrics_exporter.h"
+#include "alert_engine.h"
+#include "tabs_config.h"
+
+// ---- allocation counting ---------------------------------------------------
+
+// malloc and friends are replaced in this executable so that allocations
+// made by Qt and libstdc++ are counted as well; the real work is left to
+// glibc. Only the thread running a benchmark counts.
+namespace {
+thread_local bool t_counting = false;
+std::atomic<quint64> g_allocCount{0};
+std::atomic<quint64> g_allocBytes{0};
+
+inline void countAllocation(size_t bytes)
+{
+    if (!t_counting) return;
+    g_allocCount.fetch_add(1, std::memory_order_relaxed);
+    g_allocBytes.fetch_add(bytes, std::memory_order_relaxed);
+}
+} // namespace
+
+#ifdef __GLIBC__
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+
+void* malloc(size_t size)
+{
+    countAllocation(size);
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size)
+{
+    countAllocation(count * size);
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* ptr, size_t size)
+{
+    countAllocation(size);
+    return __libc_realloc(ptr, size);
+}
+}
+#endif
+
+// ---- sample inputs ---------------------------------------------------------
+
+namespace {
+
+QString readData(const QString& name)
+{
+    QFile file(QStringLiteral(LSV_BENCH_DATA_DIR "/") + name);
+    if (!file.open(QIODevice::ReadOnly)) {
+        std::fprintf(stderr, "lsv_bench: missing sample input %s\n", qPrintable(file.fileName()));
+        std::exit(1);
+    }
+    return QString::fromUtf8(file.readAll());
+}
+
+void writeFile(const QString& root, const QString& path, const QString& content)
+{
+    const QString fullPath = root + path;
+    QDir().mkpath(QFileInfo(fullPath).path());
+    QFile file(fullPath);
+    if (!file.open(QIODevice::WriteOnly) || file.write(content.toUtf8()) < 0) {
+        std::fprintf(stderr, "lsv_bench: cannot write %s\n", qPrintable(fullPath));
+        std::exit(1);
+    }
+}
+
+// 256 logical cpus (2 sockets x 128 cores) from one stored cpuinfo entry.
+QString serverCpuinfo()
+{
+    const QString entry = readData("server/cpuinfo_entry");
+    QString out;
+    for (int cpu = 0; cpu < 256; ++cpu) {
+        QString e = entry;
+        e.replace(QRegularExpression("^processor\\t: 0$", QRegularExpression::MultilineOption), QString("processor\t: %1").arg(cpu));
+        e.replace(QRegularExpression("^physical id\\t: 0$", QRegularExpression::MultilineOption), QString("physical id\t: %1").arg(cpu / 128));
+        e.replace(QRegularExpression("^core id\\t\\t: 0$", QRegularExpression::MultilineOption), QString("core id\t\t: %1").arg(cpu % 128));
+        out += e;
+    }
+    return out;
+}
+
+// Bonds, VLANs and container veths as on a hypervisor: 5000 interfaces.
+QStringList serverInterfaces()
+{
+    QStringList names;
+    names << "lo" << "eno1" << "eno2" << "ens1f0" << "ens1f1" << "bond0";
+    for (int vlan = 100; names.size() < 1000; ++vlan) names << QString("bond0.%1").arg(vlan);
+    for (int i = 0; names.size() < 5000; ++i) names << QString("veth%1").arg(i, 7, 16, QChar('0'));
+    return names;
+}
+
+QString netDevFor(const QStringList& interfaces)
+{
+    QString out = "Inter-|   Receive                                                |  Transmit\n"
+                  " face |bytes    packets errs drop fifo frame compressed multicast|bytes    packets errs drop fifo colls carrier compressed\n";
+    quint64 seed = 0x9e3779b97f4a7c15ull;
+    for (const QString& name : interfaces) {
+        seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+        const quint64 rx = seed >> 24, tx = seed >> 30;
+        out += QString("%1: %2 %3    0 %4    0     0          0         0 %5 %6    0    0    0     0       0          0\n")
+                   .arg(name, 6).arg(rx, 12).arg(rx / 900, 8).arg(seed % 7).arg(tx, 12).arg(tx / 700, 8);
+    }
+    return out;
+}
+
+QString serverPartitions()
+{
+    QString out = "major minor  #blocks  name\n\n";
+    for (int d = 0; d < 24; ++d) {
+        out += QString(" 259 %1 3750738264 nvme%2n1\n").arg(d * 8, 5).arg(d);
+        for (int p = 1; p <= 3; ++p) out += QString(" 259 %1 1250246088 nvme%2n1p%3\n").arg(d * 8 + p, 5).arg(d).arg(p);
+    }
+    for (int d = 0; d < 26; ++d) {
+        out += QString("   8 %1 15625879552 sd%2\n").arg(d * 16, 5).arg(QChar('a' + d));
+        out += QString("   8 %1 15625878528 sd%2%3\n").arg(d * 16 + 1, 5).arg(QChar('a' + d)).arg(1);
+    }
+    for (int d = 0; d < 64; ++d) out += QString(" 253 %1 1073741824 dm-%2\n").arg(d, 5).arg(d);
+    return out;
+}
+
+QString serverLshwShort(const QStringList& interfaces)
+{
+    QString out = "H/W path              Device          Class          Description\n"
+                  "=================================================================\n"
+                  "                                      system         PowerEdge R7625 (SKU=0B32)\n"
+                  "/0                                    bus            0N5YD6\n";
+    for (int socket = 0; socket < 2; ++socket) {
+        out += QString("/0/%1                                  processor      AMD EPYC 9754 128-Core Processor\n").arg(400 + socket);
+        out += QString("/0/%1/%2                              memory         16MiB L2 cache\n").arg(400 + socket).arg(socket);
+    }
+    out += "/0/1000                               memory         1536GiB System Memory\n";
+    for (int dimm = 0; dimm < 24; ++dimm) {
+        out += QString("/0/1000/%1                             memory         64GiB DIMM DDR5 Synchronous Registered (Buffered) 4800 MHz (0.2 ns)\n").arg(dimm);
+    }
+    for (int d = 0; d < 24; ++d) {
+        out += QString("/0/100/3.%1/0/0      /dev/nvme%1n1    disk           3840GB NVMe disk\n").arg(d);
+    }
+    for (int d = 0; d < 26; ++d) {
+        out += QString("/0/120/0.0.%1        /dev/sd%2        disk           16TB ST16000NM004J\n").arg(d).arg(QChar('a' + d));
+    }
+    out += "/0/140/0                              display        Integrated Matrox G200eW3 Graphics Controller\n";
+    int n = 0;
+    for (const QString& name : interfaces) {
+        if (name == "lo") continue;
+        out += QString("/%1                %2      network        Ethernet interface\n").arg(++n).arg(name);
+    }
+    return out;
+}
+
+QString serverPorts()
+{
+    QString out;
+    for (int bus = 1; bus <= 16; ++bus) {
+        out += QString("/:  Bus %1.Port 1: Dev 1, Class=root_hub, Driver=xhci_hcd/16p, 10000M\n").arg(bus, 2, 10, QChar('0'));
+        for (int dev = 2; dev < 10; ++dev) {
+            out += QString("    |__ Port %1: Dev %2, If 0, Class=Mass Storage, Driver=usb-storage, 5000M\n").arg(dev - 1).arg(dev);
+            out += QString("    |__ Port %1: Dev %2, If 1, Class=Human Interface Device, Driver=usbhid, 12M\n").arg(dev - 1).arg(dev);
+        }
+    }
+    for (int c = 0; c < 32; ++c) {
+        out += QString("%1:00.3 USB controller: Advanced Micro Devices, Inc. [AMD] Genoa USB 3.1 xHCI Compliant Host Controller\n").arg(c, 2, 16, QChar('0'));
+        out += QString("%1:00.4 Serial bus controller: Advanced Micro Devices, Inc. [AMD] Genoa I2C Controller\n").arg(c, 2, 16, QChar('0'));
+    }
+    return out;
+}
+
+// Eight-output display wall; the laptop sample with more heads and modes.
+QString wallXrandr()
+{
+    const QString laptop = readData("laptop/xrandr");
+    QString out = "Screen 0: minimum 320 x 200, current 15360 x 4320, maximum 16384 x 16384\n";
+    const QStringList lines = laptop.split('\n');
+    for (int head = 0; head < 8; ++head) {
+        out += QString("DP-%1 connected %2+%3+%4 (normal left inverted right x axis y axis) 597mm x 336mm\n")
+                   .arg(head + 1).arg(head == 0 ? QString("primary 3840x2160") : QString("3840x2160"))
+                   .arg((head % 4) * 3840).arg((head / 4) * 2160);
+        out += "   3840x2160     60.00*+  59.94    50.00    30.00\n";
+        for (const QString& line : lines) {
+            if (line.startsWith("   ")) out += line + '\n';
+        }
+    }
+    return out;
+}
+
+// Writes /proc and /sys for one machine profile below root.
+void writeSysroot(const QString& root, const QString& cpuinfo, const QStringList& interfaces,
+                  const QString& netDev, const QString& netRoute, const QString& partitions)
+{
+    writeFile(root, "/proc/cpuinfo", cpuinfo);
+    writeFile(root, "/sys/devices/system/cpu/cpu0/cpufreq/cpuinfo_max_freq", "4700000\n");
+    writeFile(root, "/sys/devices/system/cpu/cpu0/cpufreq/cpuinfo_min_freq", "400000\n");
+    writeFile(root, "/proc/partitions", partitions);
+    writeFile(root, "/proc/net/dev", netDev);
+    writeFile(root, "/proc/net/route", netRoute);
+    int index = 0;
+    for (const QString& name : interfaces) {
+        const QString dir = "/sys/class/net/" + name + "/";
+        ++index;
+        writeFile(root, dir + "ifindex", QString("%1\n").arg(index));
+        writeFile(root, dir + "flags", name == "lo" ? "0x9\n" : "0x1003\n");
+        writeFile(root, dir + "address", name == "lo" ? "00:00:00:00:00:00\n"
+                                                      : QString("52:54:00:%1:%2:%3\n").arg((index >> 16) & 0xff, 2, 16, QChar('0'))
+                                                            .arg((index >> 8) & 0xff, 2, 16, QChar('0')).arg(index & 0xff, 2, 16, QChar('0')));
+        writeFile(root, dir + "mtu", name == "lo" ? "65536\n" : "1500\n");
+    }
+}
+
+QStringList interfacesOf(const QString& netDev)
+{
+    QStringList names;
+    const QStringList lines = netDev.split('\n', Qt::SkipEmptyParts);
+    for (int i = 2; i < lines.size(); ++i) names << lines[i].section(':', 0, 0).trimmed();
+    return names;
+}
+
+// ---- tabs ------------------------------------------------------------------
+
+// parseOutput() is protected; these only widen access for the benchmark.
+class BenchSummaryTab : public SummaryTab
+{
+public:
+    using SummaryTab::parseOutput;
+};
+
+class BenchPortsTab : public PortsTab
+{
+public:
+    using PortsTab::parseOutput;
+};
+
+class BenchScreenTab : public ScreenTab
+{
+public:
+    using ScreenTab::parseOutput;
+};
+
+QTableWidget* newInfoTable()
+{
+    QTableWidget* table = new QTableWidget(0, 4);
+    table->setHorizontalHeaderLabels(QStringList() << "Property" << "Value" << "Unit" << "Type");
+    return table;
+}
+
+// ---- runner ----------------------------------------------------------------
+
+struct Options {
+    QString filter;
+    qint64 minTimeMs = 200;
+    QString replay;
+};
+
+// Archived output of a tab's shell command.
+QString replayedTabOutput(const QString& tabName)
+{
+    for (const TabConfig& tab : TAB_CONFIGS) {
+        if (tab.name == tabName) {
+            return QString::fromLocal8Bit(Capture::replay("bash", QStringList() << "-c" << tab.command).standardOutput);
+        }
+    }
+    return QString();
+}
+
+// An `lsv --json` document holding these sections of rows (the layout of
+// rowsToJson() in lsv_headless.cpp).
+QJsonObject snapshotDocument(const QList<QPair<QString, InfoRows>>& sections)
+{
+    QJsonObject all;
+    for (const auto& section : sections) {
+        QJsonArray rows;
+        for (const QStringList& cells : section.second) {
+            QJsonObject row;
+            row.insert("property", cells.value(0).trimmed());
+            row.insert("value", cells.value(1));
+            if (!cells.value(2).isEmpty()) row.insert("unit", cells.value(2));
+            rows.append(row);
+        }
+        all.insert(section.first, rows);
+    }
+    QJsonObject document;
+    document.insert("sections", all);
+    return document;
+}
+
+void discardMessages(QtMsgType, const QMessageLogContext&, const QString&) {}
+
+void run(const Options& options, const QString& name, const QString& size, const std::function<void()>& op)
+{
+    const QString label = name + '/' + size;
+    if (!options.filter.isEmpty() && !label.contains(options.filter)) return;
+
+    // The tabs log every parse through qDebug; keep that out of the numbers.
+    const QtMessageHandler previous = qInstallMessageHandler(discardMessages);
+    op(); // warm up caches, fonts, lazily built statics
+
+    g_allocCount = 0;
+    g_allocBytes = 0;
+    quint64 iterations = 0;
+    QElapsedTimer timer;
+    timer.start();
+    t_counting = true;
+    for (quint64 batch = 1; timer.elapsed() < options.minTimeMs; batch *= 2) {
+        for (quint64 i = 0; i < batch; ++i) op();
+        iterations += batch;
+    }
+    t_counting = false;
+    const qint64 elapsedNs = timer.nsecsElapsed();
+    qInstallMessageHandler(previous);
+
+    std::printf("%-34s %14.0f %12.1f %14.0f %10llu\n", qPrintable(label),
+                double(elapsedNs) / double(iterations),
+                double(g_allocCount.load()) / double(iterations),
+                double(g_allocBytes.load()) / double(iterations),
+                static_cast<unsigned long long>(iterations));
+    std::fflush(stdout);
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    // Offscreen and without PATH: the tabs are constructed for parseOutput()
+    // only, the commands they start on construction must not run anything.
+    qputenv("QT_QPA_PLATFORM", "offscreen");
+    qputenv("PATH", "");
+    QTemporaryDir cacheHome;
+    qputenv("XDG_CACHE_HOME", cacheHome.path().toLocal8Bit());
+
+    QApplication app(argc, argv);
+
+    Options options;
+    const QStringList args = app.arguments();
+    for (int i = 1; i < args.size(); ++i) {
+        if (args[i] == "--filter" && i + 1 < args.size()) {
+            options.filter = args[++i];
+        } else if (args[i] == "--min-time" && i + 1 < args.size()) {
+            options.minTimeMs = qMax(1, args[++i].toInt());
+        } else if (args[i] == "--replay" && i + 1 < args.size()) {
+            options.replay = args[++i];
+        } else {
+            std::fprintf(stderr, "usage: lsv_bench [--filter <substring>] [--min-time <ms>] [--replay <dir>]\n");
+            return 2;
+        }
+    }
+
+    QTemporaryDir laptopRoot;
+    QTemporaryDir serverRoot;
+    if (!laptopRoot.isValid() || !serverRoot.isValid()) {
+        std::fprintf(stderr, "lsv_bench: cannot create a temporary directory\n");
+        return 1;
+    }
+
+    const QString laptopNetDev = readData("laptop/net_dev");
+    const QStringList serverNics = serverInterfaces();
+    const QString serverNetDev = netDevFor(serverNics);
+    const QString netRoute = readData("laptop/net_route");
+    writeSysroot(laptopRoot.path(), readData("laptop/cpuinfo"), interfacesOf(laptopNetDev), laptopNetDev,
+                 netRoute, readData("laptop/partitions"));
+    writeSysroot(serverRoot.path(), serverCpuinfo(), serverNics, serverNetDev,
+                 QString(netRoute).replace("wlp0s20f3", "bond0"), serverPartitions());
+
+    struct Profile {
+        QString name;
+        QString root;
+        QString lshw;
+        QString ports;
+        QString xrandr;
+    };
+    QVector<Profile> profiles = {
+        { "laptop", laptopRoot.path(), readData("laptop/lshw_short"), readData("laptop/ports"), readData("laptop/xrandr") },
+        { "server", serverRoot.path(), serverLshwShort(serverNics), serverPorts(), wallXrandr() },
+    };
+    if (!options.replay.isEmpty()) {
+        if (!Capture::startReplay(options.replay)) {
+            std::fprintf(stderr, "lsv_bench: no capture archive in %s\n", qPrintable(options.replay));
+            return 1;
+        }
+        // The Summary tab shows the lshw tree as `lshw -short` renders it.
+        LshwProbe::instance()->adopt(Capture::replay("lshw", QStringList() << "-xml").standardOutput);
+        profiles.append({ "replay", Capture::directory() + "/root", LshwProbe::instance()->shortListing(),
+                          replayedTabOutput("Ports"), replayedTabOutput("Screen") });
+    }
+
+    BenchSummaryTab summaryTab;
+    BenchPortsTab portsTab;
+    BenchScreenTab screenTab;
+
+    std::printf("%-34s %14s %12s %14s %10s\n", "benchmark", "ns/op", "allocs/op", "bytes/op", "iterations");
+    for (const Profile& profile : profiles) {
+        procfs::setRootDirectory(profile.root.toStdString());
+
+        QTableWidget* cpuTable = newInfoTable();
+        QTableWidget* storageTable = newInfoTable();
+        QTableWidget* networkTable = newInfoTable();
+
+        run(options, "collectCpuInformation", profile.name, [] { collectCpuInformation(); });
+        run(options, "loadCpuInformation", profile.name, [cpuTable] { loadCpuInformation(cpuTable, QJsonObject()); });
+        // Mounted volumes come from the live mount table (QStorageInfo);
+        // only /proc/partitions follows the sample input.
+        run(options, "collectDiskCapacities", profile.name, [] { collectDiskCapacities(); });
+        run(options, "loadLiveStorageInformation", profile.name, [storageTable] { loadLiveStorageInformation(storageTable); });
+        // Addresses come from getifaddrs() on this host and do not match the
+        // sample interfaces; everything else is read from the sysroot.
+        run(options, "collectNetworkInformation", profile.name, [] { collectNetworkInformation(); });
+        run(options, "loadNetworkInformation", profile.name, [networkTable] { loadNetworkInformation(networkTable, QJsonObject()); });
+
+        run(options, "SummaryTab::parseOutput", profile.name, [&] { summaryTab.parseOutput(profile.lshw); });
+        run(options, "PortsTab::parseOutput", profile.name, [&] { portsTab.parseOutput(profile.ports); });
+        run(options, "ScreenTab::parseOutput", profile.name, [&] { screenTab.parseOutput(profile.xrandr); });
+
+        // Refreshing a table whose rows did not change: QTableWidget rebuilt
+        // with addRowsToTable() against the keyed model, which only compares.
+        const InfoRows networkRows = collectNetworkInformation();
+        run(options, "addRowsToTable(refresh)", profile.name, [&] {
+            networkTable->setRowCount(0);
+            addRowsToTable(networkTable, networkRows);
+        });
+        InfoTableModel networkModel(getNetworkHeaders());
+        networkModel.setRows(networkRows);
+        run(options, "InfoTableModel::setRows", profile.name, [&] { networkModel.setRows(networkRows); });
+
+        // Two snapshots of the machine: equal, and with one value changed
+        // in the middle of the network section.
+        const InfoRows cpuRows = collectCpuInformation();
+        InfoRows changedRows = networkRows;
+        if (!changedRows.isEmpty()) changedRows[changedRows.size() / 2][1] += " (changed)";
+        const QJsonObject beforeDocument = snapshotDocument({{"cpu", cpuRows}, {"network", networkRows}});
+        const QJsonObject afterDocument = snapshotDocument({{"cpu", cpuRows}, {"network", changedRows}});
+        const SnapshotTree beforeTree = SnapshotTree::fromDocument(beforeDocument);
+        const SnapshotTree sameTree = SnapshotTree::fromDocument(beforeDocument);
+        const SnapshotTree afterTree = SnapshotTree::fromDocument(afterDocument);
+        run(options, "SnapshotTree::fromDocument", profile.name, [&] { SnapshotTree::fromDocument(afterDocument); });
+        run(options, "diffSnapshots(equal)", profile.name, [&] { diffSnapshots(beforeTree, sameTree); });
+        run(options, "diffSnapshots(one change)", profile.name, [&] { diffSnapshots(beforeTree, afterTree); });
+
+        // The same document as a binary snapshot: opening maps it, a
+        // section is decoded when read.
+        const QString snapshotPath = cacheHome.filePath(profile.name + ".lsvsnap");
+        SnapshotFileWriter writer;
+        writer.addDocument(beforeDocument);
+        writer.save(snapshotPath, false);
+        run(options, "SnapshotFile::open", profile.name, [&] { SnapshotFile file; file.open(snapshotPath); });
+        SnapshotFile snapshot;
+        snapshot.open(snapshotPath);
+        run(options, "SnapshotFile::rows", profile.name, [&] { snapshot.rows("section/network"); });
+
+        // lsv-fleet's fingerprint: two machines built the same, which only
+        // differ in the board serial and the BogoMIPS reading, are one
+        // configuration; a different memory module is another.
+        const InfoRows board = {
+            {"Manufacturer", "ASUSTeK COMPUTER INC."}, {"Model", "PRIME B550M-A"}, {"Version", "Rev X.0x"},
+            {"Serial Number", "210585914800123"}, {"BIOS Vendor", "American Megatrends Inc."}, {"BIOS Version", "3002"},
+        };
+        InfoRows twinBoard = board;
+        twinBoard[3][1] = "210585914800456";
+        InfoRows twinCpu = cpuRows;
+        for (QStringList& cells : twinCpu) {
+            if (cells.value(0) == "Bogomips") cells[1] += "1";
+        }
+        const QStringList modules = {"16 GB", "No Module Installed", "16 GB", "No Module Installed"};
+        const quint64 fingerprint = hardwareFingerprint(cpuRows, board, modules);
+        if (hardwareFingerprint(twinCpu, twinBoard, modules) != fingerprint
+            || hardwareFingerprint(cpuRows, board, {"16 GB", "No Module Installed", "32 GB", "No Module Installed"}) == fingerprint) {
+            std::fprintf(stderr, "lsv_bench: hardwareFingerprint does not tell configurations apart (%s)\n", qPrintable(profile.name));
+            return 1;
+        }
+        run(options, "hardwareFingerprint", profile.name, [&] { hardwareFingerprint(cpuRows, board, modules); });
+
+        // One /metrics scrape: 256 CPUs and 1000 interfaces on the server.
+        // The output buffer is reused, as MetricsExporter does, so after
+        // the first run nothing should allocate.
+        const bool server = profile.name == "server";
+        Sample sample;
+        sample.timestampMs = 1700000000123;
+        sample.channels = Sampler::Cpu | Sampler::Memory | Sampler::Network | Sampler::CpuFreq;
+        for (int cpu = 0; cpu < (server ? 256 : 8); ++cpu) {
+            CpuTimes times;
+            times.user = 123456 + cpu;
+            times.system = 23456;
+            times.idle = 9876543;
+            times.iowait = 321;
+            sample.cpus.append(times);
+            sample.curFreqKHz.append(2400000 + cpu);
+        }
+        sample.memTotal = 64ull << 30;
+        sample.memAvailable = 40ull << 30;
+        for (int i = 0; i < (server ? 1000 : 3); ++i) {
+            NetDevCounters counters;
+            counters.name = QString("eno%1").arg(i);
+            counters.rxBytes = 987654321ull * (i + 1);
+            counters.txBytes = 123456789ull * (i + 1);
+            sample.interfaces.append(counters);
+        }
+        const QVector<FilesystemUsage> filesystems = collectFilesystemUsage();
+        QByteArray metrics;
+        renderMetrics(metrics, &sample, filesystems);
+        run(options, "renderMetrics", profile.name, [&] {
+            metrics.resize(0);
+            renderMetrics(metrics, &sample, filesystems);
+        });
+
+        // 300 alert rules on the same sample, a third of them on single
+        // interfaces, as the sampler thread evaluates them every tick.
+        sample.cpuBusyPercents.fill(42.0, sample.cpus.size());
+        sample.cpuBusyPercent = 42.0;
+        QVector<AlertRule> alertRules;
+        for (int i = 0; i < 300; ++i) {
+            AlertRule rule;
+            rule.name = QString("rule-%1").arg(i);
+            rule.metric = AlertRule::Metric(i % AlertRule::MetricCount);
+            if (i % 3 == 0) {
+                rule.metric = AlertRule::NetRxBytesPerSec;
+                rule.interface = sample.interfaces[i % sample.interfaces.size()].name;
+            }
+            rule.raiseAt = rule.clearAt = double(i % 100);
+            rule.forMs = 5000;
+            rule.rate = i % 10 == 0;
+            alertRules.append(rule);
+        }
+        AlertEngine::instance()->setRules(alertRules);
+        run(options, "AlertEngine::evaluate(300 rules)", profile.name, [&] { AlertEngine::instance()->evaluate(sample); });
+        AlertEngine::instance()->setRules({});
+
+        // Search over the filled tables, as the search tab does.
+        loadCpuInformation(cpuTable, QJsonObject());
+        loadLiveStorageInformation(storageTable);
+        loadNetworkInformation(networkTable, QJsonObject());
+        const QList<QTableWidget*> tables = { cpuTable, storageTable, networkTable };
+        const QStringList tabNames = { "CPU", "Storage", "Network" };
+        run(options, "performSearch", profile.name, [&] { performSearch("rx bytes", tables, tabNames, false); });
+        run(options, "performSearch(regex)", profile.name, [&] { performSearch("(eno|bond)\\d+ mtu", tables, tabNames, true); });
+
+        // The same tables through the title-bar search index.
+        QWidget page;
+        for (QTableWidget* table : tables) table->setParent(&page);
+        SearchIndex* index = SearchIndex::instance();
+        run(options, "SearchIndex::publish", profile.name, [&] { index->publish("All", &page); });
+        run(options, "SearchIndex::search", profile.name, [&] { index->search("rx bytes", SearchIndex::Substring); });
+        run(options, "SearchIndex::search(prefix)", profile.name, [&] { index->search("bond", SearchIndex::Prefix); });
+        run(options, "SearchIndex::search(regex)", profile.name, [&] { index->search("(eno|bond)\\d+ mtu", SearchIndex::Regex); });
+        index->remove(&page);
+    }
+    procfs::setRootDirectory(std::string_view());
+    return 0;
+}
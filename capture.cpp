@@ -0,0 +1,359 @@
+#include "capture.h"
+#include "log_helper.h"
+#include "procfs_parser.h"
+#include "snapshot_file.h"
+#include "version.h"
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QProcess>
+#include <QSaveFile>
+#include <QTemporaryDir>
+#include <QThread>
+#include <QVector>
+#include <atomic>
+
+namespace {
+
+struct FileStat {
+    qint64 reads = 0;
+    qint64 bytes = 0;
+    qint64 totalNs = 0;
+};
+
+struct CommandEntry {
+    QString program;
+    QStringList arguments;
+    Capture::Command command;
+};
+
+struct CaptureState {
+    QMutex mutex;
+    QString directory;
+    QVector<CommandEntry> commands;
+    QHash<QString, int> commandIndex;   // commandKey() -> index in commands
+    QHash<QString, FileStat> files;     // recording only
+    bool realtime = false;
+};
+
+std::atomic<int> s_mode{Capture::Off};
+
+CaptureState& state()
+{
+    static CaptureState s;
+    return s;
+}
+
+QString commandKey(const QString& program, const QStringList& arguments)
+{
+    // Same NUL separated form the CollectorEngine merges jobs by.
+    QString key = program;
+    for (const QString& a : arguments) {
+        key += QChar(0);
+        key += a;
+    }
+    return key;
+}
+
+bool writeFile(const QString& path, const QByteArray& data)
+{
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    QFile f(path);
+    if (!f.open(QIODevice::WriteOnly | QIODevice::Truncate)) return false;
+    return f.write(data) == data.size();
+}
+
+// Copy path from the live system into the archive root, as what it is: a
+// symlink stays a symlink (/etc/localtime), a directory gets its
+// subdirectories so listings replay, a file its contents. Returns the
+// time spent reading.
+qint64 archivePath(const QString& root, const QString& path, FileStat& stat)
+{
+    QElapsedTimer clock;
+    clock.start();
+    const QString target = root + path;
+    const QFileInfo info(path);
+    if (info.isSymLink()) {
+        QDir().mkpath(QFileInfo(target).absolutePath());
+        QFile::link(info.symLinkTarget(), target);
+    } else if (info.isDir()) {
+        QDir().mkpath(target);
+        const QStringList children = QDir(path).entryList(QDir::Dirs | QDir::NoDotAndDotDot | QDir::System);
+        for (const QString& child : children) QDir().mkpath(target + "/" + child);
+    } else if (info.exists()) {
+        QFile f(path);
+        if (f.open(QIODevice::ReadOnly)) {
+            const QByteArray data = f.readAll();
+            stat.bytes = data.size();
+            writeFile(target, data);
+        }
+    }
+    return clock.nsecsElapsed();
+}
+
+// procfs read hook while recording. data is null for hostPath() lookups,
+// where the caller opens the file itself.
+void recordRead(const char* path, const char* data, size_t size, int64_t elapsedNs)
+{
+    CaptureState& s = state();
+    QMutexLocker lock(&s.mutex);
+    const QString key = QString::fromLocal8Bit(path);
+    auto it = s.files.find(key);
+    if (it == s.files.end()) {
+        it = s.files.insert(key, FileStat());
+        const QString root = s.directory + "/root";
+        if (data) {
+            writeFile(root + key, QByteArray(data, qsizetype(size)));
+        } else {
+            elapsedNs += archivePath(root, key, it.value());
+        }
+    }
+    ++it->reads;
+    it->totalNs += elapsedNs;
+    if (data) it->bytes = qint64(size);
+}
+
+QString hostname()
+{
+    QFile f("/proc/sys/kernel/hostname");
+    if (!f.open(QIODevice::ReadOnly)) return QString();
+    return QString::fromLocal8Bit(f.readAll()).trimmed();
+}
+
+void writeManifest(CaptureState& s)
+{
+    QJsonArray commands;
+    for (int i = 0; i < s.commands.size(); ++i) {
+        const CommandEntry& e = s.commands[i];
+        QJsonObject c;
+        c.insert("program", e.program);
+        c.insert("arguments", QJsonArray::fromStringList(e.arguments));
+        c.insert("exit_code", e.command.exitCode);
+        c.insert("failed_to_start", e.command.failedToStart);
+        c.insert("elapsed_ms", double(e.command.elapsedMs));
+        c.insert("stdout", QString("commands/%1.out").arg(i));
+        c.insert("stderr", QString("commands/%1.err").arg(i));
+        commands.append(c);
+    }
+    QJsonObject files;
+    for (auto it = s.files.constBegin(); it != s.files.constEnd(); ++it) {
+        files.insert(it.key(), QJsonObject{{"reads", double(it->reads)}, {"bytes", double(it->bytes)},
+                                           {"read_ns", double(it->totalNs)}});
+    }
+    QJsonObject root;
+    root.insert("lsv_version", LSVVersionQString());
+    root.insert("captured", QDateTime::currentDateTimeUtc().toString(Qt::ISODate));
+    root.insert("hostname", hostname());
+    root.insert("commands", commands);
+    root.insert("files", files);
+
+    QSaveFile f(s.directory + "/manifest.json");
+    if (f.open(QIODevice::WriteOnly)) {
+        f.write(QJsonDocument(root).toJson(QJsonDocument::Indented));
+        f.commit();
+    }
+}
+
+// Contents of a command output file named by the manifest, read only if
+// it resolves inside the (canonical) archive directory root: a crafted
+// manifest could otherwise name any file ("../../etc/shadow") and have it
+// shown and exported as command output.
+QByteArray readArchived(const QString& root, const QString& name)
+{
+    if (name.isEmpty() || QDir::isAbsolutePath(name)) return QByteArray();
+    const QString path = QFileInfo(root + "/" + name).canonicalFilePath();
+    if (path.isEmpty() || !path.startsWith(root + '/')) {
+        appendLog(QString("Capture: %1 is outside the archive, not replayed").arg(name));
+        return QByteArray();
+    }
+    QFile f(path);
+    return f.open(QIODevice::ReadOnly) ? f.readAll() : QByteArray();
+}
+
+void finishOnQuit()
+{
+    if (QCoreApplication::instance()) {
+        QObject::connect(QCoreApplication::instance(), &QCoreApplication::aboutToQuit, [] { Capture::finish(); });
+    }
+}
+
+} // namespace
+
+void Capture::startFromArguments(const QStringList& arguments)
+{
+    QString capture = qEnvironmentVariable("LSV_CAPTURE");
+    QString replayDir = qEnvironmentVariable("LSV_REPLAY");
+    for (const QString& arg : arguments) {
+        if (arg.startsWith("--capture=")) capture = arg.mid(10);
+        else if (arg.startsWith("--replay=")) replayDir = arg.mid(9);
+        else if (arg.startsWith("--open=")) replayDir = arg.mid(7);
+    }
+    if (!replayDir.isEmpty()) {
+        startReplay(replayDir);
+    } else if (!capture.isEmpty()) {
+        startRecording(capture);
+    }
+}
+
+bool Capture::startRecording(const QString& directory)
+{
+    CaptureState& s = state();
+    {
+        QMutexLocker lock(&s.mutex);
+        s.directory = QFileInfo(directory).absoluteFilePath();
+        if (!QDir().mkpath(s.directory + "/commands")) {
+            appendLog(QString("Capture: cannot create %1").arg(s.directory));
+            return false;
+        }
+    }
+    procfs::setReadHook(&recordRead);
+    s_mode.store(Record);
+    finishOnQuit();
+    appendLog(QString("Capture: recording collector inputs to %1").arg(s.directory));
+    return true;
+}
+
+bool Capture::startReplay(const QString& directory)
+{
+    // A snapshot file (snapshot_file.h) carries an archive; it is unpacked
+    // into a scratch directory that goes away when the process exits.
+    if (QFileInfo(directory).isFile() && SnapshotFile::isSnapshotFile(directory)) {
+        static QTemporaryDir unpacked(QDir::tempPath() + "/lsv-snapshot-XXXXXX");
+        SnapshotFile snapshot;
+        QString error;
+        if (!unpacked.isValid() || !snapshot.open(directory, &error) || !snapshot.extractArchive(unpacked.path(), &error)) {
+            appendLog(QString("Capture: cannot open snapshot %1: %2").arg(directory, error));
+            return false;
+        }
+        return startReplay(unpacked.path());
+    }
+
+    CaptureState& s = state();
+    QMutexLocker lock(&s.mutex);
+    s.directory = QFileInfo(directory).absoluteFilePath();
+    QFile f(s.directory + "/manifest.json");
+    if (!f.open(QIODevice::ReadOnly)) {
+        appendLog(QString("Capture: no manifest in %1, not replaying").arg(s.directory));
+        return false;
+    }
+    const QJsonObject manifest = QJsonDocument::fromJson(f.readAll()).object();
+    const QString root = QFileInfo(s.directory).canonicalFilePath();
+    for (const QJsonValue& v : manifest.value("commands").toArray()) {
+        const QJsonObject c = v.toObject();
+        CommandEntry e;
+        e.program = c.value("program").toString();
+        for (const QJsonValue& a : c.value("arguments").toArray()) e.arguments.append(a.toString());
+        e.command.exitCode = c.value("exit_code").toInt(-1);
+        e.command.failedToStart = c.value("failed_to_start").toBool();
+        e.command.elapsedMs = qint64(c.value("elapsed_ms").toDouble());
+        e.command.standardOutput = readArchived(root, c.value("stdout").toString());
+        e.command.standardError = readArchived(root, c.value("stderr").toString());
+        s.commandIndex.insert(commandKey(e.program, e.arguments), s.commands.size());
+        s.commands.append(e);
+    }
+    s.realtime = qEnvironmentVariable("LSV_REPLAY_REALTIME") == "1";
+    procfs::setRootDirectory((s.directory + "/root").toStdString());
+    s_mode.store(Replay);
+    appendLog(QString("Capture: replaying %1 (%2 commands, captured on %3)")
+                  .arg(s.directory).arg(s.commands.size()).arg(manifest.value("hostname").toString()));
+    return true;
+}
+
+void Capture::finish()
+{
+    if (mode() != Record) return;
+    CaptureState& s = state();
+    QMutexLocker lock(&s.mutex);
+    writeManifest(s);
+}
+
+Capture::Mode Capture::mode()
+{
+    return Mode(s_mode.load(std::memory_order_relaxed));
+}
+
+QString Capture::directory()
+{
+    CaptureState& s = state();
+    QMutexLocker lock(&s.mutex);
+    return s.directory;
+}
+
+Capture::Command Capture::replay(const QString& program, const QStringList& arguments)
+{
+    CaptureState& s = state();
+    QMutexLocker lock(&s.mutex);
+    const int index = s.commandIndex.value(commandKey(program, arguments), -1);
+    if (index < 0) {
+        Command missing;
+        missing.failedToStart = true;
+        missing.standardError = "not in the capture archive";
+        return missing;
+    }
+    return s.commands[index].command;
+}
+
+int Capture::replayDelayMs(const Command& command)
+{
+    return state().realtime ? int(command.elapsedMs) : 0;
+}
+
+void Capture::record(const QString& program, const QStringList& arguments, const Command& command)
+{
+    if (mode() != Record) return;
+    CaptureState& s = state();
+    QMutexLocker lock(&s.mutex);
+    // The first run is the one replayed; refreshes would only add copies.
+    const QString key = commandKey(program, arguments);
+    if (s.commandIndex.contains(key)) return;
+    const int index = s.commands.size();
+    writeFile(QString("%1/commands/%2.out").arg(s.directory).arg(index), command.standardOutput);
+    writeFile(QString("%1/commands/%2.err").arg(s.directory).arg(index), command.standardError);
+    s.commandIndex.insert(key, index);
+    s.commands.append(CommandEntry{program, arguments, command});
+    writeManifest(s);
+}
+
+Capture::Command Capture::run(const QString& program, const QStringList& arguments, int timeoutMs)
+{
+    if (QCoreApplication* app = QCoreApplication::instance(); app && QThread::currentThread() == app->thread()) {
+        LSV_LOG_WARNING("capture", QString("Capture::run(%1) blocks the application thread").arg(program));
+    }
+
+    if (isReplaying()) {
+        const Command command = replay(program, arguments);
+        if (const int delay = replayDelayMs(command)) QThread::msleep(ulong(delay));
+        return command;
+    }
+
+    Command command;
+    QElapsedTimer clock;
+    clock.start();
+    QProcess process;
+    process.start(program, arguments);
+    if (!process.waitForStarted()) {
+        command.failedToStart = true;
+        command.standardError = process.errorString().toLocal8Bit();
+    } else {
+        if (!process.waitForFinished(timeoutMs)) {
+            process.kill();
+            process.waitForFinished();
+        } else if (process.exitStatus() == QProcess::NormalExit) {
+            command.exitCode = process.exitCode();
+        }
+        command.standardOutput = process.readAllStandardOutput();
+        command.standardError = process.readAllStandardError();
+    }
+    command.elapsedMs = clock.elapsed();
+    record(program, arguments, command);
+    return command;
+}
@@ -0,0 +1,68 @@
+#ifndef CAPTURE_H
+#define CAPTURE_H
+
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+
+// Record/replay of everything the collectors read, so a performance problem
+// seen on one machine can be reproduced and benchmarked on another.
+//
+// Recording (LSV_CAPTURE=<dir> or --capture=<dir>) archives
+//   <dir>/root/...         every file read through procfs (FileBuffer and
+//                          hostPath()), at its absolute path, as first read
+//   <dir>/commands/N.out   stdout/stderr of every command run through the
+//   <dir>/commands/N.err   CollectorEngine or Capture::run()
+//   <dir>/manifest.json    command lines, exit codes and run times, and per
+//                          file the number of reads and the time spent
+//
+// Replay (LSV_REPLAY=<dir> or --replay=<dir>) points procfs at <dir>/root
+// and answers commands from the archive; a command that was not recorded
+// fails to start. <dir> may also be a snapshot file (snapshot_file.h,
+// `--open=<file>`), whose archive is unpacked first. With LSV_REPLAY_REALTIME=1 archived commands take as long
+// as they did when recorded, otherwise they finish at once.
+//
+// Not covered: mounted file systems (QStorageInfo, statfs) and anything a
+// tab reads without going through procfs.
+class Capture
+{
+public:
+    enum Mode { Off, Record, Replay };
+
+    // One command run, as recorded or replayed.
+    struct Command {
+        QByteArray standardOutput;
+        QByteArray standardError;
+        int exitCode = -1;
+        bool failedToStart = false;
+        qint64 elapsedMs = 0;
+    };
+
+    // Start the mode asked for by --capture=<dir> / --replay=<dir> in
+    // arguments, else by LSV_CAPTURE / LSV_REPLAY. Call before any
+    // collector runs; does nothing when neither is given.
+    static void startFromArguments(const QStringList& arguments);
+    static bool startRecording(const QString& directory);
+    static bool startReplay(const QString& directory);
+    // Write the manifest. Also done when the application quits.
+    static void finish();
+
+    static Mode mode();
+    static bool isRecording() { return mode() == Record; }
+    static bool isReplaying() { return mode() == Replay; }
+    static QString directory();
+
+    // Replay: the archived run of program + arguments.
+    static Command replay(const QString& program, const QStringList& arguments);
+    // How long a replayed command should appear to run.
+    static int replayDelayMs(const Command& command);
+    // Recording: archive one run.
+    static void record(const QString& program, const QStringList& arguments, const Command& command);
+
+    // Blocking run for collectors that call a program directly; recorded
+    // and replayed like the CollectorEngine's commands. Worker threads only:
+    // on the application thread use CollectorEngine::run() instead.
+    static Command run(const QString& program, const QStringList& arguments, int timeoutMs);
+};
+
+#endif // CAPTURE_H
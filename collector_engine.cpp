@@ -0,0 +1,376 @@
+#include "collector_engine.h"
+#include "log_helper.h"
+#include "trace.h"
+#include "capture.h"
+#include <QCoreApplication>
+#include <QThread>
+#include <QMetaObject>
+#include <QPromise>
+#include <memory>
+#include <QtGlobal>
+
+CollectorEngine* CollectorEngine::instance()
+{
+    // Created lazily on first use and parented to the application object so it
+    // is torn down together with the event loop that drives its processes.
+    static CollectorEngine* engine = new CollectorEngine(QCoreApplication::instance());
+    return engine;
+}
+
+CollectorEngine::CollectorEngine(QObject* parent)
+    : QObject(parent)
+{
+    // External probes are mostly I/O and kernel bound (PCI/DMI/SCSI scans).
+    // Running more than a handful at once only makes them contend for the
+    // same /sys and /proc data, so keep the pool small.
+    m_maxConcurrent = qBound(2, QThread::idealThreadCount() / 2, 4);
+    appendLog(QString("CollectorEngine: created, max concurrent jobs: %1").arg(m_maxConcurrent));
+}
+
+QString CollectorEngine::makeKey(const QString& program, const QStringList& arguments)
+{
+    // A NUL separator cannot appear in a command line, so distinct
+    // program/argument splits never produce the same key.
+    QString key = program;
+    for (const QString& a : arguments) {
+        key += QChar(0);
+        key += a;
+    }
+    return key;
+}
+
+quint64 CollectorEngine::submitShell(const QString& command, QObject* receiver, Callback callback,
+                                     Priority priority, int deadlineMs)
+{
+    return submit(QStringLiteral("bash"), QStringList() << QStringLiteral("-c") << command,
+                  receiver, std::move(callback), priority, deadlineMs);
+}
+
+quint64 CollectorEngine::submitShellStreaming(const QString& command, QObject* receiver, OutputCallback onOutput,
+                                              Callback onFinished, Priority priority, int deadlineMs)
+{
+    return post(QStringLiteral("bash"), QStringList() << QStringLiteral("-c") << command,
+                receiver, std::move(onOutput), std::move(onFinished), priority, deadlineMs);
+}
+
+quint64 CollectorEngine::submit(const QString& program, const QStringList& arguments, QObject* receiver,
+                                Callback callback, Priority priority, int deadlineMs)
+{
+    return post(program, arguments, receiver, OutputCallback(), std::move(callback), priority, deadlineMs);
+}
+
+QFuture<CollectorResult> CollectorEngine::run(const QString& program, const QStringList& arguments,
+                                              Priority priority, int deadlineMs)
+{
+    // The engine itself subscribes, so the callback always runs unless the
+    // job is cancelled; a promise destroyed unfinished cancels its future.
+    auto promise = std::make_shared<QPromise<CollectorResult>>();
+    QFuture<CollectorResult> future = promise->future();
+    promise->start();
+    submit(program, arguments, this, [promise](const CollectorResult& result) {
+        promise->addResult(result);
+        promise->finish();
+    }, priority, deadlineMs);
+    return future;
+}
+
+QFuture<CollectorResult> CollectorEngine::runShell(const QString& command, Priority priority, int deadlineMs)
+{
+    return run(QStringLiteral("bash"), QStringList() << QStringLiteral("-c") << command, priority, deadlineMs);
+}
+
+quint64 CollectorEngine::post(const QString& program, const QStringList& arguments, QObject* receiver,
+                              OutputCallback onOutput, Callback callback, Priority priority, int deadlineMs)
+{
+    const quint64 ticket = m_nextTicket.fetch_add(1, std::memory_order_relaxed);
+    if (QThread::currentThread() == thread()) {
+        enqueue(program, arguments, receiver, std::move(onOutput), std::move(callback), priority, deadlineMs, ticket);
+    } else {
+        // Jobs and their QProcess objects live on the engine thread only.
+        QPointer<QObject> guard(receiver);
+        QMetaObject::invokeMethod(this, [=]() {
+            if (receiver && !guard) return; // receiver died before we got here
+            enqueue(program, arguments, receiver, onOutput, callback, priority, deadlineMs, ticket);
+        }, Qt::QueuedConnection);
+    }
+    return ticket;
+}
+
+void CollectorEngine::enqueue(const QString& program, const QStringList& arguments, QObject* receiver,
+                              OutputCallback onOutput, Callback callback, Priority priority, int deadlineMs,
+                              quint64 ticket)
+{
+    const QString key = makeKey(program, arguments);
+    Subscriber sub{ticket, QPointer<QObject>(receiver), std::move(callback), std::move(onOutput)};
+
+    // A running job can only take subscribers that have not missed any of
+    // its output: nothing has arrived yet, or it is all still kept.
+    Job* job = m_byKey.value(key, nullptr);
+    if (job && !job->cancelled && (job->outputBytes == 0 || (job->keepOutput && !sub.onOutput))) {
+        // Same command already queued or running: share its result.
+        if (!sub.onOutput) job->keepOutput = true;
+        job->subscribers.append(sub);
+        if (priority > job->priority) job->priority = priority;
+        if (deadlineMs > job->deadlineMs && !job->process) job->deadlineMs = deadlineMs;
+        LSV_LOG_DEBUG("engine", QString("CollectorEngine: merged request into existing job (%1 subscribers): %2")
+                      .arg(job->subscribers.size()).arg(arguments.join(' ')));
+        return;
+    }
+
+    job = new Job;
+    job->key = key;
+    job->program = program;
+    job->arguments = arguments;
+    job->priority = priority;
+    job->deadlineMs = deadlineMs > 0 ? deadlineMs : DefaultDeadlineMs;
+    job->sequence = m_nextSequence++;
+    job->subscribers.append(sub);
+
+    m_pending.append(job);
+    m_byKey.insert(key, job);
+    schedule();
+}
+
+void CollectorEngine::schedule()
+{
+    while (m_running.size() < m_maxConcurrent && !m_pending.isEmpty()) {
+        // Highest priority first, FIFO within a priority. The queue only ever
+        // holds a few dozen entries so a linear scan is cheapest.
+        int best = 0;
+        for (int i = 1; i < m_pending.size(); ++i) {
+            const Job* a = m_pending[i];
+            const Job* b = m_pending[best];
+            if (a->priority > b->priority || (a->priority == b->priority && a->sequence < b->sequence)) {
+                best = i;
+            }
+        }
+        Job* job = m_pending.takeAt(best);
+
+        if (!hasLiveSubscriber(job)) {
+            // Everybody who asked for this went away while it was queued.
+            m_byKey.remove(job->key);
+            delete job;
+            continue;
+        }
+        startJob(job);
+    }
+}
+
+void CollectorEngine::startJob(Job* job)
+{
+    m_running.append(job);
+
+    // Streaming subscribers take the output chunk by chunk; only collect it
+    // when somebody needs it in one piece.
+    job->keepOutput = Capture::isRecording();
+    for (const Subscriber& s : job->subscribers) {
+        if (!s.onOutput) job->keepOutput = true;
+    }
+
+    job->deadline = new QTimer(this);
+    job->deadline->setSingleShot(true);
+
+    if (Capture::isReplaying()) {
+        // Answer from the archive, after the recorded run time if asked to.
+        const Capture::Command replayed = Capture::replay(job->program, job->arguments);
+        connect(job->deadline, &QTimer::timeout, this, [this, job, replayed]() {
+            CollectorResult result;
+            result.exitCode = replayed.exitCode;
+            result.failedToStart = replayed.failedToStart;
+            deliverOutput(job, replayed.standardOutput);
+            result.standardOutput = job->output;
+            result.standardError = replayed.standardError;
+            finishJob(job, result);
+        });
+        emit jobStarted(job->key);
+        job->clock.start();
+        job->deadline->start(Capture::replayDelayMs(replayed));
+        return;
+    }
+
+    job->process = new QProcess(this);
+
+    connect(job->process, &QProcess::readyReadStandardOutput, this, [this, job]() {
+        deliverOutput(job, job->process->readAllStandardOutput());
+    });
+    connect(job->process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished), this,
+            [this, job](int exitCode, QProcess::ExitStatus exitStatus) {
+        CollectorResult result;
+        result.exitCode = exitCode;
+        result.crashed = (exitStatus == QProcess::CrashExit) && !job->timedOut && !job->cancelled;
+        deliverOutput(job, job->process->readAllStandardOutput());
+        result.standardOutput = job->output;
+        result.standardError = job->process->readAllStandardError();
+        finishJob(job, result);
+    });
+    connect(job->process, &QProcess::errorOccurred, this, [this, job](QProcess::ProcessError error) {
+        // Crashes and kills are reported through finished(); only a failed
+        // start never produces one.
+        if (error != QProcess::FailedToStart) return;
+        CollectorResult result;
+        result.failedToStart = true;
+        result.standardError = job->process->errorString().toLocal8Bit();
+        finishJob(job, result);
+    });
+    connect(job->deadline, &QTimer::timeout, this, [job]() {
+        appendLog(QString("CollectorEngine: deadline of %1 ms exceeded, killing: %2")
+                      .arg(job->deadlineMs).arg(job->arguments.join(' ')));
+        job->timedOut = true;
+        job->process->kill();
+    });
+
+    LSV_LOG_DEBUG("engine", QString("CollectorEngine: starting (priority %1, %2 running): %3 %4")
+                  .arg(int(job->priority)).arg(m_running.size()).arg(job->program, job->arguments.join(' ')));
+    emit jobStarted(job->key);
+
+    job->clock.start();
+    if (Trace::isEnabled()) job->traceStartNs = Trace::nowNs();
+    job->deadline->start(job->deadlineMs);
+    job->process->start(job->program, job->arguments);
+}
+
+void CollectorEngine::deliverOutput(Job* job, const QByteArray& data)
+{
+    if (data.isEmpty() || job->cancelled) return;
+    job->outputBytes += data.size();
+    if (job->keepOutput) job->output += data;
+    // A callback may cancel its own or another subscription.
+    const QList<Subscriber> subscribers = job->subscribers;
+    for (const Subscriber& s : subscribers) {
+        if (!s.receiver || !s.onOutput) continue;
+        s.onOutput(data);
+    }
+}
+
+void CollectorEngine::finishJob(Job* job, CollectorResult result)
+{
+    if (!m_running.removeOne(job)) return; // already finished (error + finished)
+    if (m_byKey.value(job->key) == job) m_byKey.remove(job->key);
+
+    result.key = job->key;
+    result.timedOut = job->timedOut;
+    result.cancelled = job->cancelled;
+    result.elapsedMs = job->clock.isValid() ? job->clock.elapsed() : 0;
+    result.outputBytes = job->outputBytes;
+
+    job->deadline->stop();
+    job->deadline->deleteLater();
+    if (job->process) {
+        job->process->disconnect(this);
+        job->process->deleteLater();
+    }
+    if (Capture::isRecording() && !result.cancelled && !result.timedOut) {
+        Capture::Command run;
+        run.exitCode = result.exitCode;
+        run.failedToStart = result.failedToStart;
+        run.standardOutput = result.standardOutput;
+        run.standardError = result.standardError;
+        run.elapsedMs = result.elapsedMs;
+        Capture::record(job->program, job->arguments, run);
+    }
+
+    LSV_LOG_DEBUG("engine", QString("CollectorEngine: finished in %1 ms (exit %2%3): %4")
+                  .arg(result.elapsedMs).arg(result.exitCode)
+                  .arg(result.timedOut ? ", timed out" : (result.cancelled ? ", cancelled" : ""))
+                  .arg(job->arguments.join(' ')));
+
+    if (job->traceStartNs >= 0) {
+        // Spawn to exit of the process, on the engine thread.
+        Trace::complete("process", job->program == "bash" ? job->arguments.value(1) : job->program + ' ' + job->arguments.join(' '),
+                        job->traceStartNs, Trace::nowNs(),
+                        QJsonObject{{"exitCode", result.exitCode}, {"priority", int(job->priority)},
+                                    {"timedOut", result.timedOut}, {"cancelled", result.cancelled},
+                                    {"failedToStart", result.failedToStart}, {"subscribers", int(job->subscribers.size())}});
+    }
+
+    const QList<Subscriber> subscribers = job->subscribers;
+    delete job;
+
+    if (!result.cancelled) {
+        for (const Subscriber& s : subscribers) {
+            if (!s.receiver || !s.callback) continue;
+            s.callback(result);
+        }
+    }
+    emit jobFinished(result);
+
+    schedule();
+}
+
+bool CollectorEngine::hasLiveSubscriber(const Job* job) const
+{
+    for (const Subscriber& s : job->subscribers) {
+        if (s.receiver) return true;
+    }
+    return false;
+}
+
+CollectorEngine::Job* CollectorEngine::findJob(quint64 ticket) const
+{
+    // Not through m_byKey: a running job stays out of it once a newer job
+    // for the same key took its place.
+    for (Job* job : m_pending + m_running) {
+        for (const Subscriber& s : job->subscribers) {
+            if (s.ticket == ticket) return job;
+        }
+    }
+    return nullptr;
+}
+
+void CollectorEngine::cancel(quint64 ticket)
+{
+    if (QThread::currentThread() != thread()) {
+        QMetaObject::invokeMethod(this, [this, ticket]() { cancel(ticket); }, Qt::QueuedConnection);
+        return;
+    }
+
+    Job* job = findJob(ticket);
+    if (!job) return;
+    for (int i = 0; i < job->subscribers.size(); ++i) {
+        if (job->subscribers[i].ticket == ticket) {
+            job->subscribers.removeAt(i);
+            break;
+        }
+    }
+    if (hasLiveSubscriber(job)) return;
+
+    if (m_pending.removeOne(job)) {
+        m_byKey.remove(job->key);
+        delete job;
+    } else {
+        // Running; a replayed job finishes on its own timer.
+        job->cancelled = true;
+        if (job->process) job->process->kill();
+    }
+}
+
+void CollectorEngine::cancelAll(QObject* receiver)
+{
+    if (!receiver) return;
+    QList<quint64> tickets;
+    for (Job* job : m_pending + m_running) {
+        for (const Subscriber& s : job->subscribers) {
+            if (s.receiver == receiver) tickets.append(s.ticket);
+        }
+    }
+    for (quint64 t : tickets) cancel(t);
+}
+
+void CollectorEngine::promote(QObject* receiver, Priority priority)
+{
+    for (Job* job : m_pending) {
+        if (job->priority >= priority) continue;
+        for (const Subscriber& s : job->subscribers) {
+            if (s.receiver == receiver) {
+                job->priority = priority;
+                break;
+            }
+        }
+    }
+}
+
+void CollectorEngine::setMaxConcurrent(int n)
+{
+    m_maxConcurrent = qMax(1, n);
+    schedule();
+}
@@ -0,0 +1,156 @@
+#ifndef COLLECTOR_ENGINE_H
+#define COLLECTOR_ENGINE_H
+
+#include <QObject>
+#include <QProcess>
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+#include <QHash>
+#include <QList>
+#include <QPointer>
+#include <QElapsedTimer>
+#include <QFuture>
+#include <QTimer>
+#include <atomic>
+#include <functional>
+
+// Outcome of one collector job. Every subscriber of a (deduplicated) job
+// receives the same result object.
+struct CollectorResult {
+    QString key;                // program + arguments; identical keys are merged
+    QByteArray standardOutput;
+    QByteArray standardError;
+    int exitCode = -1;
+    bool crashed = false;
+    bool timedOut = false;
+    bool cancelled = false;
+    bool failedToStart = false;
+    qint64 elapsedMs = 0;
+    qint64 outputBytes = 0;     // everything the command wrote to stdout
+
+    bool ok() const { return !crashed && !timedOut && !cancelled && !failedToStart; }
+};
+
+// Central engine for running external collector commands (lshw, lsusb, ...).
+// Instead of every tab owning a QProcess, tabs subscribe to a command and get
+// a callback with the result. The engine keeps a single priority queue, runs
+// at most maxConcurrent() processes at once, merges identical commands and
+// kills jobs that run past their deadline.
+//
+// Callbacks are invoked on the engine's (GUI) thread and only while the
+// receiver object is still alive. run() and runShell() return a future
+// instead; continuations attached with .then(context, ...) run in context's
+// thread and are dropped when context is destroyed, so nothing ever waits
+// for a process on the GUI thread.
+class CollectorEngine : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Priority {
+        Background = 0, // idle prefetch, revalidation
+        Normal = 1,     // tab constructed but not on screen
+        Visible = 2     // the tab the user is looking at
+    };
+
+    using Callback = std::function<void(const CollectorResult&)>;
+    // Receives stdout while the command runs, in the order it was written.
+    using OutputCallback = std::function<void(const QByteArray&)>;
+
+    static constexpr int DefaultDeadlineMs = 30000;
+
+    static CollectorEngine* instance();
+
+    // Queue a shell command line, run as `bash -c <command>`.
+    quint64 submitShell(const QString& command, QObject* receiver, Callback callback,
+                        Priority priority = Normal, int deadlineMs = DefaultDeadlineMs);
+
+    // Queue a program with an explicit argument list (no shell involved).
+    quint64 submit(const QString& program, const QStringList& arguments, QObject* receiver,
+                   Callback callback, Priority priority = Normal, int deadlineMs = DefaultDeadlineMs);
+
+    // Like submitShell(), but stdout is handed to onOutput as it arrives
+    // and onFinished gets the result after the last chunk. The result's
+    // standardOutput is only filled when a subscriber without onOutput
+    // shares the job, so streaming subscribers should not rely on it.
+    quint64 submitShellStreaming(const QString& command, QObject* receiver, OutputCallback onOutput,
+                                 Callback onFinished, Priority priority = Normal,
+                                 int deadlineMs = DefaultDeadlineMs);
+
+    // Future flavour of submit()/submitShell(). The future is cancelled if
+    // the job is (for instance by the engine shutting down).
+    QFuture<CollectorResult> run(const QString& program, const QStringList& arguments,
+                                 Priority priority = Normal, int deadlineMs = DefaultDeadlineMs);
+    QFuture<CollectorResult> runShell(const QString& command, Priority priority = Normal,
+                                      int deadlineMs = DefaultDeadlineMs);
+
+    // Drop a single subscription. When a job loses its last subscriber it is
+    // removed from the queue, or killed if it is already running.
+    void cancel(quint64 ticket);
+    // Drop every subscription owned by receiver.
+    void cancelAll(QObject* receiver);
+    // Raise the priority of all queued jobs the receiver is waiting for.
+    void promote(QObject* receiver, Priority priority);
+
+    void setMaxConcurrent(int n);
+    int maxConcurrent() const { return m_maxConcurrent; }
+    int pendingCount() const { return m_pending.size(); }
+    int runningCount() const { return m_running.size(); }
+
+signals:
+    void jobStarted(const QString& key);
+    void jobFinished(const CollectorResult& result);
+
+private:
+    explicit CollectorEngine(QObject* parent = nullptr);
+
+    struct Subscriber {
+        quint64 ticket;
+        QPointer<QObject> receiver;
+        Callback callback;
+        OutputCallback onOutput;    // streaming subscriber when set
+    };
+
+    struct Job {
+        QString key;
+        QString program;
+        QStringList arguments;
+        Priority priority = Normal;
+        int deadlineMs = DefaultDeadlineMs;
+        quint64 sequence = 0;
+        QList<Subscriber> subscribers;
+        QByteArray output;              // stdout so far, when keepOutput
+        qint64 outputBytes = 0;
+        bool keepOutput = true;         // some subscriber (or capture) wants it whole
+        QProcess* process = nullptr;
+        QTimer* deadline = nullptr;
+        QElapsedTimer clock;
+        qint64 traceStartNs = -1;       // Trace::nowNs() at spawn, when tracing
+        bool timedOut = false;
+        bool cancelled = false;
+    };
+
+    static QString makeKey(const QString& program, const QStringList& arguments);
+
+    quint64 post(const QString& program, const QStringList& arguments, QObject* receiver,
+                 OutputCallback onOutput, Callback callback, Priority priority, int deadlineMs);
+    void enqueue(const QString& program, const QStringList& arguments, QObject* receiver,
+                 OutputCallback onOutput, Callback callback, Priority priority, int deadlineMs,
+                 quint64 ticket);
+    void schedule();
+    void startJob(Job* job);
+    void deliverOutput(Job* job, const QByteArray& data);
+    void finishJob(Job* job, CollectorResult result);
+    bool hasLiveSubscriber(const Job* job) const;
+    Job* findJob(quint64 ticket) const;
+
+    QList<Job*> m_pending;
+    QList<Job*> m_running;
+    QHash<QString, Job*> m_byKey;       // the job new requests for a key merge into
+    int m_maxConcurrent;
+    quint64 m_nextSequence = 0;
+    std::atomic<quint64> m_nextTicket{1};
+};
+
+#endif // COLLECTOR_ENGINE_H
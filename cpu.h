@@ -1,32 +1,40 @@
 #ifndef CPU_H
 #define CPU_H
 
-#include <QTableWidget>
-#include <QTableWidgetItem>
 #include <QJsonObject>
 #include <QFile>
 #include <QTextStream>
 #include <QRegularExpression>
 #include <QStringList>
+#include <QSet>
 #include <QDebug>
 #include <QDir>
-#include <QProcess>
+#include "info_rows.h"
+#include "procfs_parser.h"
+#ifndef LSV_CORE_ONLY
+#include <QTableWidget>
+#include <QTableWidgetItem>
 #include "gui_helpers.h"
+#endif
 
 // CPU information functions
-void loadCpuInformation(QTableWidget* table, const QJsonObject& data);
+InfoRows collectCpuInformation();
 QStringList getCpuHeaders();
-void styleCpuTable(QTableWidget* table);
 QString getCpuInfo();
+#ifndef LSV_CORE_ONLY
+void loadCpuInformation(QTableWidget* table, const QJsonObject& data);
+void styleCpuTable(QTableView* table);
+#endif
 
 // CPU Headers
-QStringList getCpuHeaders()
+inline QStringList getCpuHeaders()
 {
     return QStringList() << "Property" << "Value" << "Unit";
 }
 
+#ifndef LSV_CORE_ONLY
 // CPU Table Styling
-void styleCpuTable(QTableWidget* table)
+inline void styleCpuTable(QTableView* table)
 {
     // Set column widths
     table->setColumnWidth(0, 220);  // Property
@@ -45,24 +53,23 @@ void styleCpuTable(QTableWidget* table)
     );
 }
 
-// Load CPU Information
-void loadCpuInformation(QTableWidget* table, const QJsonObject& data)
+#endif // LSV_CORE_ONLY
+
+// Collect CPU Information
+inline InfoRows collectCpuInformation()
 {
-    Q_UNUSED(data); // Use direct system calls instead of JSON data
-    
-    // Only populate the limited, user-friendly CPU fields requested by the UI:
+    // Only the limited, user-friendly CPU fields requested by the UI:
     // Vendor, Model, Number of processor (Physical), Total number of processors,
     // Max freq (GHz), Current freq (GHz), Min Freq (GHz), Cache size, Bogomips
-    table->setRowCount(0);
-
-    QFile file("/proc/cpuinfo");
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        addRowToTable(table, QStringList() << "Error" << "Could not read /proc/cpuinfo" << "");
-        return;
+    InfoRows rows;
+
+    // /proc/cpuinfo repeats every field per logical cpu, so it is walked as
+    // views and only the first occurrence of a field becomes a QString.
+    procfs::FileBuffer buffer(64 * 1024);
+    if (!buffer.read("/proc/cpuinfo")) {
+        rows.append(QStringList() << "Error" << "Could not read /proc/cpuinfo" << "");
+        return rows;
     }
-    QTextStream in(&file);
-    QString content = in.readAll();
-    file.close();
 
     // Extract fields
     QString vendor;
@@ -71,75 +78,94 @@ void loadCpuInformation(QTableWidget* table, const QJsonObject& data)
     QString bogomips;
     QString currentFreqGHz;
 
-    QSet<QString> physicalIds;
+    QSet<int> physicalIds;
     int logicalCount = 0;
 
-    for (const QString& line : content.split('\n')) {
-        if (line.trimmed().isEmpty()) continue;
-        if (line.startsWith("vendor_id")) {
-            if (vendor.isEmpty()) vendor = line.section(':',1).trimmed();
-        } else if (line.startsWith("model name")) {
-            if (model.isEmpty()) model = line.section(':',1).trimmed();
-        } else if (line.startsWith("cache size")) {
-            if (cacheSize.isEmpty()) cacheSize = line.section(':',1).trimmed();
-        } else if (line.startsWith("bogomips")) {
-            if (bogomips.isEmpty()) bogomips = line.section(':',1).trimmed();
-        } else if (line.startsWith("cpu MHz")) {
+    auto value = [](std::string_view line) {
+        const size_t colon = line.find(':');
+        return colon == std::string_view::npos ? std::string_view() : procfs::trim(line.substr(colon + 1));
+    };
+    auto firstText = [&value](QString& target, std::string_view line) {
+        if (!target.isEmpty()) return;
+        const std::string_view v = value(line);
+        target = QString::fromUtf8(v.data(), int(v.size()));
+    };
+
+    std::string_view content = buffer.view();
+    std::string_view line;
+    while (procfs::nextLine(content, line)) {
+        if (procfs::trim(line).empty()) continue;
+        if (procfs::startsWith(line, "vendor_id")) {
+            firstText(vendor, line);
+        } else if (procfs::startsWith(line, "model name")) {
+            firstText(model, line);
+        } else if (procfs::startsWith(line, "cache size")) {
+            firstText(cacheSize, line);
+        } else if (procfs::startsWith(line, "bogomips")) {
+            firstText(bogomips, line);
+        } else if (procfs::startsWith(line, "cpu MHz")) {
             if (currentFreqGHz.isEmpty()) {
-                double mhz = line.section(':',1).trimmed().toDouble();
+                double mhz = 0;
+                procfs::parseNumber(value(line), mhz);
                 currentFreqGHz = QString::number(mhz / 1000.0, 'f', 2);
             }
-        } else if (line.startsWith("physical id")) {
-            physicalIds.insert(line.section(':',1).trimmed());
-        } else if (line.startsWith("processor")) {
+        } else if (procfs::startsWith(line, "physical id")) {
+            int id = 0;
+            if (procfs::parseNumber(value(line), id)) physicalIds.insert(id);
+        } else if (procfs::startsWith(line, "processor")) {
             logicalCount++;
         }
     }
 
     // Total number of processors (logical)
-    addRowToTable(table, QStringList() << "Total number of processors" << QString::number(logicalCount) << "");
+    rows.append(QStringList() << "Total number of processors" << QString::number(logicalCount) << "");
 
     // Number of physical processors (sockets)
     int physicalCount = physicalIds.size() > 0 ? physicalIds.size() : 1;
-    addRowToTable(table, QStringList() << "Number of processor (Physical)" << QString::number(physicalCount) << "");
+    rows.append(QStringList() << "Number of processor (Physical)" << QString::number(physicalCount) << "");
 
     // Vendor and Model
-    addRowToTable(table, QStringList() << "Vendor" << (vendor.isEmpty() ? "Unknown" : vendor) << "");
-    addRowToTable(table, QStringList() << "Model" << (model.isEmpty() ? "Unknown" : model) << "");
+    rows.append(QStringList() << "Vendor" << (vendor.isEmpty() ? "Unknown" : vendor) << "");
+    rows.append(QStringList() << "Model" << (model.isEmpty() ? "Unknown" : model) << "");
 
     // Cache size and BogoMIPS
-    addRowToTable(table, QStringList() << "Cache size" << (cacheSize.isEmpty() ? "Unknown" : cacheSize) << "");
-    addRowToTable(table, QStringList() << "Bogomips" << (bogomips.isEmpty() ? "Unknown" : bogomips) << "");
+    rows.append(QStringList() << "Cache size" << (cacheSize.isEmpty() ? "Unknown" : cacheSize) << "");
+    rows.append(QStringList() << "Bogomips" << (bogomips.isEmpty() ? "Unknown" : bogomips) << "");
 
     // Current frequency (GHz)
-    addRowToTable(table, QStringList() << "Current freq (GHz)" << (currentFreqGHz.isEmpty() ? "Unknown" : currentFreqGHz) << "GHz");
+    rows.append(QStringList() << "Current freq (GHz)" << (currentFreqGHz.isEmpty() ? "Unknown" : currentFreqGHz) << "GHz");
 
     // Min / Max freq from sysfs (if available)
-    QFile maxFreqFile("/sys/devices/system/cpu/cpu0/cpufreq/cpuinfo_max_freq");
-    if (maxFreqFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        QString maxFreq = QTextStream(&maxFreqFile).readLine().trimmed();
-        maxFreqFile.close();
-        double maxGHz = maxFreq.toLongLong() / 1000000.0;
-        addRowToTable(table, QStringList() << "Max freq (GHz)" << QString::number(maxGHz, 'f', 2) << "GHz");
+    uint64_t maxKHz = 0;
+    if (procfs::readU64(buffer, "/sys/devices/system/cpu/cpu0/cpufreq/cpuinfo_max_freq", maxKHz)) {
+        rows.append(QStringList() << "Max freq (GHz)" << QString::number(maxKHz / 1000000.0, 'f', 2) << "GHz");
     } else {
-        addRowToTable(table, QStringList() << "Max freq (GHz)" << "Unknown" << "GHz");
+        rows.append(QStringList() << "Max freq (GHz)" << "Unknown" << "GHz");
     }
 
-    QFile minFreqFile("/sys/devices/system/cpu/cpu0/cpufreq/cpuinfo_min_freq");
-    if (minFreqFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        QString minFreq = QTextStream(&minFreqFile).readLine().trimmed();
-        minFreqFile.close();
-        double minGHz = minFreq.toLongLong() / 1000000.0;
-        addRowToTable(table, QStringList() << "Min Freq (GHz)" << QString::number(minGHz, 'f', 2) << "GHz");
+    uint64_t minKHz = 0;
+    if (procfs::readU64(buffer, "/sys/devices/system/cpu/cpu0/cpufreq/cpuinfo_min_freq", minKHz)) {
+        rows.append(QStringList() << "Min Freq (GHz)" << QString::number(minKHz / 1000000.0, 'f', 2) << "GHz");
     } else {
-        addRowToTable(table, QStringList() << "Min Freq (GHz)" << "Unknown" << "GHz");
+        rows.append(QStringList() << "Min Freq (GHz)" << "Unknown" << "GHz");
     }
+    return rows;
+}
+
+#ifndef LSV_CORE_ONLY
+// Load CPU Information
+inline void loadCpuInformation(QTableWidget* table, const QJsonObject& data)
+{
+    Q_UNUSED(data); // Use direct system calls instead of JSON data
+    table->setRowCount(0);
+    addRowsToTable(table, collectCpuInformation());
 }
+#endif
 
 // Get basic CPU info string
-QString getCpuInfo()
+inline QString getCpuInfo()
 {
-    QFile file("/proc/cpuinfo");
+    QFile file(procfs::hostPath("/proc/cpuinfo"));
     if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
         return "Error reading CPU information";
     }
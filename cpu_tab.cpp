@@ -1,6 +1,10 @@
 #include "cpu_tab.h"
 #include "cpu.h"
-#include <QTimer>
+#include "info_table_model.h"
+#include "trace.h"
+#include "search_index.h"
+#include "procfs_parser.h"
+#include "snapshot_baseline.h"
 #include <QShowEvent>
 #include <QVBoxLayout>
 #include <QHBoxLayout>
@@ -16,10 +20,7 @@
 #include <QFileDialog>
 #include <QPushButton>
 #include <QDialogButtonBox>
-#include <QTableWidgetItem>
-#include <QFont>
 #include <QJsonObject>
-#include <QTableWidget>
 
 CPUTab::CPUTab(QWidget* parent)
     : QWidget(parent)
@@ -27,12 +28,9 @@ CPUTab::CPUTab(QWidget* parent)
     // Headline and Geek button
     QHBoxLayout* headlineLayout = new QHBoxLayout();
     QLabel* headline = new QLabel("CPU");
-    headline->setStyleSheet("font-size: 15px; font-weight: bold; color: #222; margin-bottom: 0px;");
+    headline->setObjectName("tabHeadline");
     geekButton = new QPushButton("Geek Mode", this);
-    geekButton->setStyleSheet(
-        "QPushButton { background-color: #3498db; color: white; border: none; padding: 4px 10px; border-radius: 4px; font-weight: bold; font-size: 11px; min-width: 80px; max-height: 22px;}"
-        "QPushButton:hover { background-color: #2980b9; }"
-    );
+    geekButton->setObjectName("geekButton");
     connect(geekButton, &QPushButton::clicked, this, &CPUTab::showGeekMode);
     headlineLayout->addWidget(headline);
     headlineLayout->addStretch();
@@ -42,39 +40,49 @@ CPUTab::CPUTab(QWidget* parent)
     mainLayout->addLayout(headlineLayout);
 
     // Table
-    tableWidget = new QTableWidget();
-    tableWidget->setColumnCount(3);
-    tableWidget->setHorizontalHeaderLabels(getCpuHeaders());
-    tableWidget->verticalHeader()->setVisible(false);
-    styleCpuTable(tableWidget);
-    tableWidget->horizontalHeader()->setSectionResizeMode(0, QHeaderView::Interactive);
-    tableWidget->horizontalHeader()->setSectionResizeMode(1, QHeaderView::Stretch);
+    model = new InfoTableModel(getCpuHeaders(), this);
+    tableView = new QTableView();
+    setupInfoTableView(tableView, model);
+    styleCpuTable(tableView);
+    tableView->horizontalHeader()->setSectionResizeMode(0, QHeaderView::Interactive);
+    tableView->horizontalHeader()->setSectionResizeMode(1, QHeaderView::Stretch);
 
     // Scroll area
     QScrollArea* scrollArea = new QScrollArea;
-    scrollArea->setWidget(tableWidget);
+    scrollArea->setWidget(tableView);
     scrollArea->setWidgetResizable(true);
     scrollArea->setMinimumHeight(220);
     mainLayout->addWidget(scrollArea);
 
     // Populate table using cpu helper
-    loadCpuInformation(tableWidget, QJsonObject());
+    model->setRows(collectCpuInformation());
+    SearchIndex::instance()->publish("CPU", this);
+
+    // Mark what differs from the --baseline snapshot once it is compared.
+    SnapshotBaseline* baseline = SnapshotBaseline::instance();
+    if (baseline->isReady()) {
+        model->setBaseline(baseline->changedRows("cpu"));
+    } else if (baseline->isActive()) {
+        connect(baseline, &SnapshotBaseline::ready, this, [this, baseline]() {
+            model->setBaseline(baseline->changedRows("cpu"));
+        });
+    }
 
-    // Auto-refresh only the changing values (frequencies) every second
-    refreshTimer = new QTimer(this);
-    refreshTimer->setInterval(1000);
-    connect(refreshTimer, &QTimer::timeout, this, &CPUTab::refreshCpuValues);
+    // Only the changing values (frequencies) are refreshed, from the
+    // sampler thread's ticks while the tab is visible.
 }
 
 void CPUTab::showEvent(QShowEvent* ev)
 {
     QWidget::showEvent(ev);
-    if (refreshTimer) refreshTimer->start();
+    connect(Sampler::instance(), &Sampler::sampleReady, this, &CPUTab::refreshCpuValues, Qt::UniqueConnection);
+    Sampler::instance()->subscribe(this, Sampler::CpuFreq);
 }
 
 void CPUTab::hideEvent(QHideEvent* ev)
 {
-    if (refreshTimer) refreshTimer->stop();
+    Sampler::instance()->unsubscribe(this);
+    disconnect(Sampler::instance(), &Sampler::sampleReady, this, &CPUTab::refreshCpuValues);
     QWidget::hideEvent(ev);
 }
 
@@ -86,9 +94,12 @@ void CPUTab::showGeekMode()
 
 // --- GeekCpuDialog ---
 
+namespace {
+const QString PerCoreKey = QStringLiteral("Per-core current frequencies (kHz)");
+}
+
 GeekCpuDialog::GeekCpuDialog(QWidget* parent)
     : QDialog(parent)
-    , refreshTimer(new QTimer(this))
 {
     setWindowTitle("CPU - Geek Mode");
     setModal(true);
@@ -99,10 +110,9 @@ GeekCpuDialog::GeekCpuDialog(QWidget* parent)
     titleLabel->setStyleSheet("font-size:16px; font-weight:bold; color:#2c3e50; margin-bottom:10px;");
     layout->addWidget(titleLabel);
 
-    table = new QTableWidget();
-    table->setColumnCount(2);
-    table->setHorizontalHeaderLabels(QStringList() << "Property" << "Value");
-    table->verticalHeader()->setVisible(false);
+    model = new InfoTableModel(QStringList() << "Property" << "Value", this);
+    table = new QTableView();
+    setupInfoTableView(table, model);
     table->horizontalHeader()->setStyleSheet("QHeaderView::section { background-color: #34495e; color: white; font-weight: bold; padding: 8px; border: 1px solid #2c3e50; }");
     table->horizontalHeader()->setSectionResizeMode(0, QHeaderView::Interactive);
     table->horizontalHeader()->setSectionResizeMode(1, QHeaderView::Stretch);
@@ -123,14 +133,8 @@ GeekCpuDialog::GeekCpuDialog(QWidget* parent)
     layout->addWidget(buttonBox);
 
     connect(copyBtn, &QPushButton::clicked, [this]() {
-        QString all;
-        for (int r = 0; r < table->rowCount(); ++r) {
-            QString prop = table->item(r,0) ? table->item(r,0)->text() : QString();
-            QString val = table->item(r,1) ? table->item(r,1)->text() : QString();
-            all += prop + ": " + val + "\n";
-        }
         QClipboard *clipboard = QGuiApplication::clipboard();
-        clipboard->setText(all);
+        clipboard->setText(model->toPlainText());
     });
 
     // Note: run-as-root functionality removed to avoid accidental termination when
@@ -143,11 +147,7 @@ GeekCpuDialog::GeekCpuDialog(QWidget* parent)
             QFile out(fileName);
             if (out.open(QIODevice::WriteOnly | QIODevice::Text)) {
                 QTextStream ts(&out);
-                for (int r = 0; r < table->rowCount(); ++r) {
-                    QString prop = table->item(r,0) ? table->item(r,0)->text() : QString();
-                    QString val = table->item(r,1) ? table->item(r,1)->text() : QString();
-                    ts << prop << ": " << val << "\n";
-                }
+                ts << model->toPlainText();
                 out.close();
             }
         }
@@ -155,41 +155,52 @@ GeekCpuDialog::GeekCpuDialog(QWidget* parent)
 
     fillTable();
 
-    // Auto-refresh every second while visible
-    refreshTimer->setInterval(1000);
-    connect(refreshTimer, &QTimer::timeout, this, &GeekCpuDialog::fillTable);
+    // The static part is read once; frequencies follow the sampler while
+    // the dialog is visible.
+    connect(Sampler::instance(), &Sampler::sampleReady, this, &GeekCpuDialog::updateFrequencies);
 }
 
 void GeekCpuDialog::showEvent(QShowEvent* ev)
 {
     QDialog::showEvent(ev);
-    if (refreshTimer) refreshTimer->start();
+    Sampler::instance()->subscribe(this, Sampler::CpuFreq);
 }
 
 void GeekCpuDialog::hideEvent(QHideEvent* ev)
 {
-    if (refreshTimer) refreshTimer->stop();
+    Sampler::instance()->unsubscribe(this);
     QDialog::hideEvent(ev);
 }
 
-void GeekCpuDialog::fillTable()
+void GeekCpuDialog::updateFrequencies(const SamplePtr& sample)
 {
-    table->setRowCount(0);
-    int row = 0;
+    if (!isVisible() || !(sample->channels & Sampler::CpuFreq) || sample->curFreqKHz.isEmpty()) return;
+    TraceSpan span("live", "GeekCpuDialog::updateFrequencies");
+
+    // Only these two cells repaint; the rows keep their size.
+    if (sample->curFreqKHz[0] > 0) {
+        model->setValue("CPU MHz", 1, QString::number(sample->curFreqKHz[0] / 1000.0, 'f', 3));
+    }
+    if (model->rowOf(PerCoreKey) >= 0) {
+        QString freqSummary;
+        for (int cpu = 0; cpu < sample->curFreqKHz.size(); ++cpu) {
+            if (sample->curFreqKHz[cpu] > 0) {
+                freqSummary += QString("cpu%1: %2 kHz\n").arg(cpu).arg(sample->curFreqKHz[cpu]);
+            }
+        }
+        if (!freqSummary.isEmpty()) model->setValue(PerCoreKey, 1, freqSummary.trimmed());
+    }
+}
 
+void GeekCpuDialog::fillTable()
+{
+    InfoRows rows;
     auto addRow = [&](const QString& prop, const QString& val){
-        table->insertRow(row);
-        QTableWidgetItem* p = new QTableWidgetItem(prop);
-        QFont bold; bold.setBold(true); p->setFont(bold);
-        table->setItem(row, 0, p);
-        QTableWidgetItem* v = new QTableWidgetItem(val);
-        table->setItem(row, 1, v);
-        table->resizeRowToContents(row);
-        ++row;
+        rows.append(QStringList() << prop << val);
     };
 
     // Read /proc/cpuinfo
-    QFile file("/proc/cpuinfo");
+    QFile file(procfs::hostPath("/proc/cpuinfo"));
     QString content;
     if (file.open(QIODevice::ReadOnly | QIODevice::Text)) {
         QTextStream in(&file);
@@ -248,7 +259,7 @@ void GeekCpuDialog::fillTable()
     QString freqSummary;
     int maxCpu = 0;
     // find max cpuN directory
-    QDir sysCpuDir("/sys/devices/system/cpu");
+    QDir sysCpuDir(procfs::hostPath("/sys/devices/system/cpu"));
     QStringList entries = sysCpuDir.entryList(QDir::Dirs | QDir::NoDotAndDotDot);
     for (const QString &e : entries) {
         if (e.startsWith("cpu")) {
@@ -259,8 +270,8 @@ void GeekCpuDialog::fillTable()
     }
     if (maxCpu >= 0) {
         for (int cpu = 0; cpu <= maxCpu; ++cpu) {
-            QString curFreqPath = QString("/sys/devices/system/cpu/cpu%1/cpufreq/scaling_cur_freq").arg(cpu);
-            QString cpuinfoFreqPath = QString("/sys/devices/system/cpu/cpu%1/cpufreq/cpuinfo_cur_freq").arg(cpu);
+            QString curFreqPath = procfs::hostPath(QString("/sys/devices/system/cpu/cpu%1/cpufreq/scaling_cur_freq").arg(cpu));
+            QString cpuinfoFreqPath = procfs::hostPath(QString("/sys/devices/system/cpu/cpu%1/cpufreq/cpuinfo_cur_freq").arg(cpu));
             QString val;
             QFile f(curFreqPath);
             if (f.open(QIODevice::ReadOnly | QIODevice::Text)) {
@@ -277,80 +288,47 @@ void GeekCpuDialog::fillTable()
                 freqSummary += QString("cpu%1: %2 kHz\n").arg(cpu).arg(val);
             }
         }
-        if (!freqSummary.isEmpty()) addRow("Per-core current frequencies (kHz)", freqSummary.trimmed());
+        if (!freqSummary.isEmpty()) {
+            addRow(PerCoreKey, freqSummary.trimmed());
+        }
     }
 
     // sysfs cpuinfo_max_freq/min_freq as additional info
-    QFile maxf("/sys/devices/system/cpu/cpu0/cpufreq/cpuinfo_max_freq");
+    QFile maxf(procfs::hostPath("/sys/devices/system/cpu/cpu0/cpufreq/cpuinfo_max_freq"));
     if (maxf.open(QIODevice::ReadOnly | QIODevice::Text)) {
         addRow("cpuinfo_max_freq", QTextStream(&maxf).readLine().trimmed());
         maxf.close();
     }
-    QFile minf("/sys/devices/system/cpu/cpu0/cpufreq/cpuinfo_min_freq");
+    QFile minf(procfs::hostPath("/sys/devices/system/cpu/cpu0/cpufreq/cpuinfo_min_freq"));
     if (minf.open(QIODevice::ReadOnly | QIODevice::Text)) {
         addRow("cpuinfo_min_freq", QTextStream(&minf).readLine().trimmed());
         minf.close();
     }
+
+    model->setRows(rows);
+    // Multi-line cells (/proc/cpuinfo, per-core list) need their height;
+    // once here, the live updates do not change the line counts.
+    table->resizeRowsToContents();
 }
 
-void CPUTab::refreshCpuValues()
+void CPUTab::refreshCpuValues(const SamplePtr& sample)
 {
-    // Read a current frequency value (from /proc/cpuinfo first), and sysfs max/min
-    QString currentFreqGHz = "Unknown";
-    QFile file("/proc/cpuinfo");
-    if (file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        QTextStream in(&file);
-        QString content = in.readAll();
-        file.close();
-        for (const QString& line : content.split('\n')) {
-            if (line.startsWith("cpu MHz")) {
-                double mhz = line.section(':',1).trimmed().toDouble();
-                currentFreqGHz = QString::number(mhz / 1000.0, 'f', 2);
-                break;
-            }
-        }
-    }
-
-    QString maxGHz = "Unknown";
-    QFile maxFreqFile("/sys/devices/system/cpu/cpu0/cpufreq/cpuinfo_max_freq");
-    if (maxFreqFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        QString maxFreq = QTextStream(&maxFreqFile).readLine().trimmed();
-        maxFreqFile.close();
-        if (!maxFreq.isEmpty()) {
-            double m = maxFreq.toLongLong() / 1000000.0;
-            maxGHz = QString::number(m, 'f', 2);
-        }
-    }
-
-    QString minGHz = "Unknown";
-    QFile minFreqFile("/sys/devices/system/cpu/cpu0/cpufreq/cpuinfo_min_freq");
-    if (minFreqFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        QString minFreq = QTextStream(&minFreqFile).readLine().trimmed();
-        minFreqFile.close();
-        if (!minFreq.isEmpty()) {
-            double m = minFreq.toLongLong() / 1000000.0;
-            minGHz = QString::number(m, 'f', 2);
-        }
-    }
+    if (!(sample->channels & Sampler::CpuFreq)) return;
 
-    // Update only the rows which are likely to change
-    for (int r = 0; r < tableWidget->rowCount(); ++r) {
-        QTableWidgetItem* keyItem = tableWidget->item(r, 0);
-        if (!keyItem) continue;
-        QString key = keyItem->text().trimmed();
-
-        if (key.compare("Current freq (GHz)", Qt::CaseInsensitive) == 0) {
-            QTableWidgetItem* val = tableWidget->item(r, 1);
-            if (val) val->setText(currentFreqGHz == "Unknown" ? QString("Unknown") : currentFreqGHz);
-            else tableWidget->setItem(r, 1, new QTableWidgetItem(currentFreqGHz));
-        } else if (key.compare("Max freq (GHz)", Qt::CaseInsensitive) == 0) {
-            QTableWidgetItem* val = tableWidget->item(r, 1);
-            if (val) val->setText(maxGHz == "Unknown" ? QString("Unknown") : maxGHz);
-            else tableWidget->setItem(r, 1, new QTableWidgetItem(maxGHz));
-        } else if (key.compare("Min Freq (GHz)", Qt::CaseInsensitive) == 0 || key.compare("Min Freq (GHz)", Qt::CaseInsensitive) == 0) {
-            QTableWidgetItem* val = tableWidget->item(r, 1);
-            if (val) val->setText(minGHz == "Unknown" ? QString("Unknown") : minGHz);
-            else tableWidget->setItem(r, 1, new QTableWidgetItem(minGHz));
-        }
-    }
+    // Without cpufreq (most VMs) the values from the initial load stay.
+    auto toGHz = [](qint64 kHz) {
+        return kHz > 0 ? QString::number(kHz / 1000000.0, 'f', 2) : QString("Unknown");
+    };
+    const qint64 curKHz = sample->curFreqKHz.value(0);
+    if (curKHz <= 0 && sample->maxFreqKHz <= 0) return;
+    TraceSpan span("live", "CPUTab::refreshCpuValues");
+    const QString currentFreqGHz = curKHz > 0 ? toGHz(curKHz) : QString();
+    const QString maxGHz = toGHz(sample->maxFreqKHz);
+    const QString minGHz = toGHz(sample->minFreqKHz);
+
+    // Update only the rows which are likely to change (keys as written by
+    // collectCpuInformation()); unchanged values emit nothing.
+    if (!currentFreqGHz.isEmpty()) model->setValue("Current freq (GHz)", 1, currentFreqGHz);
+    model->setValue("Max freq (GHz)", 1, maxGHz);
+    model->setValue("Min Freq (GHz)", 1, minGHz);
 }
@@ -3,10 +3,12 @@
 
 #include <QWidget>
 #include <QPushButton>
-#include <QTableWidget>
+#include <QTableView>
 #include <QDialog>
+#include "sampler.h"
+
+class InfoTableModel;
 
-#include <QTimer>
 class QShowEvent;
 class QHideEvent;
 class GeekCpuDialog : public QDialog
@@ -22,8 +24,10 @@ protected:
     void hideEvent(QHideEvent* ev) override;
 
 private:
-    QTableWidget* table;
-    QTimer* refreshTimer;
+    void updateFrequencies(const SamplePtr& sample);
+
+    QTableView* table;
+    InfoTableModel* model;
 };
 
 class CPUTab : public QWidget
@@ -34,12 +38,12 @@ public:
 
 private slots:
     void showGeekMode();
-    void refreshCpuValues();
+    void refreshCpuValues(const SamplePtr& sample);
 
 private:
-    QTableWidget* tableWidget;
+    QTableView* tableView;
+    InfoTableModel* model;
     QPushButton* geekButton;
-    QTimer* refreshTimer;
 protected:
     void showEvent(QShowEvent* ev) override;
     void hideEvent(QHideEvent* ev) override;
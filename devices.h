@@ -0,0 +1,121 @@
+#ifndef DEVICES_H
+#define DEVICES_H
+
+#include <QDir>
+#include <QFile>
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include "info_rows.h"
+#include "procfs_parser.h"
+
+// Graphics, USB and PCI devices as the kernel lists them in sysfs, for the
+// headless "graphics", "peripherals" and "pci" sections. Only attribute
+// files are read (no lspci/lsusb, no symlinks), so capture and replay see
+// every input. Devices are keyed by their bus address, which stays the same
+// across runs, so a card, disk controller or USB device that goes away is
+// one removed row.
+InfoRows collectGraphicsInformation();
+InfoRows collectUsbDevices();
+InfoRows collectPciDevices();
+
+// First line of a sysfs attribute, trimmed; empty if it cannot be read.
+inline QString readSysfsAttribute(const QString& path)
+{
+    QFile file(procfs::hostPath(path));
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) return QString();
+    return QString::fromLocal8Bit(file.readLine()).trimmed();
+}
+
+// KEY=value lines of a uevent file.
+inline QHash<QString, QString> readUevent(const QString& path)
+{
+    QHash<QString, QString> values;
+    QFile file(procfs::hostPath(path));
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) return values;
+    for (const QString& line : QString::fromLocal8Bit(file.readAll()).split('\n', Qt::SkipEmptyParts)) {
+        const int eq = line.indexOf('=');
+        if (eq > 0) values.insert(line.left(eq), line.mid(eq + 1).trimmed());
+    }
+    return values;
+}
+
+// "1002:73df, class 030000, driver amdgpu, 16.0 GT/s PCIe x16" for the PCI
+// device in directory (a /sys/bus/pci/devices entry or a DRM card's device).
+inline QString describePciDevice(const QString& directory)
+{
+    const QHash<QString, QString> uevent = readUevent(directory + "/uevent");
+    QStringList parts;
+    parts << uevent.value("PCI_ID", "unknown id").toLower();
+    if (uevent.contains("PCI_CLASS")) parts << "class " + uevent.value("PCI_CLASS").toLower();
+    parts << "driver " + uevent.value("DRIVER", "none");
+    // A link that trained down (fewer lanes, lower speed) is worth seeing.
+    const QString speed = readSysfsAttribute(directory + "/current_link_speed");
+    const QString width = readSysfsAttribute(directory + "/current_link_width");
+    if (!speed.isEmpty() && !width.isEmpty() && width != "0") parts << QString("%1 x%2").arg(speed, width);
+    return parts.join(", ");
+}
+
+inline InfoRows collectGraphicsInformation()
+{
+    InfoRows rows;
+    const QString drm = "/sys/class/drm";
+    const QStringList entries = QDir(procfs::hostPath(drm)).entryList(QDir::Dirs | QDir::NoDotAndDotDot, QDir::Name);
+    for (const QString& entry : entries) {
+        if (!entry.startsWith("card")) continue;
+        if (!entry.contains('-')) {
+            // card0: the GPU behind it.
+            const QHash<QString, QString> uevent = readUevent(drm + "/" + entry + "/device/uevent");
+            const QString slot = uevent.value("PCI_SLOT_NAME");
+            QString value = describePciDevice(drm + "/" + entry + "/device");
+            if (!slot.isEmpty()) value += " at " + slot;
+            rows.append(QStringList() << entry << value << "" << "Graphics");
+        } else {
+            // card0-HDMI-A-1: a connector, with the preferred mode of what is
+            // plugged in.
+            const QString status = readSysfsAttribute(drm + "/" + entry + "/status");
+            if (status.isEmpty()) continue;
+            const QString mode = readSysfsAttribute(drm + "/" + entry + "/modes");
+            rows.append(QStringList() << entry << (mode.isEmpty() ? status : status + " " + mode) << "" << "Graphics");
+        }
+    }
+    return rows;
+}
+
+inline InfoRows collectUsbDevices()
+{
+    InfoRows rows;
+    const QString bus = "/sys/bus/usb/devices";
+    const QStringList entries = QDir(procfs::hostPath(bus)).entryList(QDir::Dirs | QDir::NoDotAndDotDot, QDir::Name);
+    for (const QString& entry : entries) {
+        // 1-2.3 is a device on port 2.3 of bus 1; usb1 is the root hub and
+        // 1-2.3:1.0 one of the device's interfaces.
+        if (entry.startsWith("usb") || entry.contains(':')) continue;
+        const QString path = bus + "/" + entry;
+        const QString vendor = readSysfsAttribute(path + "/idVendor");
+        const QString product = readSysfsAttribute(path + "/idProduct");
+        if (vendor.isEmpty() || product.isEmpty()) continue;
+        QStringList parts;
+        parts << vendor + ":" + product;
+        const QString name = QStringList({readSysfsAttribute(path + "/manufacturer"),
+                                          readSysfsAttribute(path + "/product")}).join(' ').trimmed();
+        if (!name.isEmpty()) parts << name;
+        const QString speed = readSysfsAttribute(path + "/speed");
+        if (!speed.isEmpty()) parts << speed + " Mb/s";
+        rows.append(QStringList() << "USB " + entry << parts.join(", ") << "" << "Peripherals");
+    }
+    return rows;
+}
+
+inline InfoRows collectPciDevices()
+{
+    InfoRows rows;
+    const QString bus = "/sys/bus/pci/devices";
+    const QStringList entries = QDir(procfs::hostPath(bus)).entryList(QDir::Dirs | QDir::NoDotAndDotDot, QDir::Name);
+    for (const QString& entry : entries) {
+        rows.append(QStringList() << entry << describePciDevice(bus + "/" + entry) << "" << "PCI");
+    }
+    return rows;
+}
+
+#endif // DEVICES_H
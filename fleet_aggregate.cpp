@@ -0,0 +1,426 @@
+#include "fleet_aggregate.h"
+#include "snapshot_file.h"
+#include <QDirIterator>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+#include <QThreadPool>
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <utility>
+
+namespace {
+
+constexpr int MaxErrors = 20;
+const QChar KeySeparator(0x1f);
+// Distinct fingerprints counted exactly, per group and over all files;
+// beyond that they are estimated (to about 6% and 1.6%).
+constexpr int GroupConfigurations = 256;
+constexpr int TotalConfigurations = 4096;
+
+quint64 fnv(quint64 h, const QString& text)
+{
+    const uchar* bytes = reinterpret_cast<const uchar*>(text.constData());
+    const qsizetype size = text.size() * qsizetype(sizeof(QChar));
+    for (qsizetype i = 0; i < size; ++i) {
+        h ^= bytes[i];
+        h *= 0x100000001b3ull;
+    }
+    return h;
+}
+
+struct MemoryModules {
+    int slots = 0;
+    int free = 0;
+    qint64 installedMB = 0;
+    QStringList sizes;      // per slot, for the fingerprint
+};
+
+// The Memory Device blocks of `dmidecode -t memory`.
+MemoryModules parseMemoryDevices(const QString& output)
+{
+    MemoryModules modules;
+    bool inDevice = false;
+    for (const QString& line : output.split('\n')) {
+        const QString trimmed = line.trimmed();
+        if (!line.startsWith('\t') && !line.startsWith(' ')) {
+            inDevice = trimmed == "Memory Device";
+            continue;
+        }
+        if (!inDevice || !trimmed.startsWith("Size:")) continue;
+        const QString size = trimmed.mid(5).trimmed();
+        ++modules.slots;
+        modules.sizes.append(size);
+        if (size.startsWith("No Module")) {
+            ++modules.free;
+            continue;
+        }
+        const QStringList parts = size.split(' ', Qt::SkipEmptyParts);
+        const qint64 amount = parts.value(0).toLongLong();
+        const QString unit = parts.value(1);
+        if (unit == "GB") modules.installedMB += amount * 1024;
+        else if (unit == "TB") modules.installedMB += amount * 1024 * 1024;
+        else if (unit == "MB") modules.installedMB += amount;
+    }
+    return modules;
+}
+
+// Output of `dmidecode -t memory` from the archive, through its manifest.
+QString archivedDmidecode(const SnapshotFile& file)
+{
+    const int manifest = file.indexOf("archive/manifest.json");
+    if (manifest < 0) return QString();
+    const QJsonObject root = QJsonDocument::fromJson(file.data(manifest)).object();
+    for (const QJsonValue& value : root.value("commands").toArray()) {
+        const QJsonObject command = value.toObject();
+        if (command.value("program").toString() != "dmidecode") continue;
+        if (command.value("arguments").toArray() != QJsonArray{"-t", "memory"}) continue;
+        const int out = file.indexOf("archive/" + command.value("stdout").toString());
+        return out < 0 ? QString() : QString::fromUtf8(file.data(out));
+    }
+    return QString();
+}
+
+// Values of the query's fields and the fingerprint of one snapshot.
+class Extractor
+{
+public:
+    explicit Extractor(const SnapshotFile& file) : m_file(file) {}
+
+    QString field(const QString& name)
+    {
+        if (name == "hostname" || name == "lsv_version" || name == "generated") {
+            if (!m_metaLoaded) {
+                m_meta = m_file.meta();
+                m_metaLoaded = true;
+            }
+            return m_meta.value(name);
+        }
+        if (name == "memory/slots") return QString::number(memory().slots);
+        if (name == "memory/free_slots") return QString::number(memory().free);
+        if (name == "memory/installed") return QString("%1 GB").arg(memory().installedMB / 1024);
+        const int slash = name.indexOf('/');
+        if (slash <= 0) return QString();
+        const QString property = name.mid(slash + 1);
+        for (const QStringList& cells : rows(name.left(slash))) {
+            if (cells.value(0).trimmed() != property) continue;
+            const QString unit = cells.value(2);
+            return unit.isEmpty() ? cells.value(1) : cells.value(1) + ' ' + unit;
+        }
+        return QString();
+    }
+
+    quint64 fingerprint()
+    {
+        return hardwareFingerprint(rows("cpu"), rows("mainboard"), memory().sizes);
+    }
+
+private:
+    const InfoRows& rows(const QString& section)
+    {
+        auto it = m_rows.find(section);
+        if (it == m_rows.end()) it = m_rows.insert(section, m_file.rows("section/" + section));
+        return it.value();
+    }
+
+    const MemoryModules& memory()
+    {
+        if (!m_memoryLoaded) {
+            m_memory = parseMemoryDevices(archivedDmidecode(m_file));
+            m_memoryLoaded = true;
+        }
+        return m_memory;
+    }
+
+    const SnapshotFile& m_file;
+    QHash<QString, InfoRows> m_rows;
+    QHash<QString, QString> m_meta;
+    bool m_metaLoaded = false;
+    MemoryModules m_memory;
+    bool m_memoryLoaded = false;
+};
+
+// Number of distinct fingerprints in at most Capacity values: exact until
+// more than Capacity were seen, then estimated from the Capacity smallest
+// (mixed) hashes, as the k-th smallest of n uniform hashes lies near k/n of
+// the range. Merging keeps the smallest again, so the count does not
+// depend on how the files were spread over the workers.
+template <int Capacity>
+class DistinctCount
+{
+public:
+    void insert(quint64 fingerprint)
+    {
+        // splitmix64's finalizer: FNV leaves the high bits poorly spread.
+        quint64 h = fingerprint;
+        h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ull;
+        h = (h ^ (h >> 27)) * 0x94d049bb133111ebull;
+        insertHash(h ^ (h >> 31));
+    }
+
+    void unite(const DistinctCount& other)
+    {
+        for (quint64 h : other.m_hashes) insertHash(h);
+        m_estimated = m_estimated || other.m_estimated;
+    }
+
+    bool isEstimate() const { return m_estimated; }
+
+    qint64 count() const
+    {
+        if (!m_estimated) return m_hashes.size();
+        return qint64((Capacity - 1) / (double(qMax<quint64>(m_hashes.last(), 1)) / 18446744073709551616.0));
+    }
+
+private:
+    void insertHash(quint64 h)
+    {
+        if (m_hashes.size() == Capacity && h >= m_hashes.last()) {
+            if (h > m_hashes.last()) m_estimated = true;
+            return;
+        }
+        const auto it = std::lower_bound(m_hashes.begin(), m_hashes.end(), h);
+        if (it != m_hashes.end() && *it == h) return;
+        m_hashes.insert(it, h);
+        if (m_hashes.size() > Capacity) {
+            m_hashes.removeLast();
+            m_estimated = true;
+        }
+    }
+
+    QVector<quint64> m_hashes;  // sorted
+    bool m_estimated = false;
+};
+
+struct Group {
+    QStringList values;
+    qint64 hosts = 0;
+    DistinctCount<GroupConfigurations> fingerprints;
+};
+
+// Groups by joined key. A worker keeps at most maxGroups groups and
+// counts the hosts of any further ones in other, so its memory stays
+// bounded however many distinct values the files have. The merged table is
+// folded to maxGroups once at the end (foldGroups()); as long as no worker
+// reached its cap, which groups become "(other)" does not depend on the
+// worker a file went to.
+struct GroupTable {
+    QHash<QString, Group> groups;
+    Group other;
+    bool overflowed = false;
+    DistinctCount<TotalConfigurations> fingerprints;
+
+    Group& find(const QStringList& values, int maxGroups)
+    {
+        const QString key = values.join(KeySeparator);
+        auto it = groups.find(key);
+        if (it != groups.end()) return it.value();
+        if (groups.size() >= maxGroups) {
+            overflowed = true;
+            return other;
+        }
+        return groups.insert(key, Group{values, 0, {}}).value();
+    }
+
+    // Adds every group of from, whatever the size of this table: the
+    // merged table holds at most jobs * maxGroups groups.
+    void merge(const GroupTable& from)
+    {
+        for (const Group& group : from.groups) {
+            Group& into = find(group.values, std::numeric_limits<int>::max());
+            into.hosts += group.hosts;
+            into.fingerprints.unite(group.fingerprints);
+        }
+        other.hosts += from.other.hosts;
+        other.fingerprints.unite(from.other.fingerprints);
+        overflowed = overflowed || from.overflowed;
+        fingerprints.unite(from.fingerprints);
+    }
+};
+
+// The maxGroups groups with the most hosts (ties by values), then one
+// "(other)" group for the rest and for what the workers could not keep.
+QVector<Group> foldGroups(const GroupTable& table, int maxGroups, int fieldCount, bool* folded)
+{
+    QVector<Group> sorted;
+    sorted.reserve(table.groups.size());
+    for (const Group& group : table.groups) sorted.append(group);
+    std::sort(sorted.begin(), sorted.end(), [](const Group& a, const Group& b) {
+        if (a.hosts != b.hosts) return a.hosts > b.hosts;
+        return a.values < b.values;
+    });
+    *folded = table.overflowed || sorted.size() > maxGroups;
+    if (!*folded) return sorted;
+    Group other = table.other;
+    for (int i = maxGroups; i < sorted.size(); ++i) {
+        other.hosts += sorted[i].hosts;
+        other.fingerprints.unite(sorted[i].fingerprints);
+    }
+    if (sorted.size() > maxGroups) sorted.resize(maxGroups);
+    for (int i = 0; i < fieldCount; ++i) other.values.append("(other)");
+    sorted.append(other);
+    return sorted;
+}
+
+QString csvField(const QString& text)
+{
+    if (!text.contains(',') && !text.contains('"') && !text.contains('\n')) return text;
+    return '"' + QString(text).replace("\"", "\"\"") + '"';
+}
+
+} // namespace
+
+quint64 hardwareFingerprint(const InfoRows& cpu, const InfoRows& mainboard, const QStringList& moduleSizes)
+{
+    // Only what identifies the hardware: serial numbers, BogoMIPS and
+    // clocks differ between machines that are built the same.
+    static const char* const CpuFields[] = {
+        "Vendor", "Model", "Total number of processors", "Number of processor (Physical)", "Cache size",
+    };
+    static const char* const MainboardFields[] = {
+        "Manufacturer", "Model", "Version", "BIOS Vendor", "BIOS Version",
+    };
+    auto value = [](const InfoRows& rows, const char* property) {
+        for (const QStringList& cells : rows) {
+            if (cells.value(0).trimmed() == QLatin1String(property)) return cells.value(1).trimmed();
+        }
+        return QString();
+    };
+    quint64 h = 0xcbf29ce484222325ull;
+    h = fnv(h, QStringLiteral("cpu"));
+    for (const char* field : CpuFields) h = fnv(fnv(h, QLatin1String(field)), value(cpu, field));
+    h = fnv(h, QStringLiteral("mainboard"));
+    for (const char* field : MainboardFields) h = fnv(fnv(h, QLatin1String(field)), value(mainboard, field));
+    h = fnv(h, QStringLiteral("memory"));
+    for (const QString& size : moduleSizes) h = fnv(h, size);
+    return h;
+}
+
+QStringList findSnapshotFiles(const QStringList& paths)
+{
+    QStringList files;
+    for (const QString& path : paths) {
+        if (!QFileInfo(path).isDir()) {
+            files.append(path);
+            continue;
+        }
+        QDirIterator it(path, QStringList() << "*.lsvsnap", QDir::Files, QDirIterator::Subdirectories);
+        while (it.hasNext()) files.append(it.next());
+    }
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+FleetResult aggregateSnapshots(const QStringList& files, const FleetQuery& query)
+{
+    QElapsedTimer clock;
+    clock.start();
+    FleetResult result;
+    result.files = files.size();
+
+    const int maxGroups = qMax(1, query.maxGroups);
+    const int jobs = qBound(1, query.jobs > 0 ? query.jobs : QThread::idealThreadCount(), qMax(1, int(files.size())));
+    std::atomic<int> next{0};
+    std::atomic<qint64> failed{0};
+    QMutex mutex;
+    GroupTable total;
+    QStringList errors;
+
+    // Workers take the next file until none are left, so slow files do not
+    // hold up a fixed share of the list.
+    QThreadPool pool;
+    pool.setMaxThreadCount(jobs);
+    for (int w = 0; w < jobs; ++w) {
+        pool.start([&]() {
+            GroupTable local;
+            QStringList localErrors;
+            for (int i = next.fetch_add(1); i < files.size(); i = next.fetch_add(1)) {
+                SnapshotFile file;
+                QString error;
+                if (!file.open(files[i], &error)) {
+                    failed.fetch_add(1);
+                    if (localErrors.size() < MaxErrors) localErrors.append(error);
+                    continue;
+                }
+                Extractor extract(file);
+                QStringList values;
+                values.reserve(query.groupBy.size());
+                for (const QString& field : query.groupBy) values.append(extract.field(field));
+                const quint64 fingerprint = extract.fingerprint();
+                Group& group = local.find(values, maxGroups);
+                ++group.hosts;
+                group.fingerprints.insert(fingerprint);
+                local.fingerprints.insert(fingerprint);
+            }
+            QMutexLocker lock(&mutex);
+            total.merge(local);
+            for (const QString& error : localErrors) {
+                if (errors.size() < MaxErrors) errors.append(error);
+            }
+        });
+    }
+    pool.waitForDone();
+
+    result.failed = failed.load();
+    result.errors = errors;
+    result.configurations = total.fingerprints.count();
+    result.estimated = total.fingerprints.isEstimate();
+    const QVector<Group> groups = foldGroups(total, maxGroups, int(query.groupBy.size()), &result.folded);
+    result.groups.reserve(groups.size());
+    for (const Group& group : groups) {
+        result.groups.append(FleetGroup{group.values, group.hosts, group.fingerprints.count()});
+        result.estimated = result.estimated || group.fingerprints.isEstimate();
+    }
+    std::sort(result.groups.begin(), result.groups.end(), [](const FleetGroup& a, const FleetGroup& b) {
+        if (a.hosts != b.hosts) return a.hosts > b.hosts;
+        return a.values < b.values;
+    });
+    result.elapsedMs = clock.elapsed();
+    return result;
+}
+
+QByteArray fleetToCsv(const FleetResult& result, const FleetQuery& query)
+{
+    QStringList header;
+    for (const QString& field : query.groupBy) header.append(csvField(field));
+    header << "hosts" << "configurations";
+    QString csv = header.join(',') + '\n';
+    for (const FleetGroup& group : result.groups) {
+        QStringList line;
+        for (const QString& value : group.values) line.append(csvField(value));
+        line << QString::number(group.hosts) << QString::number(group.configurations);
+        csv += line.join(',') + '\n';
+    }
+    return csv.toUtf8();
+}
+
+QJsonObject fleetToJson(const FleetResult& result, const FleetQuery& query)
+{
+    QJsonArray groups;
+    for (const FleetGroup& group : result.groups) {
+        QJsonObject values;
+        for (int i = 0; i < query.groupBy.size(); ++i) values.insert(query.groupBy[i], group.values.value(i));
+        QJsonObject object;
+        object.insert("values", values);
+        object.insert("hosts", double(group.hosts));
+        object.insert("configurations", double(group.configurations));
+        groups.append(object);
+    }
+    QJsonObject root;
+    root.insert("files", double(result.files));
+    root.insert("failed", double(result.failed));
+    root.insert("configurations", double(result.configurations));
+    root.insert("elapsed_ms", double(result.elapsedMs));
+    root.insert("group_by", QJsonArray::fromStringList(query.groupBy));
+    root.insert("folded", result.folded);
+    root.insert("estimated", result.estimated);
+    root.insert("errors", QJsonArray::fromStringList(result.errors));
+    root.insert("groups", groups);
+    return root;
+}
@@ -0,0 +1,79 @@
+#ifndef FLEET_AGGREGATE_H
+#define FLEET_AGGREGATE_H
+
+#include <QByteArray>
+#include <QJsonObject>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include "info_rows.h"
+
+// Group-by over many snapshot files (snapshot_file.h), for lsv-fleet.
+//
+// Fields a snapshot can be grouped by:
+//
+//   hostname, lsv_version, generated      from the snapshot's metadata
+//   <section>/<property>                  value (and unit) of a row in a
+//                                         row section, e.g. "cpu/Model"
+//   memory/slots, memory/free_slots,      from the archived
+//   memory/installed                      `dmidecode -t memory` output
+//
+// A missing field groups as an empty value.
+//
+// Every snapshot also gets a hardware fingerprint (hardwareFingerprint()).
+// Each group counts its hosts and its distinct fingerprints, so a thousand
+// identical machines are one configuration. Up to 256 configurations per
+// group (4096 over all files) are counted exactly; beyond that the count
+// is an estimate (FleetResult::estimated).
+//
+// Files are spread over a pool of workers; each maps one file at a time,
+// keeps only the extracted values and aggregates into its own table, and
+// the tables are merged at the end. A worker keeps at most maxGroups
+// groups of at most 2 KB of fingerprints each and counts the hosts of
+// further groups as "(other)" straight away, so memory stays within
+// jobs * maxGroups groups whatever the files hold. After the merge, the
+// groups beyond maxGroups with the fewest hosts are folded into "(other)"
+// too; that part does not depend on how the files were spread over the
+// workers, so the output is the same for any number of workers unless one
+// of them reached the cap (FleetResult::folded is set either way).
+struct FleetQuery {
+    QStringList groupBy;
+    int jobs = 0;               // workers; 0: one per core
+    int maxGroups = 100000;     // groups printed and kept per worker; the rest are "(other)"
+};
+
+struct FleetGroup {
+    QStringList values;         // one per groupBy field
+    qint64 hosts = 0;
+    qint64 configurations = 0;
+};
+
+struct FleetResult {
+    qint64 files = 0;
+    qint64 failed = 0;
+    qint64 configurations = 0;  // over all files
+    qint64 elapsedMs = 0;
+    bool folded = false;        // there were more than maxGroups groups
+    bool estimated = false;     // some configuration counts are estimates
+    QStringList errors;         // the first few unreadable files
+    QVector<FleetGroup> groups; // most hosts first
+};
+
+// Hash of the fields that identify a machine's hardware: CPU vendor, model,
+// processor counts and cache; board vendor, model and version; BIOS vendor
+// and version; and the size of the module in each memory slot. Serial
+// numbers, BogoMIPS and clocks are left out, so identically built machines
+// hash the same.
+quint64 hardwareFingerprint(const InfoRows& cpu, const InfoRows& mainboard, const QStringList& moduleSizes);
+
+// *.lsvsnap files below paths (directories are searched recursively;
+// files are taken as they are), sorted.
+QStringList findSnapshotFiles(const QStringList& paths);
+
+FleetResult aggregateSnapshots(const QStringList& files, const FleetQuery& query);
+
+// One line per group: the fields, then hosts and configurations.
+QByteArray fleetToCsv(const FleetResult& result, const FleetQuery& query);
+QJsonObject fleetToJson(const FleetResult& result, const FleetQuery& query);
+
+#endif // FLEET_AGGREGATE_H
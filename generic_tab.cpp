@@ -1,6 +1,7 @@
 #include "generic_tab.h"
 #include <QVBoxLayout>
 #include <QTextEdit>
+#include <QTextCursor>
 #include <QFont>
 #include <QLabel>
 #include <QDebug>
@@ -36,14 +37,22 @@ QWidget* GenericTab::createUserFriendlyView()
     return m_outputDisplay;
 }
 
-void GenericTab::parseOutput(const QString& output)
+void GenericTab::beginStream()
 {
-    qDebug() << "GenericTab: parseOutput called for:" << m_tabName;
-    
+    qDebug() << "GenericTab: parsing started for:" << m_tabName;
+
     if (m_outputDisplay) {
-        QString formattedOutput = "=== " + m_tabName + " Information ===\n\n" + output;
-        m_outputDisplay->setPlainText(formattedOutput);
+        m_outputDisplay->setPlainText("=== " + m_tabName + " Information ===\n");
+    }
+}
+
+void GenericTab::parseLines(const QStringList& lines)
+{
+    if (m_outputDisplay) {
+        // append() would start a new paragraph per call; keep the
+        // lines exactly as the command wrote them.
+        QTextCursor cursor(m_outputDisplay->document());
+        cursor.movePosition(QTextCursor::End);
+        cursor.insertText('\n' + lines.join('\n'));
     }
-    
-    qDebug() << "GenericTab: parseOutput completed for:" << m_tabName;
 }
\ No newline at end of file
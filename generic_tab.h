@@ -15,7 +15,10 @@ public:
 
 protected:
     QWidget* createUserFriendlyView() override;
-    void parseOutput(const QString& output) override;
+    // Raw output, appended as it arrives.
+    bool streamsOutput() const override { return true; }
+    void beginStream() override;
+    void parseLines(const QStringList& lines) override;
 
 private:
     QTextEdit* m_outputDisplay;
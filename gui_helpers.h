@@ -10,6 +10,7 @@
 #include <QHeaderView>
 #include <QColor>
 #include <QBrush>
+#include <QHash>
 #include <QRegularExpression>
 #include <QList>
 #include <QDebug>
@@ -17,6 +18,8 @@
 #include <QVariant>
 #include <QMetaType>
 #include <QtGlobal>
+#include "info_rows.h"
+#include "trace.h"
 
 // Search result structure
 struct SearchResult {
@@ -32,6 +35,7 @@ Q_DECLARE_METATYPE(SearchResult)
 
 // UI utility functions
 void addRowToTable(QTableWidget* table, const QStringList& data);
+void addRowsToTable(QTableWidget* table, const InfoRows& rows);
 void setupTableWidget(QTableWidget* table, const QStringList& headers);
 void clearAllHighlighting(QList<QTableWidget*> tables);
 void highlightMatchedText(QTableWidget* table, int row, int col, const QString& searchTerm, bool useRegex);
@@ -44,6 +48,8 @@ void navigateToSearchResult(QTabWidget* tabWidget, QList<QTableWidget*> tables,
 // Table styling functions
 void styleTable(QTableWidget* table);
 void styleSearchTable(QTableWidget* table);
+void markBaselineRows(QTableWidget* table, const QHash<QString, QString>& changed,
+                      const QHash<QString, QString>& keyOf = QHash<QString, QString>());
 
 // Inline implementations
 
@@ -77,6 +83,15 @@ inline void addRowToTable(QTableWidget* table, const QStringList& data)
     }
 }
 
+inline void addRowsToTable(QTableWidget* table, const InfoRows& rows)
+{
+    TraceSpan span("table", "fillTable");
+    span.addArg("rows", qint64(rows.size()));
+    for (const QStringList& row : rows) {
+        addRowToTable(table, row);
+    }
+}
+
 inline void setupTableWidget(QTableWidget* table, const QStringList& headers)
 {
     if (!table) return;
@@ -401,4 +416,29 @@ inline void initializeSearchTable(QTableWidget* table)
     table->horizontalHeader()->setSectionResizeMode(1, QHeaderView::Stretch);
 }
 
+// Highlight the values of rows that differ from the --baseline snapshot,
+// the way InfoTableModel::setBaseline() does for model tables. changed is
+// SnapshotBaseline::changedRows(); keyOf maps a table property to its
+// snapshot key where the two differ.
+inline void markBaselineRows(QTableWidget* table, const QHash<QString, QString>& changed,
+                             const QHash<QString, QString>& keyOf)
+{
+    if (!table || changed.isEmpty()) return;
+    QHash<QString, int> seen;
+    for (int row = 0; row < table->rowCount(); ++row) {
+        QTableWidgetItem* propItem = table->item(row, 0);
+        QTableWidgetItem* valItem = table->item(row, 1);
+        if (!propItem || !valItem) continue;
+        // A property that repeats is "<property> #2" and on in the snapshot.
+        const QString property = propItem->text().trimmed();
+        QString key = keyOf.value(property, property);
+        const int n = ++seen[key];
+        if (n > 1) key += QString(" #%1").arg(n);
+        const auto it = changed.constFind(key);
+        if (it == changed.constEnd()) continue;
+        valItem->setBackground(QColor(0xff, 0xf3, 0xc4)); // #fff3c4
+        valItem->setToolTip(it->isNull() ? QString("Not in the baseline") : QString("Baseline: %1").arg(*it));
+    }
+}
+
 #endif // UI_HELPERS_H
\ No newline at end of file
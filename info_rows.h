@@ -0,0 +1,16 @@
+#ifndef INFO_ROWS_H
+#define INFO_ROWS_H
+
+#include <QList>
+#include <QStringList>
+
+// Rows produced by the collectors in cpu.h, os.h, storage.h, ...
+// Each row holds the cells of one table line: Property, Value and, where the
+// collector has them, Unit and Type.
+//
+// Collectors only depend on Qt Core so they can be shared by the GUI tables
+// (see addRowsToTable in gui_helpers.h and InfoTableModel::setRows) and the
+// headless `--json` mode.
+using InfoRows = QList<QStringList>;
+
+#endif // INFO_ROWS_H
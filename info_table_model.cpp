@@ -0,0 +1,205 @@
+#include "info_table_model.h"
+#include "trace.h"
+#include <QColor>
+#include <QHeaderView>
+#include <QPalette>
+#include <QTableView>
+
+InfoTableModel::InfoTableModel(const QStringList& headers, QObject* parent)
+    : QAbstractTableModel(parent)
+    , m_headers(headers)
+    , m_columns(headers.size())
+{
+}
+
+int InfoTableModel::rowCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : m_keys.size();
+}
+
+int InfoTableModel::columnCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : m_headers.size();
+}
+
+QVariant InfoTableModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid()) return QVariant();
+    if (!m_baseline.isEmpty() && index.column() == 1 && (role == Qt::BackgroundRole || role == Qt::ToolTipRole)) {
+        const auto it = m_baseline.constFind(m_keys[index.row()].trimmed());
+        if (it != m_baseline.constEnd()) {
+            if (role == Qt::BackgroundRole) return QColor(0xff, 0xf3, 0xc4); // #fff3c4
+            return it->isNull() ? QString("Not in the baseline") : QString("Baseline: %1").arg(*it);
+        }
+    }
+    if (role != Qt::DisplayRole && role != Qt::ToolTipRole) return QVariant();
+    return m_columns[index.column()][index.row()];
+}
+
+QVariant InfoTableModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation == Qt::Horizontal && role == Qt::DisplayRole) return m_headers.value(section);
+    return QAbstractTableModel::headerData(section, orientation, role);
+}
+
+QString InfoTableModel::text(int row, int column) const
+{
+    if (column < 0 || column >= m_columns.size() || row < 0 || row >= m_keys.size()) return QString();
+    return m_columns[column][row];
+}
+
+void InfoTableModel::setRows(const InfoRows& rows)
+{
+    TraceSpan span("table", "InfoTableModel::setRows");
+    span.addArg("rows", qint64(rows.size()));
+
+    const int oldRows = m_keys.size();
+    const int newRows = rows.size();
+    const int common = qMin(oldRows, newRows);
+    for (int row = 0; row < common; ++row) {
+        if (rows[row].value(0) != m_keys[row]) {
+            // Different rows (or order): nothing to keep.
+            beginResetModel();
+            for (QVector<QString>& column : m_columns) column.clear();
+            m_keys.clear();
+            m_rowOfKey.clear();
+            for (const QStringList& cells : rows) {
+                m_keys.append(cells.value(0));
+                for (int col = 0; col < m_columns.size(); ++col) m_columns[col].append(cells.value(col));
+                indexKey(m_keys.size() - 1);
+            }
+            endResetModel();
+            return;
+        }
+    }
+
+    // Same rows: update in place, one dataChanged per run of adjacent
+    // changed rows, spanning the changed columns of that run.
+    int runStart = -1;
+    int runFirstCol = 0;
+    int runLastCol = 0;
+    auto flush = [&](int lastRow) {
+        if (runStart < 0) return;
+        emit dataChanged(index(runStart, runFirstCol), index(lastRow, runLastCol), {Qt::DisplayRole});
+        runStart = -1;
+    };
+    for (int row = 0; row < common; ++row) {
+        int firstCol = -1;
+        int lastCol = -1;
+        for (int col = 0; col < m_columns.size(); ++col) {
+            const QString cell = rows[row].value(col);
+            if (m_columns[col][row] != cell) {
+                m_columns[col][row] = cell;
+                if (firstCol < 0) firstCol = col;
+                lastCol = col;
+            }
+        }
+        if (firstCol < 0) {
+            flush(row - 1);
+        } else if (runStart < 0) {
+            runStart = row;
+            runFirstCol = firstCol;
+            runLastCol = lastCol;
+        } else {
+            runFirstCol = qMin(runFirstCol, firstCol);
+            runLastCol = qMax(runLastCol, lastCol);
+        }
+    }
+    flush(common - 1);
+
+    if (newRows > oldRows) {
+        beginInsertRows(QModelIndex(), oldRows, newRows - 1);
+        for (int row = oldRows; row < newRows; ++row) {
+            m_keys.append(rows[row].value(0));
+            for (int col = 0; col < m_columns.size(); ++col) m_columns[col].append(rows[row].value(col));
+            indexKey(row);
+        }
+        endInsertRows();
+    } else if (newRows < oldRows) {
+        beginRemoveRows(QModelIndex(), newRows, oldRows - 1);
+        for (int row = newRows; row < oldRows; ++row) {
+            auto it = m_rowOfKey.find(m_keys[row]);
+            if (it != m_rowOfKey.end() && it.value() == row) m_rowOfKey.erase(it);
+        }
+        m_keys.resize(newRows);
+        for (QVector<QString>& column : m_columns) column.resize(newRows);
+        endRemoveRows();
+    }
+}
+
+int InfoTableModel::appendRow(const QStringList& cells, const QString& key)
+{
+    const int row = m_keys.size();
+    beginInsertRows(QModelIndex(), row, row);
+    m_keys.append(key.isNull() ? cells.value(0) : key);
+    for (int col = 0; col < m_columns.size(); ++col) m_columns[col].append(cells.value(col));
+    indexKey(row);
+    endInsertRows();
+    return row;
+}
+
+bool InfoTableModel::setValue(const QString& key, int column, const QString& text)
+{
+    const int row = rowOf(key);
+    if (row < 0 || column < 0 || column >= m_columns.size()) return false;
+    QString& cell = m_columns[column][row];
+    if (cell != text) {
+        cell = text;
+        const QModelIndex changed = index(row, column);
+        emit dataChanged(changed, changed, {Qt::DisplayRole});
+    }
+    return true;
+}
+
+void InfoTableModel::clear()
+{
+    if (m_keys.isEmpty()) return;
+    beginResetModel();
+    for (QVector<QString>& column : m_columns) column.clear();
+    m_keys.clear();
+    m_rowOfKey.clear();
+    endResetModel();
+}
+
+void InfoTableModel::setBaseline(const QHash<QString, QString>& before)
+{
+    if (before.isEmpty() && m_baseline.isEmpty()) return;
+    m_baseline = before;
+    if (!m_keys.isEmpty() && m_columns.size() > 1) {
+        emit dataChanged(index(0, 1), index(m_keys.size() - 1, 1), {Qt::BackgroundRole, Qt::ToolTipRole});
+    }
+}
+
+QString InfoTableModel::toPlainText() const
+{
+    QString all;
+    for (int row = 0; row < m_keys.size(); ++row) {
+        all += text(row, 0) + ": " + text(row, 1) + "\n";
+    }
+    return all;
+}
+
+void InfoTableModel::indexKey(int row)
+{
+    if (!m_rowOfKey.contains(m_keys[row])) m_rowOfKey.insert(m_keys[row], row);
+}
+
+void InfoItemDelegate::initStyleOption(QStyleOptionViewItem* option, const QModelIndex& index) const
+{
+    QStyledItemDelegate::initStyleOption(option, index);
+    if (index.column() == 0) {
+        option->font.setBold(true);
+        option->palette.setColor(QPalette::Text, QColor(0, 0, 0));
+    } else {
+        option->palette.setColor(QPalette::Text, QColor(56, 42, 126)); // #382a7e
+    }
+}
+
+void setupInfoTableView(QTableView* view, InfoTableModel* model)
+{
+    view->setModel(model);
+    view->setItemDelegate(new InfoItemDelegate(view));
+    view->verticalHeader()->setVisible(false);
+    view->setSelectionBehavior(QAbstractItemView::SelectRows);
+    view->setEditTriggers(QAbstractItemView::NoEditTriggers);
+}
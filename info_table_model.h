@@ -0,0 +1,91 @@
+#ifndef INFO_TABLE_MODEL_H
+#define INFO_TABLE_MODEL_H
+
+#include <QAbstractTableModel>
+#include <QHash>
+#include <QStringList>
+#include <QStyledItemDelegate>
+#include <QVector>
+#include "info_rows.h"
+
+class QTableView;
+
+// Table model for the Property/Value tables that are refreshed while shown
+// (CPU tab, CPU Geek Mode).
+//
+// Cells are kept per column and every row has a key (its first cell unless
+// given), so a refresh can find its row through a hash instead of comparing
+// the text of every row. setRows() and setValue() only emit dataChanged for
+// the cells whose text actually changed, in as few ranges as possible; the
+// view repaints those cells and nothing is reallocated or laid out again.
+//
+// The property/value colours and the bold property column come from
+// InfoItemDelegate rather than from per-cell fonts and brushes. Values that
+// differ from a baseline snapshot (see setBaseline()) get a highlight
+// background and the baseline value as tool tip.
+class InfoTableModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    explicit InfoTableModel(const QStringList& headers, QObject* parent = nullptr);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+    // Replace the contents. Rows whose keys match the current rows in order
+    // are updated in place; only a different order or set of keys resets
+    // the model. Extra cells are dropped, missing ones are empty.
+    void setRows(const InfoRows& rows);
+
+    // Append one row; key defaults to the first cell. Returns its index.
+    int appendRow(const QStringList& cells, const QString& key = QString());
+
+    // Set one cell of the row with this key. Returns false if there is no
+    // such row. Nothing is emitted when the text is unchanged.
+    bool setValue(const QString& key, int column, const QString& text);
+
+    void clear();
+
+    // Row of key, or -1. With duplicate keys the first row wins.
+    int rowOf(const QString& key) const { return m_rowOfKey.value(key, -1); }
+    QString text(int row, int column) const;
+
+    // Mark the value cells of these rows as changed, keyed by the trimmed
+    // first cell: the baseline value, or a null string for a row that the
+    // baseline does not have (SnapshotBaseline::changedRows()).
+    void setBaseline(const QHash<QString, QString>& before);
+
+    // "Property: Value" lines, for Copy and Save.
+    QString toPlainText() const;
+
+private:
+    void indexKey(int row);
+
+    QStringList m_headers;
+    QVector<QVector<QString>> m_columns;    // m_columns[column][row]
+    QVector<QString> m_keys;
+    QHash<QString, int> m_rowOfKey;
+    QHash<QString, QString> m_baseline;
+};
+
+// Paints the first column bold and black and the others in the value
+// colour used by addRowToTable().
+class InfoItemDelegate : public QStyledItemDelegate
+{
+    Q_OBJECT
+
+public:
+    using QStyledItemDelegate::QStyledItemDelegate;
+
+protected:
+    void initStyleOption(QStyleOptionViewItem* option, const QModelIndex& index) const override;
+};
+
+// Give view the model and the delegate, with the defaults of the info
+// tables (no row numbers, rows selected as a whole, read-only).
+void setupInfoTableView(QTableView* view, InfoTableModel* model);
+
+#endif // INFO_TABLE_MODEL_H
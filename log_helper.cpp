@@ -0,0 +1,344 @@
+#include "log_helper.h"
+
+#ifdef LSV_ENABLE_DEBUG_LOGGER
+
+#include <QByteArray>
+#include <QDir>
+#include <QFile>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+#include <QWaitCondition>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr unsigned RingSize = 4096;     // records, a power of two
+constexpr int TextBytes = 216;          // UTF-8 bytes per record
+constexpr int MaxParts = 16;            // records one message may take
+constexpr int FlushIntervalMs = 25;
+
+struct Record {
+    std::atomic<unsigned> sequence{0};
+    qint64 timeNs = 0;                  // CLOCK_REALTIME
+    int threadId = 0;
+    LogLevel level = LogLevel::Info;
+    const char* category = nullptr;
+    int length = 0;
+    bool continuation = false;          // carries on the previous record's text
+    bool more = false;                  // the next record carries on this one
+    char text[TextBytes];
+};
+
+// Bounded multi-producer/single-consumer ring. A producer claims count
+// consecutive positions with one compare-exchange on the head, fills those
+// records and publishes each by advancing its sequence; the writer
+// consumes the records in order and hands them back the same way, so the
+// parts of one message stay together. Nobody ever waits on somebody else:
+// a full ring makes claim() fail.
+class LogRing
+{
+    static_assert((RingSize & (RingSize - 1)) == 0, "ring size must be a power of two");
+
+public:
+    LogRing()
+    {
+        for (unsigned i = 0; i < RingSize; ++i) m_records[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    // The writer hands records back in order, so when the last of the
+    // count positions is free the ones before it are too.
+    bool claim(unsigned count, unsigned* position)
+    {
+        unsigned pos = m_head.load(std::memory_order_relaxed);
+        for (;;) {
+            const unsigned last = pos + count - 1;
+            const int lag = int(m_records[last % RingSize].sequence.load(std::memory_order_acquire) - last);
+            if (lag == 0) {
+                if (m_head.compare_exchange_weak(pos, pos + count, std::memory_order_relaxed)) {
+                    *position = pos;
+                    return true;
+                }
+            } else if (lag < 0) {
+                return false;       // the writer has not consumed these yet
+            } else {
+                pos = m_head.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    Record* at(unsigned position) { return &m_records[position % RingSize]; }
+
+    void publish(Record* record, unsigned position)
+    {
+        record->sequence.store(position + 1, std::memory_order_release);
+    }
+
+    // Writer side.
+    Record* peek()
+    {
+        Record& record = m_records[m_tail % RingSize];
+        return record.sequence.load(std::memory_order_acquire) == m_tail + 1 ? &record : nullptr;
+    }
+
+    void release()
+    {
+        m_records[m_tail % RingSize].sequence.store(m_tail + RingSize, std::memory_order_release);
+        ++m_tail;
+    }
+
+private:
+    Record m_records[RingSize];
+    alignas(64) std::atomic<unsigned> m_head{0};
+    alignas(64) unsigned m_tail = 0;
+};
+
+// Length of text in UTF-8.
+qsizetype utf8Length(const QString& text)
+{
+    qsizetype n = 0;
+    const QChar* p = text.constData();
+    const QChar* end = p + text.size();
+    for (; p < end; ++p) {
+        const char16_t c = p->unicode();
+        if (QChar::isHighSurrogate(c) && p + 1 < end && p[1].isLowSurrogate()) {
+            n += 4;
+            ++p;
+        } else {
+            n += c < 0x80 ? 1 : c < 0x800 ? 2 : 3;
+        }
+    }
+    return n;
+}
+
+// UTF-16 from *from on to UTF-8 straight into the record, cut at a
+// character boundary when it does not fit; *from moves past what was
+// encoded. No allocation.
+int encodeUtf8(const QString& text, qsizetype* from, char* out, int capacity)
+{
+    int n = 0;
+    const QChar* p = text.constData() + *from;
+    const QChar* end = text.constData() + text.size();
+    while (p < end) {
+        char32_t c = p->unicode();
+        ++p;
+        if (QChar::isHighSurrogate(c) && p < end && p->isLowSurrogate()) {
+            c = QChar::surrogateToUcs4(char16_t(c), p->unicode());
+            ++p;
+        }
+        const int bytes = c < 0x80 ? 1 : c < 0x800 ? 2 : c < 0x10000 ? 3 : 4;
+        if (n + bytes > capacity) {
+            p -= c < 0x10000 ? 1 : 2;
+            break;
+        }
+        switch (bytes) {
+        case 1:
+            out[n++] = char(c);
+            break;
+        case 2:
+            out[n++] = char(0xc0 | (c >> 6));
+            out[n++] = char(0x80 | (c & 0x3f));
+            break;
+        case 3:
+            out[n++] = char(0xe0 | (c >> 12));
+            out[n++] = char(0x80 | ((c >> 6) & 0x3f));
+            out[n++] = char(0x80 | (c & 0x3f));
+            break;
+        default:
+            out[n++] = char(0xf0 | (c >> 18));
+            out[n++] = char(0x80 | ((c >> 12) & 0x3f));
+            out[n++] = char(0x80 | ((c >> 6) & 0x3f));
+            out[n++] = char(0x80 | (c & 0x3f));
+            break;
+        }
+    }
+    *from = p - text.constData();
+    return n;
+}
+
+const char* levelName(LogLevel level)
+{
+    switch (level) {
+    case LogLevel::Debug: return "DEBUG";
+    case LogLevel::Info: return "INFO";
+    case LogLevel::Warning: return "WARN";
+    case LogLevel::Error: return "ERROR";
+    }
+    return "LOG";
+}
+
+// Drains the ring into lsv-debug.log every FlushIntervalMs, one write per
+// batch.
+class LogWriter : public QThread
+{
+public:
+    LogRing ring;
+    std::atomic<quint64> dropped{0};
+    std::atomic<quint64> truncated{0};
+
+    LogWriter()
+    {
+        const QString path = QDir::tempPath() + QDir::separator() + "lsv-debug.log";
+        m_file = std::fopen(QFile::encodeName(path).constData(), "w");
+        start(QThread::LowPriority);
+    }
+
+    ~LogWriter() override
+    {
+        {
+            QMutexLocker lock(&m_mutex);
+            m_stop = true;
+            m_wake.wakeAll();
+        }
+        wait();
+        drain();
+        if (m_file) std::fclose(m_file);
+    }
+
+    void drain()
+    {
+        QMutexLocker lock(&m_drainMutex);
+        if (!m_file) {
+            while (ring.peek()) ring.release();
+            return;
+        }
+        m_batch.clear();
+        char line[128];
+        while (Record* record = ring.peek()) {
+            if (record->continuation) {
+                m_batch.append(record->text, record->length);
+                if (!record->more) m_batch.append('\n');
+                m_midMessage = record->more;
+                ring.release();
+                continue;
+            }
+            const time_t seconds = time_t(record->timeNs / 1000000000);
+            struct tm local;
+            localtime_r(&seconds, &local);
+            char stamp[32];
+            std::strftime(stamp, sizeof(stamp), "%Y-%m-%dT%H:%M:%S", &local);
+            const int n = std::snprintf(line, sizeof(line), "%s.%03d %d %s %s: ", stamp,
+                                        int((record->timeNs / 1000000) % 1000), record->threadId,
+                                        levelName(record->level), record->category ? record->category : "lsv");
+            m_batch.append(line, qMin(n, int(sizeof(line)) - 1));
+            m_batch.append(record->text, record->length);
+            if (!record->more) m_batch.append('\n');
+            m_midMessage = record->more;
+            ring.release();
+        }
+        // Between two parts of a message, nothing else may be written.
+        if (!m_midMessage) {
+            const quint64 lost = dropped.exchange(0, std::memory_order_relaxed);
+            if (lost > 0) m_batch.append(QByteArray("(log ring full, ") + QByteArray::number(lost) + " messages dropped)\n");
+            const quint64 cut = truncated.exchange(0, std::memory_order_relaxed);
+            if (cut > 0) {
+                m_batch.append(QByteArray("(") + QByteArray::number(cut) + " messages cut at "
+                               + QByteArray::number(MaxParts * (TextBytes - 3)) + " bytes)\n");
+            }
+        }
+        if (!m_batch.isEmpty()) {
+            std::fwrite(m_batch.constData(), 1, size_t(m_batch.size()), m_file);
+            std::fflush(m_file);
+        }
+    }
+
+protected:
+    void run() override
+    {
+        for (;;) {
+            drain();
+            QMutexLocker lock(&m_mutex);
+            if (m_stop) return;
+            m_wake.wait(&m_mutex, FlushIntervalMs);
+            if (m_stop) return;
+        }
+    }
+
+private:
+    std::FILE* m_file = nullptr;
+    QByteArray m_batch;
+    bool m_midMessage = false;  // the last record written has more parts to come
+    QMutex m_drainMutex;    // one consumer at a time (writer or flush)
+    QMutex m_mutex;
+    QWaitCondition m_wake;
+    bool m_stop = false;
+};
+
+LogWriter& writer()
+{
+    static LogWriter instance;
+    return instance;
+}
+
+int currentThreadId()
+{
+    thread_local int id = int(::syscall(SYS_gettid));
+    return id;
+}
+
+} // namespace
+
+bool lsvLogEnabled()
+{
+    // Enable runtime logging by setting the environment variable LSV_DEBUG=1.
+    static const bool enabled = [] {
+        const char* env = std::getenv("LSV_DEBUG");
+        return env && (std::strcmp(env, "1") == 0 || std::strcmp(env, "true") == 0);
+    }();
+    return enabled;
+}
+
+void lsvLog(LogLevel level, const char* category, const QString& message)
+{
+    if (!lsvLogEnabled()) return;
+    LogWriter& w = writer();
+    // A long message (a command line, a stderr dump) takes consecutive
+    // records; past MaxParts of them it is cut and ends in "…".
+    static const char Ellipsis[] = "\xe2\x80\xa6";
+    const qsizetype bytes = utf8Length(message);
+    // A record cut at a character boundary still holds TextBytes - 3.
+    const qsizetype partBytes = TextBytes - 3;
+    const bool cut = bytes > MaxParts * partBytes;
+    const unsigned parts = cut ? MaxParts : unsigned(qMax<qsizetype>(1, (bytes + partBytes - 1) / partBytes));
+    unsigned position = 0;
+    if (!w.ring.claim(parts, &position)) {
+        w.dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    if (cut) w.truncated.fetch_add(1, std::memory_order_relaxed);
+    timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    const qint64 timeNs = qint64(now.tv_sec) * 1000000000 + now.tv_nsec;
+    const int threadId = currentThreadId();
+    qsizetype from = 0;
+    for (unsigned part = 0; part < parts; ++part) {
+        Record* record = w.ring.at(position + part);
+        const bool last = part + 1 == parts;
+        record->timeNs = timeNs;
+        record->threadId = threadId;
+        record->level = level;
+        record->category = category;
+        record->continuation = part > 0;
+        record->more = !last;
+        const int capacity = last && cut ? TextBytes - 3 : TextBytes;
+        record->length = encodeUtf8(message, &from, record->text, capacity);
+        if (last && cut) {
+            std::memcpy(record->text + record->length, Ellipsis, 3);
+            record->length += 3;
+        }
+        w.ring.publish(record, position + part);
+    }
+}
+
+void lsvLogFlush()
+{
+    if (lsvLogEnabled()) writer().drain();
+}
+
+#endif // LSV_ENABLE_DEBUG_LOGGER
@@ -1,57 +1,67 @@
 #ifndef LOG_HELPER_H
 #define LOG_HELPER_H
 
+#include <QString>
+
 // The debug logger is optional and can be compiled out using the
 // CMake option -DLSV_ENABLE_DEBUG_LOGGER=ON. When compiled out, appendLog
 // is a no-op and will not create any files or have side-effects.
-#ifdef LSV_ENABLE_DEBUG_LOGGER
+//
+// When compiled in and enabled at runtime (LSV_DEBUG=1), a call formats
+// one record into a bounded lock-free ring (log_helper.cpp) and returns; a
+// background thread writes the records to lsv-debug.log in the temp
+// directory in batches. Callers never open files or wait for the disk, and
+// when the ring is full the record is dropped rather than blocking. Each
+// record carries its time, thread id, level and category, and up to 216
+// bytes of UTF-8 text; a longer message takes consecutive records, up to
+// 16 (about 3.4 KB). Longer still, it is cut, ends in "…", and the log
+// says how many messages were cut.
+//
+// LSV_LOG_DEBUG() and friends take a category (a string literal) and a
+// message. Levels below LSV_LOG_LEVEL (CMake option, 0 = debug .. 3 =
+// error) are removed at compile time, message formatting included.
+// appendLog(msg) logs at info level in the "lsv" category.
 
-#include <QFile>
-#include <QTextStream>
-#include <QDateTime>
-#include <QDebug>
-#include <QDir>
-#include <QString>
-#include <cstdlib>
-#include <cstring>
+enum class LogLevel { Debug = 0, Info = 1, Warning = 2, Error = 3 };
 
-inline void appendLog(const QString& msg)
-{
-    // Enable runtime logging by setting the environment variable LSV_DEBUG=1.
-    const char* env = std::getenv("LSV_DEBUG");
-    static const bool enabled = (env && (std::strcmp(env, "1") == 0 || std::strcmp(env, "true") == 0));
-    if (!enabled) {
-        return; // no-op when debugging is not explicitly enabled
-    }
-
-    // When enabled, write to the system temp directory to avoid creating
-    // persistent files inside AppImage or user folders.
-    static bool firstCall = true;
-    QString tmp = QDir::tempPath() + QDir::separator() + "lsv-debug.log";
-    QFile f(tmp);
-    if (firstCall) {
-        if (f.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
-            QTextStream out(&f);
-            out << QDateTime::currentDateTime().toString(Qt::ISODate) << " " << msg << "\n";
-            f.close();
-        }
-        firstCall = false;
-    } else {
-        if (f.open(QIODevice::Append | QIODevice::Text)) {
-            QTextStream out(&f);
-            out << QDateTime::currentDateTime().toString(Qt::ISODate) << " " << msg << "\n";
-            f.close();
-        }
-    }
+#ifndef LSV_LOG_LEVEL
+#define LSV_LOG_LEVEL 0
+#endif
 
-}
+#ifdef LSV_ENABLE_DEBUG_LOGGER
+
+// category must outlive the process (a string literal).
+void lsvLog(LogLevel level, const char* category, const QString& message);
+// True when LSV_DEBUG asks for logging; checked once.
+bool lsvLogEnabled();
+// Write out everything logged so far (before abort(), for instance).
+void lsvLogFlush();
+
+#define LSV_LOG(level, category, message)                                            \
+    do {                                                                             \
+        if constexpr (int(level) >= LSV_LOG_LEVEL) {                                 \
+            if (lsvLogEnabled()) lsvLog(level, category, message);                   \
+        }                                                                            \
+    } while (0)
 
 #else
 
-// Logging compiled out: no-op implementation
-#include <QString>
-inline void appendLog(const QString& /*msg*/) { }
+inline void lsvLog(LogLevel, const char*, const QString&) { }
+inline bool lsvLogEnabled() { return false; }
+inline void lsvLogFlush() { }
+
+#define LSV_LOG(level, category, message) do { } while (0)
 
 #endif // LSV_ENABLE_DEBUG_LOGGER
 
+#define LSV_LOG_DEBUG(category, message) LSV_LOG(LogLevel::Debug, category, message)
+#define LSV_LOG_INFO(category, message) LSV_LOG(LogLevel::Info, category, message)
+#define LSV_LOG_WARNING(category, message) LSV_LOG(LogLevel::Warning, category, message)
+#define LSV_LOG_ERROR(category, message) LSV_LOG(LogLevel::Error, category, message)
+
+inline void appendLog(const QString& msg)
+{
+    LSV_LOG_INFO("lsv", msg);
+}
+
 #endif // LOG_HELPER_H
@@ -0,0 +1,284 @@
+#include "lshw_probe.h"
+#include "log_helper.h"
+#include "snapshot_cache.h"
+#include <QCoreApplication>
+#include <QXmlStreamReader>
+#include <QElapsedTimer>
+
+namespace {
+
+// A full lshw scan walks PCI, DMI, SCSI and USB; on large servers that can
+// take well over the default collector deadline.
+constexpr int LshwDeadlineMs = 120000;
+const char* const CacheKey = "lshw -xml";
+
+// Same unit formatting lshw uses for sizes in its short listing ("16GiB").
+QString formatSize(qint64 bytes)
+{
+    static const char* units[] = { "B", "KiB", "MiB", "GiB", "TiB", "PiB" };
+    int unit = 0;
+    while (bytes >= 1024 && unit < 5) {
+        bytes /= 1024;
+        ++unit;
+    }
+    return QString::number(bytes) + units[unit];
+}
+
+} // namespace
+
+LshwProbe* LshwProbe::instance()
+{
+    static LshwProbe* probe = new LshwProbe(QCoreApplication::instance());
+    return probe;
+}
+
+LshwProbe::LshwProbe(QObject* parent)
+    : QObject(parent)
+{
+}
+
+void LshwProbe::request(QObject* receiver, std::function<void()> ready, CollectorEngine::Priority priority)
+{
+    if (!m_ready && m_generation == 0 && m_ticket == 0 && loadFromCache()) {
+        // Painted from the previous run; check it against a real probe
+        // without holding anybody up.
+        startProbe(CollectorEngine::Background);
+    }
+    if (m_ready) {
+        ready();
+        return;
+    }
+    m_waiters.append(Waiter{QPointer<QObject>(receiver), std::move(ready)});
+    if (m_ticket == 0) {
+        startProbe(priority);
+    } else {
+        promote(priority);
+    }
+}
+
+void LshwProbe::refresh()
+{
+    if (m_ticket != 0) return; // a probe is already on its way
+    // Keep the old tree around until the new one is parsed; callers that ask
+    // in the meantime are queued until then.
+    m_ready = false;
+    startProbe(CollectorEngine::Normal);
+}
+
+void LshwProbe::promote(CollectorEngine::Priority priority)
+{
+    if (m_ticket != 0) CollectorEngine::instance()->promote(this, priority);
+}
+
+bool LshwProbe::adopt(const QByteArray& xml)
+{
+    QVector<LshwNode> nodes;
+    if (!parseXml(xml, nodes)) return false;
+    const bool unchanged = xml == m_sourceXml;
+    if (!unchanged) {
+        installTree(std::move(nodes), xml);
+        ++m_generation;
+    }
+    SnapshotCache::instance()->store(CacheKey, xml);
+    m_ready = true;
+    appendLog(QString("LshwProbe: adopted %1 nodes from the agent").arg(m_nodes.size()));
+
+    const QList<Waiter> waiters = m_waiters;
+    m_waiters.clear();
+    for (const Waiter& w : waiters) {
+        if (w.receiver && w.ready) w.ready();
+    }
+    if (!unchanged) emit treeUpdated();
+    return true;
+}
+
+void LshwProbe::startProbe(CollectorEngine::Priority priority)
+{
+    appendLog("LshwProbe: starting lshw -xml");
+    m_ticket = CollectorEngine::instance()->submit("lshw", QStringList() << "-xml", this,
+        [this](const CollectorResult& result) { onProbeFinished(result); }, priority, LshwDeadlineMs);
+}
+
+bool LshwProbe::loadFromCache()
+{
+    QByteArray xml;
+    if (!SnapshotCache::instance()->lookup(CacheKey, &xml)) return false;
+
+    QElapsedTimer parseClock;
+    parseClock.start();
+    QVector<LshwNode> nodes;
+    if (!parseXml(xml, nodes)) {
+        SnapshotCache::instance()->remove(CacheKey);
+        return false;
+    }
+    installTree(std::move(nodes), xml);
+    m_ready = true;
+    ++m_generation;
+    appendLog(QString("LshwProbe: %1 nodes served from snapshot cache, parsed in %2 ms")
+                  .arg(m_nodes.size()).arg(parseClock.elapsed()));
+    return true;
+}
+
+void LshwProbe::installTree(QVector<LshwNode> nodes, const QByteArray& xml)
+{
+    m_nodes = std::move(nodes);
+    m_sourceXml = xml;
+    m_byClass.clear();
+    for (int i = 0; i < m_nodes.size(); ++i) {
+        m_byClass[m_nodes[i].className].append(i);
+    }
+}
+
+void LshwProbe::onProbeFinished(const CollectorResult& result)
+{
+    m_ticket = 0;
+
+    // Identical output: the tree we have is still right. Waiters (after a
+    // refresh) are served from it, nobody else needs to hear about it.
+    const bool unchanged = !m_sourceXml.isEmpty() && result.standardOutput == m_sourceXml;
+    if (unchanged) {
+        appendLog(QString("LshwProbe: lshw finished in %1 ms, tree unchanged").arg(result.elapsedMs));
+        SnapshotCache::instance()->store(CacheKey, result.standardOutput);
+    } else {
+        QElapsedTimer parseClock;
+        parseClock.start();
+        QVector<LshwNode> nodes;
+        if (!result.failedToStart && !result.standardOutput.isEmpty()) {
+            parseXml(result.standardOutput, nodes);
+        }
+        appendLog(QString("LshwProbe: lshw finished in %1 ms (exit %2), %3 nodes parsed in %4 ms")
+                      .arg(result.elapsedMs).arg(result.exitCode).arg(nodes.size()).arg(parseClock.elapsed()));
+
+        // A failed probe still counts as done: tabs then show "Not detected"
+        // instead of waiting forever, which matches the old per-tab behaviour
+        // when lshw was missing. An earlier good tree is kept, though.
+        if (!nodes.isEmpty()) {
+            if (result.exitCode == 0 && !result.timedOut) {
+                SnapshotCache::instance()->store(CacheKey, result.standardOutput);
+            }
+            installTree(std::move(nodes), result.standardOutput);
+        } else if (m_nodes.isEmpty()) {
+            installTree(QVector<LshwNode>(), QByteArray());
+        }
+        ++m_generation;
+    }
+    m_ready = true;
+
+    const QList<Waiter> waiters = m_waiters;
+    m_waiters.clear();
+    for (const Waiter& w : waiters) {
+        if (w.receiver && w.ready) w.ready();
+    }
+    if (!unchanged) emit treeUpdated();
+}
+
+QList<const LshwNode*> LshwProbe::nodesOfClass(const QString& className) const
+{
+    QList<const LshwNode*> result;
+    const QVector<int> indices = m_byClass.value(className);
+    for (int i : indices) result.append(&m_nodes[i]);
+    return result;
+}
+
+QString LshwProbe::shortDescription(const LshwNode& node) const
+{
+    if (!node.product.isEmpty()) return node.product;
+    if (node.size > 0 && node.className == "memory") {
+        return formatSize(node.size) + " " + node.description;
+    }
+    return node.description;
+}
+
+QString LshwProbe::shortListing(const QString& className) const
+{
+    struct Row { QString path, device, cls, description; };
+    QVector<Row> rows;
+    rows.reserve(m_nodes.size());
+
+    int pathWidth = 8, deviceWidth = 6, classWidth = 5; // header widths
+    for (const LshwNode& node : m_nodes) {
+        if (!className.isEmpty() && node.className != className) continue;
+        Row row{node.hwPath, node.logicalNames.value(0), node.className, shortDescription(node)};
+        pathWidth = qMax(pathWidth, int(row.path.size()));
+        deviceWidth = qMax(deviceWidth, int(row.device.size()));
+        classWidth = qMax(classWidth, int(row.cls.size()));
+        rows.append(row);
+    }
+
+    auto line = [&](const QString& a, const QString& b, const QString& c, const QString& d) {
+        return a.leftJustified(pathWidth + 2) + b.leftJustified(deviceWidth + 2)
+             + c.leftJustified(classWidth + 2) + d + "\n";
+    };
+
+    QString out = line("H/W path", "Device", "Class", "Description");
+    out += QString(pathWidth + deviceWidth + classWidth + 6 + 11, '=') + "\n";
+    for (const Row& row : rows) {
+        out += line(row.path, row.device, row.cls, row.description);
+    }
+    return out;
+}
+
+bool LshwProbe::parseXml(const QByteArray& xml, QVector<LshwNode>& out)
+{
+    out.clear();
+    QXmlStreamReader reader(xml);
+    QVector<int> open; // indices of the <node> elements we are inside
+
+    while (!reader.atEnd()) {
+        const QXmlStreamReader::TokenType token = reader.readNext();
+        if (token == QXmlStreamReader::EndElement) {
+            if (reader.name() == QLatin1String("node") && !open.isEmpty()) open.removeLast();
+            continue;
+        }
+        if (token != QXmlStreamReader::StartElement) continue;
+
+        const QStringView name = reader.name();
+        if (name == QLatin1String("node")) {
+            LshwNode node;
+            const QXmlStreamAttributes attrs = reader.attributes();
+            node.id = attrs.value("id").toString();
+            node.className = attrs.value("class").toString();
+            node.parent = open.isEmpty() ? -1 : open.last();
+            const int index = out.size();
+            out.append(node);
+            if (node.parent >= 0) out[node.parent].children.append(index);
+            open.append(index);
+            continue;
+        }
+        if (open.isEmpty()) continue;
+
+        LshwNode& node = out[open.last()];
+        if (name == QLatin1String("setting")) {
+            const QXmlStreamAttributes attrs = reader.attributes();
+            node.config.insert(attrs.value("id").toString(), attrs.value("value").toString());
+        } else if (name == QLatin1String("description")) {
+            node.description = reader.readElementText();
+        } else if (name == QLatin1String("product")) {
+            node.product = reader.readElementText();
+        } else if (name == QLatin1String("vendor")) {
+            node.vendor = reader.readElementText();
+        } else if (name == QLatin1String("physid")) {
+            node.physid = reader.readElementText();
+        } else if (name == QLatin1String("businfo")) {
+            node.businfo = reader.readElementText();
+        } else if (name == QLatin1String("logicalname")) {
+            node.logicalNames.append(reader.readElementText());
+        } else if (name == QLatin1String("size")) {
+            node.size = reader.readElementText().toLongLong();
+        }
+    }
+
+    if (reader.hasError()) {
+        appendLog(QString("LshwProbe: XML error at line %1: %2").arg(reader.lineNumber()).arg(reader.errorString()));
+    }
+
+    // Nodes are stored parent first, so paths can be built in one pass. The
+    // root has no path in `lshw -short`; nodes without a physid share their
+    // parent's path.
+    for (LshwNode& node : out) {
+        if (node.parent < 0) continue;
+        const QString& parentPath = out[node.parent].hwPath;
+        node.hwPath = node.physid.isEmpty() ? parentPath : parentPath + "/" + node.physid;
+    }
+    return !out.isEmpty();
+}
@@ -0,0 +1,102 @@
+#ifndef LSHW_PROBE_H
+#define LSHW_PROBE_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QByteArray>
+#include <QHash>
+#include <QVector>
+#include <QList>
+#include <QPointer>
+#include <functional>
+#include "collector_engine.h"
+
+// One device node of the lshw tree. Nodes are stored flat in a vector and
+// refer to each other by index, parent first.
+struct LshwNode {
+    QString id;
+    QString className;          // "system", "bus", "display", "multimedia", ...
+    QString description;
+    QString product;
+    QString vendor;
+    QString physid;
+    QString businfo;
+    QString hwPath;             // "/0/100/1f.3", as printed by `lshw -short`
+    QStringList logicalNames;
+    QHash<QString, QString> config; // <configuration><setting id= value=/>
+    qint64 size = -1;               // bytes, when lshw reports one
+    int parent = -1;
+    QVector<int> children;
+};
+
+// Runs `lshw -xml` once per session through the CollectorEngine and keeps the
+// parsed device tree in memory. Tabs that used to start their own
+// `lshw -short` / `lshw -C <class>` read class-filtered views from here
+// instead. The tree is only re-probed when refresh() is called.
+//
+// The raw XML is kept in the SnapshotCache, so on startup the tree is served
+// from the previous run at once and revalidated in the background;
+// treeUpdated() only fires if the new probe differs.
+class LshwProbe : public QObject
+{
+    Q_OBJECT
+
+public:
+    static LshwProbe* instance();
+
+    // Run ready() once the tree is available; immediately if it already is.
+    // The callback is dropped if receiver is destroyed first.
+    void request(QObject* receiver, std::function<void()> ready,
+                 CollectorEngine::Priority priority = CollectorEngine::Normal);
+    // Throw the current tree away and probe again.
+    void refresh();
+    // Raise the priority of a probe that is still queued.
+    void promote(CollectorEngine::Priority priority);
+    // Install a tree probed elsewhere (lsv-agentd) from its `lshw -xml`
+    // output, as if our own probe had produced it. Returns false if the
+    // XML does not parse; the current tree is kept then.
+    bool adopt(const QByteArray& xml);
+
+    bool isReady() const { return m_ready; }
+    bool isProbing() const { return m_ticket != 0; }
+    // Bumped every time a new tree has been parsed.
+    int generation() const { return m_generation; }
+
+    const QVector<LshwNode>& nodes() const { return m_nodes; }
+    QList<const LshwNode*> nodesOfClass(const QString& className) const;
+
+    // Render the tree (or only nodes of className) in the column layout of
+    // `lshw -short` / `lshw -C <class> -short`.
+    QString shortListing(const QString& className = QString()) const;
+
+    // Streaming parse of `lshw -xml` output into a flat node list.
+    static bool parseXml(const QByteArray& xml, QVector<LshwNode>& out);
+
+signals:
+    void treeUpdated();
+
+private:
+    explicit LshwProbe(QObject* parent = nullptr);
+
+    struct Waiter {
+        QPointer<QObject> receiver;
+        std::function<void()> ready;
+    };
+
+    bool loadFromCache();
+    void installTree(QVector<LshwNode> nodes, const QByteArray& xml);
+    void startProbe(CollectorEngine::Priority priority);
+    void onProbeFinished(const CollectorResult& result);
+    QString shortDescription(const LshwNode& node) const;
+
+    QVector<LshwNode> m_nodes;
+    QHash<QString, QVector<int>> m_byClass;
+    QByteArray m_sourceXml;             // output the current tree was parsed from
+    QList<Waiter> m_waiters;
+    quint64 m_ticket = 0;
+    bool m_ready = false;
+    int m_generation = 0;
+};
+
+#endif // LSHW_PROBE_H
@@ -29,17 +29,89 @@
 #include "log_helper.h"
 // Central version header (single source of truth for the version string)
 #include "version.h"
+// Headless `--json` mode (no QApplication, no widgets)
+#include "lsv_headless.h"
+// Optional trace-event recording (LSV_TRACE / --trace)
+#include "trace.h"
+// Record/replay of collector inputs (LSV_CAPTURE / LSV_REPLAY)
+#include "capture.h"
+// Title-bar search across all tabs
+#include "search_box.h"
+#include "alerts_panel.h"
+#include "alert_engine.h"
+#include "refresh_scheduler.h"
+// Application-wide style sheet and info sections
+#include "lsv_style.h"
+// Client of the optional lsv-agentd collector agent
+#include "agent_client.h"
+#include "lshw_probe.h"
+#include "snapshot_cache.h"
+#include "snapshot_baseline.h"
+
+// What lsv-agentd already knows: the sampler history, so graphs start
+// filled, and the lshw/dmidecode output, so no tab has to wait for those
+// programs.
+struct AgentPrime {
+    QString error;
+    qint64 agentPid = 0;
+    bool haveHistory = false;
+    TimeSeriesStore::Dump history;
+    QByteArray lshw;
+    QByteArray dmidecode;
+};
+
+// Blocks on the agent socket; runs on a pool thread.
+static AgentPrime fetchAgentPrime()
+{
+    AgentPrime prime;
+    AgentClient client;
+    if (!client.connectToAgent(agent::socketPath(), 250)) {
+        prime.error = client.errorString();
+        return prime;
+    }
+    prime.agentPid = client.agentPid();
+    prime.haveHistory = client.fetchHistory(&prime.history);
+    QByteArray output;
+    if (client.fetchCommand("lshw -xml", false, &output)) prime.lshw = output;
+    if (client.fetchCommand("dmidecode -t memory", false, &output)) prime.dmidecode = output;
+    return prime;
+}
+
+// If lsv-agentd runs, take what it already knows before the tabs ask for
+// it. The agent is asked on a pool thread and the answer applied on the
+// GUI thread, so a slow or hung agent never holds up the window; tabs that
+// ask first collect for themselves as without an agent. LSV_AGENT=0 skips
+// this, and so do capture and replay, which must see this machine's (or
+// the archive's) inputs only.
+static void primeFromAgent()
+{
+    if (qEnvironmentVariable("LSV_AGENT") == "0" || Capture::mode() != Capture::Off) return;
+    QtConcurrent::run(fetchAgentPrime).then(qApp, [](const AgentPrime& prime) {
+        if (!prime.error.isEmpty()) {
+            appendLog("Agent: " + prime.error);
+            return;
+        }
+        if (prime.haveHistory) TimeSeriesStore::instance()->restore(prime.history);
+        if (!prime.lshw.isEmpty()) LshwProbe::instance()->adopt(prime.lshw);
+        if (!prime.dmidecode.isEmpty()) SnapshotCache::instance()->store("dmidecode -t memory", prime.dmidecode);
+        appendLog(QString("Agent: primed from lsv-agentd pid %1").arg(prime.agentPid));
+    });
+}
 
 static bool polkitAgentRunning()
 {
-    // Look for common polkit GUI auth agent process names
-    QProcess p;
-    p.start("ps", QStringList() << "-eo" << "cmd");
-    if (!p.waitForFinished(1000)) return false;
-    QString out = QString::fromLocal8Bit(p.readAllStandardOutput());
-    QStringList agents = {"polkit-gnome-authentication-agent-1", "polkit-mate-authentication-agent-1", "polkit-kde-authentication-agent-1", "polkit-gnome"};
-    for (const QString &a : agents) {
-        if (out.contains(a)) return true;
+    // Look for common polkit GUI auth agent process names in the command
+    // lines under /proc rather than waiting for `ps` on the GUI thread.
+    const QStringList agents = {"polkit-gnome-authentication-agent-1", "polkit-mate-authentication-agent-1", "polkit-kde-authentication-agent-1", "polkit-gnome"};
+    const QStringList pids = QDir("/proc").entryList(QDir::Dirs | QDir::NoDotAndDotDot);
+    for (const QString &pid : pids) {
+        if (!pid.front().isDigit()) continue;
+        QFile cmdline("/proc/" + pid + "/cmdline");
+        if (!cmdline.open(QIODevice::ReadOnly)) continue;
+        const QString cmd = QString::fromLocal8Bit(cmdline.readAll());
+        for (const QString &a : agents) {
+            if (cmd.contains(a)) return true;
+        }
     }
     return false;
 }
@@ -94,17 +166,14 @@ static QPixmap makeBadgePixmap(const QColor &bgColor, int size = 20)
 static void lsvQtMessageHandler(QtMsgType type, const QMessageLogContext &context, const QString &msg)
 {
     Q_UNUSED(context);
-    QString prefix;
     switch (type) {
-        case QtDebugMsg: prefix = "DEBUG: "; break;
-        case QtInfoMsg: prefix = "INFO: "; break;
-        case QtWarningMsg: prefix = "WARNING: "; break;
-        case QtCriticalMsg: prefix = "CRITICAL: "; break;
-        case QtFatalMsg: prefix = "FATAL: "; break;
-        default: prefix = "LOG: "; break;
+        case QtDebugMsg: LSV_LOG_DEBUG("qt", msg); break;
+        case QtInfoMsg: LSV_LOG_INFO("qt", msg); break;
+        case QtWarningMsg: LSV_LOG_WARNING("qt", msg); break;
+        default: LSV_LOG_ERROR("qt", msg); break;
     }
-    appendLog(prefix + msg);
     if (type == QtFatalMsg) {
+        lsvLogFlush();
         abort();
     }
 }
@@ -129,6 +198,7 @@ static void lsvQtMessageHandler(QtMsgType type, const QMessageLogContext &contex
 #include "tabs_config.h"
 #include "pc_tab.h"
 #include "memory_tab.h"
+#include "timeseries_store.h"
 #include "log_helper.h"
 
 // Perform cleanup of temporary files the application may have created.
@@ -329,19 +399,27 @@ public:
 
     void createAllTabs()
     {
+        // Tabs are only registered here. Each one is built (and starts its
+        // commands) when its button is first clicked or when idle prefetch
+        // reaches it, so startup cost does not grow with the number of tabs.
+        TraceSpan span("tabs", "TabManager::createAllTabs");
         for (int i = 0; i < TAB_CONFIGS.size(); ++i) {
             const TabConfig& config = TAB_CONFIGS[i];
-            qDebug() << "TabManager: Creating tab" << i << ":" << config.name;
-            appendLog(QString("TabManager: Creating tab %1 : %2 (command: %3)").arg(QString::number(i), config.name, config.command));
-            
-            QWidget* tabWidget = createTab(config);
-            if (tabWidget) {
-                m_tabWidget->addTab(tabWidget, config.name);
-                qDebug() << "TabManager: Successfully added tab:" << config.name;
-            } else {
-                qDebug() << "TabManager: Failed to create tab:" << config.name;
-            }
+            qDebug() << "TabManager: Registering tab" << i << ":" << config.name;
+            m_tabWidget->addLazyTab(config.name, [this, config, i]() -> QWidget* {
+                appendLog(QString("TabManager: Creating tab %1 : %2 (command: %3)").arg(QString::number(i), config.name, config.command));
+                TraceSpan span("tabs", "TabManager::createTab");
+                span.addArg("tab", config.name);
+                QWidget* tabWidget = createTab(config);
+                if (tabWidget) {
+                    qDebug() << "TabManager: Successfully created tab:" << config.name;
+                } else {
+                    qDebug() << "TabManager: Failed to create tab:" << config.name;
+                }
+                return tabWidget;
+            });
         }
+        m_tabWidget->startIdlePrefetch();
     }
 
     void setTabWidget(MultiRowTabWidget* tabWidget)
@@ -477,6 +555,12 @@ private:
 
 int main(int argc, char *argv[])
 {
+    // `--json` prints a snapshot and exits before any GUI object or
+    // privilege check exists.
+    if (wantsHeadless(argc, argv)) {
+        return runHeadless(argc, argv);
+    }
+
     QApplication app(argc, argv);
     // Central version constant
 #include "version.h"
@@ -490,17 +574,28 @@ int main(int argc, char *argv[])
     QIcon appIcon(":/lsv.png");
     app.setWindowIcon(appIcon);
 
+    // One style sheet for all tabs (lsv_style.h), parsed once here.
+    applyLsvStyle(&app);
+
     // Install Qt message handler so all qDebug/qWarning/etc go to the
     // appendLog file instead of printing to the console.
     qInstallMessageHandler(lsvQtMessageHandler);
 
     qDebug() << "Application starting..."; // will be routed to appendLog
+
+    // Resolved before elevation so the root instance writes the same file.
+    const QString tracePath = Trace::requestedPath(app.arguments());
+    const QString baselinePath = SnapshotBaseline::requestedPath(app.arguments());
+    const RefreshScheduler::Profile refreshProfile = RefreshScheduler::requestedProfile(app.arguments());
+    // Record or replay collector inputs (LSV_CAPTURE / LSV_REPLAY).
+    Capture::startFromArguments(app.arguments());
     appendLog(QString("Application starting. CWD: %1, log-file: %2").arg(QDir::currentPath(), QDir::currentPath()+"/lsv-cli.log"));
 
     // Auto-elevation: always relaunch via a terminal sudo prompt and exit the
     // unprivileged instance. This ensures the user always authenticates in a
     // terminal window with a clear custom message and the GUI runs as root.
-    if (geteuid() != 0 && qgetenv("LSV_ELEVATED").isEmpty()) {
+    // A replay only reads the archive, so it never needs root.
+    if (geteuid() != 0 && qgetenv("LSV_ELEVATED").isEmpty() && !Capture::isReplaying()) {
         // Cleanup old temp files to avoid clutter.
         QDir tmpDir(QDir::tempPath());
         QDateTime now = QDateTime::currentDateTime();
@@ -571,9 +666,20 @@ int main(int argc, char *argv[])
         // Build the sudo command that authenticates and then starts the GUI
         // as a detached process so the terminal can close after auth.
         QString sudoPrompt = "Please enter password to run Linux System Viewer as root";
-        QString escTarget = targetExe;
-        escTarget.replace('\'', "'" "'" "'");
-        QString inner = QString("setsid '%1' > /dev/null 2>&1 &").arg(escTarget);
+        // sudo drops the environment, so LSV_TRACE, LSV_CAPTURE,
+        // LSV_BASELINE and LSV_PROFILE travel as --trace, --capture,
+        // --baseline and --profile.
+        QStringList relaunchArgs;
+        if (refreshProfile != RefreshScheduler::Normal) relaunchArgs << "--profile=" + RefreshScheduler::profileName(refreshProfile);
+        if (!tracePath.isEmpty()) relaunchArgs << "--trace=" + tracePath;
+        if (!baselinePath.isEmpty()) relaunchArgs << "--baseline=" + baselinePath;
+        if (Capture::isRecording()) relaunchArgs << "--capture=" + Capture::directory();
+        // Every word is single-quoted for the inner `sh -c`, so paths may
+        // hold any character.
+        auto shellQuote = [](QString word) { return "'" + word.replace('\'', "'\\''") + "'"; };
+        QString inner = "setsid " + shellQuote(targetExe);
+        for (const QString& arg : relaunchArgs) inner += " " + shellQuote(arg);
+        inner += " > /dev/null 2>&1 &";
         // Create a temporary wrapper script to run sudo. This reduces quoting
         // issues when passing complex commands to terminal emulators.
         QString wrapperPath = QDir::tempPath() + QDir::separator() + QString("lsv-sudo-%1.sh").arg(getpid());
@@ -595,8 +701,12 @@ int main(int argc, char *argv[])
             ts << "  printf '%s: ' '" << promptEsc << "'\n";
             ts << "  read -s PASS\n";
             ts << "  echo\n";
+            // inner goes inside a double-quoted string, where \, $, ` and "
+            // are still special; escaped, the outer shell passes it on as is.
             QString innerEsc = inner;
-            innerEsc.replace('"', "\\\"");
+            for (const QChar c : {QChar('\\'), QChar('$'), QChar('`'), QChar('"')}) {
+                innerEsc.replace(c, QString("\\") + c);
+            }
             ts << "  printf '%s\\n' \"$PASS\" | sudo -S -p '' sh -c \"" << innerEsc << "\"\n";
             ts << "  rc=$?\n";
             ts << "  echo 'sudo finished with exitcode:' $rc >> /tmp/lsv-relaunch-" << getpid() << ".log\n";
@@ -639,6 +749,10 @@ int main(int argc, char *argv[])
         return 0;
     }
 
+    if (!tracePath.isEmpty()) {
+        Trace::start(tracePath);
+    }
+
     // Create main window
     CleaningMainWindow mainWindow;
     mainWindow.setWindowTitle(QStringLiteral("Linux System Viewer V. %1").arg(LSVVersionQString()));
@@ -687,13 +801,21 @@ int main(int argc, char *argv[])
         about->activateWindow();
     });
 
+    // Create tab widget
+    MultiRowTabWidget* tabWidget = new MultiRowTabWidget();
+
+    // Search box in the title bar; its hits are listed between the title
+    // and the tabs while a query is typed.
+    SearchBox* searchBox = new SearchBox(tabWidget);
+
     titleLayout->addWidget(titleLabel);
     titleLayout->addStretch();
+    titleLayout->addWidget(searchBox);
     titleLayout->addWidget(aboutBtn);
     mainLayout->addLayout(titleLayout);
-
-    // Create tab widget
-    MultiRowTabWidget* tabWidget = new MultiRowTabWidget();
+    mainLayout->addWidget(searchBox->resultsView());
+    // Alerts firing now; hidden while there are none.
+    mainLayout->addWidget(new AlertsPanel());
     mainLayout->addWidget(tabWidget);
 
     // Install global Ctrl+W / close handler so Ctrl+W shows a quit dialog
@@ -717,13 +839,26 @@ int main(int argc, char *argv[])
 
     // Show main window first so the UI appears even if tab construction takes time.
     mainWindow.show();
+
+    // Sampler rates for the profile; a minimised window shows nothing live.
+    RefreshScheduler::instance()->setProfile(refreshProfile);
+    RefreshScheduler::instance()->watchWindow(&mainWindow);
+    // Keep a bounded history of the sampled values from the start, so tabs
+    // can show more than the current second.
+    TimeSeriesStore::instance()->startRecording();
+    // Threshold rules on the same samples (alerts.json or the defaults).
+    AlertEngine::instance()->setDesktopNotifications(true);
+    AlertEngine::instance()->start();
+    primeFromAgent();
+    // Compare with an earlier `lsv --json` document; tabs mark what changed.
+    if (!baselinePath.isEmpty()) SnapshotBaseline::instance()->start(baselinePath);
     qDebug() << "Application window shown, scheduling tab creation...";
 
-    // Defer heavy tab creation to the event loop so the window can render immediately.
+    // Defer tab registration to the event loop so the window can render immediately.
     QTimer::singleShot(0, [&tabManager]() {
-        qDebug() << "Creating tabs...";
+        qDebug() << "Registering tabs...";
         tabManager.createAllTabs();
-        qDebug() << "All tabs created successfully";
+        qDebug() << "All tabs registered";
     });
 
     qDebug() << "Entering event loop...";
@@ -0,0 +1,103 @@
+// lsv-agentd: runs the LSV collectors in the background and serves their
+// results to `lsv` and `lsv --json --agent` over a local socket (see
+// agent_server.h and agent_protocol.h). Linked against Qt Core and Network
+// only, so it can run on machines without a display.
+#include "agent_protocol.h"
+#include "alert_engine.h"
+#include "agent_server.h"
+#include "log_helper.h"
+#include "metrics_exporter.h"
+#include "timeseries_store.h"
+#include "version.h"
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <cstdio>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace {
+
+// The agent should never compete with what the user is doing: lowest CPU
+// share we can take without privileges, and the idle I/O class so lshw
+// and friends only touch the disks when nobody else does.
+void lowerPriority()
+{
+    if (setpriority(PRIO_PROCESS, 0, 10) != 0) appendLog("lsv-agentd: setpriority failed");
+#ifdef SYS_ioprio_set
+    const int IoprioWhoProcess = 1;
+    const int IoprioClassIdle = 3;
+    const int IoprioClassShift = 13;
+    if (syscall(SYS_ioprio_set, IoprioWhoProcess, 0, IoprioClassIdle << IoprioClassShift) != 0) {
+        appendLog("lsv-agentd: ioprio_set failed");
+    }
+#endif
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+    app.setApplicationName("lsv-agentd");
+    app.setApplicationVersion(LSVVersionQString());
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Linux System Viewer - collector agent");
+    parser.addHelpOption();
+    parser.addVersionOption();
+    QCommandLineOption socketOption("socket", "Socket path (default: " + agent::socketPath() + ").", "path");
+    parser.addOption(socketOption);
+    QCommandLineOption sharedOption("shared", "Let every local user connect, not only this one.");
+    parser.addOption(sharedOption);
+    QCommandLineOption refreshOption("refresh", "Seconds between recollecting the sections (default: 30).", "seconds", "30");
+    parser.addOption(refreshOption);
+    QCommandLineOption metricsPortOption("metrics-port", "Serve Prometheus metrics on http://127.0.0.1:<port>/metrics.", "port");
+    parser.addOption(metricsPortOption);
+    parser.process(app);
+
+    AgentServer::Options options;
+    options.socketPath = parser.isSet(socketOption) ? parser.value(socketOption) : agent::socketPath();
+    options.shared = parser.isSet(sharedOption);
+    bool ok = false;
+    options.refreshSeconds = parser.value(refreshOption).toInt(&ok);
+    if (!ok || options.refreshSeconds <= 0) {
+        std::fprintf(stderr, "lsv-agentd: --refresh needs a positive number of seconds\n");
+        return 2;
+    }
+    quint16 metricsPort = 0;
+    if (parser.isSet(metricsPortOption)) {
+        const uint port = parser.value(metricsPortOption).toUInt(&ok);
+        if (!ok || port == 0 || port > 65535) {
+            std::fprintf(stderr, "lsv-agentd: --metrics-port needs a port number\n");
+            return 2;
+        }
+        metricsPort = quint16(port);
+    }
+
+    lowerPriority();
+
+    AgentServer server(options);
+    if (!server.listen()) {
+        std::fprintf(stderr, "lsv-agentd: %s\n", qPrintable(server.errorString()));
+        return 1;
+    }
+    std::fprintf(stderr, "lsv-agentd: listening on %s\n", qPrintable(options.socketPath));
+
+    MetricsExporter metrics;
+    if (metricsPort != 0) {
+        if (!metrics.listen(metricsPort)) {
+            std::fprintf(stderr, "lsv-agentd: %s\n", qPrintable(metrics.errorString()));
+            return 1;
+        }
+        std::fprintf(stderr, "lsv-agentd: metrics on http://127.0.0.1:%u/metrics\n", unsigned(metrics.port()));
+    }
+
+    // Same history the GUI keeps, but from the moment the agent starts.
+    TimeSeriesStore::instance()->startRecording();
+    // There is no desktop to notify, and the debug log is compiled out of
+    // release builds: alerts go to stderr, and so to the journal.
+    AlertEngine::instance()->setStandardError(true);
+    AlertEngine::instance()->start();
+    return app.exec();
+}
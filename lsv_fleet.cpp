@@ -0,0 +1,65 @@
+// lsv-fleet: group-by over the snapshot files of many hosts (written by
+// `lsv --snapshot`), e.g. CPU models or free DIMM slots across a fleet.
+// See fleet_aggregate.h for the fields. Linked against Qt Core only.
+#include "fleet_aggregate.h"
+#include "version.h"
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QJsonDocument>
+#include <cstdio>
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+    app.setApplicationName("lsv-fleet");
+    app.setApplicationVersion(LSVVersionQString());
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Linux System Viewer - fleet aggregation over snapshot files");
+    parser.addHelpOption();
+    parser.addVersionOption();
+    QCommandLineOption groupOption("group-by", "Comma separated fields to group by, e.g. cpu/Model,memory/free_slots.",
+                                   "fields");
+    parser.addOption(groupOption);
+    QCommandLineOption formatOption("format", "csv (default) or json.", "format", "csv");
+    parser.addOption(formatOption);
+    QCommandLineOption jobsOption("jobs", "Worker threads (default: one per core).", "n", "0");
+    parser.addOption(jobsOption);
+    QCommandLineOption groupsOption("max-groups", "Groups printed, most hosts first; the rest are counted as (other) (default: 100000).",
+                                    "n", "100000");
+    parser.addOption(groupsOption);
+    parser.addPositionalArgument("paths", "Snapshot files, or directories searched for *.lsvsnap.", "paths...");
+    parser.process(app);
+
+    FleetQuery query;
+    for (const QString& field : parser.value(groupOption).split(',', Qt::SkipEmptyParts)) {
+        query.groupBy.append(field.trimmed());
+    }
+    bool jobsOk = false;
+    bool groupsOk = false;
+    query.jobs = parser.value(jobsOption).toInt(&jobsOk);
+    query.maxGroups = parser.value(groupsOption).toInt(&groupsOk);
+    const QString format = parser.value(formatOption);
+    if (!jobsOk || query.jobs < 0 || !groupsOk || query.maxGroups <= 0 || (format != "csv" && format != "json")) {
+        std::fprintf(stderr, "lsv-fleet: invalid --jobs, --max-groups or --format\n");
+        return 2;
+    }
+    if (parser.positionalArguments().isEmpty()) {
+        std::fprintf(stderr, "lsv-fleet: no snapshot files or directories given\n");
+        return 2;
+    }
+
+    const QStringList files = findSnapshotFiles(parser.positionalArguments());
+    const FleetResult result = aggregateSnapshots(files, query);
+    const QByteArray out = format == "json" ? QJsonDocument(fleetToJson(result, query)).toJson(QJsonDocument::Indented)
+                                            : fleetToCsv(result, query);
+    std::fwrite(out.constData(), 1, size_t(out.size()), stdout);
+
+    for (const QString& error : result.errors) std::fprintf(stderr, "lsv-fleet: %s\n", qPrintable(error));
+    std::fprintf(stderr, "lsv-fleet: %lld files (%lld unreadable), %s%lld configurations, %lld ms%s\n",
+                 static_cast<long long>(result.files), static_cast<long long>(result.failed),
+                 result.estimated ? "about " : "",
+                 static_cast<long long>(result.configurations), static_cast<long long>(result.elapsedMs),
+                 result.folded ? ", groups beyond --max-groups counted as (other)" : "");
+    return result.failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,414 @@
+// Headless JSON mode. Only the Qt Core parts of the collector headers are
+// compiled here, so this file can be linked without Qt Widgets. Qt Network
+// is only needed for the lsv-agentd client.
+#define LSV_CORE_ONLY
+
+#include "lsv_headless.h"
+#include "cpu.h"
+#include "os.h"
+#include "storage.h"
+#include "network.h"
+#include "mainboard.h"
+#include "audio.h"
+#include "memory_modules.h"
+#include "devices.h"
+#include "version.h"
+#include "agent_client.h"
+#include "sampler.h"
+#include "capture.h"
+#include "snapshot_diff.h"
+#include "snapshot_file.h"
+#include "tabs_config.h"
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QDateTime>
+#include <QFile>
+#include <QElapsedTimer>
+#include <QTemporaryDir>
+#include <QThreadPool>
+#include <QVector>
+#include <functional>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+struct HeadlessSection {
+    const char* name;
+    std::function<QJsonValue()> collect;
+};
+
+// Rows become objects keyed by column; empty Unit/Type cells are left out.
+QJsonArray rowsToJson(const InfoRows& rows)
+{
+    static const char* keys[] = { "property", "value", "unit", "type" };
+    QJsonArray array;
+    for (const QStringList& row : rows) {
+        QJsonObject object;
+        for (int col = 0; col < row.size() && col < 4; ++col) {
+            if (col >= 2 && row[col].isEmpty()) continue;
+            object.insert(keys[col], row[col].trimmed());
+        }
+        array.append(object);
+    }
+    return array;
+}
+
+QJsonValue collectStorageJson()
+{
+    QJsonArray volumes;
+    for (const StorageVolume& v : collectStorageVolumes()) {
+        QJsonObject object;
+        object.insert("device", v.device);
+        object.insert("mount_point", v.mountPoint);
+        object.insert("fs_type", v.fsType);
+        object.insert("used_bytes", double(v.usedBytes));
+        object.insert("total_bytes", double(v.totalBytes));
+        object.insert("usage_percent", v.usagePercent);
+        volumes.append(object);
+    }
+    QJsonObject storage;
+    storage.insert("volumes", volumes);
+    storage.insert("disks", rowsToJson(collectDiskCapacities()));
+    return storage;
+}
+
+const QVector<HeadlessSection>& headlessSections()
+{
+    static const QVector<HeadlessSection> sections = {
+        { "cpu",       [] { return QJsonValue(rowsToJson(collectCpuInformation())); } },
+        { "os",        [] { return QJsonValue(rowsToJson(collectOSInformation())); } },
+        { "storage",   [] { return collectStorageJson(); } },
+        { "network",   [] { return QJsonValue(rowsToJson(collectNetworkInformation())); } },
+        { "mainboard", [] { return QJsonValue(rowsToJson(collectMainboardInformation())); } },
+        { "system",    [] { return QJsonValue(rowsToJson(collectSystemInformation())); } },
+        { "memory",    [] { return QJsonValue(rowsToJson(collectMemoryModules())); } },
+        { "graphics",  [] { return QJsonValue(rowsToJson(collectGraphicsInformation())); } },
+        { "peripherals", [] { return QJsonValue(rowsToJson(collectUsbDevices())); } },
+        { "pci",       [] { return QJsonValue(rowsToJson(collectPciDevices())); } },
+        { "audio",     [] { return QJsonValue(rowsToJson(collectAudioInformation())); } },
+    };
+    return sections;
+}
+
+// One line of `--follow` output.
+QJsonObject sampleToJson(const Sample& sample)
+{
+    QJsonObject object;
+    object.insert("sequence", double(sample.sequence));
+    object.insert("timestamp_ms", double(sample.timestampMs));
+    if (sample.channels & Sampler::Cpu) {
+        object.insert("cpu_busy_percent", sample.cpuBusyPercent);
+        QJsonArray perCpu;
+        for (double busy : sample.cpuBusyPercents) perCpu.append(busy);
+        object.insert("cpu_busy_percents", perCpu);
+    }
+    if (sample.channels & Sampler::Memory) {
+        object.insert("mem_total_bytes", double(sample.memTotal));
+        object.insert("mem_available_bytes", double(sample.memAvailable));
+        object.insert("swap_total_bytes", double(sample.swapTotal));
+        object.insert("swap_free_bytes", double(sample.swapFree));
+    }
+    if (sample.channels & Sampler::Network) {
+        QJsonArray interfaces;
+        for (const NetDevCounters& c : sample.interfaces) {
+            QJsonObject i;
+            i.insert("name", c.name);
+            i.insert("rx_bytes", double(c.rxBytes));
+            i.insert("tx_bytes", double(c.txBytes));
+            i.insert("rx_bytes_per_sec", c.rxBytesPerSec);
+            i.insert("tx_bytes_per_sec", c.txBytesPerSec);
+            interfaces.append(i);
+        }
+        object.insert("interfaces", interfaces);
+    }
+    if (sample.channels & Sampler::CpuFreq) {
+        QJsonArray freq;
+        for (qint64 khz : sample.curFreqKHz) freq.append(double(khz));
+        object.insert("cpu_freq_khz", freq);
+    }
+    return object;
+}
+
+// Run every tab's command and Geek Mode command, plus the ones run outside
+// the tabs (LshwProbe, the memory and network Geek dialogs), through
+// Capture::run() so a recording archives their output.
+void runTabCommands()
+{
+    QVector<QPair<QString, QStringList>> commands = {
+        { "lshw", QStringList() << "-xml" },
+        { "dmidecode", QStringList() << "-t" << "memory" },
+        { "bash", QStringList() << "-c" << "ip addr && echo --- && ip route" },
+    };
+    for (const TabConfig& tab : TAB_CONFIGS) {
+        for (const QString& command : {tab.command, tab.geekCommand}) {
+            const QPair<QString, QStringList> shell("bash", QStringList() << "-c" << command);
+            if (!command.isEmpty() && !commands.contains(shell)) commands.append(shell);
+        }
+    }
+    QThreadPool pool;
+    pool.setMaxThreadCount(8);
+    for (const auto& command : commands) {
+        pool.start([command]() { Capture::run(command.first, command.second, 60000); });
+    }
+    pool.waitForDone();
+}
+
+} // namespace
+
+bool wantsHeadless(int argc, char* argv[])
+{
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--json") == 0) return true;
+        if (std::strncmp(argv[i], "--diff", 6) == 0 && std::strncmp(argv[i], "--diff-", 7) != 0) return true;
+        if (std::strncmp(argv[i], "--snapshot", 10) == 0) return true;
+    }
+    return false;
+}
+
+QStringList headlessSectionNames()
+{
+    QStringList names;
+    for (const HeadlessSection& s : headlessSections()) names.append(QLatin1String(s.name));
+    return names;
+}
+
+QJsonObject collectHeadlessSections(const QStringList& names)
+{
+    QVector<const HeadlessSection*> selected;
+    for (const HeadlessSection& s : headlessSections()) {
+        if (names.isEmpty() || names.contains(QLatin1String(s.name))) selected.append(&s);
+    }
+
+    // Every collector runs on its own pool thread. Several of them wait on
+    // external programs (lspci, pactl), so the pool is sized to run them all
+    // at once; each task writes only its own result slot.
+    QVector<QJsonValue> results(selected.size());
+    QThreadPool pool;
+    pool.setMaxThreadCount(qMax(1, int(selected.size())));
+    for (int i = 0; i < selected.size(); ++i) {
+        const HeadlessSection* section = selected[i];
+        QJsonValue* slot = &results[i];
+        pool.start([section, slot]() { *slot = section->collect(); });
+    }
+    pool.waitForDone();
+
+    QJsonObject sections;
+    for (int i = 0; i < selected.size(); ++i) {
+        sections.insert(selected[i]->name, results[i]);
+    }
+    return sections;
+}
+
+QJsonObject headlessDocument(const QJsonObject& sections, qint64 collectMs)
+{
+    QJsonObject root;
+    root.insert("lsv_version", LSVVersionQString());
+    root.insert("generated", QDateTime::currentDateTimeUtc().toString(Qt::ISODate));
+    QFile hostnameFile(procfs::hostPath("/proc/sys/kernel/hostname"));
+    if (hostnameFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        root.insert("hostname", QString::fromLocal8Bit(hostnameFile.readAll()).trimmed());
+    }
+    root.insert("collect_ms", double(collectMs));
+    root.insert("sections", sections);
+    return root;
+}
+
+int runHeadless(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+    app.setApplicationName("lsv");
+    app.setApplicationVersion(LSVVersionQString());
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Linux System Viewer - headless JSON output");
+    parser.addHelpOption();
+    parser.addVersionOption();
+    parser.addOption(QCommandLineOption("json", "Print system information as JSON (default in this mode)."));
+    QCommandLineOption sectionsOption("sections", "Comma separated list of sections to collect.", "list");
+    parser.addOption(sectionsOption);
+    QCommandLineOption compactOption("compact", "Print compact JSON instead of indented JSON.");
+    parser.addOption(compactOption);
+    QCommandLineOption listOption("list-sections", "List the available sections and exit.");
+    parser.addOption(listOption);
+    QCommandLineOption agentOption("agent", "Ask a running lsv-agentd instead of collecting locally.");
+    parser.addOption(agentOption);
+    QCommandLineOption followOption("follow", "With --agent: print one JSON line per live sample until interrupted.");
+    parser.addOption(followOption);
+    QCommandLineOption socketOption("socket", "Agent socket path (default: " + agent::socketPath() + ").", "path");
+    parser.addOption(socketOption);
+    QCommandLineOption captureOption("capture", "Archive every file and command the collectors read into dir.", "dir");
+    parser.addOption(captureOption);
+    QCommandLineOption replayOption("replay", "Collect from an archive written by --capture instead of this machine.", "dir");
+    parser.addOption(replayOption);
+    QCommandLineOption diffOption("diff", "Compare the document in file (from lsv --json) with this machine, or with "
+                                          "the file given as argument. Exits 1 if anything changed.", "file");
+    parser.addOption(diffOption);
+    QCommandLineOption ignoreOption("diff-ignore", "With --diff: keys to leave out, as a regular expression "
+                                                   "(default: " + defaultDiffIgnore().pattern() + "; empty: none).",
+                                    "regex");
+    parser.addOption(ignoreOption);
+    parser.addPositionalArgument("after", "With --diff: the second document.", "[after.json]");
+    QCommandLineOption snapshotOption("snapshot", "Write a binary snapshot (the JSON sections plus every file and "
+                                                  "command output read) to file instead of printing JSON.", "file");
+    parser.addOption(snapshotOption);
+    QCommandLineOption compressOption("compress", "With --snapshot: compress the blocks of the snapshot.");
+    parser.addOption(compressOption);
+    parser.process(app);
+
+    if (parser.isSet(replayOption)) {
+        if (!Capture::startReplay(parser.value(replayOption))) {
+            std::fprintf(stderr, "lsv: no capture archive in '%s'\n", qPrintable(parser.value(replayOption)));
+            return 2;
+        }
+    } else if (parser.isSet(captureOption)) {
+        Capture::startRecording(parser.value(captureOption));
+    } else {
+        Capture::startFromArguments(QStringList()); // LSV_CAPTURE / LSV_REPLAY
+    }
+
+    const QStringList all = headlessSectionNames();
+    if (parser.isSet(listOption)) {
+        for (const QString& name : all) std::printf("%s\n", qPrintable(name));
+        return 0;
+    }
+
+    QStringList selected;
+    if (parser.isSet(sectionsOption)) {
+        const QStringList wanted = parser.value(sectionsOption).split(',', Qt::SkipEmptyParts);
+        for (const QString& w : wanted) {
+            const QString name = w.trimmed();
+            if (!all.contains(name)) {
+                std::fprintf(stderr, "lsv: unknown section '%s' (see --list-sections)\n", qPrintable(w));
+                return 2;
+            }
+            if (!selected.contains(name)) selected.append(name);
+        }
+    } else {
+        selected = all;
+    }
+    const QJsonDocument::JsonFormat format = parser.isSet(compactOption) ? QJsonDocument::Compact
+                                                                         : QJsonDocument::Indented;
+
+    if (parser.isSet(snapshotOption)) {
+        // Record into a scratch archive unless --capture/--replay already
+        // name one; a replayed archive is packed as it is.
+        QTemporaryDir scratch;
+        if (Capture::mode() == Capture::Off && (!scratch.isValid() || !Capture::startRecording(scratch.path()))) {
+            std::fprintf(stderr, "lsv: cannot create a capture directory\n");
+            return 2;
+        }
+        QElapsedTimer clock;
+        clock.start();
+        const QJsonObject sections = collectHeadlessSections(selected);
+        runTabCommands();
+        const QJsonObject document = headlessDocument(sections, clock.elapsed());
+        Capture::finish();
+
+        SnapshotFileWriter writer;
+        writer.addDocument(document);
+        QString error;
+        if (!writer.addArchive(Capture::directory(), &error)
+            || !writer.save(parser.value(snapshotOption), parser.isSet(compressOption), &error)) {
+            std::fprintf(stderr, "lsv: %s\n", qPrintable(error));
+            return 1;
+        }
+        return 0;
+    }
+
+    if (parser.isSet(diffOption)) {
+        QRegularExpression ignore = defaultDiffIgnore();
+        if (parser.isSet(ignoreOption)) {
+            ignore.setPattern(parser.value(ignoreOption));
+            if (!ignore.isValid()) {
+                std::fprintf(stderr, "lsv: --diff-ignore: %s\n", qPrintable(ignore.errorString()));
+                return 2;
+            }
+        }
+        QJsonObject before;
+        QJsonObject after;
+        QString error;
+        if (!loadSnapshotDocument(parser.value(diffOption), &before, &error)) {
+            std::fprintf(stderr, "lsv: %s\n", qPrintable(error));
+            return 2;
+        }
+        if (!parser.positionalArguments().isEmpty()) {
+            if (!loadSnapshotDocument(parser.positionalArguments().constFirst(), &after, &error)) {
+                std::fprintf(stderr, "lsv: %s\n", qPrintable(error));
+                return 2;
+            }
+        } else {
+            // Against this machine: collect only what the file has, so
+            // sections left out of it do not show up as added.
+            QStringList wanted;
+            const QJsonObject stored = before.value("sections").toObject();
+            for (const QString& name : selected) {
+                if (stored.contains(name)) wanted.append(name);
+            }
+            QElapsedTimer clock;
+            clock.start();
+            const QJsonObject sections = wanted.isEmpty() ? QJsonObject() : collectHeadlessSections(wanted);
+            after = headlessDocument(sections, clock.elapsed());
+            Capture::finish();
+        }
+        if (parser.isSet(sectionsOption)) {
+            // Compare the selected sections only.
+            for (QJsonObject* document : {&before, &after}) {
+                QJsonObject sections;
+                const QJsonObject all = document->value("sections").toObject();
+                for (const QString& name : selected) {
+                    if (all.contains(name)) sections.insert(name, all.value(name));
+                }
+                document->insert("sections", sections);
+            }
+        }
+
+        const SnapshotTree beforeTree = SnapshotTree::fromDocument(before, ignore);
+        const SnapshotTree afterTree = SnapshotTree::fromDocument(after, ignore);
+        const SnapshotDiff diff = diffSnapshots(beforeTree, afterTree);
+        const QByteArray json = QJsonDocument(diffToJson(diff, beforeTree, afterTree)).toJson(format);
+        std::fwrite(json.constData(), 1, size_t(json.size()), stdout);
+        return diff.isEmpty() ? 0 : 1;
+    }
+
+    if ((parser.isSet(agentOption) || parser.isSet(followOption)) && Capture::mode() == Capture::Off) {
+        const QString path = parser.isSet(socketOption) ? parser.value(socketOption) : agent::socketPath();
+        AgentClient* client = new AgentClient(&app);
+        if (!client->connectToAgent(path)) {
+            if (parser.isSet(followOption)) {
+                std::fprintf(stderr, "lsv: %s\n", qPrintable(client->errorString()));
+                return 1;
+            }
+            std::fprintf(stderr, "lsv: %s; collecting locally\n", qPrintable(client->errorString()));
+        } else if (parser.isSet(followOption)) {
+            QObject::connect(client, &AgentClient::sampleReceived, [](const SamplePtr& sample) {
+                const QByteArray line = QJsonDocument(sampleToJson(*sample)).toJson(QJsonDocument::Compact);
+                std::fwrite(line.constData(), 1, size_t(line.size()), stdout);
+                std::fputc('\n', stdout);
+                std::fflush(stdout);
+            });
+            QObject::connect(client, &AgentClient::disconnected, &app, [&app]() { app.exit(1); });
+            client->subscribe(Sampler::Cpu | Sampler::Memory | Sampler::Network | Sampler::CpuFreq);
+            return app.exec();
+        } else {
+            QJsonObject document;
+            if (client->fetchSnapshot(selected, &document)) {
+                const QByteArray json = QJsonDocument(document).toJson(format);
+                std::fwrite(json.constData(), 1, size_t(json.size()), stdout);
+                return 0;
+            }
+            std::fprintf(stderr, "lsv: %s; collecting locally\n", qPrintable(client->errorString()));
+        }
+    }
+
+    QElapsedTimer clock;
+    clock.start();
+    const QJsonObject sections = collectHeadlessSections(selected);
+    const QByteArray json = QJsonDocument(headlessDocument(sections, clock.elapsed())).toJson(format);
+    std::fwrite(json.constData(), 1, size_t(json.size()), stdout);
+    Capture::finish();
+    return 0;
+}
@@ -0,0 +1,33 @@
+#ifndef LSV_HEADLESS_H
+#define LSV_HEADLESS_H
+
+#include <QJsonObject>
+#include <QStringList>
+
+// Headless entry point: `lsv --json [--sections cpu,os,...] [--compact]`.
+// Runs the Core-only collectors in parallel and prints one JSON document to
+// stdout. Never creates a QApplication or any widget, and never elevates.
+// With --agent the document is taken from a running lsv-agentd instead.
+// `lsv --diff old.json [new.json]` prints the changes between a stored
+// document and this machine (or a second document) instead, and
+// `lsv --snapshot <file>` writes a binary snapshot (snapshot_file.h).
+//
+// Returns the process exit code.
+int runHeadless(int argc, char* argv[]);
+
+// True if argv asks for headless mode. Checked by main() before any GUI
+// object exists.
+bool wantsHeadless(int argc, char* argv[]);
+
+// Names of the sections runHeadless() knows, in output order.
+QStringList headlessSectionNames();
+
+// Run the collectors of the named sections in parallel (all of them when
+// names is empty) and return {name: value}. Unknown names are skipped.
+// Blocks until every collector is done; safe to call from any thread.
+QJsonObject collectHeadlessSections(const QStringList& names = QStringList());
+
+// The document `lsv --json` prints around a sections object.
+QJsonObject headlessDocument(const QJsonObject& sections, qint64 collectMs);
+
+#endif // LSV_HEADLESS_H
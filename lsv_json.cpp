@@ -0,0 +1,9 @@
+// lsv-json: the headless `--json` mode as its own small binary, linked
+// against Qt Core and Network only. Useful on servers without any GUI
+// libraries.
+#include "lsv_headless.h"
+
+int main(int argc, char *argv[])
+{
+    return runHeadless(argc, argv);
+}
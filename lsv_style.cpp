@@ -0,0 +1,78 @@
+#include "lsv_style.h"
+#include <QApplication>
+#include <QGroupBox>
+#include <QLabel>
+#include <QVBoxLayout>
+
+QString lsvStyleSheet()
+{
+    return QStringLiteral(
+        "QGroupBox#infoSection {"
+        "  font-weight: bold;"
+        "  border: 2px solid #bdc3c7;"
+        "  border-radius: 8px;"
+        "  margin-top: 10px;"
+        "  padding-top: 10px;"
+        "}"
+        "QGroupBox#infoSection::title {"
+        "  subcontrol-origin: margin;"
+        "  left: 10px;"
+        "  padding: 0 10px 0 10px;"
+        "}"
+        "QLabel#infoSectionContent {"
+        "  padding: 10px;"
+        "  background-color: #f8f9fa;"
+        "  border-radius: 4px;"
+        "}"
+        "QLabel#aboutSectionContent {"
+        "  padding: 15px;"
+        "  background-color: #f8f9fa;"
+        "  border-radius: 4px;"
+        "}"
+        "MemoryTab QLabel {"
+        "  font-size: 11px;"
+        "  color: #2c3e50;"
+        "}"
+        "QLabel#tabHeadline {"
+        "  font-size: 15px;"
+        "  font-weight: bold;"
+        "  color: #222;"
+        "  margin-bottom: 0px;"
+        "}"
+        "QPushButton#geekButton {"
+        "  background-color: #3498db;"
+        "  color: white;"
+        "  border: none;"
+        "  padding: 4px 10px;"
+        "  border-radius: 4px;"
+        "  font-weight: bold;"
+        "  font-size: 11px;"
+        "  min-width: 80px;"
+        "  max-height: 22px;"
+        "}"
+        "QPushButton#geekButton:hover {"
+        "  background-color: #2980b9;"
+        "}"
+    );
+}
+
+void applyLsvStyle(QApplication* app)
+{
+    app->setStyleSheet(lsvStyleSheet());
+}
+
+QGroupBox* createInfoSection(const QString& title, QLabel** contentLabel, QVBoxLayout* parentLayout,
+                             const QString& placeholder)
+{
+    QGroupBox* groupBox = new QGroupBox(title);
+    groupBox->setObjectName("infoSection");
+
+    QVBoxLayout* sectionLayout = new QVBoxLayout(groupBox);
+    *contentLabel = new QLabel(placeholder);
+    (*contentLabel)->setObjectName("infoSectionContent");
+    (*contentLabel)->setWordWrap(true);
+    sectionLayout->addWidget(*contentLabel);
+
+    parentLayout->addWidget(groupBox);
+    return groupBox;
+}
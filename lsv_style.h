@@ -0,0 +1,32 @@
+#ifndef LSV_STYLE_H
+#define LSV_STYLE_H
+
+#include <QString>
+
+class QApplication;
+class QGroupBox;
+class QLabel;
+class QVBoxLayout;
+
+// The look shared by all tabs, as one application style sheet installed at
+// startup. Widgets opt in by object name instead of carrying a copy of the
+// rules, so Qt parses the sheet once and never has to re-polish a widget
+// because its own sheet was replaced:
+//
+//   QGroupBox#infoSection        titled section of the lshw based tabs
+//   QLabel#infoSectionContent    the text inside such a section
+//   QLabel#tabHeadline           bold headline above a tab's content
+//   QPushButton#geekButton       the "Geek Mode" buttons
+//   MemoryTab QLabel             the RAM/SWAP figures
+//
+// Values that change at runtime (usage levels) are painted by UsageBar
+// from plain properties rather than expressed in style sheets.
+QString lsvStyleSheet();
+void applyLsvStyle(QApplication* app);
+
+// A titled section holding one word-wrapped label, appended to
+// parentLayout. Used by the tabs that show lshw/command output as text.
+QGroupBox* createInfoSection(const QString& title, QLabel** contentLabel, QVBoxLayout* parentLayout,
+                             const QString& placeholder = QString());
+
+#endif // LSV_STYLE_H
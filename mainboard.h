@@ -1,187 +1,130 @@
 #ifndef MAINBOARD_H
 #define MAINBOARD_H
 
-#include <QTableWidget>
-#include <QTableWidgetItem>
 #include <QJsonObject>
 #include <QFile>
 #include <QTextStream>
-#include <QProcess>
 #include <QRegularExpression>
 #include <QDebug>
-#include "gui_helpers.h"
+#include "info_rows.h"
+#include "procfs_parser.h"
+#include "capture.h"
 
 // Mainboard information functions
-void loadMainboardInformation(QTableWidget* table, const QJsonObject& data);
+InfoRows collectMainboardInformation();
+InfoRows collectSystemInformation();
 QStringList getMainboardHeaders();
-void styleMainboardTable(QTableWidget* table);
 QString getMainboardInfo();
 
 // Mainboard Headers
-QStringList getMainboardHeaders()
+inline QStringList getMainboardHeaders()
 {
     return QStringList() << "Property" << "Value" << "Unit" << "Type";
 }
 
-// Mainboard Table Styling
-void styleMainboardTable(QTableWidget* table)
+// Read one DMI field as exported by the kernel. These are the strings
+// `dmidecode -t baseboard|bios` decodes from the SMBIOS tables, available
+// without sudo or a process (only the serial number is root-only).
+inline QString readDmiField(const QString& field)
 {
-    // Set column widths
-    table->setColumnWidth(0, 200);  // Property
-    table->setColumnWidth(1, 300);  // Value
-    table->setColumnWidth(2, 80);   // Unit
-    table->setColumnWidth(3, 120);  // Type
-    
-    // Style headers
-    table->horizontalHeader()->setStyleSheet(
-        "QHeaderView::section { "
-        "background-color: #16a085; "
-        "color: white; "
-        "padding: 8px; "
-        "border: none; "
-        "font-weight: bold; "
-        "}"
-    );
+    QFile file(procfs::hostPath("/sys/class/dmi/id/" + field));
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) return QString();
+    return QString::fromLocal8Bit(file.readAll()).trimmed();
 }
 
-// Load Mainboard Information
-void loadMainboardInformation(QTableWidget* table, const QJsonObject& data)
+// Collect Mainboard Information
+inline InfoRows collectMainboardInformation()
 {
-    Q_UNUSED(data);
-    
-    table->setRowCount(0);
-    
-    // Get DMI information
-    QProcess dmiProcess;
-    dmiProcess.start("sudo", QStringList() << "dmidecode" << "-t" << "baseboard");
-    dmiProcess.waitForFinished();
-    QString dmiOutput = dmiProcess.readAllStandardOutput();
-    
-    if (!dmiOutput.isEmpty()) {
-        QStringList lines = dmiOutput.split('\n');
-        QString manufacturer, product, version, serialNumber;
-        
-        for (const QString& line : lines) {
-            QString trimmedLine = line.trimmed();
-            if (trimmedLine.startsWith("Manufacturer:")) {
-                manufacturer = trimmedLine.mid(13).trimmed();
-            } else if (trimmedLine.startsWith("Product Name:")) {
-                product = trimmedLine.mid(13).trimmed();
-            } else if (trimmedLine.startsWith("Version:")) {
-                version = trimmedLine.mid(8).trimmed();
-            } else if (trimmedLine.startsWith("Serial Number:")) {
-                serialNumber = trimmedLine.mid(14).trimmed();
-            }
-        }
-        
-        if (!manufacturer.isEmpty() && manufacturer != "Not Specified") {
-            addRowToTable(table, QStringList() << "Manufacturer" << manufacturer << "" << "Mainboard");
-        }
-        if (!product.isEmpty() && product != "Not Specified") {
-            addRowToTable(table, QStringList() << "Model" << product << "" << "Mainboard");
-        }
-        if (!version.isEmpty() && version != "Not Specified") {
-            addRowToTable(table, QStringList() << "Version" << version << "" << "Mainboard");
-        }
-        if (!serialNumber.isEmpty() && serialNumber != "Not Specified") {
-            addRowToTable(table, QStringList() << "Serial Number" << serialNumber << "" << "Mainboard");
-        }
+    InfoRows rows;
+
+    // Baseboard information
+    QString manufacturer = readDmiField("board_vendor");
+    QString product = readDmiField("board_name");
+    QString version = readDmiField("board_version");
+    QString serialNumber = readDmiField("board_serial");
+
+    if (!manufacturer.isEmpty() && manufacturer != "Not Specified") {
+        rows.append(QStringList() << "Manufacturer" << manufacturer << "" << "Mainboard");
     }
-    
-    // Get BIOS information
-    dmiProcess.start("sudo", QStringList() << "dmidecode" << "-t" << "bios");
-    dmiProcess.waitForFinished();
-    QString biosOutput = dmiProcess.readAllStandardOutput();
-    
-    if (!biosOutput.isEmpty()) {
-        QStringList lines = biosOutput.split('\n');
-        QString biosVendor, biosVersion, biosDate;
-        
-        for (const QString& line : lines) {
-            QString trimmedLine = line.trimmed();
-            if (trimmedLine.startsWith("Vendor:")) {
-                biosVendor = trimmedLine.mid(7).trimmed();
-            } else if (trimmedLine.startsWith("Version:")) {
-                biosVersion = trimmedLine.mid(8).trimmed();
-            } else if (trimmedLine.startsWith("Release Date:")) {
-                biosDate = trimmedLine.mid(13).trimmed();
-            }
-        }
-        
-        if (!biosVendor.isEmpty()) {
-            addRowToTable(table, QStringList() << "BIOS Vendor" << biosVendor << "" << "Mainboard");
-        }
-        if (!biosVersion.isEmpty()) {
-            addRowToTable(table, QStringList() << "BIOS Version" << biosVersion << "" << "Mainboard");
-        }
-        if (!biosDate.isEmpty()) {
-            addRowToTable(table, QStringList() << "BIOS Date" << biosDate << "" << "Mainboard");
-        }
+    if (!product.isEmpty() && product != "Not Specified") {
+        rows.append(QStringList() << "Model" << product << "" << "Mainboard");
     }
-    
-    // Get chipset information from lspci
-    QProcess lspciProcess;
-    lspciProcess.start("lspci", QStringList() << "-v");
-    lspciProcess.waitForFinished();
-    QString lspciOutput = lspciProcess.readAllStandardOutput();
-    
-    QStringList lspciLines = lspciOutput.split('\n');
-    for (const QString& line : lspciLines) {
-        if (line.contains("Host bridge:") || line.contains("ISA bridge:")) {
-            QString chipset = line.split(':').last().trimmed();
-            if (line.contains("Host bridge:")) {
-                addRowToTable(table, QStringList() << "Chipset" << chipset << "" << "Mainboard");
-            } else if (line.contains("ISA bridge:")) {
-                addRowToTable(table, QStringList() << "South Bridge" << chipset << "" << "Mainboard");
-            }
-        }
+    if (!version.isEmpty() && version != "Not Specified") {
+        rows.append(QStringList() << "Version" << version << "" << "Mainboard");
     }
-    
-    // Get USB controllers
-    lspciProcess.start("lspci", QStringList() << "-v" << "-d" << "*:*");
-    lspciProcess.waitForFinished();
-    QString usbOutput = lspciProcess.readAllStandardOutput();
-    
-    QStringList usbLines = usbOutput.split('\n');
+    if (!serialNumber.isEmpty() && serialNumber != "Not Specified") {
+        rows.append(QStringList() << "Serial Number" << serialNumber << "" << "Mainboard");
+    }
+
+    // BIOS information
+    QString biosVendor = readDmiField("bios_vendor");
+    QString biosVersion = readDmiField("bios_version");
+    QString biosDate = readDmiField("bios_date");
+
+    if (!biosVendor.isEmpty()) {
+        rows.append(QStringList() << "BIOS Vendor" << biosVendor << "" << "Mainboard");
+    }
+    if (!biosVersion.isEmpty()) {
+        rows.append(QStringList() << "BIOS Version" << biosVersion << "" << "Mainboard");
+    }
+    if (!biosDate.isEmpty()) {
+        rows.append(QStringList() << "BIOS Date" << biosDate << "" << "Mainboard");
+    }
+
+    // Chipset and USB controllers from a single lspci run; the class names
+    // are part of the plain listing, -v only adds detail we do not show.
+    QString lspciOutput = Capture::run("lspci", QStringList(), 5000).standardOutput;
+
+    QStringList lspciLines = lspciOutput.split('\n');
     QStringList usbControllers;
-    for (const QString& line : usbLines) {
-        if (line.contains("USB controller:")) {
+    for (const QString& line : lspciLines) {
+        if (line.contains("Host bridge:")) {
+            rows.append(QStringList() << "Chipset" << line.split(':').last().trimmed() << "" << "Mainboard");
+        } else if (line.contains("ISA bridge:")) {
+            rows.append(QStringList() << "South Bridge" << line.split(':').last().trimmed() << "" << "Mainboard");
+        } else if (line.contains("USB controller:")) {
             QString controller = line.split(':').last().trimmed();
             if (!usbControllers.contains(controller)) {
                 usbControllers.append(controller);
             }
         }
     }
-    
+
     for (int i = 0; i < usbControllers.size(); ++i) {
-        addRowToTable(table, QStringList() << QString("USB Controller %1").arg(i + 1) << usbControllers[i] << "" << "Mainboard");
+        rows.append(QStringList() << QString("USB Controller %1").arg(i + 1) << usbControllers[i] << "" << "Mainboard");
     }
+    return rows;
 }
 
-QString getMainboardInfo()
+// The machine as a whole (the PC Info tab's DMI rows, under the same
+// names): what model it is and who made it.
+inline InfoRows collectSystemInformation()
 {
-    QProcess dmiProcess;
-    dmiProcess.start("sudo", QStringList() << "dmidecode" << "-t" << "baseboard");
-    dmiProcess.waitForFinished();
-    QString dmiOutput = dmiProcess.readAllStandardOutput();
-    
-    QStringList lines = dmiOutput.split('\n');
-    QString manufacturer, product;
-    
-    for (const QString& line : lines) {
-        QString trimmedLine = line.trimmed();
-        if (trimmedLine.startsWith("Manufacturer:")) {
-            manufacturer = trimmedLine.mid(13).trimmed();
-        } else if (trimmedLine.startsWith("Product Name:")) {
-            product = trimmedLine.mid(13).trimmed();
-        }
+    InfoRows rows;
+    const QList<QPair<QString, QString>> fields = {
+        {"Manufacturer", "sys_vendor"},
+        {"Product", "product_name"},
+        {"Serial", "product_serial"},
+        {"Family", "product_family"},
+        {"Chassis", "chassis_type"},
+    };
+    for (const auto& field : fields) {
+        const QString value = readDmiField(field.second);
+        if (!value.isEmpty()) rows.append(QStringList() << field.first << value << "" << "System");
     }
-    
+    return rows;
+}
+
+inline QString getMainboardInfo()
+{
+    QString manufacturer = readDmiField("board_vendor");
+    QString product = readDmiField("board_name");
+
     if (!manufacturer.isEmpty() && !product.isEmpty()) {
         return QString("%1 %2").arg(manufacturer, product);
     }
-    
+
     return "Unknown Mainboard";
 }
 
-#endif // MAINBOARD_H
\ No newline at end of file
+#endif // MAINBOARD_H
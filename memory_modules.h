@@ -0,0 +1,90 @@
+#ifndef MEMORY_MODULES_H
+#define MEMORY_MODULES_H
+
+#include <QList>
+#include <QMap>
+#include <QString>
+#include <QStringList>
+#include "info_rows.h"
+#include "capture.h"
+
+// Memory module (DIMM) information functions
+InfoRows parseMemoryModules(const QString& dmidecodeOutput);
+InfoRows collectMemoryModules();
+
+// Rows of `dmidecode -t memory` output: slot counts and totals, then one
+// row per slot, so a module that goes missing shows as a changed slot, a
+// free slot more and a smaller total. Shared by the Memory Geek dialog and
+// the headless "memory" section.
+inline InfoRows parseMemoryModules(const QString& dmidecodeOutput)
+{
+    QList<QMap<QString, QString>> devices;
+    QMap<QString, QString> currentDevice;
+    bool inDevice = false;
+    for (const QString& line : dmidecodeOutput.split('\n')) {
+        const QString trimmed = line.trimmed();
+        if (trimmed.startsWith("Memory Device")) {
+            if (!currentDevice.isEmpty()) devices.append(currentDevice);
+            currentDevice.clear();
+            inDevice = true;
+        } else if (inDevice && !trimmed.isEmpty() && trimmed.contains(':')) {
+            const QStringList parts = trimmed.split(':');
+            if (parts.size() == 2) currentDevice[parts[0].trimmed()] = parts[1].trimmed();
+        }
+    }
+    if (!currentDevice.isEmpty()) devices.append(currentDevice);
+
+    InfoRows rows;
+    if (devices.isEmpty()) return rows;
+
+    int freeSlots = 0, maxModuleSize = 0, totalMaxRam = 0;
+    QString ramType, ramSpeed;
+    for (const auto& dev : devices) {
+        QString sizeStr = dev.value("Size");
+        if (sizeStr == "No Module Installed") {
+            freeSlots++;
+        } else if (sizeStr.endsWith("MB")) {
+            totalMaxRam += sizeStr.remove("MB").trimmed().toInt();
+        } else if (sizeStr.endsWith("GB")) {
+            totalMaxRam += sizeStr.remove("GB").trimmed().toInt() * 1024;
+        }
+        if (ramType.isEmpty()) ramType = dev.value("Type");
+        if (ramSpeed.isEmpty()) ramSpeed = dev.value("Configured Clock Speed");
+        if (maxModuleSize == 0 && dev.contains("Maximum Capacity")) {
+            QString maxStr = dev.value("Maximum Capacity");
+            if (maxStr.endsWith("MB")) maxModuleSize = maxStr.remove("MB").trimmed().toInt();
+            else if (maxStr.endsWith("GB")) maxModuleSize = maxStr.remove("GB").trimmed().toInt() * 1024;
+        }
+    }
+
+    auto addRow = [&rows](const QString& property, const QString& value) {
+        rows.append(QStringList() << property << value << "" << "Memory");
+    };
+    addRow("RAM Slots", QString::number(devices.size()));
+    addRow("Free Slots", QString::number(freeSlots));
+    addRow("Max Module Size", maxModuleSize > 0 ? QString("%1 MB").arg(maxModuleSize) : "Unknown");
+    addRow("Total Installed RAM", totalMaxRam > 0 ? QString("%1 MB").arg(totalMaxRam) : "Unknown");
+    addRow("RAM Type", ramType.isEmpty() ? "Unknown" : ramType);
+    addRow("RAM Speed", ramSpeed.isEmpty() ? "Unknown" : ramSpeed);
+
+    for (int i = 0; i < devices.size(); ++i) {
+        const auto& dev = devices[i];
+        const QString slotInfo = QString("Slot %1: %2, %3, %4")
+            .arg(i + 1)
+            .arg(dev.value("Size", "No Module"))
+            .arg(dev.value("Type", "Unknown"))
+            .arg(dev.value("Configured Clock Speed", dev.value("Speed", "Unknown")));
+        addRow(QString("Slot %1 Info").arg(i + 1), slotInfo);
+    }
+    return rows;
+}
+
+// dmidecode needs root; without it (or without dmidecode) there are no rows.
+inline InfoRows collectMemoryModules()
+{
+    const Capture::Command dmidecode = Capture::run("dmidecode", QStringList() << "-t" << "memory", 5000);
+    if (dmidecode.exitCode != 0) return InfoRows();
+    return parseMemoryModules(QString::fromLocal8Bit(dmidecode.standardOutput));
+}
+
+#endif // MEMORY_MODULES_H
@@ -1,7 +1,16 @@
 #include "memory_tab.h"
-#include <sys/sysinfo.h>
+#include "snapshot_cache.h"
+#include "collector_engine.h"
+#include "timeseries_store.h"
+#include "alert_engine.h"
+#include "trace.h"
+#include "search_index.h"
+#include "snapshot_baseline.h"
+#include "memory_modules.h"
+#include "gui_helpers.h"
+#include <QToolTip>
+#include <QHelpEvent>
 #include <QFrame>
-#include <QProcess>
 #include <QHeaderView>
 #include <QDialogButtonBox>
 #include <QScrollArea>
@@ -11,24 +20,9 @@ MemoryTab::MemoryTab(QWidget* parent) : QWidget(parent)
     // Headline and Geek button on same line
     QHBoxLayout* headlineLayout = new QHBoxLayout();
     QLabel* headline = new QLabel("Memory");
-    headline->setStyleSheet("font-size: 15px; font-weight: bold; color: #222; margin-bottom: 0px;");
+    headline->setObjectName("tabHeadline");
     geekButton = new QPushButton("Geek Mode", this);
-    geekButton->setStyleSheet(
-        "QPushButton {"
-        "  background-color: #3498db;"
-        "  color: white;"
-        "  border: none;"
-        "  padding: 4px 10px;"
-        "  border-radius: 4px;"
-        "  font-weight: bold;"
-        "  font-size: 11px;"
-        "  min-width: 80px;"
-        "  max-height: 22px;"
-        "}"
-        "QPushButton:hover {"
-        "  background-color: #2980b9;"
-        "}"
-    );
+    geekButton->setObjectName("geekButton");
     connect(geekButton, &QPushButton::clicked, this, &MemoryTab::showGeekMode);
     headlineLayout->addWidget(headline);
     headlineLayout->addStretch();
@@ -37,15 +31,10 @@ MemoryTab::MemoryTab(QWidget* parent) : QWidget(parent)
     // RAM widgets
     ramTotalLabel = new QLabel(this);
     ramTotalLabel->setStyleSheet("font-weight: bold; font-size: 11px; color: #222; margin-bottom: 0px;");
-    ramUsageBar = new QProgressBar(this);
+    ramUsageBar = new UsageBar(this);
     ramUsedLabel = new QLabel(this);
     ramFreeLabel = new QLabel(this);
 
-    ramUsageBar->setMinimum(0);
-    ramUsageBar->setMaximum(100);
-    ramUsageBar->setTextVisible(false);
-    ramUsageBar->setFixedHeight(10);
-
     QFont smallBoldFont = ramUsedLabel->font();
     smallBoldFont.setPointSize(9);
     smallBoldFont.setBold(true);
@@ -61,15 +50,22 @@ MemoryTab::MemoryTab(QWidget* parent) : QWidget(parent)
     // SWAP widgets
     swapTotalLabel = new QLabel(this);
     swapTotalLabel->setStyleSheet("font-weight: bold; font-size: 11px; color: #222; margin-bottom: 0px;");
-    swapUsageBar = new QProgressBar(this);
+    swapUsageBar = new UsageBar(this);
+
+    // Yellow and red from the levels of the memory and swap alert rules
+    // (75 % and 90 % unless alerts.json says otherwise).
+    auto applyThresholds = [](UsageBar* bar, AlertRule::Metric metric) {
+        double warningAt = bar->warningAt();
+        double criticalAt = bar->criticalAt();
+        if (!AlertEngine::instance()->thresholds(metric, &warningAt, &criticalAt)) return;
+        bar->setWarningAt(warningAt);
+        bar->setCriticalAt(criticalAt);
+    };
+    applyThresholds(ramUsageBar, AlertRule::MemoryUsedPercent);
+    applyThresholds(swapUsageBar, AlertRule::SwapUsedPercent);
     swapUsedLabel = new QLabel(this);
     swapFreeLabel = new QLabel(this);
 
-    swapUsageBar->setMinimum(0);
-    swapUsageBar->setMaximum(100);
-    swapUsageBar->setTextVisible(false);
-    swapUsageBar->setFixedHeight(10);
-
     swapUsedLabel->setFont(smallBoldFont);
     swapFreeLabel->setFont(smallBoldFont);
     swapUsedLabel->setPalette(darkGray);
@@ -117,82 +113,94 @@ MemoryTab::MemoryTab(QWidget* parent) : QWidget(parent)
     swapLabelsLayout->addWidget(swapFreeLabel, 0, Qt::AlignRight);
     mainLayout->addLayout(swapLabelsLayout);
 
-    setStyleSheet(
-        "QLabel { font-size: 11px; color: #2c3e50; }"
-        "QProgressBar {"
-        " border: 1px solid #34495e;"
-        " border-radius: 5px;"
-        " background: #eee;"
-        " min-height: 6px;"
-        " max-height: 12px;"
-        "}"
-        "QProgressBar::chunk {"
-        " border-radius: 5px;"
-        "}"
-    );
+    // Hovering a bar shows min/avg/max from the recorded history.
+    ramUsageBar->installEventFilter(this);
+    swapUsageBar->installEventFilter(this);
+
+    // Values arrive from the sampler thread while the tab is visible.
+    connect(Sampler::instance(), &Sampler::sampleReady, this, &MemoryTab::updateMemoryInfo);
+}
+
+void MemoryTab::showEvent(QShowEvent* ev)
+{
+    QWidget::showEvent(ev);
+    Sampler::instance()->subscribe(this, Sampler::Memory);
+}
+
+void MemoryTab::hideEvent(QHideEvent* ev)
+{
+    Sampler::instance()->unsubscribe(this);
+    QWidget::hideEvent(ev);
+}
 
-    timer = new QTimer(this);
-    connect(timer, &QTimer::timeout, this, &MemoryTab::updateMemoryInfo);
-    timer->start(1000);
+bool MemoryTab::eventFilter(QObject* watched, QEvent* event)
+{
+    // Built on demand: the history is only queried when a tooltip shows.
+    if (event->type() == QEvent::ToolTip && (watched == ramUsageBar || watched == swapUsageBar)) {
+        QHelpEvent* help = static_cast<QHelpEvent*>(event);
+        QToolTip::showText(help->globalPos(), historyToolTip(watched == swapUsageBar), static_cast<QWidget*>(watched));
+        return true;
+    }
+    return QWidget::eventFilter(watched, event);
+}
+
+QString MemoryTab::historyToolTip(bool swap) const
+{
+    const TimeSeriesStore::Metric metric = swap ? TimeSeriesStore::SwapUsedBytes : TimeSeriesStore::RamUsedBytes;
+    const struct { const char* label; qint64 windowMs; } windows[] = {
+        { "Last 5 min", 5 * 60 * 1000LL },
+        { "Last hour", 60 * 60 * 1000LL },
+        { "Last 24 h", 24 * 60 * 60 * 1000LL },
+    };
 
-    updateMemoryInfo();
+    auto gb = [](double bytes) { return QString::number(bytes / (1024.0 * 1024 * 1024), 'f', 2); };
+    QString text = QString("<b>%1 used</b> (min / avg / max GB)").arg(swap ? "SWAP" : "RAM");
+    const qint64 recordedMs = TimeSeriesStore::instance()->recordedSpanMs();
+    qint64 previousWindowMs = 0;
+    for (const auto& w : windows) {
+        // A longer window adds nothing until LSV has run past the shorter one.
+        if (previousWindowMs >= recordedMs) break;
+        const SeriesSummary s = TimeSeriesStore::instance()->summarize(metric, w.windowMs);
+        if (s.points == 0) break;
+        text += QString("<br>%1: %2 / %3 / %4").arg(w.label, gb(s.min), gb(s.avg), gb(s.max));
+        previousWindowMs = w.windowMs;
+    }
+    return text;
 }
 
-void MemoryTab::updateMemoryInfo()
+void MemoryTab::updateMemoryInfo(const SamplePtr& sample)
 {
-    struct sysinfo info;
-    sysinfo(&info);
+    if (!isVisible() || !(sample->channels & Sampler::Memory)) return;
+    TraceSpan span("live", "MemoryTab::updateMemoryInfo");
 
     // RAM
-    double ramTotalGB = info.totalram * info.mem_unit / (1024.0 * 1024 * 1024);
-    double ramFreeGB = info.freeram * info.mem_unit / (1024.0 * 1024 * 1024);
+    double ramTotalGB = sample->memTotal / (1024.0 * 1024 * 1024);
+    double ramFreeGB = sample->memFree / (1024.0 * 1024 * 1024);
     double ramUsedGB = ramTotalGB - ramFreeGB;
     int ramPercent = ramTotalGB > 0 ? (int)((ramUsedGB / ramTotalGB) * 100) : 0;
 
     ramTotalLabel->setText(QString("RAM Total: %1 GB").arg(QString::number(ramTotalGB, 'f', 3)));
     ramUsageBar->setValue(ramPercent);
-    setBarColor(ramUsageBar, ramPercent);
 
     ramUsedLabel->setText(QString("Used: %1 GB").arg(QString::number(ramUsedGB, 'f', 3)));
     ramFreeLabel->setText(QString("Free: %1 GB (%2%)").arg(QString::number(ramFreeGB, 'f', 3)).arg(100 - ramPercent));
 
     // SWAP
-    double swapTotalGB = info.totalswap * info.mem_unit / (1024.0 * 1024 * 1024);
-    double swapFreeGB = info.freeswap * info.mem_unit / (1024.0 * 1024 * 1024);
+    double swapTotalGB = sample->swapTotal / (1024.0 * 1024 * 1024);
+    double swapFreeGB = sample->swapFree / (1024.0 * 1024 * 1024);
     double swapUsedGB = swapTotalGB - swapFreeGB;
     int swapPercent = swapTotalGB > 0 ? (int)((swapUsedGB / swapTotalGB) * 100) : 0;
 
     swapTotalLabel->setText(QString("SWAP Total: %1 GB").arg(QString::number(swapTotalGB, 'f', 3)));
     swapUsageBar->setValue(swapPercent);
-    setBarColor(swapUsageBar, swapPercent);
 
     swapUsedLabel->setText(QString("Used: %1 GB").arg(QString::number(swapUsedGB, 'f', 3)));
     swapFreeLabel->setText(QString("Free: %1 GB (%2%)").arg(QString::number(swapFreeGB, 'f', 3)).arg(100 - swapPercent));
-}
 
-void MemoryTab::setBarColor(QProgressBar* bar, int percent)
-{
-    QString color;
-    if (percent < 75)
-        color = "#4caf50"; // green
-    else if (percent < 90)
-        color = "#ffeb3b"; // yellow
-    else
-        color = "#f44336"; // red
-
-    bar->setStyleSheet(QString(
-        "QProgressBar {"
-        " border: 1px solid #34495e;"
-        " border-radius: 5px;"
-        " background: #eee;"
-        " min-height: 6px;"
-        " max-height: 12px;"
-        "}"
-        "QProgressBar::chunk {"
-        " background-color: %1;"
-        " border-radius: 5px;"
-        "}"
-    ).arg(color));
+    if (!searchPublished) {
+        SearchIndex::instance()->publish("Memory", this);
+        searchPublished = true;
+    }
 }
 
 void MemoryTab::showGeekMode()
@@ -272,82 +280,53 @@ void GeekMemoryDialog::fillTable()
 {
     table->setRowCount(0);
 
-    QProcess proc;
-    proc.start("dmidecode", QStringList() << "-t" << "memory");
-    proc.waitForFinished(2000);
-    QString output = QString::fromLocal8Bit(proc.readAllStandardOutput());
-
-    int slotCount = 0, freeSlots = 0, maxModuleSize = 0, totalMaxRam = 0;
-    QString ramType, ramSpeed;
-    QList<QMap<QString, QString>> devices;
-
-    QStringList lines = output.split('\n');
-    QMap<QString, QString> currentDevice;
-    bool inDevice = false;
-    for (const QString& line : lines) {
-        QString trimmed = line.trimmed();
-        if (trimmed.startsWith("Memory Device")) {
-            if (!currentDevice.isEmpty()) devices.append(currentDevice);
-            currentDevice.clear();
-            inDevice = true;
-        } else if (inDevice && !trimmed.isEmpty() && trimmed.contains(':')) {
-            QStringList parts = trimmed.split(':');
-            if (parts.size() == 2)
-                currentDevice[parts[0].trimmed()] = parts[1].trimmed();
-        }
-    }
-    if (!currentDevice.isEmpty()) devices.append(currentDevice);
-
-    slotCount = devices.size();
-    for (const auto& dev : devices) {
-        QString sizeStr = dev.value("Size");
-        if (sizeStr == "No Module Installed") {
-            freeSlots++;
-        } else if (sizeStr.endsWith("MB")) {
-            totalMaxRam += sizeStr.remove("MB").trimmed().toInt();
-        } else if (sizeStr.endsWith("GB")) {
-            totalMaxRam += sizeStr.remove("GB").trimmed().toInt() * 1024;
-        }
-        if (ramType.isEmpty()) ramType = dev.value("Type");
-        if (ramSpeed.isEmpty()) ramSpeed = dev.value("Configured Clock Speed");
-        if (maxModuleSize == 0 && dev.contains("Maximum Capacity")) {
-            QString maxStr = dev.value("Maximum Capacity");
-            if (maxStr.endsWith("MB")) maxModuleSize = maxStr.remove("MB").trimmed().toInt();
-            else if (maxStr.endsWith("GB")) maxModuleSize = maxStr.remove("GB").trimmed().toInt() * 1024;
-        }
+    // The DMI tables cannot change without a reboot, so output recorded
+    // earlier in this boot is reused instead of running dmidecode again.
+    const QString cacheKey = "dmidecode -t memory";
+    SnapshotCache* cache = SnapshotCache::instance();
+    QByteArray raw;
+    if (cache->isFresh(cacheKey) && cache->lookup(cacheKey, &raw)) {
+        showModules(QString::fromLocal8Bit(raw));
+        return;
     }
+    // The dialog stays responsive while dmidecode runs and fills in when it
+    // is done; closing it first drops the continuation.
+    CollectorEngine::instance()->run("dmidecode", QStringList() << "-t" << "memory", CollectorEngine::Visible, 2000)
+        .then(this, [this, cacheKey](const CollectorResult& result) {
+            if (result.exitCode == 0 && !result.timedOut && !result.standardOutput.isEmpty()) {
+                SnapshotCache::instance()->store(cacheKey, result.standardOutput);
+            }
+            showModules(QString::fromLocal8Bit(result.standardOutput));
+        });
+}
+
+void GeekMemoryDialog::showModules(const QString& output)
+{
+    table->setRowCount(0);
 
     int row = 0;
-    auto addRow = [&](const QString& prop, const QString& val) {
+    for (const QStringList& data : parseMemoryModules(output)) {
         table->insertRow(row);
-        QTableWidgetItem* propItem = new QTableWidgetItem(prop);
+        QTableWidgetItem* propItem = new QTableWidgetItem(data.value(0));
         QFont boldFont;
         boldFont.setBold(true);
         propItem->setFont(boldFont);
         propItem->setForeground(QColor("#000000"));
         table->setItem(row, 0, propItem);
-        QTableWidgetItem* valItem = new QTableWidgetItem(val);
+        QTableWidgetItem* valItem = new QTableWidgetItem(data.value(1));
         valItem->setForeground(QColor("#1f1971"));
         table->setItem(row, 1, valItem);
         table->resizeRowToContents(row);
         row++;
-    };
+    }
 
-    addRow("RAM Slots", QString::number(slotCount));
-    addRow("Free Slots", QString::number(freeSlots));
-    addRow("Max Module Size", maxModuleSize > 0 ? QString("%1 MB").arg(maxModuleSize) : "Unknown");
-    addRow("Total Installed RAM", totalMaxRam > 0 ? QString("%1 MB").arg(totalMaxRam) : "Unknown");
-    addRow("RAM Type", ramType.isEmpty() ? "Unknown" : ramType);
-    addRow("RAM Speed", ramSpeed.isEmpty() ? "Unknown" : ramSpeed);
-
-    // Add per-slot info
-    for (int i = 0; i < devices.size(); ++i) {
-        const auto& dev = devices[i];
-        QString slotInfo = QString("Slot %1: %2, %3, %4")
-            .arg(i + 1)
-            .arg(dev.value("Size", "No Module"))
-            .arg(dev.value("Type", "Unknown"))
-            .arg(dev.value("Configured Clock Speed", dev.value("Speed", "Unknown")));
-        addRow(QString("Slot %1 Info").arg(i + 1), slotInfo);
+    // Mark what differs from the --baseline snapshot once it is compared.
+    SnapshotBaseline* baseline = SnapshotBaseline::instance();
+    if (baseline->isReady()) {
+        markBaselineRows(table, baseline->changedRows("memory"));
+    } else if (baseline->isActive()) {
+        connect(baseline, &SnapshotBaseline::ready, this, [this, baseline]() {
+            markBaselineRows(table, baseline->changedRows("memory"));
+        });
     }
 }
\ No newline at end of file
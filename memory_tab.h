@@ -3,13 +3,16 @@
 
 #include <QWidget>
 #include <QLabel>
-#include <QProgressBar>
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QPushButton>
 #include <QTableWidget>
 #include <QDialog>
-#include <QTimer>
+#include "sampler.h"
+#include "usage_bar.h"
+
+class QShowEvent;
+class QHideEvent;
 
 class GeekMemoryDialog : public QDialog
 {
@@ -19,6 +22,9 @@ public:
     void fillTable();
 
 private:
+    // Rows from `dmidecode -t memory` output.
+    void showModules(const QString& output);
+
     QTableWidget* table;
 };
 
@@ -28,26 +34,33 @@ class MemoryTab : public QWidget
 public:
     explicit MemoryTab(QWidget* parent = nullptr);
 
-    void updateMemoryInfo();
+    void updateMemoryInfo(const SamplePtr& sample);
+
+protected:
+    void showEvent(QShowEvent* ev) override;
+    void hideEvent(QHideEvent* ev) override;
+    bool eventFilter(QObject* watched, QEvent* event) override;
 
 private:
     // RAM widgets
     QLabel* ramTotalLabel;
-    QProgressBar* ramUsageBar;
+    UsageBar* ramUsageBar;
     QLabel* ramUsedLabel;
     QLabel* ramFreeLabel;
 
     // SWAP widgets
     QLabel* swapTotalLabel;
-    QProgressBar* swapUsageBar;
+    UsageBar* swapUsageBar;
     QLabel* swapUsedLabel;
     QLabel* swapFreeLabel;
 
     QPushButton* geekButton;
 
-    void setBarColor(QProgressBar* bar, int percent);
+    // The labels are indexed for search once; later ticks only change values.
+    bool searchPublished = false;
+
+    QString historyToolTip(bool swap) const;
     void showGeekMode();
-    QTimer* timer;
 };
 
 #endif // MEMORY_TAB_H
\ No newline at end of file
@@ -0,0 +1,394 @@
+#include "metrics_exporter.h"
+#include "log_helper.h"
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QMetaObject>
+#include <QPointer>
+#include <QStorageInfo>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QThreadPool>
+#include <QTimer>
+#include <cstdio>
+#include <unistd.h>
+
+namespace {
+
+constexpr int RequestTimeoutMs = 5000;
+constexpr qint64 MaxRequestLineBytes = 4096;
+
+quint64 clockTicksPerSecond()
+{
+    static const quint64 hz = [] {
+        const long ticks = sysconf(_SC_CLK_TCK);
+        return ticks > 0 ? quint64(ticks) : quint64(100);
+    }();
+    return hz;
+}
+
+void appendUInt(QByteArray& out, quint64 value)
+{
+    char digits[24];
+    char* p = digits + sizeof(digits);
+    do {
+        *--p = char('0' + value % 10);
+        value /= 10;
+    } while (value);
+    out.append(p, int(digits + sizeof(digits) - p));
+}
+
+// value / unit with three decimals, in integer arithmetic.
+void appendFixed(QByteArray& out, quint64 value, quint64 unit)
+{
+    appendUInt(out, value / unit);
+    const quint64 millis = (value % unit) * 1000 / unit;
+    const char fraction[4] = {'.', char('0' + millis / 100), char('0' + millis / 10 % 10), char('0' + millis % 10)};
+    out.append(fraction, 4);
+}
+
+void appendEscaped(QByteArray& out, char c)
+{
+    switch (c) {
+    case '\\': out.append("\\\\", 2); break;
+    case '"': out.append("\\\"", 2); break;
+    case '\n': out.append("\\n", 2); break;
+    default: out.append(c); break;
+    }
+}
+
+// A label value from a QString, UTF-8 encoded and escaped in place.
+void appendLabel(QByteArray& out, const QString& text)
+{
+    const QChar* p = text.constData();
+    const QChar* end = p + text.size();
+    while (p < end) {
+        char32_t c = p->unicode();
+        ++p;
+        if (c < 0x80) {
+            appendEscaped(out, char(c));
+            continue;
+        }
+        if (QChar::isHighSurrogate(c) && p < end && p->isLowSurrogate()) {
+            c = QChar::surrogateToUcs4(char16_t(c), p->unicode());
+            ++p;
+        }
+        if (c < 0x800) {
+            const char bytes[2] = {char(0xc0 | (c >> 6)), char(0x80 | (c & 0x3f))};
+            out.append(bytes, 2);
+        } else if (c < 0x10000) {
+            const char bytes[3] = {char(0xe0 | (c >> 12)), char(0x80 | ((c >> 6) & 0x3f)), char(0x80 | (c & 0x3f))};
+            out.append(bytes, 3);
+        } else {
+            const char bytes[4] = {char(0xf0 | (c >> 18)), char(0x80 | ((c >> 12) & 0x3f)),
+                                   char(0x80 | ((c >> 6) & 0x3f)), char(0x80 | (c & 0x3f))};
+            out.append(bytes, 4);
+        }
+    }
+}
+
+QByteArray escapeLabel(const QByteArray& utf8)
+{
+    QByteArray out;
+    out.reserve(utf8.size());
+    for (char c : utf8) appendEscaped(out, c);
+    return out;
+}
+
+void family(QByteArray& out, const char* name, const char* type, const char* help)
+{
+    out += "# HELP ";
+    out += name;
+    out += ' ';
+    out += help;
+    out += "\n# TYPE ";
+    out += name;
+    out += ' ';
+    out += type;
+    out += '\n';
+}
+
+void gauge(QByteArray& out, const char* name, const char* help, quint64 value)
+{
+    family(out, name, "gauge", help);
+    out += name;
+    out += ' ';
+    appendUInt(out, value);
+    out += '\n';
+}
+
+struct CpuMode {
+    const char* name;
+    quint64 CpuTimes::*ticks;
+};
+
+const CpuMode CpuModes[] = {
+    {"user", &CpuTimes::user},
+    {"nice", &CpuTimes::nice},
+    {"system", &CpuTimes::system},
+    {"idle", &CpuTimes::idle},
+    {"iowait", &CpuTimes::iowait},
+    {"irq", &CpuTimes::irq},
+    {"softirq", &CpuTimes::softirq},
+    {"steal", &CpuTimes::steal},
+};
+
+struct InterfaceCounter {
+    const char* name;
+    const char* help;
+    quint64 NetDevCounters::*value;
+};
+
+const InterfaceCounter InterfaceCounters[] = {
+    {"lsv_network_receive_bytes_total", "Bytes received, from /proc/net/dev.", &NetDevCounters::rxBytes},
+    {"lsv_network_receive_packets_total", "Packets received.", &NetDevCounters::rxPackets},
+    {"lsv_network_receive_errors_total", "Receive errors.", &NetDevCounters::rxErrors},
+    {"lsv_network_receive_drop_total", "Received packets dropped.", &NetDevCounters::rxDropped},
+    {"lsv_network_transmit_bytes_total", "Bytes transmitted.", &NetDevCounters::txBytes},
+    {"lsv_network_transmit_packets_total", "Packets transmitted.", &NetDevCounters::txPackets},
+    {"lsv_network_transmit_errors_total", "Transmit errors.", &NetDevCounters::txErrors},
+    {"lsv_network_transmit_drop_total", "Transmitted packets dropped.", &NetDevCounters::txDropped},
+};
+
+struct FilesystemValue {
+    const char* name;
+    const char* help;
+    quint64 FilesystemUsage::*value;
+};
+
+const FilesystemValue FilesystemValues[] = {
+    {"lsv_filesystem_size_bytes", "Filesystem size.", &FilesystemUsage::sizeBytes},
+    {"lsv_filesystem_free_bytes", "Free space, including space reserved for root.", &FilesystemUsage::freeBytes},
+    {"lsv_filesystem_avail_bytes", "Space available to unprivileged users.", &FilesystemUsage::availableBytes},
+};
+
+} // namespace
+
+QVector<FilesystemUsage> collectFilesystemUsage()
+{
+    QVector<FilesystemUsage> filesystems;
+    for (const QStorageInfo& storage : QStorageInfo::mountedVolumes()) {
+        if (!storage.isValid() || !storage.isReady()) continue;
+        const QByteArray device = storage.device();
+        const QByteArray fsType = storage.fileSystemType();
+        const QString mountPoint = storage.rootPath();
+        if (device.startsWith("/dev/loop") || device.startsWith("/dev/snap")
+            || fsType == "tmpfs" || fsType == "devtmpfs" || fsType == "sysfs" || fsType == "proc"
+            || fsType == "squashfs" || fsType == "overlay"
+            || mountPoint.startsWith("/snap/") || mountPoint.startsWith("/sys/")
+            || mountPoint.startsWith("/proc/") || mountPoint.startsWith("/dev/") || mountPoint.startsWith("/run/")) {
+            continue;
+        }
+        if (storage.bytesTotal() <= 0) continue;
+
+        FilesystemUsage usage;
+        usage.device = escapeLabel(device);
+        usage.mountPoint = escapeLabel(mountPoint.toUtf8());
+        usage.fsType = escapeLabel(fsType);
+        usage.sizeBytes = quint64(storage.bytesTotal());
+        usage.freeBytes = quint64(qMax<qint64>(0, storage.bytesFree()));
+        usage.availableBytes = quint64(qMax<qint64>(0, storage.bytesAvailable()));
+        filesystems.append(usage);
+    }
+    return filesystems;
+}
+
+void renderMetrics(QByteArray& out, const Sample* sample, const QVector<FilesystemUsage>& filesystems)
+{
+    if (sample) {
+        family(out, "lsv_sample_timestamp_seconds", "gauge", "When the sample being served was taken.");
+        out += "lsv_sample_timestamp_seconds ";
+        appendFixed(out, quint64(qMax<qint64>(0, sample->timestampMs)), 1000);
+        out += '\n';
+    }
+
+    if (sample && (sample->channels & Sampler::Cpu)) {
+        const quint64 hz = clockTicksPerSecond();
+        family(out, "lsv_cpu_seconds_total", "counter", "Time each CPU spent in each mode, from /proc/stat.");
+        for (int cpu = 0; cpu < sample->cpus.size(); ++cpu) {
+            const CpuTimes& times = sample->cpus[cpu];
+            for (const CpuMode& mode : CpuModes) {
+                out += "lsv_cpu_seconds_total{cpu=\"";
+                appendUInt(out, quint64(cpu));
+                out += "\",mode=\"";
+                out += mode.name;
+                out += "\"} ";
+                appendFixed(out, times.*mode.ticks, hz);
+                out += '\n';
+            }
+        }
+    }
+
+    if (sample && (sample->channels & Sampler::CpuFreq)) {
+        family(out, "lsv_cpu_frequency_hertz", "gauge", "Current CPU frequency, from cpufreq.");
+        for (int cpu = 0; cpu < sample->curFreqKHz.size(); ++cpu) {
+            const qint64 khz = sample->curFreqKHz[cpu];
+            if (khz <= 0) continue;
+            out += "lsv_cpu_frequency_hertz{cpu=\"";
+            appendUInt(out, quint64(cpu));
+            out += "\"} ";
+            appendUInt(out, quint64(khz) * 1000);
+            out += '\n';
+        }
+        if (sample->minFreqKHz > 0) gauge(out, "lsv_cpu_frequency_min_hertz", "Lowest frequency the CPUs run at.", quint64(sample->minFreqKHz) * 1000);
+        if (sample->maxFreqKHz > 0) gauge(out, "lsv_cpu_frequency_max_hertz", "Highest frequency the CPUs run at.", quint64(sample->maxFreqKHz) * 1000);
+    }
+
+    if (sample && (sample->channels & Sampler::Memory)) {
+        gauge(out, "lsv_memory_total_bytes", "MemTotal from /proc/meminfo.", sample->memTotal);
+        gauge(out, "lsv_memory_free_bytes", "MemFree from /proc/meminfo.", sample->memFree);
+        gauge(out, "lsv_memory_available_bytes", "MemAvailable from /proc/meminfo.", sample->memAvailable);
+        gauge(out, "lsv_memory_buffers_bytes", "Buffers from /proc/meminfo.", sample->buffers);
+        gauge(out, "lsv_memory_cached_bytes", "Cached from /proc/meminfo.", sample->cached);
+        gauge(out, "lsv_swap_total_bytes", "SwapTotal from /proc/meminfo.", sample->swapTotal);
+        gauge(out, "lsv_swap_free_bytes", "SwapFree from /proc/meminfo.", sample->swapFree);
+    }
+
+    if (sample && (sample->channels & Sampler::Network)) {
+        for (const InterfaceCounter& counter : InterfaceCounters) {
+            family(out, counter.name, "counter", counter.help);
+            for (const NetDevCounters& interface : sample->interfaces) {
+                out += counter.name;
+                out += "{interface=\"";
+                appendLabel(out, interface.name);
+                out += "\"} ";
+                appendUInt(out, interface.*counter.value);
+                out += '\n';
+            }
+        }
+    }
+
+    if (!filesystems.isEmpty()) {
+        for (const FilesystemValue& value : FilesystemValues) {
+            family(out, value.name, "gauge", value.help);
+            for (const FilesystemUsage& fs : filesystems) {
+                out += value.name;
+                out += "{device=\"";
+                out += fs.device;
+                out += "\",mountpoint=\"";
+                out += fs.mountPoint;
+                out += "\",fstype=\"";
+                out += fs.fsType;
+                out += "\"} ";
+                appendUInt(out, fs.*value.value);
+                out += '\n';
+            }
+        }
+    }
+}
+
+MetricsExporter::MetricsExporter(QObject* parent)
+    : QObject(parent)
+    , m_server(new QTcpServer(this))
+    , m_filesystemTimer(new QTimer(this))
+{
+    connect(m_server, &QTcpServer::newConnection, this, &MetricsExporter::onNewConnection);
+    m_filesystemTimer->setTimerType(Qt::VeryCoarseTimer);
+    connect(m_filesystemTimer, &QTimer::timeout, this, &MetricsExporter::refreshFilesystems);
+}
+
+MetricsExporter::~MetricsExporter()
+{
+    Sampler::instance()->unsubscribe(this);
+}
+
+bool MetricsExporter::listen(quint16 port, const QHostAddress& address)
+{
+    if (!m_server->listen(address, port)) {
+        m_error = QString("cannot listen on %1:%2: %3").arg(address.toString()).arg(port).arg(m_server->errorString());
+        return false;
+    }
+    // Scrapes read whatever the sampler took last; keep it ticking.
+    Sampler::instance()->subscribe(this, Sampler::Cpu | Sampler::Memory | Sampler::Network | Sampler::CpuFreq,
+                                   Sampler::Background);
+    refreshFilesystems();
+    m_filesystemTimer->start(FilesystemIntervalMs);
+    appendLog(QString("MetricsExporter: serving /metrics on %1:%2").arg(address.toString()).arg(this->port()));
+    return true;
+}
+
+quint16 MetricsExporter::port() const
+{
+    return m_server->serverPort();
+}
+
+void MetricsExporter::onNewConnection()
+{
+    while (QTcpSocket* socket = m_server->nextPendingConnection()) {
+        connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+        connect(socket, &QTcpSocket::readyRead, this, [this, socket]() { onReadyRead(socket); });
+        // Nobody gets to hold a connection open.
+        QTimer::singleShot(RequestTimeoutMs, socket, [socket]() { socket->abort(); });
+    }
+}
+
+void MetricsExporter::onReadyRead(QTcpSocket* socket)
+{
+    if (!socket->canReadLine()) {
+        if (socket->bytesAvailable() > MaxRequestLineBytes) socket->abort();
+        return;
+    }
+    // Only the request line matters; the response closes the connection.
+    const QByteArray line = socket->readLine(MaxRequestLineBytes).trimmed();
+    socket->disconnect(this);
+
+    const QList<QByteArray> parts = line.split(' ');
+    const QByteArray method = parts.value(0);
+    QByteArray path = parts.value(1);
+    const int query = path.indexOf('?');
+    if (query >= 0) path.truncate(query);
+
+    if (method != "GET" && method != "HEAD") {
+        respond(socket, "405 Method Not Allowed", false, false);
+    } else if (path == "/metrics") {
+        respond(socket, "200 OK", method == "HEAD", true);
+    } else {
+        respond(socket, "404 Not Found", method == "HEAD", false);
+    }
+}
+
+void MetricsExporter::respond(QTcpSocket* socket, const char* status, bool headOnly, bool metrics)
+{
+    static const QVector<FilesystemUsage> noFilesystems;
+
+    QElapsedTimer clock;
+    clock.start();
+    m_body.resize(0);   // keeps the capacity of earlier scrapes
+    if (metrics) {
+        const SamplePtr sample = Sampler::instance()->latest();
+        renderMetrics(m_body, sample.get(), m_filesystems ? *m_filesystems : noFilesystems);
+    } else {
+        m_body += status;
+        m_body += '\n';
+    }
+    const qint64 renderUs = clock.nsecsElapsed() / 1000;
+
+    char header[256];
+    const int n = std::snprintf(header, sizeof(header),
+                                "HTTP/1.1 %s\r\nContent-Type: %s\r\nContent-Length: %lld\r\nConnection: close\r\n\r\n",
+                                status, metrics ? "text/plain; version=0.0.4; charset=utf-8" : "text/plain; charset=utf-8",
+                                static_cast<long long>(m_body.size()));
+    socket->write(header, qMin(n, int(sizeof(header)) - 1));
+    // Written by pointer so the socket copies the bytes instead of sharing
+    // m_body, which would make the next scrape reallocate it.
+    if (!headOnly) socket->write(m_body.constData(), m_body.size());
+    socket->disconnectFromHost();
+
+    LSV_LOG_DEBUG("metrics", QString("MetricsExporter: %1, %2 bytes rendered in %3 us")
+                  .arg(QLatin1String(status)).arg(m_body.size()).arg(renderUs));
+}
+
+void MetricsExporter::refreshFilesystems()
+{
+    if (m_refreshing) return;
+    m_refreshing = true;
+
+    QPointer<MetricsExporter> self(this);
+    QThreadPool::globalInstance()->start([self]() {
+        FilesystemList filesystems = std::make_shared<const QVector<FilesystemUsage>>(collectFilesystemUsage());
+        QMetaObject::invokeMethod(QCoreApplication::instance(), [self, filesystems]() {
+            if (!self) return;
+            self->m_filesystems = filesystems;
+            self->m_refreshing = false;
+        }, Qt::QueuedConnection);
+    });
+}
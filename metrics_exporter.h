@@ -0,0 +1,79 @@
+#ifndef METRICS_EXPORTER_H
+#define METRICS_EXPORTER_H
+
+#include <QByteArray>
+#include <QHostAddress>
+#include <QObject>
+#include <QString>
+#include <QVector>
+#include <memory>
+#include "sampler.h"
+
+class QTcpServer;
+class QTcpSocket;
+class QTimer;
+
+// One mounted filesystem as exported. The label values are kept escaped,
+// ready to be copied into the output.
+struct FilesystemUsage {
+    QByteArray device;
+    QByteArray mountPoint;
+    QByteArray fsType;
+    quint64 sizeBytes = 0;
+    quint64 freeBytes = 0;
+    quint64 availableBytes = 0;
+};
+
+using FilesystemList = std::shared_ptr<const QVector<FilesystemUsage>>;
+
+// Mounted filesystems worth exporting: no pseudo, loop or snap mounts.
+// statfs() can hang on a dead network mount, so call it off the thread
+// that serves scrapes.
+QVector<FilesystemUsage> collectFilesystemUsage();
+
+// Prometheus text exposition (format 0.0.4) of a sample and the
+// filesystems, appended to out. Numbers and labels are written straight
+// into out, so once out has grown to size rendering does not allocate.
+// sample may be null before the sampler's first tick.
+void renderMetrics(QByteArray& out, const Sample* sample, const QVector<FilesystemUsage>& filesystems);
+
+// Optional HTTP endpoint serving GET /metrics (lsv-agentd --metrics-port).
+//
+// A scrape only formats what is already there: the Sampler's latest
+// sample (CPU times and frequencies, memory and swap, interface counters)
+// and a filesystem list refreshed on the thread pool every
+// FilesystemIntervalMs. Scrape time therefore does not depend on how long
+// collection takes, and a slow mount never stalls a scrape. The output
+// buffer is reused between scrapes.
+//
+// Binds to localhost by default. There is no TLS or authentication; put a
+// proxy in front to expose it further.
+class MetricsExporter : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr int FilesystemIntervalMs = 15000;
+
+    explicit MetricsExporter(QObject* parent = nullptr);
+    ~MetricsExporter() override;
+
+    bool listen(quint16 port, const QHostAddress& address = QHostAddress::LocalHost);
+    QString errorString() const { return m_error; }
+    quint16 port() const;
+
+private:
+    void onNewConnection();
+    void onReadyRead(QTcpSocket* socket);
+    void respond(QTcpSocket* socket, const char* status, bool headOnly, bool metrics);
+    void refreshFilesystems();
+
+    QTcpServer* m_server = nullptr;
+    QTimer* m_filesystemTimer = nullptr;
+    FilesystemList m_filesystems;
+    bool m_refreshing = false;
+    QByteArray m_body;          // reused between scrapes
+    QString m_error;
+};
+
+#endif // METRICS_EXPORTER_H
@@ -1,4 +1,5 @@
 #include "motherboard_tab.h"
+#include "lsv_style.h"
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QLabel>
@@ -13,6 +14,7 @@ MotherboardTab::MotherboardTab(QWidget* parent)
                     "lshw -C bus && dmidecode -t baseboard 2>/dev/null && dmidecode -t system 2>/dev/null", parent)
 {
     qDebug() << "MotherboardTab: Constructor called - base constructor done";
+    useLshwProbe("bus");
     initializeTab();
     qDebug() << "MotherboardTab: Constructor finished";
 }
@@ -57,29 +59,7 @@ QWidget* MotherboardTab::createUserFriendlyView()
 
 void MotherboardTab::createInfoSection(const QString& title, QGroupBox** groupBox, QLabel** contentLabel, QVBoxLayout* parentLayout)
 {
-    *groupBox = new QGroupBox(title);
-    (*groupBox)->setStyleSheet(
-        "QGroupBox {"
-        "  font-weight: bold;"
-        "  border: 2px solid #bdc3c7;"
-        "  border-radius: 8px;"
-        "  margin-top: 10px;"
-        "  padding-top: 10px;"
-        "}"
-        "QGroupBox::title {"
-        "  subcontrol-origin: margin;"
-        "  left: 10px;"
-        "  padding: 0 10px 0 10px;"
-        "}"
-    );
-    
-    QVBoxLayout* sectionLayout = new QVBoxLayout(*groupBox);
-    *contentLabel = new QLabel("Loading " + title.toLower() + " information...");
-    (*contentLabel)->setWordWrap(true);
-    (*contentLabel)->setStyleSheet("QLabel { padding: 10px; background-color: #f8f9fa; border-radius: 4px; }");
-    sectionLayout->addWidget(*contentLabel);
-    
-    parentLayout->addWidget(*groupBox);
+    *groupBox = ::createInfoSection(title, contentLabel, parentLayout, "Loading " + title.toLower() + " information...");
 }
 
 void MotherboardTab::parseOutput(const QString& output)
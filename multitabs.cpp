@@ -11,7 +11,7 @@
 #include <QApplication>
 
 MultiRowTabWidget::MultiRowTabWidget(QWidget* parent)
-    : QWidget(parent), m_currentIndex(-1)
+    : QWidget(parent), m_currentIndex(-1), m_prefetchTimer(nullptr)
 {
     setupUI();
     qDebug() << "MultiRowTabWidget: Initialized";
@@ -50,7 +50,7 @@ QSize MultiRowTabWidget::calculateOptimalSize()
     return QSize(850, 480);
 }
 
-void MultiRowTabWidget::addTab(QWidget* widget, const QString& title)
+QPushButton* MultiRowTabWidget::createTabButton(const QString& title)
 {
     QPushButton* button = new QPushButton(title);
     button->setCheckable(true);
@@ -79,6 +79,13 @@ void MultiRowTabWidget::addTab(QWidget* widget, const QString& title)
     
     connect(button, &QPushButton::clicked, this, &MultiRowTabWidget::onTabButtonClicked);
     
+    return button;
+}
+
+void MultiRowTabWidget::addTab(QWidget* widget, const QString& title)
+{
+    QPushButton* button = createTabButton(title);
+    
     m_tabs.append(TabInfo(title, widget, button));
     m_stackedWidget->addWidget(widget);
     
@@ -91,6 +98,81 @@ void MultiRowTabWidget::addTab(QWidget* widget, const QString& title)
     qDebug() << "MultiRowTabWidget: Added tab" << title << "Total tabs:" << m_tabs.size();
 }
 
+void MultiRowTabWidget::addLazyTab(const QString& title, TabFactory factory)
+{
+    QPushButton* button = createTabButton(title);
+    
+    // A bare QWidget costs next to nothing; the real tab replaces it in the
+    // stack when it is built.
+    QWidget* placeholder = new QWidget();
+    m_tabs.append(TabInfo(title, placeholder, button, std::move(factory)));
+    m_stackedWidget->addWidget(placeholder);
+    
+    updateTabLayout();
+    
+    if (m_currentIndex == -1) {
+        setCurrentIndex(0);
+    }
+    
+    qDebug() << "MultiRowTabWidget: Added lazy tab" << title << "Total tabs:" << m_tabs.size();
+}
+
+QWidget* MultiRowTabWidget::ensureWidget(int index)
+{
+    if (index < 0 || index >= m_tabs.size()) {
+        return nullptr;
+    }
+    if (!m_tabs[index].factory) {
+        return m_tabs[index].widget;
+    }
+    
+    // Take the factory out first so a re-entrant call cannot build twice.
+    TabFactory factory = std::move(m_tabs[index].factory);
+    m_tabs[index].factory = TabFactory();
+    
+    qDebug() << "MultiRowTabWidget: Building tab" << m_tabs[index].title;
+    QWidget* widget = factory();
+    if (!widget) {
+        qDebug() << "MultiRowTabWidget: Factory returned no widget for" << m_tabs[index].title;
+        return m_tabs[index].widget; // keep the placeholder
+    }
+    
+    QWidget* placeholder = m_tabs[index].widget;
+    const bool wasCurrent = (m_stackedWidget->currentWidget() == placeholder);
+    m_stackedWidget->insertWidget(index, widget);
+    m_stackedWidget->removeWidget(placeholder);
+    placeholder->deleteLater();
+    m_tabs[index].widget = widget;
+    if (wasCurrent) {
+        m_stackedWidget->setCurrentIndex(index);
+    }
+    
+    return widget;
+}
+
+void MultiRowTabWidget::startIdlePrefetch(int delayMs)
+{
+    if (!m_prefetchTimer) {
+        m_prefetchTimer = new QTimer(this);
+        m_prefetchTimer->setSingleShot(true);
+        connect(m_prefetchTimer, &QTimer::timeout, this, &MultiRowTabWidget::prefetchNext);
+    }
+    m_prefetchTimer->start(delayMs);
+}
+
+void MultiRowTabWidget::prefetchNext()
+{
+    // One tab per event-loop pass, so clicks and repaints get in between.
+    for (int i = 0; i < m_tabs.size(); ++i) {
+        if (m_tabs[i].factory) {
+            ensureWidget(i);
+            m_prefetchTimer->start(0);
+            return;
+        }
+    }
+    qDebug() << "MultiRowTabWidget: Idle prefetch finished";
+}
+
 void MultiRowTabWidget::updateTabLayout()
 {
     if (m_tabs.isEmpty()) return;
@@ -180,6 +262,7 @@ void MultiRowTabWidget::setCurrentIndex(int index)
     }
     
     m_currentIndex = index;
+    ensureWidget(index);
     m_stackedWidget->setCurrentIndex(index);
     updateTabStyling();
     
@@ -214,9 +297,13 @@ void MultiRowTabWidget::removeTab(int index)
     
     QWidget* widget = m_tabs[index].widget;
     QPushButton* button = m_tabs[index].button;
+    const bool placeholder = static_cast<bool>(m_tabs[index].factory);
     
     m_tabs.removeAt(index);
     m_stackedWidget->removeWidget(widget);
+    if (placeholder) {
+        delete widget;
+    }
     
     delete button;
     
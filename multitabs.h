@@ -11,14 +11,19 @@
 #include <QResizeEvent>
 #include <QScreen>
 #include <QApplication>
+#include <functional>
+
+// Builds the real widget of a lazily added tab.
+using TabFactory = std::function<QWidget*()>;
 
 struct TabInfo {
     QString title;
     QWidget* widget;
     QPushButton* button;
+    TabFactory factory;     // set while the tab is still a placeholder
     
-    TabInfo(const QString& t, QWidget* w, QPushButton* b) 
-        : title(t), widget(w), button(b) {}
+    TabInfo(const QString& t, QWidget* w, QPushButton* b, TabFactory f = TabFactory()) 
+        : title(t), widget(w), button(b), factory(std::move(f)) {}
 };
 
 class MultiRowTabWidget : public QWidget
@@ -29,6 +34,14 @@ public:
     explicit MultiRowTabWidget(QWidget* parent = nullptr);
     
     void addTab(QWidget* widget, const QString& title);
+    // Register a tab whose widget is only built by factory when the tab is
+    // first shown or reached by idle prefetch. Until then the stack holds an
+    // empty placeholder.
+    void addLazyTab(const QString& title, TabFactory factory);
+    // Build the widget of a lazy tab now. Returns the real widget.
+    QWidget* ensureWidget(int index);
+    // After delayMs, build the remaining lazy tabs one per idle cycle.
+    void startIdlePrefetch(int delayMs = 1500);
     void setCurrentIndex(int index);
     int currentIndex() const;
     int count() const;
@@ -45,10 +58,12 @@ protected:
 private slots:
     void onTabButtonClicked();
     void updateTabLayout();
+    void prefetchNext();
 
 private:
     void setupUI();
     void updateTabStyling();
+    QPushButton* createTabButton(const QString& title);
     QSize calculateOptimalSize();
     
     QVBoxLayout* m_mainLayout;
@@ -59,6 +74,7 @@ private:
     
     QList<TabInfo> m_tabs;
     int m_currentIndex;
+    QTimer* m_prefetchTimer;
 };
 
 #endif // MULTITABS_H
\ No newline at end of file
@@ -1,8 +1,6 @@
 #ifndef NETWORK_H
 #define NETWORK_H
 
-#include <QTableWidget>
-#include <QTableWidgetItem>
 #include <QJsonObject>
 #include <QFile>
 #include <QTextStream>
@@ -10,20 +8,34 @@
 #include <QStringList>
 #include <QDebug>
 #include <QDir>
-#include <QProcess>
+#include <QMap>
+#include <QtEndian>  // For qFromBigEndian
+#include <ifaddrs.h>
+#include <net/if.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include "info_rows.h"
+#include "procfs_parser.h"
+#ifndef LSV_CORE_ONLY
+#include <QTableWidget>
+#include <QTableWidgetItem>
 #include <QNetworkInterface>
 #include <QHostAddress>
-#include <QtEndian>  // For qFromBigEndian
 #include "gui_helpers.h"
+#endif
 
 // Forward declaration of formatBytes
 QString formatBytes(long long bytes);
 
 // Network information functions
+InfoRows collectNetworkInformation();
+#ifndef LSV_CORE_ONLY
 void loadNetworkInformation(QTableWidget* table, const QJsonObject& data);
 void styleNetworkTable(QTableWidget* table);
 QString getNetworkInfo();
+#endif
 
+#ifndef LSV_CORE_ONLY
 // Network Table Styling
 inline void styleNetworkTable(QTableWidget* table)
 {
@@ -45,6 +57,8 @@ inline void styleNetworkTable(QTableWidget* table)
     );
 }
 
+#endif // LSV_CORE_ONLY
+
 // Helper function to format bytes - moved to top
 inline QString formatBytes(long long bytes)
 {
@@ -60,165 +74,185 @@ inline QString formatBytes(long long bytes)
     return QString("%1 %2").arg(QString::number(size, 'f', 2)).arg(units[unitIndex]);
 }
 
-// Load Network Information
-inline void loadNetworkInformation(QTableWidget* table, const QJsonObject& data)
+// Address of a sockaddr as text, the way QHostAddress::toString() prints it
+// (link-local IPv6 addresses carry their interface as scope id).
+inline QString socketAddressToString(const struct sockaddr* addr, const QString& interfaceName)
 {
-    Q_UNUSED(data); // Use direct system calls instead of JSON data
+    char buffer[INET6_ADDRSTRLEN] = {0};
+    if (!addr) return QString();
+    if (addr->sa_family == AF_INET) {
+        const auto* in = reinterpret_cast<const struct sockaddr_in*>(addr);
+        if (!inet_ntop(AF_INET, &in->sin_addr, buffer, sizeof(buffer))) return QString();
+        return QString::fromLatin1(buffer);
+    }
+    if (addr->sa_family == AF_INET6) {
+        const auto* in6 = reinterpret_cast<const struct sockaddr_in6*>(addr);
+        if (!inet_ntop(AF_INET6, &in6->sin6_addr, buffer, sizeof(buffer))) return QString();
+        QString text = QString::fromLatin1(buffer);
+        if (IN6_IS_ADDR_LINKLOCAL(&in6->sin6_addr)) text += "%" + interfaceName;
+        return text;
+    }
+    return QString();
+}
+
+// Collect Network Information
+//
+// Interfaces come from /sys/class/net and getifaddrs() rather than
+// QNetworkInterface, so this works with Qt Core alone.
+inline InfoRows collectNetworkInformation()
+{
+    InfoRows rows;
     
-    table->setRowCount(0);
+    // One buffer for every /sys and /proc file read below.
+    procfs::FileBuffer buffer;
+    auto readSysValue = [&buffer](const QString& interfaceName, const char* attribute) {
+        std::string_view value;
+        const QByteArray path = QString("/sys/class/net/%1/%2").arg(interfaceName, attribute).toLocal8Bit();
+        if (!procfs::readValue(buffer, path.constData(), value)) return QString();
+        return procfs::toQString(value);
+    };
     
-    // Get network interfaces using Qt
-    QList<QNetworkInterface> interfaces = QNetworkInterface::allInterfaces();
+    // Interfaces in kernel (ifindex) order, like QNetworkInterface lists them.
+    // sysfs has the index as an attribute; if_nametoindex() would open a
+    // socket per interface.
+    QMap<int, QString> interfacesByIndex;
+    const QStringList netEntries = QDir(procfs::hostPath("/sys/class/net")).entryList(QDir::Dirs | QDir::NoDotAndDotDot | QDir::System);
+    for (const QString& name : netEntries) {
+        interfacesByIndex.insert(readSysValue(name, "ifindex").toInt(), name);
+    }
     
-    for (const QNetworkInterface& interface : interfaces) {
-        QString interfaceName = interface.name();
-        QString displayName = interface.humanReadableName();
-        
+    struct ifaddrs* addressList = nullptr;
+    if (getifaddrs(&addressList) != 0) addressList = nullptr;
+    
+    for (const QString& interfaceName : interfacesByIndex) {
         // Skip loopback if it's just "lo"
         if (interfaceName == "lo") continue;
         
-    addRowToTable(table, QStringList() << QString("Interface: %1").arg(interfaceName) << displayName);
+        rows.append(QStringList() << QString("Interface: %1").arg(interfaceName) << interfaceName);
         
         // Interface flags
-        QNetworkInterface::InterfaceFlags flags = interface.flags();
+        bool ok = false;
+        const uint flags = readSysValue(interfaceName, "flags").toUInt(&ok, 16);
         QStringList flagsList;
-        if (flags & QNetworkInterface::IsUp) flagsList << "UP";
-        if (flags & QNetworkInterface::IsRunning) flagsList << "RUNNING";
-        if (flags & QNetworkInterface::CanBroadcast) flagsList << "BROADCAST";
-        if (flags & QNetworkInterface::IsLoopBack) flagsList << "LOOPBACK";
-        if (flags & QNetworkInterface::IsPointToPoint) flagsList << "POINTOPOINT";
-        if (flags & QNetworkInterface::CanMulticast) flagsList << "MULTICAST";
+        if (ok) {
+            if (flags & IFF_UP) flagsList << "UP";
+            if (flags & IFF_RUNNING) flagsList << "RUNNING";
+            if (flags & IFF_BROADCAST) flagsList << "BROADCAST";
+            if (flags & IFF_LOOPBACK) flagsList << "LOOPBACK";
+            if (flags & IFF_POINTOPOINT) flagsList << "POINTOPOINT";
+            if (flags & IFF_MULTICAST) flagsList << "MULTICAST";
+        }
         
         if (!flagsList.isEmpty()) {
-            addRowToTable(table, QStringList() << QString("  %1 Flags").arg(interfaceName) << flagsList.join(", "));
+            rows.append(QStringList() << QString("  %1 Flags").arg(interfaceName) << flagsList.join(", "));
         }
         
         // MAC Address
-        QString macAddress = interface.hardwareAddress();
-        if (!macAddress.isEmpty()) {
-            addRowToTable(table, QStringList() << QString("  %1 MAC").arg(interfaceName) << macAddress);
+        QString macAddress = readSysValue(interfaceName, "address").toUpper();
+        if (!macAddress.isEmpty() && macAddress != "00:00:00:00:00:00") {
+            rows.append(QStringList() << QString("  %1 MAC").arg(interfaceName) << macAddress);
         }
         
         // IP Addresses
-        QList<QNetworkAddressEntry> addresses = interface.addressEntries();
-        for (const QNetworkAddressEntry& entry : addresses) {
-            QHostAddress ip = entry.ip();
-                if (ip.protocol() == QAbstractSocket::IPv4Protocol) {
-                addRowToTable(table, QStringList() << QString("  %1 IPv4").arg(interfaceName) << ip.toString());
+        const QByteArray nameBytes = interfaceName.toLocal8Bit();
+        for (struct ifaddrs* ifa = addressList; ifa; ifa = ifa->ifa_next) {
+            if (!ifa->ifa_addr || nameBytes != ifa->ifa_name) continue;
+            if (ifa->ifa_addr->sa_family == AF_INET) {
+                rows.append(QStringList() << QString("  %1 IPv4").arg(interfaceName) << socketAddressToString(ifa->ifa_addr, interfaceName));
                 
-                QHostAddress netmask = entry.netmask();
-                if (!netmask.isNull()) {
-                    addRowToTable(table, QStringList() << QString("  %1 Netmask").arg(interfaceName) << netmask.toString());
+                QString netmask = socketAddressToString(ifa->ifa_netmask, interfaceName);
+                if (!netmask.isEmpty()) {
+                    rows.append(QStringList() << QString("  %1 Netmask").arg(interfaceName) << netmask);
                 }
                 
-                QHostAddress broadcast = entry.broadcast();
-                if (!broadcast.isNull()) {
-                    addRowToTable(table, QStringList() << QString("  %1 Broadcast").arg(interfaceName) << broadcast.toString());
+                if (ifa->ifa_flags & IFF_BROADCAST) {
+                    QString broadcast = socketAddressToString(ifa->ifa_broadaddr, interfaceName);
+                    if (!broadcast.isEmpty()) {
+                        rows.append(QStringList() << QString("  %1 Broadcast").arg(interfaceName) << broadcast);
+                    }
                 }
-            } else if (ip.protocol() == QAbstractSocket::IPv6Protocol) {
-                addRowToTable(table, QStringList() << QString("  %1 IPv6").arg(interfaceName) << ip.toString() << "" << "Network");
+            } else if (ifa->ifa_addr->sa_family == AF_INET6) {
+                rows.append(QStringList() << QString("  %1 IPv6").arg(interfaceName) << socketAddressToString(ifa->ifa_addr, interfaceName) << "" << "Network");
             }
         }
         
         // MTU
-        int mtu = interface.maximumTransmissionUnit();
+        int mtu = readSysValue(interfaceName, "mtu").toInt();
         if (mtu > 0) {
-            addRowToTable(table, QStringList() << QString("  %1 MTU").arg(interfaceName) << QString("%1 bytes").arg(QString::number(mtu)));
+            rows.append(QStringList() << QString("  %1 MTU").arg(interfaceName) << QString("%1 bytes").arg(QString::number(mtu)));
         }
     }
     
+    if (addressList) freeifaddrs(addressList);
+    
     // Read network statistics from /proc/net/dev
-    QFile netDevFile("/proc/net/dev");
-    if (netDevFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        QTextStream stream(&netDevFile);
-        QStringList lines = stream.readAll().split('\n');
-        netDevFile.close();
-        
-        // Skip header lines
-        for (int i = 2; i < lines.size(); ++i) {
-            QString line = lines[i].trimmed();
-            if (line.isEmpty()) continue;
-            
-            QStringList parts = line.split(QRegularExpression("\\s+"));
-            if (parts.size() >= 17) {
-                QString interfaceName = parts[0];
-                interfaceName.chop(1); // Remove trailing ':'
-                
-                if (interfaceName == "lo") continue; // Skip loopback
-                
-                // Received bytes, packets, errors, dropped
-                long long rxBytes = parts[1].toLongLong();
-                long long rxPackets = parts[2].toLongLong();
-                long long rxErrors = parts[3].toLongLong();
-                long long rxDropped = parts[4].toLongLong();
-                
-                // Transmitted bytes, packets, errors, dropped  
-                long long txBytes = parts[9].toLongLong();
-                long long txPackets = parts[10].toLongLong();
-                long long txErrors = parts[11].toLongLong();
-                long long txDropped = parts[12].toLongLong();
-                
-                // Convert bytes to human readable format
-                QString rxBytesStr = formatBytes(rxBytes);
-                QString txBytesStr = formatBytes(txBytes);
-                
-                addRowToTable(table, QStringList() << QString("  %1 RX Bytes").arg(interfaceName) << rxBytesStr);
-                addRowToTable(table, QStringList() << QString("  %1 RX Packets").arg(interfaceName) << QString::number(rxPackets));
-                if (rxErrors > 0) {
-                    addRowToTable(table, QStringList() << QString("  %1 RX Errors").arg(interfaceName) << QString::number(rxErrors));
-                }
-                if (rxDropped > 0) {
-                    addRowToTable(table, QStringList() << QString("  %1 RX Dropped").arg(interfaceName) << QString::number(rxDropped));
-                }
+    if (buffer.read("/proc/net/dev")) {
+        procfs::parseNetDev(buffer.view(), [&rows](const procfs::NetDevLine& dev) {
+            if (dev.name == "lo") return; // Skip loopback
+            const QString interfaceName = procfs::toQString(dev.name);
 
-                addRowToTable(table, QStringList() << QString("  %1 TX Bytes").arg(interfaceName) << txBytesStr);
-                addRowToTable(table, QStringList() << QString("  %1 TX Packets").arg(interfaceName) << QString::number(txPackets));
-                if (txErrors > 0) {
-                    addRowToTable(table, QStringList() << QString("  %1 TX Errors").arg(interfaceName) << QString::number(txErrors));
-                }
-                if (txDropped > 0) {
-                    addRowToTable(table, QStringList() << QString("  %1 TX Dropped").arg(interfaceName) << QString::number(txDropped));
-                }
+            // Received bytes, packets, errors, dropped
+            const long long rxBytes = dev.rx[0];
+            const long long rxPackets = dev.rx[1];
+            const long long rxErrors = dev.rx[2];
+            const long long rxDropped = dev.rx[3];
+
+            // Transmitted bytes, packets, errors, dropped
+            const long long txBytes = dev.tx[0];
+            const long long txPackets = dev.tx[1];
+            const long long txErrors = dev.tx[2];
+            const long long txDropped = dev.tx[3];
+
+            rows.append(QStringList() << QString("  %1 RX Bytes").arg(interfaceName) << formatBytes(rxBytes));
+            rows.append(QStringList() << QString("  %1 RX Packets").arg(interfaceName) << QString::number(rxPackets));
+            if (rxErrors > 0) {
+                rows.append(QStringList() << QString("  %1 RX Errors").arg(interfaceName) << QString::number(rxErrors));
             }
-        }
+            if (rxDropped > 0) {
+                rows.append(QStringList() << QString("  %1 RX Dropped").arg(interfaceName) << QString::number(rxDropped));
+            }
+
+            rows.append(QStringList() << QString("  %1 TX Bytes").arg(interfaceName) << formatBytes(txBytes));
+            rows.append(QStringList() << QString("  %1 TX Packets").arg(interfaceName) << QString::number(txPackets));
+            if (txErrors > 0) {
+                rows.append(QStringList() << QString("  %1 TX Errors").arg(interfaceName) << QString::number(txErrors));
+            }
+            if (txDropped > 0) {
+                rows.append(QStringList() << QString("  %1 TX Dropped").arg(interfaceName) << QString::number(txDropped));
+            }
+        });
     }
     
     // Get default route information
-    QFile routeFile("/proc/net/route");
-    if (routeFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        QTextStream stream(&routeFile);
-        QStringList lines = stream.readAll().split('\n');
-        routeFile.close();
-        
-        for (int i = 1; i < lines.size(); ++i) { // Skip header
-            QString line = lines[i].trimmed();
-            if (line.isEmpty()) continue;
-            
-            QStringList parts = line.split('\t');
-            if (parts.size() >= 8) {
-                QString iface = parts[0];
-                QString destination = parts[1];
-                QString gateway = parts[2];
-                QString flags = parts[3];
-                
-                // Check if this is the default route (destination 00000000)
-                if (destination == "00000000") {
-                    // Convert gateway from hex to IP
-                    bool ok;
-                    quint32 gwHex = gateway.toUInt(&ok, 16);
-                    if (ok) {
-                        QHostAddress gwAddr(qFromLittleEndian(gwHex));
-                        addRowToTable(table, QStringList() << "Default Gateway" << gwAddr.toString());
-                        addRowToTable(table, QStringList() << "Default Interface" << iface);
-                    }
-                    break;
-                }
+    if (buffer.read("/proc/net/route")) {
+        std::string_view content = buffer.view();
+        std::string_view line;
+        procfs::nextLine(content, line); // Skip header
+        while (procfs::nextLine(content, line)) {
+            std::string_view iface, destination, gateway;
+            if (!procfs::nextField(line, iface) || !procfs::nextField(line, destination)
+                || !procfs::nextField(line, gateway)) continue;
+
+            // Check if this is the default route (destination 00000000)
+            if (destination != "00000000") continue;
+
+            // Convert gateway from hex to IP
+            quint32 gwHex = 0;
+            const auto parsed = std::from_chars(gateway.data(), gateway.data() + gateway.size(), gwHex, 16);
+            if (parsed.ec == std::errc()) {
+                // The kernel prints the address in network byte
+                // order, i.e. the first octet is the lowest byte.
+                QString gwAddr = QString("%1.%2.%3.%4").arg(gwHex & 0xff).arg((gwHex >> 8) & 0xff)
+                                                       .arg((gwHex >> 16) & 0xff).arg((gwHex >> 24) & 0xff);
+                rows.append(QStringList() << "Default Gateway" << gwAddr);
+                rows.append(QStringList() << "Default Interface" << procfs::toQString(iface));
             }
+            break;
         }
     }
     
     // Get DNS servers from /etc/resolv.conf
-    QFile resolvFile("/etc/resolv.conf");
+    QFile resolvFile(procfs::hostPath("/etc/resolv.conf"));
     if (resolvFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
         QTextStream stream(&resolvFile);
         QStringList lines = stream.readAll().split('\n');
@@ -233,21 +267,31 @@ inline void loadNetworkInformation(QTableWidget* table, const QJsonObject& data)
         }
         
         if (!dnsServers.isEmpty()) {
-            addRowToTable(table, QStringList() << "DNS Servers" << dnsServers.join(", ") << "" << "Network");
+            rows.append(QStringList() << "DNS Servers" << dnsServers.join(", ") << "" << "Network");
         }
     }
     
     // Get hostname
-    QFile hostnameFile("/proc/sys/kernel/hostname");
+    QFile hostnameFile(procfs::hostPath("/proc/sys/kernel/hostname"));
     if (hostnameFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
         QTextStream stream(&hostnameFile);
         QString hostname = stream.readLine().trimmed();
         hostnameFile.close();
         
         if (!hostname.isEmpty()) {
-            addRowToTable(table, QStringList() << "Hostname" << hostname << "" << "Network");
+            rows.append(QStringList() << "Hostname" << hostname << "" << "Network");
         }
     }
+    return rows;
+}
+
+#ifndef LSV_CORE_ONLY
+// Load Network Information
+inline void loadNetworkInformation(QTableWidget* table, const QJsonObject& data)
+{
+    Q_UNUSED(data); // Use direct system calls instead of JSON data
+    table->setRowCount(0);
+    addRowsToTable(table, collectNetworkInformation());
 }
 
 // Get basic network info string
@@ -271,5 +315,6 @@ inline QString getNetworkInfo()
     
     return "No active network interfaces";
 }
+#endif // LSV_CORE_ONLY
 
 #endif // NETWORK_H
\ No newline at end of file
@@ -1,10 +1,13 @@
 #include "network_geek.h"
 #include "network.h"
+#include "collector_engine.h"
+#include "refresh_scheduler.h"
+#include "trace.h"
+#include "procfs_parser.h"
 
 #include <QVBoxLayout>
 #include <QDialogButtonBox>
 #include <QPushButton>
-#include <QProcess>
 #include <QGuiApplication>
 #include <QClipboard>
 #include <QFileDialog>
@@ -12,7 +15,7 @@
 #include <QTextStream>
 
 NetworkGeekDialog::NetworkGeekDialog(QWidget* parent)
-    : QDialog(parent), te(new QTextEdit(this)), timer(new QTimer(this))
+    : QDialog(parent), te(new QTextEdit(this))
 {
     setWindowTitle("Network - Geek Mode");
     resize(800, 480);
@@ -35,29 +38,79 @@ NetworkGeekDialog::NetworkGeekDialog(QWidget* parent)
 
     ml->addWidget(box);
 
-    connect(timer, &QTimer::timeout, this, &NetworkGeekDialog::refresh);
-    timer->start(3000); // refresh every 3s
+    // Every third sampler tick while visible; no timer of its own.
+    RefreshScheduler::instance()->every(this, 3000, [this]() {
+        if (isVisible()) refresh();
+    });
 
     refresh();
 }
 
+void NetworkGeekDialog::showEvent(QShowEvent* ev)
+{
+    QDialog::showEvent(ev);
+    // Interface counters come from the sampler thread; the text itself is
+    // only rebuilt every 3 s so scrolling is not reset every tick.
+    Sampler::instance()->subscribe(this, Sampler::Network);
+}
+
+void NetworkGeekDialog::hideEvent(QHideEvent* ev)
+{
+    Sampler::instance()->unsubscribe(this);
+    QDialog::hideEvent(ev);
+}
+
+QString NetworkGeekDialog::formatNetDev() const
+{
+    SamplePtr sample = Sampler::instance()->latest();
+    if (!sample || !(sample->channels & Sampler::Network)) return QString();
+
+    QString out;
+    out += QString("%1 %2 %3 %4 %5 %6\n")
+               .arg("Interface", -12).arg("RX total", 12).arg("RX/s", 12)
+               .arg("TX total", 12).arg("TX/s", 12).arg("Errors (rx/tx)", 16);
+    for (const NetDevCounters& c : sample->interfaces) {
+        out += QString("%1 %2 %3 %4 %5 %6\n")
+                   .arg(c.name, -12)
+                   .arg(formatBytes(c.rxBytes), 12)
+                   .arg(formatBytes(qint64(c.rxBytesPerSec)), 12)
+                   .arg(formatBytes(c.txBytes), 12)
+                   .arg(formatBytes(qint64(c.txBytesPerSec)), 12)
+                   .arg(QString("%1/%2").arg(c.rxErrors).arg(c.txErrors), 16);
+    }
+    return out;
+}
+
 void NetworkGeekDialog::fillText()
 {
+    TraceSpan span("live", "NetworkGeekDialog::fillText");
     // Prefer structured helper output and then append raw commands
     QString out = getNetworkInfo();
 
-    QProcess p;
-    p.start("sh", QStringList() << "-c" << "ip addr && echo --- && ip route && echo --- && cat /proc/net/dev && echo --- && cat /proc/net/route");
-    p.waitForFinished(3000);
-    out += "\n\n" + QString::fromLocal8Bit(p.readAllStandardOutput());
-    out += "\n" + QString::fromLocal8Bit(p.readAllStandardError());
+    out += "\n\n" + ipOutput;
+    out += "\n---\n" + formatNetDev();
+    QFile route(procfs::hostPath("/proc/net/route"));
+    if (route.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        out += "---\n" + QString::fromLocal8Bit(route.readAll());
+    }
 
     te->setPlainText(out);
 }
 
 void NetworkGeekDialog::refresh()
 {
-    fillText();
+    if (ipTicket != 0) return; // previous run still in flight
+    TraceSpan span("live", "NetworkGeekDialog::refresh");
+
+    // `ip` runs through the collector engine so the dialog never blocks
+    // the GUI thread waiting for it.
+    ipTicket = CollectorEngine::instance()->submitShell("ip addr && echo --- && ip route", this,
+        [this](const CollectorResult& result) {
+            ipTicket = 0;
+            ipOutput = QString::fromLocal8Bit(result.standardOutput);
+            if (!result.standardError.isEmpty()) ipOutput += "\n" + QString::fromLocal8Bit(result.standardError);
+            fillText();
+        }, CollectorEngine::Visible, 5000);
 }
 
 void NetworkGeekDialog::copyToClipboard()
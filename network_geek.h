@@ -3,7 +3,10 @@
 
 #include <QDialog>
 #include <QTextEdit>
-#include <QTimer>
+#include "sampler.h"
+
+class QShowEvent;
+class QHideEvent;
 
 class NetworkGeekDialog : public QDialog
 {
@@ -16,10 +19,16 @@ private slots:
     void copyToClipboard();
     void saveToFile();
 
+protected:
+    void showEvent(QShowEvent* ev) override;
+    void hideEvent(QHideEvent* ev) override;
+
 private:
     void fillText();
+    QString formatNetDev() const;
     QTextEdit* te;
-    QTimer* timer;
+    QString ipOutput;           // last `ip addr` / `ip route` result
+    quint64 ipTicket = 0;       // CollectorEngine job in flight, 0 if none
 };
 
 #endif // NETWORK_GEEK_H
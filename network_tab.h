@@ -4,6 +4,7 @@
 #include "tab_widget_base.h"
 #include "network.h"
 #include "network_geek.h"
+#include "snapshot_baseline.h"
 #include <QTableWidget>
 #include <QHBoxLayout>
 #include <QLabel>
@@ -29,12 +30,9 @@ protected:
         // Headline + Geek button
         QHBoxLayout* headlineLayout = new QHBoxLayout();
         QLabel* headline = new QLabel("Network");
-        headline->setStyleSheet("font-size: 15px; font-weight: bold; color: #222; margin-bottom: 0px;");
+        headline->setObjectName("tabHeadline");
         QPushButton* geekButton = new QPushButton("Geek Mode", w);
-        geekButton->setStyleSheet(
-            "QPushButton { background-color: #3498db; color: white; border: none; padding: 4px 10px; border-radius: 4px; font-weight: bold; font-size: 11px; min-width: 80px; max-height: 22px;}"
-            "QPushButton:hover { background-color: #2980b9; }"
-        );
+        geekButton->setObjectName("geekButton");
         headlineLayout->addWidget(headline);
         headlineLayout->addStretch();
         headlineLayout->addWidget(geekButton);
@@ -53,6 +51,16 @@ protected:
         // Populate immediately
         loadNetworkInformation(table, QJsonObject());
 
+        // Mark what differs from the --baseline snapshot once it is compared.
+        SnapshotBaseline* baseline = SnapshotBaseline::instance();
+        if (baseline->isReady()) {
+            markBaselineRows(table, baseline->changedRows("network"));
+        } else if (baseline->isActive()) {
+            connect(baseline, &SnapshotBaseline::ready, table, [table, baseline]() {
+                markBaselineRows(table, baseline->changedRows("network"));
+            });
+        }
+
         // Geek dialog: opens the richer NetworkGeekDialog
         connect(geekButton, &QPushButton::clicked, this, [this, w]() {
             NetworkGeekDialog dlg(w);
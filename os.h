@@ -1,30 +1,34 @@
 #ifndef OS_H
 #define OS_H
 
-#include <QTableWidget>
-#include <QTableWidgetItem>
 #include <QJsonObject>
 #include <QFile>
+#include <QFileInfo>
 #include <QTextStream>
-#include <QProcess>
 #include <QRegularExpression>
 #include <QDebug>
+#include <sys/utsname.h>
+#include "info_rows.h"
+#include "procfs_parser.h"
+#ifndef LSV_CORE_ONLY
+#include <QTableWidget>
+#include <QTableWidgetItem>
 #include "gui_helpers.h"
+#endif
 
 // OS information functions
+InfoRows collectOSInformation();
+QString getOSInfo();
+#ifndef LSV_CORE_ONLY
 void loadOSInformation(QTableWidget* table, const QJsonObject& data);
-QStringList getOSHeaders();
 void styleOSTable(QTableWidget* table);
-QString getOSInfo();
+#endif
 
-// OS Headers
-QStringList getOSHeaders()
-{
-    return QStringList() << "Property" << "Value" << "Unit" << "Type";
-}
+// Column headers for these rows come from getOSHeaders() in gui_helpers.h.
 
+#ifndef LSV_CORE_ONLY
 // OS Table Styling
-void styleOSTable(QTableWidget* table)
+inline void styleOSTable(QTableWidget* table)
 {
     // Set column widths
     table->setColumnWidth(0, 200);  // Property
@@ -44,15 +48,15 @@ void styleOSTable(QTableWidget* table)
     );
 }
 
-// Load OS Information
-void loadOSInformation(QTableWidget* table, const QJsonObject& data)
+#endif // LSV_CORE_ONLY
+
+// Collect OS Information
+inline InfoRows collectOSInformation()
 {
-    Q_UNUSED(data);
-    
-    table->setRowCount(0);
+    InfoRows rows;
     
     // Get OS Release information
-    QFile osReleaseFile("/etc/os-release");
+    QFile osReleaseFile(procfs::hostPath("/etc/os-release"));
     if (osReleaseFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
         QTextStream stream(&osReleaseFile);
         QStringList lines = stream.readAll().split('\n');
@@ -75,21 +79,21 @@ void loadOSInformation(QTableWidget* table, const QJsonObject& data)
         }
         
         if (!prettyName.isEmpty()) {
-            addRowToTable(table, QStringList() << "OS Name" << prettyName << "" << "OS");
+            rows.append(QStringList() << "OS Name" << prettyName << "" << "OS");
         }
         if (!osName.isEmpty()) {
-            addRowToTable(table, QStringList() << "Distribution" << osName << "" << "OS");
+            rows.append(QStringList() << "Distribution" << osName << "" << "OS");
         }
         if (!osVersion.isEmpty()) {
-            addRowToTable(table, QStringList() << "Version" << osVersion << "" << "OS");
+            rows.append(QStringList() << "Version" << osVersion << "" << "OS");
         }
         if (!versionId.isEmpty()) {
-            addRowToTable(table, QStringList() << "Version ID" << versionId << "" << "OS");
+            rows.append(QStringList() << "Version ID" << versionId << "" << "OS");
         }
     }
     
     // Get kernel information
-    QFile versionFile("/proc/version");
+    QFile versionFile(procfs::hostPath("/proc/version"));
     if (versionFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
         QTextStream stream(&versionFile);
         QString versionInfo = stream.readLine();
@@ -99,19 +103,19 @@ void loadOSInformation(QTableWidget* table, const QJsonObject& data)
         QRegularExpression kernelRegex("Linux version ([^ ]+)");
         QRegularExpressionMatch match = kernelRegex.match(versionInfo);
         if (match.hasMatch()) {
-            addRowToTable(table, QStringList() << "Kernel Version" << match.captured(1) << "" << "OS");
+            rows.append(QStringList() << "Kernel Version" << match.captured(1) << "" << "OS");
         }
         
         // Parse compiler info
         QRegularExpression gccRegex("\\(gcc version ([^)]+)\\)");
         match = gccRegex.match(versionInfo);
         if (match.hasMatch()) {
-            addRowToTable(table, QStringList() << "Compiled with" << "GCC " + match.captured(1) << "" << "OS");
+            rows.append(QStringList() << "Compiled with" << "GCC " + match.captured(1) << "" << "OS");
         }
     }
     
     // Get uptime
-    QFile uptimeFile("/proc/uptime");
+    QFile uptimeFile(procfs::hostPath("/proc/uptime"));
     if (uptimeFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
         QTextStream stream(&uptimeFile);
         QString uptimeStr = stream.readLine();
@@ -123,40 +127,60 @@ void loadOSInformation(QTableWidget* table, const QJsonObject& data)
         int minutes = (uptimeSeconds - days * 86400 - hours * 3600) / 60;
         
         QString uptimeFormatted = QString("%1 days, %2 hours, %3 minutes").arg(days).arg(hours).arg(minutes);
-        addRowToTable(table, QStringList() << "Uptime" << uptimeFormatted << "" << "OS");
+        rows.append(QStringList() << "Uptime" << uptimeFormatted << "" << "OS");
     }
     
-    // Get architecture
-    QProcess archProcess;
-    archProcess.start("uname", QStringList() << "-m");
-    archProcess.waitForFinished();
-    QString architecture = archProcess.readAllStandardOutput().trimmed();
+    // Get architecture (same as `uname -m`, without spawning it)
+    QString architecture;
+    struct utsname uts;
+    if (uname(&uts) == 0) {
+        architecture = QString::fromLocal8Bit(uts.machine).trimmed();
+    }
     if (!architecture.isEmpty()) {
-        addRowToTable(table, QStringList() << "Architecture" << architecture << "" << "OS");
+        rows.append(QStringList() << "Architecture" << architecture << "" << "OS");
     }
     
     // Get hostname
-    QFile hostnameFile("/proc/sys/kernel/hostname");
+    QFile hostnameFile(procfs::hostPath("/proc/sys/kernel/hostname"));
     if (hostnameFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
         QTextStream stream(&hostnameFile);
         QString hostname = stream.readLine().trimmed();
         hostnameFile.close();
-        addRowToTable(table, QStringList() << "Hostname" << hostname << "" << "OS");
+        rows.append(QStringList() << "Hostname" << hostname << "" << "OS");
     }
     
-    // Get timezone
-    QProcess timezoneProcess;
-    timezoneProcess.start("timedatectl", QStringList() << "show" << "--property=Timezone" << "--value");
-    timezoneProcess.waitForFinished();
-    QString timezone = timezoneProcess.readAllStandardOutput().trimmed();
+    // Get timezone. timedatectl derives it from the /etc/localtime symlink;
+    // reading the link directly avoids a D-Bus round trip.
+    QString timezone;
+    const QString zoneTarget = QFileInfo(procfs::hostPath("/etc/localtime")).symLinkTarget();
+    const int zoneinfo = zoneTarget.indexOf("zoneinfo/");
+    if (zoneinfo >= 0) {
+        timezone = zoneTarget.mid(zoneinfo + 9);
+    } else {
+        QFile timezoneFile(procfs::hostPath("/etc/timezone"));
+        if (timezoneFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
+            timezone = QString::fromLocal8Bit(timezoneFile.readLine()).trimmed();
+        }
+    }
     if (!timezone.isEmpty()) {
-        addRowToTable(table, QStringList() << "Timezone" << timezone << "" << "OS");
+        rows.append(QStringList() << "Timezone" << timezone << "" << "OS");
     }
+    return rows;
+}
+
+#ifndef LSV_CORE_ONLY
+// Load OS Information
+inline void loadOSInformation(QTableWidget* table, const QJsonObject& data)
+{
+    Q_UNUSED(data);
+    table->setRowCount(0);
+    addRowsToTable(table, collectOSInformation());
 }
+#endif
 
-QString getOSInfo()
+inline QString getOSInfo()
 {
-    QFile osReleaseFile("/etc/os-release");
+    QFile osReleaseFile(procfs::hostPath("/etc/os-release"));
     if (osReleaseFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
         QTextStream stream(&osReleaseFile);
         QStringList lines = stream.readAll().split('\n');
@@ -3,6 +3,9 @@
 #include <QVBoxLayout>
 #include <QLabel>
 #include "log_helper.h"
+#include "procfs_parser.h"
+#include "snapshot_baseline.h"
+#include "gui_helpers.h"
 #include <QTableWidget>
 #include <QHeaderView>
 #include <QScrollArea>
@@ -78,7 +81,7 @@ OSTab::OSTab(const QString& tabName, const QString& command, bool showHeader, co
 
     // Populate OS info directly from system files to avoid relying on external binaries
     QString osOutput;
-    QFile osReleaseFile("/etc/os-release");
+    QFile osReleaseFile(procfs::hostPath("/etc/os-release"));
     appendLog("OSTab: reading /etc/os-release");
     if (osReleaseFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
         QTextStream in(&osReleaseFile);
@@ -110,7 +113,7 @@ OSTab::OSTab(const QString& tabName, const QString& command, bool showHeader, co
                 .arg(QString::fromLocal8Bit(u.machine));
         }
         // Fallback: try /proc/version
-        QFile f("/proc/version");
+        QFile f(procfs::hostPath("/proc/version"));
         if (f.open(QIODevice::ReadOnly | QIODevice::Text)) {
             QByteArray data = f.readAll().trimmed();
             return QString::fromLocal8Bit(data);
@@ -179,4 +182,23 @@ void OSTab::fillTableWithOutput(const QString& output)
             }
         }
     }
+
+    // Mark what differs from the --baseline snapshot once it is compared.
+    // The table shows os-release keys; the snapshot has collectOSInformation()
+    // names for them.
+    static const QHash<QString, QString> keyOf = {
+        { "PRETTY_NAME", "OS Name" },
+        { "NAME", "Distribution" },
+        { "VERSION", "Version" },
+        { "VERSION_ID", "Version ID" },
+        { "uname", "Kernel Version" },
+    };
+    SnapshotBaseline* baseline = SnapshotBaseline::instance();
+    if (baseline->isReady()) {
+        markBaselineRows(tableWidget, baseline->changedRows("os"), keyOf);
+    } else if (baseline->isActive()) {
+        connect(baseline, &SnapshotBaseline::ready, this, [this, baseline]() {
+            markBaselineRows(tableWidget, baseline->changedRows("os"), keyOf);
+        });
+    }
 }
\ No newline at end of file
@@ -1,4 +1,7 @@
 #include "pc_tab.h"
+#include "procfs_parser.h"
+#include "snapshot_baseline.h"
+#include "gui_helpers.h"
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QLabel>
@@ -11,6 +14,7 @@
 PCTab::PCTab(QWidget* parent)
     : TabWidgetBase("PC Info", "hostnamectl && cat /sys/class/dmi/id/* 2>/dev/null", true, "", parent)
 {
+    setCacheable(true);
     initializeTab();
 }
 
@@ -27,6 +31,15 @@ QWidget* PCTab::createUserFriendlyView()
     setupTable(m_pcTable);
     mainLayout->addWidget(m_pcTable);
 
+    // Mark what differs from the --baseline snapshot once it is compared;
+    // parseOutput() marks the rows again after each refresh.
+    SnapshotBaseline* baseline = SnapshotBaseline::instance();
+    if (baseline->isActive() && !baseline->isReady()) {
+        connect(baseline, &SnapshotBaseline::ready, m_pcTable, [this, baseline]() {
+            markBaselineRows(m_pcTable, baseline->changedRows("system"));
+        });
+    }
+
     return mainWidget;
 }
 
@@ -76,23 +89,23 @@ void PCTab::parseOutput(const QString& output)
 
     // Fallbacks using DMI
     QFile file;
-    file.setFileName("/sys/class/dmi/id/product_name");
+    file.setFileName(procfs::hostPath("/sys/class/dmi/id/product_name"));
     if (file.open(QIODevice::ReadOnly | QIODevice::Text))
         m_product = QString::fromLocal8Bit(file.readAll()).trimmed();
 
-    file.setFileName("/sys/class/dmi/id/sys_vendor");
+    file.setFileName(procfs::hostPath("/sys/class/dmi/id/sys_vendor"));
     if (file.open(QIODevice::ReadOnly | QIODevice::Text))
         m_manufacturer = QString::fromLocal8Bit(file.readAll()).trimmed();
 
-    file.setFileName("/sys/class/dmi/id/chassis_type");
+    file.setFileName(procfs::hostPath("/sys/class/dmi/id/chassis_type"));
     if (file.open(QIODevice::ReadOnly | QIODevice::Text))
         m_chassis = QString::fromLocal8Bit(file.readAll()).trimmed();
 
-    file.setFileName("/sys/class/dmi/id/product_family");
+    file.setFileName(procfs::hostPath("/sys/class/dmi/id/product_family"));
     if (file.open(QIODevice::ReadOnly | QIODevice::Text))
         m_family = QString::fromLocal8Bit(file.readAll()).trimmed();
 
-    file.setFileName("/sys/class/dmi/id/product_serial");
+    file.setFileName(procfs::hostPath("/sys/class/dmi/id/product_serial"));
     if (file.open(QIODevice::ReadOnly | QIODevice::Text))
         m_serial = QString::fromLocal8Bit(file.readAll()).trimmed();
 
@@ -121,4 +134,8 @@ void PCTab::parseOutput(const QString& output)
     addTableRow(m_pcTable, "Serial", m_serial);
     addTableRow(m_pcTable, "Family", m_family);
     addTableRow(m_pcTable, "Chassis", m_chassis);
+
+    if (SnapshotBaseline::instance()->isReady()) {
+        markBaselineRows(m_pcTable, SnapshotBaseline::instance()->changedRows("system"));
+    }
 }
\ No newline at end of file
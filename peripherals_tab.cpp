@@ -1,4 +1,5 @@
 #include "peripherals_tab.h"
+#include "lsv_style.h"
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QLabel>
@@ -13,6 +14,7 @@ PeripheralsTab::PeripheralsTab(QWidget* parent)
                     "lsusb -v && lspci -vv && lsblk && cat /proc/bus/input/devices", parent)
 {
     qDebug() << "PeripheralsTab: Constructor called - base constructor done";
+    setCacheable(true);
     initializeTab();
     qDebug() << "PeripheralsTab: Constructor finished";
 }
@@ -57,78 +59,52 @@ QWidget* PeripheralsTab::createUserFriendlyView()
 
 void PeripheralsTab::createInfoSection(const QString& title, QGroupBox** groupBox, QLabel** contentLabel, QVBoxLayout* parentLayout)
 {
-    *groupBox = new QGroupBox(title);
-    (*groupBox)->setStyleSheet(
-        "QGroupBox {"
-        "  font-weight: bold;"
-        "  border: 2px solid #bdc3c7;"
-        "  border-radius: 8px;"
-        "  margin-top: 10px;"
-        "  padding-top: 10px;"
-        "}"
-        "QGroupBox::title {"
-        "  subcontrol-origin: margin;"
-        "  left: 10px;"
-        "  padding: 0 10px 0 10px;"
-        "}"
-    );
-    
-    QVBoxLayout* sectionLayout = new QVBoxLayout(*groupBox);
-    *contentLabel = new QLabel("Loading " + title.toLower() + " information...");
-    (*contentLabel)->setWordWrap(true);
-    (*contentLabel)->setStyleSheet("QLabel { padding: 10px; background-color: #f8f9fa; border-radius: 4px; }");
-    sectionLayout->addWidget(*contentLabel);
-    
-    parentLayout->addWidget(*groupBox);
+    *groupBox = ::createInfoSection(title, contentLabel, parentLayout, "Loading " + title.toLower() + " information...");
 }
 
-void PeripheralsTab::parseOutput(const QString& output)
+void PeripheralsTab::beginStream()
+{
+    qDebug() << "PeripheralsTab: parsing started";
+    m_usbDevices.clear();
+    m_inputDevices.clear();
+    m_storageDevices.clear();
+    m_networkDevices.clear();
+}
+
+void PeripheralsTab::parseLines(const QStringList& lines)
 {
-    qDebug() << "PeripheralsTab: parseOutput called";
-    
-    QStringList lines = output.split('\n', Qt::SkipEmptyParts);
-    
-    QString usbDevicesInfo = "USB Devices: Not detected";
-    QString inputDevicesInfo = "Input Devices: Not detected";
-    QString storageDevicesInfo = "Storage Devices: Not detected";
-    QString networkDevicesInfo = "Network Devices: Not detected";
-    
-    QStringList usbDevices;
-    QStringList inputDevices;
-    QStringList storageDevices;
-    QStringList networkDevices;
-    
     for (const QString& line : lines) {
         QString trimmed = line.trimmed();
+        if (trimmed.isEmpty()) continue;
         
         // Parse lsusb output
         if (trimmed.startsWith("Bus ") && trimmed.contains("Device ")) {
-            QRegularExpression usbRegex("Bus\\s+\\d+\\s+Device\\s+\\d+:\\s+ID\\s+[0-9a-fA-F:]+\\s+(.+)");
+            static const QRegularExpression usbRegex("Bus\\s+\\d+\\s+Device\\s+\\d+:\\s+ID\\s+[0-9a-fA-F:]+\\s+(.+)");
             QRegularExpressionMatch usbMatch = usbRegex.match(trimmed);
             if (usbMatch.hasMatch()) {
                 QString deviceName = usbMatch.captured(1);
-                usbDevices.append(deviceName);
+                m_usbDevices.append(deviceName);
                 
                 // Categorize USB devices
                 if (deviceName.contains("keyboard", Qt::CaseInsensitive) ||
                     deviceName.contains("mouse", Qt::CaseInsensitive) ||
                     deviceName.contains("trackpad", Qt::CaseInsensitive) ||
                     deviceName.contains("touchscreen", Qt::CaseInsensitive)) {
-                    inputDevices.append(deviceName + " (USB)");
+                    m_inputDevices.append(deviceName + " (USB)");
                 }
                 
                 if (deviceName.contains("storage", Qt::CaseInsensitive) ||
                     deviceName.contains("drive", Qt::CaseInsensitive) ||
                     deviceName.contains("disk", Qt::CaseInsensitive) ||
                     deviceName.contains("flash", Qt::CaseInsensitive)) {
-                    storageDevices.append(deviceName + " (USB)");
+                    m_storageDevices.append(deviceName + " (USB)");
                 }
                 
                 if (deviceName.contains("ethernet", Qt::CaseInsensitive) ||
                     deviceName.contains("wireless", Qt::CaseInsensitive) ||
                     deviceName.contains("wifi", Qt::CaseInsensitive) ||
                     deviceName.contains("bluetooth", Qt::CaseInsensitive)) {
-                    networkDevices.append(deviceName + " (USB)");
+                    m_networkDevices.append(deviceName + " (USB)");
                 }
             }
         }
@@ -143,14 +119,14 @@ void PeripheralsTab::parseOutput(const QString& output)
                     deviceDesc.contains("Wireless", Qt::CaseInsensitive) ||
                     deviceDesc.contains("Network", Qt::CaseInsensitive) ||
                     deviceDesc.contains("WiFi", Qt::CaseInsensitive)) {
-                    networkDevices.append(deviceDesc + " (PCI)");
+                    m_networkDevices.append(deviceDesc + " (PCI)");
                 }
                 
                 if (deviceDesc.contains("Storage", Qt::CaseInsensitive) ||
                     deviceDesc.contains("SATA", Qt::CaseInsensitive) ||
                     deviceDesc.contains("RAID", Qt::CaseInsensitive) ||
                     deviceDesc.contains("IDE", Qt::CaseInsensitive)) {
-                    storageDevices.append(deviceDesc + " (PCI)");
+                    m_storageDevices.append(deviceDesc + " (PCI)");
                 }
             }
         }
@@ -163,7 +139,7 @@ void PeripheralsTab::parseOutput(const QString& output)
             if (parts.size() >= 4) {
                 QString device = parts[0];
                 QString size = parts[3];
-                storageDevices.append(device + " (" + size + ")");
+                m_storageDevices.append(device + " (" + size + ")");
             }
         }
         
@@ -171,32 +147,48 @@ void PeripheralsTab::parseOutput(const QString& output)
         if (trimmed.startsWith("N: Name=")) {
             QString deviceName = trimmed.split("Name=")[1].trimmed().remove('"');
             if (!deviceName.isEmpty()) {
-                inputDevices.append(deviceName);
+                m_inputDevices.append(deviceName);
             }
         }
     }
-    
+
+    showDevices();
+}
+
+void PeripheralsTab::endStream()
+{
+    showDevices();
+    qDebug() << "PeripheralsTab: parsing completed";
+}
+
+void PeripheralsTab::showDevices()
+{
+    QString usbDevicesInfo = "USB Devices: Not detected";
+    QString inputDevicesInfo = "Input Devices: Not detected";
+    QString storageDevicesInfo = "Storage Devices: Not detected";
+    QString networkDevicesInfo = "Network Devices: Not detected";
+
     // Remove duplicates
-    usbDevices.removeDuplicates();
-    inputDevices.removeDuplicates();
-    storageDevices.removeDuplicates();
-    networkDevices.removeDuplicates();
+    m_usbDevices.removeDuplicates();
+    m_inputDevices.removeDuplicates();
+    m_storageDevices.removeDuplicates();
+    m_networkDevices.removeDuplicates();
     
     // Format the information
-    if (!usbDevices.isEmpty()) {
-        usbDevicesInfo = "USB Devices:\n" + usbDevices.join("\n");
+    if (!m_usbDevices.isEmpty()) {
+        usbDevicesInfo = "USB Devices:\n" + m_usbDevices.join("\n");
     }
     
-    if (!inputDevices.isEmpty()) {
-        inputDevicesInfo = "Input Devices:\n" + inputDevices.join("\n");
+    if (!m_inputDevices.isEmpty()) {
+        inputDevicesInfo = "Input Devices:\n" + m_inputDevices.join("\n");
     }
     
-    if (!storageDevices.isEmpty()) {
-        storageDevicesInfo = "Storage Devices:\n" + storageDevices.join("\n");
+    if (!m_storageDevices.isEmpty()) {
+        storageDevicesInfo = "Storage Devices:\n" + m_storageDevices.join("\n");
     }
     
-    if (!networkDevices.isEmpty()) {
-        networkDevicesInfo = "Network Devices:\n" + networkDevices.join("\n");
+    if (!m_networkDevices.isEmpty()) {
+        networkDevicesInfo = "Network Devices:\n" + m_networkDevices.join("\n");
     }
     
     // Update the UI with parsed information
@@ -212,6 +204,4 @@ void PeripheralsTab::parseOutput(const QString& output)
     if (m_networkDevicesContent) {
         m_networkDevicesContent->setText(networkDevicesInfo);
     }
-    
-    qDebug() << "PeripheralsTab: parseOutput completed";
 }
\ No newline at end of file
@@ -15,10 +15,21 @@ public:
 
 protected:
     QWidget* createUserFriendlyView() override;
-    void parseOutput(const QString& output) override;
+    // lsusb and lspci are parsed line by line; sections fill in as the
+    // lines arrive.
+    bool streamsOutput() const override { return true; }
+    void beginStream() override;
+    void parseLines(const QStringList& lines) override;
+    void endStream() override;
 
 private:
     void createInfoSection(const QString& title, QGroupBox** groupBox, QLabel** contentLabel, QVBoxLayout* parentLayout);
+    void showDevices();
+
+    QStringList m_usbDevices;
+    QStringList m_inputDevices;
+    QStringList m_storageDevices;
+    QStringList m_networkDevices;
     
     QGroupBox* m_usbDevicesSection;
     QLabel* m_usbDevicesContent;
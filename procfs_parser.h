@@ -0,0 +1,342 @@
+#ifndef PROCFS_PARSER_H
+#define PROCFS_PARSER_H
+
+// Allocation-free parsing of the kernel's text interfaces.
+//
+// Files under /proc and /sys are small ASCII tables. Reading them into a
+// QString, splitting on '\n' and running a QRegularExpression per line
+// allocates for every line and field on every refresh. The helpers here read
+// into a reusable byte buffer and walk it with std::string_view, parsing
+// numbers with std::from_chars; the buffer keeps its capacity between reads,
+// so a steady-state refresh does not touch the heap at all.
+//
+// The typed parsers call back once per row with views into the buffer, which
+// stay valid until the next read into the same FileBuffer.
+
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <QString>
+
+namespace procfs {
+
+// Directory that absolute kernel paths are resolved under. Empty for the
+// live system; the benchmarks point it at a generated /proc + /sys tree.
+inline std::string& rootDirectory()
+{
+    static std::string root;
+    return root;
+}
+
+inline void setRootDirectory(std::string_view directory) { rootDirectory().assign(directory); }
+
+// Called with every file read through FileBuffer (path as asked for, the
+// data and the read time) and with every path passed to hostPath() (data
+// null). Set once at startup by capture mode (capture.h); null otherwise.
+using ReadHook = void (*)(const char* path, const char* data, size_t size, int64_t elapsedNs);
+
+inline ReadHook& readHook()
+{
+    static ReadHook hook = nullptr;
+    return hook;
+}
+
+inline void setReadHook(ReadHook hook) { readHook() = hook; }
+
+// path as seen under rootDirectory(), for reads that do not go through
+// FileBuffer (QFile, directory listings).
+inline QString hostPath(const QString& path)
+{
+    if (ReadHook hook = readHook()) hook(path.toLocal8Bit().constData(), nullptr, 0, 0);
+    const std::string& root = rootDirectory();
+    return root.empty() ? path : QString::fromLocal8Bit(root.data(), int(root.size())) + path;
+}
+
+// Holds the contents of the last file read; reuse one per call site/thread.
+class FileBuffer
+{
+public:
+    // Never smaller than a page: /proc/sys handlers return everything on the
+    // first read() and report EOF for any read at a non-zero offset.
+    explicit FileBuffer(size_t initialCapacity = 4096) { m_data.resize(initialCapacity < 4096 ? 4096 : initialCapacity); }
+
+    // Read the whole file. procfs reports st_size 0, so read until EOF and
+    // grow the buffer (once) when a file is larger than anything seen so far.
+    bool read(const char* path)
+    {
+        m_size = 0;
+        if (ReadHook hook = readHook()) {
+            const auto start = std::chrono::steady_clock::now();
+            if (!readFile(path)) return false;
+            hook(path, m_data.data(), m_size,
+                 std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+            return true;
+        }
+        return readFile(path);
+    }
+
+    bool read(const QString& path) { return read(path.toLocal8Bit().constData()); }
+
+    std::string_view view() const { return std::string_view(m_data.data(), m_size); }
+
+private:
+    bool readFile(const char* path)
+    {
+        if (!rootDirectory().empty()) {
+            m_path.assign(rootDirectory()).append(path);
+            path = m_path.c_str();
+        }
+        const int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+        if (fd < 0) return false;
+        for (;;) {
+            if (m_size == m_data.size()) m_data.resize(m_data.size() * 2);
+            const ssize_t n = ::read(fd, m_data.data() + m_size, m_data.size() - m_size);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                ::close(fd);
+                m_size = 0;
+                return false;
+            }
+            if (n == 0) break;
+            m_size += size_t(n);
+        }
+        ::close(fd);
+        return true;
+    }
+
+    std::vector<char> m_data;
+    size_t m_size = 0;
+    std::string m_path;     // scratch for rootDirectory() + path
+};
+
+inline bool isSpace(char c) { return c == ' ' || c == '\t' || c == '\n' || c == '\r'; }
+
+inline std::string_view trim(std::string_view s)
+{
+    while (!s.empty() && isSpace(s.front())) s.remove_prefix(1);
+    while (!s.empty() && isSpace(s.back())) s.remove_suffix(1);
+    return s;
+}
+
+// Split off the next line (without '\n'). Returns false at the end.
+inline bool nextLine(std::string_view& rest, std::string_view& line)
+{
+    if (rest.empty()) return false;
+    const size_t nl = rest.find('\n');
+    if (nl == std::string_view::npos) {
+        line = rest;
+        rest = std::string_view();
+    } else {
+        line = rest.substr(0, nl);
+        rest.remove_prefix(nl + 1);
+    }
+    return true;
+}
+
+// Split off the next whitespace separated field. Returns false when none is left.
+inline bool nextField(std::string_view& rest, std::string_view& field)
+{
+    size_t i = 0;
+    while (i < rest.size() && isSpace(rest[i])) ++i;
+    if (i == rest.size()) {
+        rest = std::string_view();
+        return false;
+    }
+    size_t j = i;
+    while (j < rest.size() && !isSpace(rest[j])) ++j;
+    field = rest.substr(i, j - i);
+    rest.remove_prefix(j);
+    return true;
+}
+
+template <typename T>
+inline bool parseNumber(std::string_view s, T& out)
+{
+    const auto result = std::from_chars(s.data(), s.data() + s.size(), out);
+    return result.ec == std::errc();
+}
+
+// Next field as an unsigned number; 0 when missing or malformed.
+inline uint64_t nextU64(std::string_view& rest)
+{
+    std::string_view field;
+    uint64_t value = 0;
+    if (nextField(rest, field)) parseNumber(field, value);
+    return value;
+}
+
+inline bool startsWith(std::string_view s, std::string_view prefix)
+{
+    return s.size() >= prefix.size() && s.compare(0, prefix.size(), prefix) == 0;
+}
+
+inline QString toQString(std::string_view s)
+{
+    return QString::fromLatin1(s.data(), int(s.size()));
+}
+
+// ---- single-value files (sysfs attributes, /proc/sys) ----------------------
+
+inline bool readValue(FileBuffer& buffer, const char* path, std::string_view& value)
+{
+    if (!buffer.read(path)) return false;
+    value = trim(buffer.view());
+    return true;
+}
+
+inline bool readU64(FileBuffer& buffer, const char* path, uint64_t& value)
+{
+    std::string_view text;
+    return readValue(buffer, path, text) && parseNumber(text, value);
+}
+
+// ---- /proc/stat ------------------------------------------------------------
+
+// The "cpu" lines: cpu is -1 for the aggregate line, otherwise the cpu
+// number. ticks holds user, nice, system, idle, iowait, irq, softirq, steal
+// (missing trailing columns on old kernels read as 0).
+struct StatCpuLine {
+    int cpu = -1;
+    uint64_t ticks[8] = {};
+};
+
+template <typename Callback>
+inline void parseStatCpu(std::string_view data, Callback&& callback)
+{
+    std::string_view line;
+    while (nextLine(data, line)) {
+        if (!startsWith(line, "cpu")) break; // the cpu lines come first
+        std::string_view name;
+        if (!nextField(line, name)) continue;
+        StatCpuLine row;
+        if (name.size() > 3 && !parseNumber(name.substr(3), row.cpu)) continue;
+        for (uint64_t& t : row.ticks) t = nextU64(line);
+        callback(row);
+    }
+}
+
+// ---- /proc/meminfo ---------------------------------------------------------
+
+// Calls back with the key (without ':') and the value in kB (or the plain
+// count for the HugePages_* lines).
+template <typename Callback>
+inline void parseMeminfo(std::string_view data, Callback&& callback)
+{
+    std::string_view line;
+    while (nextLine(data, line)) {
+        const size_t colon = line.find(':');
+        if (colon == std::string_view::npos || colon == 0) continue;
+        std::string_view rest = line.substr(colon + 1);
+        callback(line.substr(0, colon), nextU64(rest));
+    }
+}
+
+// ---- /proc/net/dev ---------------------------------------------------------
+
+// rx and tx hold bytes, packets, errs, drop, fifo, frame/colls,
+// compressed, multicast/carrier as in the kernel's column order.
+struct NetDevLine {
+    std::string_view name;
+    uint64_t rx[8] = {};
+    uint64_t tx[8] = {};
+};
+
+template <typename Callback>
+inline void parseNetDev(std::string_view data, Callback&& callback)
+{
+    std::string_view line;
+    int lineNo = 0;
+    while (nextLine(data, line)) {
+        if (lineNo++ < 2) continue; // two header lines
+        const size_t colon = line.find(':');
+        if (colon == std::string_view::npos) continue;
+        NetDevLine row;
+        row.name = trim(line.substr(0, colon));
+        std::string_view rest = line.substr(colon + 1);
+        for (uint64_t& v : row.rx) v = nextU64(rest);
+        for (uint64_t& v : row.tx) v = nextU64(rest);
+        callback(row);
+    }
+}
+
+// ---- /proc/partitions ------------------------------------------------------
+
+struct PartitionLine {
+    unsigned major = 0;
+    unsigned minor = 0;
+    uint64_t blocks = 0;        // 1 KiB blocks
+    std::string_view name;
+};
+
+template <typename Callback>
+inline void parsePartitions(std::string_view data, Callback&& callback)
+{
+    std::string_view line;
+    while (nextLine(data, line)) {
+        std::string_view field;
+        PartitionLine row;
+        // The header and the blank line after it fail the first number.
+        if (!nextField(line, field) || !parseNumber(field, row.major)) continue;
+        if (!nextField(line, field) || !parseNumber(field, row.minor)) continue;
+        row.blocks = nextU64(line);
+        if (!nextField(line, row.name)) continue;
+        callback(row);
+    }
+}
+
+// ---- /proc/diskstats -------------------------------------------------------
+
+// The first eleven statistics after the device name (see
+// Documentation/admin-guide/iostats.rst); newer discard/flush columns are
+// not needed here.
+struct DiskStatsLine {
+    unsigned major = 0;
+    unsigned minor = 0;
+    std::string_view name;
+    uint64_t readsCompleted = 0;
+    uint64_t readsMerged = 0;
+    uint64_t sectorsRead = 0;
+    uint64_t msReading = 0;
+    uint64_t writesCompleted = 0;
+    uint64_t writesMerged = 0;
+    uint64_t sectorsWritten = 0;
+    uint64_t msWriting = 0;
+    uint64_t iosInProgress = 0;
+    uint64_t msDoingIo = 0;
+    uint64_t weightedMsDoingIo = 0;
+};
+
+template <typename Callback>
+inline void parseDiskStats(std::string_view data, Callback&& callback)
+{
+    std::string_view line;
+    while (nextLine(data, line)) {
+        std::string_view field;
+        DiskStatsLine row;
+        if (!nextField(line, field) || !parseNumber(field, row.major)) continue;
+        if (!nextField(line, field) || !parseNumber(field, row.minor)) continue;
+        if (!nextField(line, row.name)) continue;
+        row.readsCompleted = nextU64(line);
+        row.readsMerged = nextU64(line);
+        row.sectorsRead = nextU64(line);
+        row.msReading = nextU64(line);
+        row.writesCompleted = nextU64(line);
+        row.writesMerged = nextU64(line);
+        row.sectorsWritten = nextU64(line);
+        row.msWriting = nextU64(line);
+        row.iosInProgress = nextU64(line);
+        row.msDoingIo = nextU64(line);
+        row.weightedMsDoingIo = nextU64(line);
+        callback(row);
+    }
+}
+
+} // namespace procfs
+
+#endif // PROCFS_PARSER_H
@@ -0,0 +1,151 @@
+#include "refresh_scheduler.h"
+#include "log_helper.h"
+#include <QCoreApplication>
+#include <QEvent>
+#include <QWidget>
+
+RefreshScheduler* RefreshScheduler::instance()
+{
+    static RefreshScheduler* scheduler = new RefreshScheduler(QCoreApplication::instance());
+    return scheduler;
+}
+
+RefreshScheduler::RefreshScheduler(QObject* parent)
+    : QObject(parent)
+{
+    m_clock.start();
+    connect(Sampler::instance(), &Sampler::sampleReady, this, &RefreshScheduler::onSample);
+}
+
+RefreshScheduler::Settings RefreshScheduler::settings(Profile profile)
+{
+    Settings s;
+    switch (profile) {
+    case LowOverhead:
+        s.displayIntervalMs = 2000;
+        s.backgroundIntervalMs = 30000;
+        s.timerSlackUs = 50000;
+        break;
+    case Normal:
+        s.displayIntervalMs = 1000;
+        s.backgroundIntervalMs = 5000;
+        s.timerSlackUs = 5000;
+        break;
+    case Forensic:
+        s.displayIntervalMs = 1000;
+        s.backgroundIntervalMs = 1000;
+        s.pauseWhenMinimized = false;
+        break;
+    }
+    return s;
+}
+
+QString RefreshScheduler::profileName(Profile profile)
+{
+    switch (profile) {
+    case LowOverhead: return "low-overhead";
+    case Normal: return "normal";
+    case Forensic: return "forensic";
+    }
+    return "normal";
+}
+
+bool RefreshScheduler::profileFromName(const QString& name, Profile* profile)
+{
+    for (Profile p : {LowOverhead, Normal, Forensic}) {
+        if (name == profileName(p)) {
+            *profile = p;
+            return true;
+        }
+    }
+    return false;
+}
+
+RefreshScheduler::Profile RefreshScheduler::requestedProfile(const QStringList& arguments)
+{
+    QString name = qEnvironmentVariable("LSV_PROFILE");
+    for (const QString& arg : arguments) {
+        if (arg.startsWith("--profile=")) name = arg.mid(10);
+    }
+    Profile profile = Normal;
+    if (!name.isEmpty() && !profileFromName(name, &profile)) {
+        appendLog(QString("RefreshScheduler: unknown profile %1, using normal").arg(name));
+    }
+    return profile;
+}
+
+void RefreshScheduler::setProfile(Profile profile)
+{
+    m_profile = profile;
+    const Settings s = settings(profile);
+    Sampler* sampler = Sampler::instance();
+    sampler->setInterval(s.displayIntervalMs);
+    sampler->setBackgroundInterval(s.backgroundIntervalMs);
+    sampler->setTimerSlack(s.timerSlackUs);
+    updateWindowState();
+    appendLog(QString("RefreshScheduler: profile %1").arg(profileName(profile)));
+}
+
+void RefreshScheduler::watchWindow(QWidget* window)
+{
+    if (m_window) m_window->removeEventFilter(this);
+    m_window = window;
+    if (m_window) m_window->installEventFilter(this);
+    updateWindowState();
+}
+
+bool RefreshScheduler::eventFilter(QObject* watched, QEvent* event)
+{
+    if (watched == m_window) {
+        switch (event->type()) {
+        case QEvent::WindowStateChange:
+        case QEvent::Show:
+        case QEvent::Hide:
+            updateWindowState();
+            break;
+        default:
+            break;
+        }
+    }
+    return QObject::eventFilter(watched, event);
+}
+
+void RefreshScheduler::updateWindowState()
+{
+    // Tabs unsubscribe when they are hidden, but a minimised window does
+    // not hide its children.
+    const bool offScreen = m_window && (m_window->isMinimized() || !m_window->isVisible());
+    Sampler::instance()->setDisplayPaused(settings(m_profile).pauseWhenMinimized && offScreen);
+}
+
+void RefreshScheduler::every(QObject* receiver, int periodMs, std::function<void()> task)
+{
+    if (!receiver) return;
+    cancel(receiver);
+    m_tasks.append(Task{receiver, periodMs, -1, std::move(task)});
+    connect(receiver, &QObject::destroyed, this, [this, receiver]() { cancel(receiver); });
+}
+
+void RefreshScheduler::cancel(QObject* receiver)
+{
+    for (int i = m_tasks.size() - 1; i >= 0; --i) {
+        if (m_tasks[i].receiver == receiver) m_tasks.removeAt(i);
+    }
+    disconnect(receiver, &QObject::destroyed, this, nullptr);
+}
+
+void RefreshScheduler::onSample()
+{
+    // Half a tick of tolerance, so a 3 s task on 1 s ticks runs every third
+    // tick and not every fourth when a tick comes in a little early.
+    const qint64 now = m_clock.elapsed();
+    const qint64 tolerance = Sampler::instance()->interval() / 2;
+    for (int i = 0; i < m_tasks.size(); ++i) {
+        Task& task = m_tasks[i];
+        if (task.lastRunMs >= 0 && now - task.lastRunMs < task.periodMs - tolerance) continue;
+        task.lastRunMs = now;
+        // The task may cancel itself; it is copied out of the list first.
+        const std::function<void()> run = task.run;
+        run();
+    }
+}
@@ -0,0 +1,86 @@
+#ifndef REFRESH_SCHEDULER_H
+#define REFRESH_SCHEDULER_H
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QPointer>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <functional>
+#include "sampler.h"
+
+class QWidget;
+
+// One clock for everything LSV refreshes periodically.
+//
+// The sampler tick is the only timer: widgets subscribe to the channels
+// they show while they are visible, and other periodic work runs from
+// every() on the same tick instead of keeping a QTimer of its own. The
+// profile decides how often the sampler ticks while something on screen
+// shows live values and while only background consumers (history, alerts)
+// need it, whether a minimised window still counts as on screen, and how
+// much the kernel may defer a tick to batch it with other wakeups:
+//
+//   low-overhead  2 s on screen, 30 s in the background, 50 ms slack
+//   normal        1 s on screen,  5 s in the background,  5 ms slack
+//   forensic      1 s always, also while minimised, default slack
+class RefreshScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Profile { LowOverhead, Normal, Forensic };
+
+    struct Settings {
+        int displayIntervalMs = Sampler::DefaultIntervalMs;
+        int backgroundIntervalMs = Sampler::DefaultIntervalMs;
+        bool pauseWhenMinimized = true;
+        int timerSlackUs = 0;
+    };
+
+    static RefreshScheduler* instance();
+
+    static Settings settings(Profile profile);
+    static QString profileName(Profile profile);
+    static bool profileFromName(const QString& name, Profile* profile);
+    // --profile=<name>, else LSV_PROFILE, else Normal.
+    static Profile requestedProfile(const QStringList& arguments);
+
+    void setProfile(Profile profile);
+    Profile profile() const { return m_profile; }
+
+    // Pause the display consumers while window is minimised or hidden.
+    void watchWindow(QWidget* window);
+
+    // Run task on a sampler tick at most once per periodMs, until receiver
+    // is destroyed or cancel() is called. Ticks only happen while somebody
+    // subscribes to the sampler, so the receiver subscribes to what it
+    // shows.
+    void every(QObject* receiver, int periodMs, std::function<void()> task);
+    void cancel(QObject* receiver);
+
+protected:
+    bool eventFilter(QObject* watched, QEvent* event) override;
+
+private:
+    explicit RefreshScheduler(QObject* parent = nullptr);
+
+    struct Task {
+        QObject* receiver = nullptr;
+        int periodMs = 0;
+        qint64 lastRunMs = -1;          // on m_clock; -1: not run yet
+        std::function<void()> run;
+    };
+
+    void onSample();
+    void updateWindowState();
+
+    Profile m_profile = Normal;
+    QPointer<QWidget> m_window;
+    QVector<Task> m_tasks;
+    // Monotonic, so setting the wall clock neither stalls nor bunches tasks.
+    QElapsedTimer m_clock;
+};
+
+#endif // REFRESH_SCHEDULER_H
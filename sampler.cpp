@@ -0,0 +1,442 @@
+#include "sampler.h"
+#include "log_helper.h"
+#include "timeseries_store.h"
+#include "alert_engine.h"
+#include "procfs_parser.h"
+#include "sysfs_handle_cache.h"
+#include "trace.h"
+#include <QCoreApplication>
+#include <QThread>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QWaitCondition>
+#include <QDeadlineTimer>
+#include <QElapsedTimer>
+#include <QDateTime>
+#include <QFile>
+#include <QDir>
+#include <QMetaObject>
+#include <atomic>
+#include <functional>
+#include <sys/prctl.h>
+
+namespace {
+
+// Single-producer/single-consumer ring: the sampler thread pushes, the GUI
+// thread pops. Neither side ever blocks; if the GUI falls N samples behind
+// the newest sample is dropped rather than stalling the sampler.
+template <typename T, unsigned N>
+class SpscRing
+{
+    static_assert((N & (N - 1)) == 0, "ring size must be a power of two");
+
+public:
+    bool push(T value)
+    {
+        const unsigned head = m_head.load(std::memory_order_relaxed);
+        const unsigned tail = m_tail.load(std::memory_order_acquire);
+        if (head - tail == N) return false;
+        m_slots[head % N] = std::move(value);
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(T& out)
+    {
+        const unsigned tail = m_tail.load(std::memory_order_relaxed);
+        const unsigned head = m_head.load(std::memory_order_acquire);
+        if (tail == head) return false;
+        out = std::move(m_slots[tail % N]);
+        m_slots[tail % N] = T();
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    T m_slots[N];
+    std::atomic<unsigned> m_head{0};
+    std::atomic<unsigned> m_tail{0};
+};
+
+} // namespace
+
+class SamplerThread : public QThread
+{
+public:
+    std::atomic<int> channels{0};
+    std::atomic<int> intervalMs{Sampler::DefaultIntervalMs};
+    std::atomic<int> timerSlackUs{0};
+    std::atomic<bool> drainPending{false};
+    SpscRing<SamplePtr, 8> queue;
+    std::function<void()> notify;   // called on this thread when a drain is needed
+    std::atomic<quint64> dropped{0};
+    std::atomic<TimeSeriesStore*> history{nullptr};
+    std::atomic<AlertEngine*> alerts{nullptr};
+
+    void kick()
+    {
+        QMutexLocker lock(&m_mutex);
+        m_kick = true;
+        m_wake.wakeAll();
+    }
+
+    void stop()
+    {
+        QMutexLocker lock(&m_mutex);
+        m_stop = true;
+        m_wake.wakeAll();
+    }
+
+protected:
+    void run() override;
+
+private:
+    SamplePtr takeSample(int channels);
+    void readStat(Sample& s);
+    void readMeminfo(Sample& s);
+    void readNetDev(Sample& s, double elapsedSec);
+    void readCpuFreq(Sample& s);
+    void probeCpuFreq();
+
+    QMutex m_mutex;
+    QWaitCondition m_wake;
+    bool m_stop = false;
+    bool m_kick = false;
+    int m_appliedSlackUs = 0;
+
+    quint64 m_sequence = 0;
+    QElapsedTimer m_clock;
+
+    // State carried between ticks to derive rates; only touched by run().
+    CpuTimes m_prevTotal;
+    QVector<CpuTimes> m_prevCpus;
+    QHash<QString, QPair<quint64, quint64>> m_prevNet;  // name -> rx, tx bytes
+    qint64 m_prevNetMs = -1;
+
+    // cpufreq files stay open between ticks and are re-read with pread().
+    // They are resolved again when the set of online cpus changes; min/max
+    // are read then as well.
+    bool m_freqProbed = false;
+    procfs::HandleCache m_freqHandles;
+    int m_onlineSlot = -1;              // /sys/devices/system/cpu/online
+    std::string m_online;
+    QVector<int> m_curFreqSlots;        // index = cpu number; -1: no cpufreq
+    qint64 m_minFreqKHz = 0;
+    qint64 m_maxFreqKHz = 0;
+
+    // Every file of a tick is read into this one buffer.
+    procfs::FileBuffer m_buffer;
+};
+
+void SamplerThread::run()
+{
+    m_clock.start();
+    for (;;) {
+        const int wanted = channels.load(std::memory_order_acquire);
+        // Next multiple of the interval on the monotonic clock, which all
+        // processes share.
+        const qint64 interval = intervalMs.load(std::memory_order_relaxed);
+        QDeadlineTimer nextTick(interval - QDeadlineTimer::current().deadline() % interval);
+        const int slackUs = timerSlackUs.load(std::memory_order_relaxed);
+        if (slackUs != m_appliedSlackUs) {
+            // 0 restores the thread's default slack.
+            prctl(PR_SET_TIMERSLACK, static_cast<unsigned long>(slackUs) * 1000UL, 0, 0, 0);
+            m_appliedSlackUs = slackUs;
+        }
+        if (wanted != 0) {
+            TraceSpan span("sampler", "tick");
+            span.addArg("channels", qint64(wanted));
+            SamplePtr sample = takeSample(wanted);
+            if (TimeSeriesStore* store = history.load(std::memory_order_acquire)) store->record(*sample);
+            if (AlertEngine* engine = alerts.load(std::memory_order_acquire)) engine->evaluate(*sample);
+            if (!queue.push(std::move(sample))) {
+                dropped.fetch_add(1, std::memory_order_relaxed);
+            }
+            // One queued drain covers any number of pushed samples.
+            if (!drainPending.exchange(true, std::memory_order_acq_rel)) notify();
+        }
+
+        QMutexLocker lock(&m_mutex);
+        if (!m_stop && !m_kick) {
+            // Channels are re-read under the lock: subscribe() stores them
+            // before kick(), so a subscription cannot slip in unnoticed.
+            if (channels.load(std::memory_order_acquire) == 0) {
+                m_wake.wait(&m_mutex);
+            } else {
+                m_wake.wait(&m_mutex, nextTick);
+            }
+        }
+        m_kick = false;
+        if (m_stop) break;
+    }
+}
+
+SamplePtr SamplerThread::takeSample(int wanted)
+{
+    auto sample = std::make_shared<Sample>();
+    sample->sequence = ++m_sequence;
+    sample->timestampMs = QDateTime::currentMSecsSinceEpoch();
+    sample->channels = wanted;
+
+    const qint64 nowMs = m_clock.elapsed();
+    if (wanted & Sampler::Cpu) readStat(*sample);
+    if (wanted & Sampler::Memory) readMeminfo(*sample);
+    if (wanted & Sampler::Network) {
+        const double elapsedSec = m_prevNetMs < 0 ? 0.0 : (nowMs - m_prevNetMs) / 1000.0;
+        readNetDev(*sample, elapsedSec);
+        m_prevNetMs = nowMs;
+    } else {
+        m_prevNetMs = -1;
+    }
+    if (wanted & Sampler::CpuFreq) readCpuFreq(*sample);
+    return sample;
+}
+
+void SamplerThread::readStat(Sample& s)
+{
+    auto busyPercent = [](const CpuTimes& now, const CpuTimes& before) {
+        const quint64 total = now.total() - before.total();
+        const quint64 idle = now.idleAll() - before.idleAll();
+        if (total == 0 || now.total() < before.total()) return 0.0;
+        return 100.0 * double(total - idle) / double(total);
+    };
+
+    if (!m_buffer.read("/proc/stat")) return;
+    procfs::parseStatCpu(m_buffer.view(), [&s](const procfs::StatCpuLine& row) {
+        CpuTimes t;
+        t.user = row.ticks[0];
+        t.nice = row.ticks[1];
+        t.system = row.ticks[2];
+        t.idle = row.ticks[3];
+        t.iowait = row.ticks[4];
+        t.irq = row.ticks[5];
+        t.softirq = row.ticks[6];
+        t.steal = row.ticks[7];
+        if (row.cpu < 0) {
+            s.cpuTotal = t;
+        } else {
+            if (s.cpus.size() <= row.cpu) s.cpus.resize(row.cpu + 1);
+            s.cpus[row.cpu] = t;
+        }
+    });
+
+    // The first tick has nothing to compare against and reports 0%.
+    if (m_prevTotal.total() != 0) s.cpuBusyPercent = busyPercent(s.cpuTotal, m_prevTotal);
+    s.cpuBusyPercents.resize(s.cpus.size());
+    for (int i = 0; i < s.cpus.size(); ++i) {
+        if (i < m_prevCpus.size() && m_prevCpus[i].total() != 0) {
+            s.cpuBusyPercents[i] = busyPercent(s.cpus[i], m_prevCpus[i]);
+        }
+    }
+    m_prevTotal = s.cpuTotal;
+    m_prevCpus = s.cpus;
+}
+
+void SamplerThread::readMeminfo(Sample& s)
+{
+    if (!m_buffer.read("/proc/meminfo")) return;
+    procfs::parseMeminfo(m_buffer.view(), [&s](std::string_view key, uint64_t kB) {
+        const quint64 bytes = kB * 1024;
+        if (key == "MemTotal") s.memTotal = bytes;
+        else if (key == "MemFree") s.memFree = bytes;
+        else if (key == "MemAvailable") s.memAvailable = bytes;
+        else if (key == "Buffers") s.buffers = bytes;
+        else if (key == "Cached") s.cached = bytes;
+        else if (key == "SwapTotal") s.swapTotal = bytes;
+        else if (key == "SwapFree") s.swapFree = bytes;
+    });
+}
+
+void SamplerThread::readNetDev(Sample& s, double elapsedSec)
+{
+    if (!m_buffer.read("/proc/net/dev")) return;
+    QHash<QString, QPair<quint64, quint64>> current;
+    procfs::parseNetDev(m_buffer.view(), [&](const procfs::NetDevLine& row) {
+        NetDevCounters c;
+        c.name = procfs::toQString(row.name);
+        c.rxBytes = row.rx[0];
+        c.rxPackets = row.rx[1];
+        c.rxErrors = row.rx[2];
+        c.rxDropped = row.rx[3];
+        c.txBytes = row.tx[0];
+        c.txPackets = row.tx[1];
+        c.txErrors = row.tx[2];
+        c.txDropped = row.tx[3];
+
+        const auto prev = m_prevNet.constFind(c.name);
+        if (elapsedSec > 0 && prev != m_prevNet.constEnd()) {
+            // Counters reset when an interface is re-created; skip that tick.
+            if (c.rxBytes >= prev->first) c.rxBytesPerSec = (c.rxBytes - prev->first) / elapsedSec;
+            if (c.txBytes >= prev->second) c.txBytesPerSec = (c.txBytes - prev->second) / elapsedSec;
+        }
+        current.insert(c.name, qMakePair(c.rxBytes, c.txBytes));
+        s.interfaces.append(c);
+    });
+    m_prevNet.swap(current);
+}
+
+void SamplerThread::probeCpuFreq()
+{
+    m_freqProbed = true;
+    m_freqHandles.clear();
+    m_onlineSlot = m_freqHandles.add("/sys/devices/system/cpu/online");
+    std::string_view online;
+    m_online.assign(m_freqHandles.read(m_onlineSlot, online) ? online : std::string_view());
+
+    const QString base = "/sys/devices/system/cpu/";
+    int maxCpu = -1;
+    const QStringList entries = QDir(procfs::hostPath(base)).entryList(QStringList() << "cpu[0-9]*", QDir::Dirs);
+    for (const QString& e : entries) maxCpu = qMax(maxCpu, e.mid(3).toInt());
+    m_curFreqSlots.fill(-1, maxCpu + 1);
+    for (int cpu = 0; cpu <= maxCpu; ++cpu) {
+        // Offline cpus have no cpufreq directory; they get a slot once the
+        // online list changes.
+        const QString dir = base + QString("cpu%1/cpufreq/").arg(cpu);
+        if (QFile::exists(procfs::hostPath(dir + "scaling_cur_freq"))) m_curFreqSlots[cpu] = m_freqHandles.add((dir + "scaling_cur_freq").toStdString());
+        else if (QFile::exists(procfs::hostPath(dir + "cpuinfo_cur_freq"))) m_curFreqSlots[cpu] = m_freqHandles.add((dir + "cpuinfo_cur_freq").toStdString());
+    }
+    uint64_t kHz = 0;
+    if (procfs::readU64(m_buffer, "/sys/devices/system/cpu/cpu0/cpufreq/cpuinfo_min_freq", kHz)) m_minFreqKHz = qint64(kHz);
+    if (procfs::readU64(m_buffer, "/sys/devices/system/cpu/cpu0/cpufreq/cpuinfo_max_freq", kHz)) m_maxFreqKHz = qint64(kHz);
+}
+
+void SamplerThread::readCpuFreq(Sample& s)
+{
+    // One pread of cpu/online per tick notices hotplug.
+    std::string_view online;
+    if (!m_freqProbed || (m_freqHandles.read(m_onlineSlot, online) && online != m_online)) probeCpuFreq();
+
+    s.minFreqKHz = m_minFreqKHz;
+    s.maxFreqKHz = m_maxFreqKHz;
+    s.curFreqKHz.resize(m_curFreqSlots.size());
+    for (int cpu = 0; cpu < m_curFreqSlots.size(); ++cpu) {
+        uint64_t kHz = 0;
+        if (m_curFreqSlots[cpu] >= 0 && m_freqHandles.readU64(m_curFreqSlots[cpu], kHz)) {
+            s.curFreqKHz[cpu] = qint64(kHz);
+        }
+    }
+}
+
+Sampler* Sampler::instance()
+{
+    static Sampler* sampler = new Sampler(QCoreApplication::instance());
+    return sampler;
+}
+
+Sampler::Sampler(QObject* parent)
+    : QObject(parent)
+    , m_thread(new SamplerThread)
+{
+    m_thread->setObjectName("lsv-sampler");
+    m_thread->notify = [this]() {
+        QMetaObject::invokeMethod(this, [this]() { drain(); }, Qt::QueuedConnection);
+    };
+    if (QCoreApplication::instance()) {
+        // Stop before the event loop and the subscribers go away.
+        connect(QCoreApplication::instance(), &QCoreApplication::aboutToQuit, this, &Sampler::shutdown);
+    }
+    m_thread->start(QThread::LowPriority);
+    appendLog("Sampler: started");
+}
+
+Sampler::~Sampler()
+{
+    shutdown();
+    delete m_thread;
+}
+
+void Sampler::shutdown()
+{
+    if (!m_thread->isRunning()) return;
+    m_thread->stop();
+    m_thread->wait();
+    appendLog(QString("Sampler: stopped, %1 samples dropped").arg(m_thread->dropped.load()));
+}
+
+void Sampler::subscribe(QObject* subscriber, Channels channels, Consumer consumer)
+{
+    if (!subscriber) return;
+    if (!m_subscribers.contains(subscriber)) {
+        connect(subscriber, &QObject::destroyed, this, [this, subscriber]() { unsubscribe(subscriber); });
+    }
+    m_subscribers.insert(subscriber, Subscription{channels, consumer});
+    updateChannels();
+    m_thread->kick();
+}
+
+void Sampler::unsubscribe(QObject* subscriber)
+{
+    if (m_subscribers.remove(subscriber) == 0) return;
+    disconnect(subscriber, &QObject::destroyed, this, nullptr);
+    updateChannels();
+}
+
+void Sampler::updateChannels()
+{
+    Channels wanted;
+    bool display = false;
+    for (auto it = m_subscribers.constBegin(); it != m_subscribers.constEnd(); ++it) {
+        if (it->consumer == Display && m_displayPaused) continue;
+        wanted |= it->channels;
+        display = display || it->consumer == Display;
+    }
+    const int interval = display ? m_intervalMs : m_backgroundIntervalMs;
+    const bool faster = interval < m_thread->intervalMs.load(std::memory_order_relaxed);
+    m_thread->intervalMs.store(interval, std::memory_order_relaxed);
+    m_thread->channels.store(wanted.toInt(), std::memory_order_release);
+    // A thread sleeping out a long background interval starts the short
+    // one now.
+    if (faster) m_thread->kick();
+}
+
+void Sampler::setInterval(int ms)
+{
+    m_intervalMs = qMax(100, ms);
+    updateChannels();
+}
+
+void Sampler::setBackgroundInterval(int ms)
+{
+    m_backgroundIntervalMs = qMax(100, ms);
+    updateChannels();
+}
+
+int Sampler::interval() const
+{
+    return m_thread->intervalMs.load(std::memory_order_relaxed);
+}
+
+void Sampler::setDisplayPaused(bool paused)
+{
+    if (paused == m_displayPaused) return;
+    m_displayPaused = paused;
+    updateChannels();
+}
+
+void Sampler::setTimerSlack(int microseconds)
+{
+    m_thread->timerSlackUs.store(qMax(0, microseconds), std::memory_order_relaxed);
+}
+
+void Sampler::setHistoryStore(TimeSeriesStore* store)
+{
+    m_thread->history.store(store, std::memory_order_release);
+}
+
+void Sampler::setAlertEngine(AlertEngine* engine)
+{
+    m_thread->alerts.store(engine, std::memory_order_release);
+}
+
+void Sampler::drain()
+{
+    // Clear the flag before popping: a sample pushed after this point asks
+    // for a new drain instead of waiting in the queue until the next one.
+    m_thread->drainPending.store(false, std::memory_order_release);
+    TraceSpan span("sampler", "deliver");
+    SamplePtr sample;
+    while (m_thread->queue.pop(sample)) {
+        m_latest = sample;
+        emit sampleReady(m_latest);
+    }
+}
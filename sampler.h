@@ -0,0 +1,167 @@
+#ifndef SAMPLER_H
+#define SAMPLER_H
+
+#include <QObject>
+#include <QString>
+#include <QVector>
+#include <QHash>
+#include <QFlags>
+#include <memory>
+
+// Counters of one "cpu" line of /proc/stat, in USER_HZ ticks.
+struct CpuTimes {
+    quint64 user = 0;
+    quint64 nice = 0;
+    quint64 system = 0;
+    quint64 idle = 0;
+    quint64 iowait = 0;
+    quint64 irq = 0;
+    quint64 softirq = 0;
+    quint64 steal = 0;
+
+    quint64 idleAll() const { return idle + iowait; }
+    quint64 total() const { return user + nice + system + idle + iowait + irq + softirq + steal; }
+};
+
+// Counters of one interface line of /proc/net/dev.
+struct NetDevCounters {
+    QString name;
+    quint64 rxBytes = 0;
+    quint64 rxPackets = 0;
+    quint64 rxErrors = 0;
+    quint64 rxDropped = 0;
+    quint64 txBytes = 0;
+    quint64 txPackets = 0;
+    quint64 txErrors = 0;
+    quint64 txDropped = 0;
+    double rxBytesPerSec = 0;   // since the previous sample
+    double txBytesPerSec = 0;
+};
+
+// One tick of the sampler. Built on the sampler thread and never modified
+// once published, so subscribers can keep and read it from any thread.
+// Only the groups named in `channels` are filled in.
+struct Sample {
+    quint64 sequence = 0;
+    qint64 timestampMs = 0;     // wall clock, ms since epoch
+    int channels = 0;           // Sampler::Channel bits
+
+    // /proc/stat
+    CpuTimes cpuTotal;
+    QVector<CpuTimes> cpus;             // index = cpu number
+    double cpuBusyPercent = 0;          // since the previous sample
+    QVector<double> cpuBusyPercents;
+
+    // /proc/meminfo, in bytes
+    quint64 memTotal = 0;
+    quint64 memFree = 0;
+    quint64 memAvailable = 0;
+    quint64 buffers = 0;
+    quint64 cached = 0;
+    quint64 swapTotal = 0;
+    quint64 swapFree = 0;
+
+    // /proc/net/dev
+    QVector<NetDevCounters> interfaces;
+
+    // cpufreq, in kHz; 0 where the kernel does not expose a value
+    QVector<qint64> curFreqKHz;         // index = cpu number
+    qint64 minFreqKHz = 0;
+    qint64 maxFreqKHz = 0;
+};
+
+using SamplePtr = std::shared_ptr<const Sample>;
+
+class SamplerThread;
+class TimeSeriesStore;
+class AlertEngine;
+
+// Single source of live metrics. One background thread reads /proc/stat,
+// /proc/meminfo, /proc/net/dev and the cpufreq files once per tick and hands
+// the finished Sample to the GUI thread through a lock-free queue; widgets
+// only format and paint what they are given.
+//
+// Files are only read for channels somebody subscribed to, and the thread
+// sleeps while there are no subscribers (hidden tabs unsubscribe).
+//
+// Subscribers are Display consumers (widgets, agent clients) or Background
+// ones (history, alerts, metrics export). The thread ticks every interval()
+// while a display consumer is subscribed and every backgroundInterval()
+// otherwise; setDisplayPaused() discounts the display consumers, e.g. while
+// the window is minimised. Ticks fall on multiples of the interval on the
+// monotonic clock, so every LSV process on the machine wakes at the same
+// moments. RefreshScheduler (refresh_scheduler.h) sets these per profile.
+class Sampler : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Channel {
+        Cpu = 0x1,          // /proc/stat
+        Memory = 0x2,       // /proc/meminfo
+        Network = 0x4,      // /proc/net/dev
+        CpuFreq = 0x8       // /sys/devices/system/cpu/cpuN/cpufreq
+    };
+    Q_DECLARE_FLAGS(Channels, Channel)
+
+    static constexpr int DefaultIntervalMs = 1000;
+
+    static Sampler* instance();
+
+    // Sample `channels` on behalf of subscriber until unsubscribe() or until
+    // the subscriber is destroyed. Subscribing again replaces its channels.
+    // A new subscription triggers an immediate tick.
+    enum Consumer { Display, Background };
+
+    void subscribe(QObject* subscriber, Channels channels, Consumer consumer = Display);
+    void unsubscribe(QObject* subscriber);
+
+    // Most recent sample delivered on the GUI thread, or null before the
+    // first tick.
+    SamplePtr latest() const { return m_latest; }
+
+    void setInterval(int ms);
+    void setBackgroundInterval(int ms);
+    // The interval the thread ticks at now.
+    int interval() const;
+    void setDisplayPaused(bool paused);
+    // Timer slack of the sampler thread (prctl PR_SET_TIMERSLACK); the
+    // kernel may defer a tick by up to this much to batch wakeups. 0 keeps
+    // the default.
+    void setTimerSlack(int microseconds);
+
+    // Hand every sample to store->record() on the sampler thread, before
+    // it is queued for the GUI. Pass nullptr to stop recording.
+    void setHistoryStore(TimeSeriesStore* store);
+    // Hand every sample to engine->evaluate() on the sampler thread, after
+    // the history store. Pass nullptr to stop.
+    void setAlertEngine(AlertEngine* engine);
+
+signals:
+    // Emitted on the GUI thread for every sample, in order.
+    void sampleReady(const SamplePtr& sample);
+
+private:
+    explicit Sampler(QObject* parent = nullptr);
+    ~Sampler() override;
+
+    void updateChannels();
+    void drain();
+    void shutdown();
+
+    struct Subscription {
+        Channels channels;
+        Consumer consumer = Display;
+    };
+
+    SamplerThread* m_thread = nullptr;
+    QHash<QObject*, Subscription> m_subscribers;
+    int m_intervalMs = DefaultIntervalMs;
+    int m_backgroundIntervalMs = DefaultIntervalMs;
+    bool m_displayPaused = false;
+    SamplePtr m_latest;
+};
+
+Q_DECLARE_OPERATORS_FOR_FLAGS(Sampler::Channels)
+
+#endif // SAMPLER_H
@@ -0,0 +1,146 @@
+#include "search_box.h"
+#include "multitabs.h"
+#include <QKeyEvent>
+#include <QLabel>
+#include <QListWidget>
+#include <QPlainTextEdit>
+#include <QScrollArea>
+#include <QTableView>
+#include <QTextEdit>
+#include <QTimer>
+
+namespace {
+
+constexpr int MaxHits = 200;
+
+} // namespace
+
+SearchBox::SearchBox(MultiRowTabWidget* tabs, QWidget* parent)
+    : QLineEdit(parent), m_tabs(tabs), m_results(new QListWidget), m_queryTimer(new QTimer(this))
+{
+    setPlaceholderText("Search all tabs (word*, /regex)");
+    setClearButtonEnabled(true);
+    setMinimumWidth(220);
+
+    m_results->setMaximumHeight(160);
+    m_results->setUniformItemSizes(true);
+    m_results->setFocusPolicy(Qt::NoFocus);
+    m_results->hide();
+    connect(m_results, &QListWidget::itemActivated, this, &SearchBox::activate);
+    connect(m_results, &QListWidget::itemClicked, this, &SearchBox::activate);
+
+    // Queries take microseconds; the zero timer only folds a burst of
+    // keystrokes (or index updates) into one run per event-loop pass.
+    m_queryTimer->setSingleShot(true);
+    m_queryTimer->setInterval(0);
+    connect(m_queryTimer, &QTimer::timeout, this, &SearchBox::runQuery);
+    connect(this, &QLineEdit::textChanged, m_queryTimer, qOverload<>(&QTimer::start));
+    connect(SearchIndex::instance(), &SearchIndex::updated, this, [this]() {
+        if (!m_results->isHidden()) m_queryTimer->start();
+    });
+}
+
+void SearchBox::runQuery()
+{
+    QString query = text().trimmed();
+    m_results->clear();
+    m_hits.clear();
+    if (query.length() < 2) {
+        m_results->hide();
+        return;
+    }
+
+    SearchIndex::Mode mode = SearchIndex::Substring;
+    if (query.startsWith('/')) {
+        mode = SearchIndex::Regex;
+        query = query.mid(1);
+        if (query.endsWith('/')) query.chop(1);
+    } else if (query.contains('*')) {
+        mode = SearchIndex::Prefix;
+        query.remove('*');
+    }
+
+    m_hits = SearchIndex::instance()->search(query, mode, MaxHits);
+    for (const SearchIndex::Hit& hit : m_hits) {
+        m_results->addItem(QString("%1 — %2").arg(hit.tab, hit.text));
+    }
+    if (m_hits.isEmpty()) {
+        QListWidgetItem* none = new QListWidgetItem("No matches");
+        none->setFlags(Qt::NoItemFlags);
+        m_results->addItem(none);
+    } else if (m_hits.size() == MaxHits) {
+        QListWidgetItem* more = new QListWidgetItem(QString("First %1 matches shown").arg(MaxHits));
+        more->setFlags(Qt::NoItemFlags);
+        m_results->addItem(more);
+    }
+    m_results->setCurrentRow(m_hits.isEmpty() ? -1 : 0);
+    m_results->show();
+}
+
+void SearchBox::keyPressEvent(QKeyEvent* event)
+{
+    const int rows = m_hits.size();
+    switch (event->key()) {
+    case Qt::Key_Down:
+        if (rows > 0) m_results->setCurrentRow(qMin(m_results->currentRow() + 1, rows - 1));
+        return;
+    case Qt::Key_Up:
+        if (rows > 0) m_results->setCurrentRow(qMax(m_results->currentRow() - 1, 0));
+        return;
+    case Qt::Key_Return:
+    case Qt::Key_Enter:
+        if (rows > 0) activate(m_results->item(qMax(m_results->currentRow(), 0)));
+        return;
+    case Qt::Key_Escape:
+        clear();
+        return;
+    default:
+        QLineEdit::keyPressEvent(event);
+    }
+}
+
+void SearchBox::activate(QListWidgetItem* item)
+{
+    const int index = item ? m_results->row(item) : -1;
+    if (index < 0 || index >= m_hits.size()) return;
+    navigate(m_hits[index]);
+}
+
+void SearchBox::navigate(const SearchIndex::Hit& hit)
+{
+    QWidget* target = hit.target;
+    if (!target) return; // tab rebuilt since; the index is updated next pass
+
+    for (int i = 0; i < m_tabs->count(); ++i) {
+        QWidget* page = m_tabs->widget(i);
+        if (page && (page == target || page->isAncestorOf(target))) {
+            m_tabs->setCurrentIndex(i);
+            break;
+        }
+    }
+
+    for (QWidget* w = target->parentWidget(); w; w = w->parentWidget()) {
+        if (QScrollArea* area = qobject_cast<QScrollArea*>(w)) {
+            area->ensureWidgetVisible(target);
+            break;
+        }
+    }
+
+    if (QTableView* table = qobject_cast<QTableView*>(target)) {
+        if (table->model() && hit.row < table->model()->rowCount()) {
+            table->selectRow(hit.row);
+            table->scrollTo(table->model()->index(hit.row, 0), QAbstractItemView::PositionAtCenter);
+        }
+    } else if (QTextEdit* edit = qobject_cast<QTextEdit*>(target)) {
+        edit->moveCursor(QTextCursor::Start);
+        edit->find(hit.text);
+    } else if (QPlainTextEdit* edit = qobject_cast<QPlainTextEdit*>(target)) {
+        edit->moveCursor(QTextCursor::Start);
+        edit->find(hit.text);
+    } else if (QLabel* label = qobject_cast<QLabel*>(target)) {
+        const int at = label->text().indexOf(hit.text);
+        if (at >= 0 && label->textFormat() != Qt::RichText && (label->textInteractionFlags() & Qt::TextSelectableByMouse)) {
+            label->setSelection(at, hit.text.length());
+        }
+    }
+}
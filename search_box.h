@@ -0,0 +1,43 @@
+#ifndef SEARCH_BOX_H
+#define SEARCH_BOX_H
+
+#include <QLineEdit>
+#include <QVector>
+#include "search_index.h"
+
+class QListWidget;
+class QListWidgetItem;
+class QTimer;
+class QKeyEvent;
+class MultiRowTabWidget;
+
+// Title-bar search over every tab, answered by SearchIndex as you type.
+//
+// Plain words match anywhere in a row, "word*" matches token prefixes and
+// "/pattern" is a regular expression. Hits are listed in resultsView(),
+// which the caller places in its layout; activating one switches to the tab
+// and selects the row.
+class SearchBox : public QLineEdit
+{
+    Q_OBJECT
+
+public:
+    explicit SearchBox(MultiRowTabWidget* tabs, QWidget* parent = nullptr);
+
+    QListWidget* resultsView() const { return m_results; }
+
+protected:
+    void keyPressEvent(QKeyEvent* event) override;
+
+private:
+    void runQuery();
+    void activate(QListWidgetItem* item);
+    void navigate(const SearchIndex::Hit& hit);
+
+    MultiRowTabWidget* m_tabs;
+    QListWidget* m_results;
+    QTimer* m_queryTimer;
+    QVector<SearchIndex::Hit> m_hits;
+};
+
+#endif // SEARCH_BOX_H
@@ -0,0 +1,344 @@
+#include "search_index.h"
+#include "log_helper.h"
+#include "trace.h"
+#include <QCoreApplication>
+#include <QDialog>
+#include <QLabel>
+#include <QPlainTextEdit>
+#include <QRegularExpression>
+#include <QTableView>
+#include <QTextDocumentFragment>
+#include <QTextEdit>
+#include <algorithm>
+
+namespace {
+
+// Calls f with every token (run of letters, digits and '_') of folded text.
+template <typename Callback>
+void forEachToken(const QString& folded, Callback&& callback)
+{
+    int start = -1;
+    for (int i = 0; i <= folded.size(); ++i) {
+        const bool inToken = i < folded.size() && (folded[i].isLetterOrNumber() || folded[i] == QLatin1Char('_'));
+        if (inToken && start < 0) {
+            start = i;
+        } else if (!inToken && start >= 0) {
+            callback(QStringView(folded).mid(start, i - start));
+            start = -1;
+        }
+    }
+}
+
+quint64 trigramKey(QStringView s, int at)
+{
+    return (quint64(s[at].unicode()) << 32) | (quint64(s[at + 1].unicode()) << 16) | quint64(s[at + 2].unicode());
+}
+
+std::vector<int> intersect(const std::vector<int>& a, const std::vector<int>& b)
+{
+    std::vector<int> out;
+    out.reserve(std::min(a.size(), b.size()));
+    std::set_intersection(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(out));
+    return out;
+}
+
+// Geek dialogs are children of their tab but are not part of what the tab shows.
+bool insideDialog(const QWidget* widget, const QWidget* root)
+{
+    for (const QWidget* w = widget; w && w != root; w = w->parentWidget()) {
+        if (qobject_cast<const QDialog*>(w)) return true;
+    }
+    return false;
+}
+
+QStringList textLines(const QString& text, bool maybeRich)
+{
+    const QString plain = maybeRich && Qt::mightBeRichText(text) ? QTextDocumentFragment::fromHtml(text).toPlainText() : text;
+    QStringList lines;
+    for (const QString& line : plain.split(QLatin1Char('\n'))) {
+        const QString trimmed = line.trimmed();
+        if (!trimmed.isEmpty()) lines << trimmed;
+    }
+    return lines;
+}
+
+} // namespace
+
+SearchIndex* SearchIndex::instance()
+{
+    static SearchIndex* index = new SearchIndex(QCoreApplication::instance());
+    return index;
+}
+
+SearchIndex::SearchIndex(QObject* parent)
+    : QObject(parent)
+{
+}
+
+void SearchIndex::publish(const QString& tab, QWidget* root)
+{
+    if (!root) return;
+    TraceSpan span("search", "SearchIndex::publish");
+    span.addArg("tab", tab);
+
+    remove(root);
+    // One connection per root however often it is published or removed.
+    connect(root, &QObject::destroyed, this, &SearchIndex::onRootDestroyed, Qt::UniqueConnection);
+
+    QVector<int> ids;
+    // QTableWidgets and the views over InfoTableModel alike.
+    for (QTableView* table : root->findChildren<QTableView*>()) {
+        const QAbstractItemModel* model = table->model();
+        if (!model || insideDialog(table, root)) continue;
+        for (int row = 0; row < model->rowCount(); ++row) {
+            QStringList cells;
+            for (int col = 0; col < model->columnCount(); ++col) {
+                const QString text = model->index(row, col).data().toString().trimmed();
+                if (!text.isEmpty()) cells << text;
+            }
+            if (!cells.isEmpty()) addDocument(tab, cells.join(QLatin1String(" | ")), table, row, ids);
+        }
+    }
+    for (QLabel* label : root->findChildren<QLabel*>()) {
+        if (insideDialog(label, root)) continue;
+        const QStringList lines = textLines(label->text(), label->textFormat() != Qt::PlainText);
+        for (int line = 0; line < lines.size(); ++line) addDocument(tab, lines[line], label, line, ids);
+    }
+    for (QTextEdit* edit : root->findChildren<QTextEdit*>()) {
+        if (insideDialog(edit, root)) continue;
+        const QStringList lines = textLines(edit->toPlainText(), false);
+        for (int line = 0; line < lines.size(); ++line) addDocument(tab, lines[line], edit, line, ids);
+    }
+    for (QPlainTextEdit* edit : root->findChildren<QPlainTextEdit*>()) {
+        if (insideDialog(edit, root)) continue;
+        const QStringList lines = textLines(edit->toPlainText(), false);
+        for (int line = 0; line < lines.size(); ++line) addDocument(tab, lines[line], edit, line, ids);
+    }
+    m_published.insert(root, ids);
+    span.addArg("documents", qint64(ids.size()));
+
+    emit updated();
+}
+
+void SearchIndex::remove(const QObject* root)
+{
+    auto it = m_published.find(root);
+    if (it == m_published.end()) return;
+
+    // Mark the documents dead first and then filter each affected postings
+    // list once: erasing id by id is quadratic in the length of the lists
+    // of common tokens, which every row of a big table shares.
+    std::vector<int> touched;
+    for (int id : it.value()) {
+        Document& doc = m_documents[size_t(id)];
+        touched.insert(touched.end(), doc.tokens.begin(), doc.tokens.end());
+        doc = Document();
+        doc.alive = false;
+        --m_liveDocuments;
+    }
+    m_published.erase(it);
+    std::sort(touched.begin(), touched.end());
+    touched.erase(std::unique(touched.begin(), touched.end()), touched.end());
+    for (int token : touched) {
+        std::vector<int>& postings = m_tokens[size_t(token)].postings;
+        postings.erase(std::remove_if(postings.begin(), postings.end(),
+                                      [this](int id) { return !m_documents[size_t(id)].alive; }),
+                       postings.end());
+    }
+
+    // Document ids only grow; rebuild once most of them are dead.
+    const int dead = int(m_documents.size()) - m_liveDocuments;
+    if (dead > 4096 && dead > m_liveDocuments) compact();
+}
+
+void SearchIndex::onRootDestroyed(QObject* root)
+{
+    remove(root);
+    emit updated();
+}
+
+void SearchIndex::addDocument(const QString& tab, const QString& text, QWidget* target, int row, QVector<int>& ids)
+{
+    const int id = int(m_documents.size());
+    Document doc;
+    doc.tab = tab;
+    doc.text = text;
+    doc.folded = text.toCaseFolded();
+    doc.target = target;
+    doc.row = row;
+    forEachToken(doc.folded, [&](QStringView token) { doc.tokens.push_back(tokenId(token.toString())); });
+    std::sort(doc.tokens.begin(), doc.tokens.end());
+    doc.tokens.erase(std::unique(doc.tokens.begin(), doc.tokens.end()), doc.tokens.end());
+    for (int token : doc.tokens) m_tokens[size_t(token)].postings.push_back(id); // ids ascend
+    m_documents.push_back(std::move(doc));
+    ids.append(id);
+    ++m_liveDocuments;
+}
+
+int SearchIndex::tokenId(const QString& token)
+{
+    auto it = m_tokenIds.constFind(token);
+    if (it != m_tokenIds.constEnd()) return it.value();
+
+    const int id = int(m_tokens.size());
+    m_tokens.push_back(Token{token, {}});
+    m_tokenIds.insert(token, id);
+    for (int i = 0; i + 3 <= token.size(); ++i) {
+        std::vector<int>& list = m_trigrams[trigramKey(token, i)];
+        if (list.empty() || list.back() != id) list.push_back(id);
+    }
+    m_sortedDirty = true;
+    return id;
+}
+
+void SearchIndex::compact()
+{
+    std::vector<Document> old;
+    old.swap(m_documents);
+    m_tokens.clear();
+    m_tokenIds.clear();
+    m_trigrams.clear();
+    m_sortedTokens.clear();
+    m_sortedDirty = true;
+    m_liveDocuments = 0;
+
+    // Re-add in the old order so hits keep their publish order.
+    std::vector<int> newId(old.size(), -1);
+    QVector<int> scratch;
+    for (size_t i = 0; i < old.size(); ++i) {
+        if (!old[i].alive) continue;
+        newId[i] = int(m_documents.size());
+        addDocument(old[i].tab, old[i].text, old[i].target, old[i].row, scratch);
+    }
+    for (QVector<int>& ids : m_published) {
+        for (int& id : ids) id = newId[size_t(id)];
+    }
+    appendLog(QString("SearchIndex: compacted to %1 documents, %2 tokens").arg(m_liveDocuments).arg(m_tokens.size()));
+}
+
+std::vector<int> SearchIndex::tokensContaining(const QString& needle) const
+{
+    std::vector<int> out;
+    if (needle.size() < 3) {
+        // Too short for a trigram; the dictionary is far smaller than the rows.
+        for (size_t id = 0; id < m_tokens.size(); ++id) {
+            if (!m_tokens[id].postings.empty() && m_tokens[id].text.contains(needle)) out.push_back(int(id));
+        }
+        return out;
+    }
+
+    // Candidates from the rarest trigram of the needle, then verified.
+    const std::vector<int>* rarest = nullptr;
+    for (int i = 0; i + 3 <= needle.size(); ++i) {
+        auto it = m_trigrams.constFind(trigramKey(needle, i));
+        if (it == m_trigrams.constEnd()) return out;
+        if (!rarest || it->size() < rarest->size()) rarest = &it.value();
+    }
+    for (int id : *rarest) {
+        const Token& token = m_tokens[size_t(id)];
+        if (!token.postings.empty() && token.text.contains(needle)) out.push_back(id);
+    }
+    return out;
+}
+
+std::vector<int> SearchIndex::tokensWithPrefix(const QString& prefix) const
+{
+    if (m_sortedDirty) {
+        m_sortedTokens.resize(m_tokens.size());
+        for (size_t i = 0; i < m_tokens.size(); ++i) m_sortedTokens[i] = int(i);
+        std::sort(m_sortedTokens.begin(), m_sortedTokens.end(), [this](int a, int b) {
+            return m_tokens[size_t(a)].text < m_tokens[size_t(b)].text;
+        });
+        m_sortedDirty = false;
+    }
+
+    std::vector<int> out;
+    auto it = std::lower_bound(m_sortedTokens.begin(), m_sortedTokens.end(), prefix, [this](int id, const QString& p) {
+        return m_tokens[size_t(id)].text < p;
+    });
+    for (; it != m_sortedTokens.end() && m_tokens[size_t(*it)].text.startsWith(prefix); ++it) {
+        if (!m_tokens[size_t(*it)].postings.empty()) out.push_back(*it);
+    }
+    return out;
+}
+
+std::vector<int> SearchIndex::documentsOf(const std::vector<int>& tokens) const
+{
+    std::vector<int> out;
+    if (tokens.size() == 1) return m_tokens[size_t(tokens.front())].postings;
+    for (int token : tokens) {
+        const std::vector<int>& postings = m_tokens[size_t(token)].postings;
+        out.insert(out.end(), postings.begin(), postings.end());
+    }
+    std::sort(out.begin(), out.end());
+    out.erase(std::unique(out.begin(), out.end()), out.end());
+    return out;
+}
+
+SearchIndex::Hit SearchIndex::hitFor(int document) const
+{
+    const Document& doc = m_documents[size_t(document)];
+    Hit hit;
+    hit.tab = doc.tab;
+    hit.text = doc.text;
+    hit.target = doc.target;
+    hit.row = doc.row;
+    return hit;
+}
+
+QVector<SearchIndex::Hit> SearchIndex::search(const QString& query, Mode mode, int limit) const
+{
+    QVector<Hit> hits;
+    if (query.trimmed().isEmpty() || limit <= 0) return hits;
+    TraceSpan span("search", "SearchIndex::search");
+    span.addArg("query", query);
+
+    if (mode == Regex) {
+        // No token structure to use; one match per row text.
+        const QRegularExpression regex(query, QRegularExpression::CaseInsensitiveOption);
+        if (!regex.isValid()) return hits;
+        for (size_t id = 0; id < m_documents.size() && hits.size() < limit; ++id) {
+            if (m_documents[id].alive && regex.match(m_documents[id].text).hasMatch()) hits.append(hitFor(int(id)));
+        }
+        return hits;
+    }
+
+    const QStringList words = query.toCaseFolded().split(QRegularExpression("\\s+"), Qt::SkipEmptyParts);
+
+    // Rows that contain every token of every word (as a substring or a
+    // prefix of one of their tokens).
+    std::vector<int> candidates;
+    bool narrowed = false;
+    for (const QString& word : words) {
+        forEachToken(word, [&](QStringView tokenView) {
+            if (narrowed && candidates.empty()) return;
+            const QString token = tokenView.toString();
+            const std::vector<int> docs = documentsOf(mode == Prefix ? tokensWithPrefix(token) : tokensContaining(token));
+            candidates = narrowed ? intersect(candidates, docs) : docs;
+            narrowed = true;
+        });
+    }
+
+    auto verify = [&](const Document& doc) {
+        if (!doc.alive) return false;
+        if (mode == Prefix) return true; // tokens already matched exactly
+        for (const QString& word : words) {
+            if (!doc.folded.contains(word)) return false;
+        }
+        return true;
+    };
+
+    if (narrowed) {
+        for (int id : candidates) {
+            if (hits.size() >= limit) break;
+            if (verify(m_documents[size_t(id)])) hits.append(hitFor(id));
+        }
+    } else {
+        // Only punctuation was typed: nothing to look up, scan the rows.
+        for (size_t id = 0; id < m_documents.size() && hits.size() < limit; ++id) {
+            if (mode == Substring && verify(m_documents[id])) hits.append(hitFor(int(id)));
+        }
+    }
+    span.addArg("hits", qint64(hits.size()));
+    return hits;
+}
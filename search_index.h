@@ -0,0 +1,102 @@
+#ifndef SEARCH_INDEX_H
+#define SEARCH_INDEX_H
+
+#include <QObject>
+#include <QHash>
+#include <QPointer>
+#include <QString>
+#include <QVector>
+#include <vector>
+
+class QWidget;
+
+// Inverted index over everything the tabs display, for the global search.
+//
+// A tab publishes its view after each load: every table row and every line
+// of a label or text view becomes one document. Documents are split into
+// case-folded tokens (runs of letters and digits); the index maps tokens to
+// the documents containing them and token trigrams to tokens, so a query
+// only touches the few tokens and rows that can match instead of every cell
+// of every table. Publishing again replaces that tab's documents only.
+//
+// Used from the GUI thread.
+class SearchIndex : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Mode {
+        Substring,      // every word occurs in the row
+        Prefix,         // every word starts a token of the row
+        Regex           // the pattern matches the row (case-insensitive)
+    };
+
+    struct Hit {
+        QString tab;
+        QString text;               // the row, cells joined by " | "
+        QPointer<QWidget> target;   // table, label or text view holding it
+        int row = -1;               // table row, or line of a label/text view
+    };
+
+    static SearchIndex* instance();
+
+    // Replace what was published for root with the rows of its tables and
+    // the lines of its labels and text views (dialogs excluded).
+    void publish(const QString& tab, QWidget* root);
+    void remove(const QObject* root);
+
+    // Hits in publish order, at most limit of them. Invalid regular
+    // expressions and empty queries give no hits.
+    QVector<Hit> search(const QString& query, Mode mode, int limit = 200) const;
+
+    int documentCount() const { return m_liveDocuments; }
+    int tokenCount() const { return m_tokens.size(); }
+
+signals:
+    // Published content changed; open queries may want to re-run.
+    void updated();
+
+private:
+    explicit SearchIndex(QObject* parent = nullptr);
+
+    void onRootDestroyed(QObject* root);
+
+    struct Document {
+        QString tab;
+        QString text;
+        QString folded;             // case-folded text, for verification
+        QPointer<QWidget> target;
+        int row = -1;
+        std::vector<int> tokens;    // distinct token ids
+        bool alive = true;
+    };
+
+    struct Token {
+        QString text;
+        std::vector<int> postings;  // ascending document ids
+    };
+
+    void addDocument(const QString& tab, const QString& text, QWidget* target, int row, QVector<int>& ids);
+    int tokenId(const QString& token);
+    void compact();
+
+    // Token ids whose text contains (or starts with) needle.
+    std::vector<int> tokensContaining(const QString& needle) const;
+    std::vector<int> tokensWithPrefix(const QString& prefix) const;
+    // Sorted union of the postings of tokens.
+    std::vector<int> documentsOf(const std::vector<int>& tokens) const;
+    Hit hitFor(int document) const;
+
+    std::vector<Document> m_documents;
+    std::vector<Token> m_tokens;
+    QHash<QString, int> m_tokenIds;
+    QHash<quint64, std::vector<int>> m_trigrams;    // trigram -> ascending token ids
+    QHash<const QObject*, QVector<int>> m_published; // root -> its documents
+    int m_liveDocuments = 0;
+
+    // Token ids in text order, for prefix lookups; rebuilt after new tokens.
+    mutable std::vector<int> m_sortedTokens;
+    mutable bool m_sortedDirty = false;
+};
+
+#endif // SEARCH_INDEX_H
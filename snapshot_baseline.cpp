@@ -0,0 +1,71 @@
+#include "snapshot_baseline.h"
+#include "lsv_headless.h"
+#include "log_helper.h"
+#include "trace.h"
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QJsonObject>
+#include <QThreadPool>
+
+SnapshotBaseline* SnapshotBaseline::instance()
+{
+    static SnapshotBaseline* baseline = new SnapshotBaseline(QCoreApplication::instance());
+    return baseline;
+}
+
+SnapshotBaseline::SnapshotBaseline(QObject* parent)
+    : QObject(parent)
+{
+}
+
+QString SnapshotBaseline::requestedPath(const QStringList& arguments)
+{
+    for (const QString& arg : arguments) {
+        if (arg.startsWith("--baseline=")) return QFileInfo(arg.mid(11)).absoluteFilePath();
+    }
+    const QString env = qEnvironmentVariable("LSV_BASELINE");
+    return env.isEmpty() ? QString() : QFileInfo(env).absoluteFilePath();
+}
+
+bool SnapshotBaseline::start(const QString& path)
+{
+    if (isActive()) return true;
+    QJsonObject before;
+    QString error;
+    if (!loadSnapshotDocument(path, &before, &error)) {
+        appendLog("Baseline: " + error);
+        return false;
+    }
+    m_path = path;
+
+    QThreadPool::globalInstance()->start([this, before]() {
+        TraceSpan span("baseline", "SnapshotBaseline::compare");
+        QElapsedTimer clock;
+        clock.start();
+        const QJsonObject sections = collectHeadlessSections(before.value("sections").toObject().keys());
+        const QJsonObject after = headlessDocument(sections, clock.elapsed());
+        const SnapshotTree beforeTree = SnapshotTree::fromDocument(before, defaultDiffIgnore());
+        const SnapshotTree afterTree = SnapshotTree::fromDocument(after, defaultDiffIgnore());
+        SnapshotDiff diff = diffSnapshots(beforeTree, afterTree);
+        QMetaObject::invokeMethod(this, [this, diff]() {
+            m_diff = diff;
+            m_ready = true;
+            appendLog(QString("Baseline: %1 change(s) against %2, diff took %3 us")
+                          .arg(m_diff.changes.size()).arg(m_path).arg(m_diff.elapsedUs));
+            emit ready();
+        }, Qt::QueuedConnection);
+    });
+    return true;
+}
+
+QHash<QString, QString> SnapshotBaseline::changedRows(const QString& section) const
+{
+    QHash<QString, QString> rows;
+    for (const SnapshotChange& change : m_diff.changes) {
+        if (change.section != section || change.path.isEmpty() || change.path.contains('/')) continue;
+        if (change.kind == SnapshotChange::Changed) rows.insert(change.path, change.before);
+        else if (change.kind == SnapshotChange::Added) rows.insert(change.path, QString());
+    }
+    return rows;
+}
@@ -0,0 +1,50 @@
+#ifndef SNAPSHOT_BASELINE_H
+#define SNAPSHOT_BASELINE_H
+
+#include <QHash>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include "snapshot_diff.h"
+
+// The document of an earlier `lsv --json` run (`--baseline=<file>` or
+// LSV_BASELINE) and how this machine differs from it, for tabs that mark
+// what changed.
+//
+// start() collects the sections the file holds on a pool thread and diffs
+// them; ready() is emitted on the GUI thread once the result is in.
+class SnapshotBaseline : public QObject
+{
+    Q_OBJECT
+
+public:
+    static SnapshotBaseline* instance();
+
+    // Baseline file asked for by --baseline=<file>, else LSV_BASELINE.
+    static QString requestedPath(const QStringList& arguments);
+
+    // Load path and start the comparison. False if the file is unusable.
+    bool start(const QString& path);
+
+    bool isActive() const { return !m_path.isEmpty(); }
+    bool isReady() const { return m_ready; }
+    QString path() const { return m_path; }
+    const SnapshotDiff& diff() const { return m_diff; }
+
+    // Rows of a row section (cpu, os, ...) that differ from the baseline,
+    // by property: the baseline value, or a null string for rows the
+    // baseline does not have.
+    QHash<QString, QString> changedRows(const QString& section) const;
+
+signals:
+    void ready();
+
+private:
+    explicit SnapshotBaseline(QObject* parent = nullptr);
+
+    QString m_path;
+    bool m_ready = false;
+    SnapshotDiff m_diff;
+};
+
+#endif // SNAPSHOT_BASELINE_H
@@ -0,0 +1,191 @@
+#include "snapshot_cache.h"
+#include "log_helper.h"
+#include "version.h"
+#include "capture.h"
+#include "procfs_parser.h"
+#include <QCoreApplication>
+#include <QStandardPaths>
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+#include <QDataStream>
+#include <QCryptographicHash>
+#include <QElapsedTimer>
+
+namespace {
+
+constexpr quint32 CacheMagic = 0x4c535643; // "LSVC"
+// Bump whenever the stored layout or the meaning of a key changes.
+constexpr quint32 CacheFormat = 1;
+constexpr int SaveDelayMs = 2000;
+
+QByteArray readSmallFile(const QString& path)
+{
+    QFile f(procfs::hostPath(path));
+    if (!f.open(QIODevice::ReadOnly)) return QByteArray();
+    return f.read(4096).trimmed();
+}
+
+} // namespace
+
+SnapshotCache* SnapshotCache::instance()
+{
+    static SnapshotCache* cache = new SnapshotCache(QCoreApplication::instance());
+    return cache;
+}
+
+SnapshotCache::SnapshotCache(QObject* parent)
+    : QObject(parent)
+{
+    QString dir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    if (dir.isEmpty()) dir = QDir::tempPath() + "/lsv-cache";
+    QDir().mkpath(dir);
+    m_path = dir + "/hardware-snapshot.bin";
+
+    m_bootId = readBootId();
+    m_fingerprint = computeFingerprint();
+    if (Capture::mode() != Capture::Off) {
+        // Recording has to see every command run, and a replay must not
+        // mix in (or overwrite) this machine's cache: memory only.
+        m_path.clear();
+    } else {
+        load();
+    }
+
+    m_saveTimer.setSingleShot(true);
+    m_saveTimer.setInterval(SaveDelayMs);
+    connect(&m_saveTimer, &QTimer::timeout, this, &SnapshotCache::flush);
+    if (QCoreApplication::instance()) {
+        connect(QCoreApplication::instance(), &QCoreApplication::aboutToQuit, this, &SnapshotCache::flush);
+    }
+}
+
+QByteArray SnapshotCache::readBootId()
+{
+    return readSmallFile("/proc/sys/kernel/random/boot_id");
+}
+
+QByteArray SnapshotCache::computeFingerprint()
+{
+    // Only world-readable identity fields: the serial numbers and UUID under
+    // /sys/class/dmi/id need root, and LSV may run either way.
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    const char* dmiFields[] = { "sys_vendor", "product_name", "product_version", "board_vendor",
+                                "board_name", "bios_vendor", "bios_version", "bios_date" };
+    for (const char* field : dmiFields) {
+        hash.addData(readSmallFile(QString("/sys/class/dmi/id/") + field));
+        hash.addData(QByteArray(1, '\n'));
+    }
+
+    // CPU model and installed memory catch swapped parts and, for machines
+    // without DMI data (VMs, ARM boards), are most of the identity.
+    QFile cpuinfo(procfs::hostPath("/proc/cpuinfo"));
+    if (cpuinfo.open(QIODevice::ReadOnly)) {
+        while (!cpuinfo.atEnd()) {
+            const QByteArray line = cpuinfo.readLine();
+            if (line.startsWith("model name") || line.startsWith("Hardware") || line.startsWith("cpu model")) {
+                hash.addData(line);
+                break;
+            }
+        }
+    }
+    QFile meminfo(procfs::hostPath("/proc/meminfo"));
+    if (meminfo.open(QIODevice::ReadOnly)) {
+        hash.addData(meminfo.readLine()); // MemTotal
+    }
+    return hash.result().toHex();
+}
+
+void SnapshotCache::load()
+{
+    QElapsedTimer clock;
+    clock.start();
+
+    QFile f(m_path);
+    if (!f.open(QIODevice::ReadOnly)) {
+        appendLog(QString("SnapshotCache: no cache file at %1").arg(m_path));
+        return;
+    }
+
+    QDataStream in(&f);
+    in.setVersion(QDataStream::Qt_6_0);
+    quint32 magic = 0, format = 0;
+    QString version;
+    QByteArray fingerprint;
+    QHash<QString, QByteArray> entries, entryBoot;
+    in >> magic >> format;
+    if (magic != CacheMagic || format != CacheFormat) {
+        appendLog("SnapshotCache: cache file has an unknown format, ignoring");
+        return;
+    }
+    in >> version >> fingerprint >> entries >> entryBoot;
+    if (in.status() != QDataStream::Ok) {
+        appendLog("SnapshotCache: cache file is truncated, ignoring");
+        return;
+    }
+    // Parsers may change between releases, and a different fingerprint means
+    // the file describes some other machine (shared home, moved disk).
+    if (version != LSVVersionQString() || fingerprint != m_fingerprint) {
+        appendLog("SnapshotCache: cache is from another version or machine, ignoring");
+        return;
+    }
+
+    m_entries = entries;
+    m_entryBoot = entryBoot;
+    int fresh = 0;
+    for (auto it = m_entries.constBegin(); it != m_entries.constEnd(); ++it) {
+        if (isFresh(it.key())) ++fresh;
+    }
+    appendLog(QString("SnapshotCache: loaded %1 entries (%2 from this boot) in %3 ms")
+                  .arg(m_entries.size()).arg(fresh).arg(clock.elapsed()));
+}
+
+bool SnapshotCache::lookup(const QString& key, QByteArray* value) const
+{
+    auto it = m_entries.constFind(key);
+    if (it == m_entries.constEnd()) return false;
+    if (value) *value = it.value();
+    return true;
+}
+
+void SnapshotCache::store(const QString& key, const QByteArray& value)
+{
+    auto it = m_entries.find(key);
+    if (it != m_entries.end() && it.value() == value && isFresh(key)) return;
+    m_entries.insert(key, value);
+    m_entryBoot.insert(key, m_bootId);
+    m_dirty = true;
+    m_saveTimer.start();
+}
+
+void SnapshotCache::remove(const QString& key)
+{
+    m_entryBoot.remove(key);
+    if (m_entries.remove(key) > 0) {
+        m_dirty = true;
+        m_saveTimer.start();
+    }
+}
+
+void SnapshotCache::flush()
+{
+    m_saveTimer.stop();
+    if (!m_dirty || m_path.isEmpty()) return;
+
+    // QSaveFile writes a temporary file and renames it, so a crash mid-write
+    // never leaves a half-written cache behind.
+    QSaveFile f(m_path);
+    if (!f.open(QIODevice::WriteOnly)) {
+        appendLog(QString("SnapshotCache: cannot write %1: %2").arg(m_path, f.errorString()));
+        return;
+    }
+    QDataStream out(&f);
+    out.setVersion(QDataStream::Qt_6_0);
+    out << CacheMagic << CacheFormat << LSVVersionQString() << m_fingerprint << m_entries << m_entryBoot;
+    if (f.commit()) {
+        m_dirty = false;
+        appendLog(QString("SnapshotCache: wrote %1 entries to %2").arg(m_entries.size()).arg(m_path));
+    } else {
+        appendLog(QString("SnapshotCache: failed to commit %1: %2").arg(m_path, f.errorString()));
+    }
+}
@@ -0,0 +1,60 @@
+#ifndef SNAPSHOT_CACHE_H
+#define SNAPSHOT_CACHE_H
+
+#include <QObject>
+#include <QString>
+#include <QByteArray>
+#include <QHash>
+#include <QTimer>
+
+// Persistent cache of collector output that rarely changes between runs
+// (lshw tree, PCI/USB listings, dmidecode tables, ...).
+//
+// Every entry carries the boot id it was recorded under, and the file carries
+// a hardware fingerprint (DMI identity, CPU model, installed RAM). A file
+// written on different hardware is discarded on load. Entries from an earlier
+// boot of the same machine are still used to paint the window immediately,
+// but callers are expected to revalidate them in the background (see
+// isFresh()).
+class SnapshotCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    static SnapshotCache* instance();
+
+    // Cached output for key (normally the command line), if any.
+    bool lookup(const QString& key, QByteArray* value) const;
+    bool contains(const QString& key) const { return m_entries.contains(key); }
+    // Record fresh output. The file is rewritten shortly afterwards, so a
+    // burst of stores at startup only costs one write.
+    void store(const QString& key, const QByteArray& value);
+    void remove(const QString& key);
+
+    // True when the entry was recorded during the current boot. Firmware
+    // tables such as dmidecode cannot change without a reboot, so callers
+    // may skip revalidating fresh entries of that kind.
+    bool isFresh(const QString& key) const { return !m_bootId.isEmpty() && m_entryBoot.value(key) == m_bootId; }
+
+    // Empty while capturing or replaying (capture.h): the cache is then
+    // kept in memory only.
+    QString filePath() const { return m_path; }
+    void flush();
+
+private:
+    explicit SnapshotCache(QObject* parent = nullptr);
+
+    static QByteArray readBootId();
+    static QByteArray computeFingerprint();
+    void load();
+
+    QString m_path;
+    QByteArray m_bootId;
+    QByteArray m_fingerprint;
+    QHash<QString, QByteArray> m_entries;
+    QHash<QString, QByteArray> m_entryBoot; // key -> boot id it was recorded in
+    bool m_dirty = false;
+    QTimer m_saveTimer;
+};
+
+#endif // SNAPSHOT_CACHE_H
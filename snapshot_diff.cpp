@@ -0,0 +1,354 @@
+#include "snapshot_diff.h"
+#include "snapshot_file.h"
+#include <QElapsedTimer>
+#include <QFile>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonParseError>
+
+namespace {
+
+constexpr quint64 FnvOffset = 0xcbf29ce484222325ull;
+constexpr quint64 FnvPrime = 0x100000001b3ull;
+
+quint64 hashText(quint64 h, const QString& text)
+{
+    const uchar* bytes = reinterpret_cast<const uchar*>(text.constData());
+    const qsizetype size = text.size() * qsizetype(sizeof(QChar));
+    for (qsizetype i = 0; i < size; ++i) {
+        h ^= bytes[i];
+        h *= FnvPrime;
+    }
+    return h;
+}
+
+quint64 combine(quint64 h, quint64 value)
+{
+    return h ^ (value + 0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2));
+}
+
+// {property, value[, unit][, type]} as written by rowsToJson().
+bool isRow(const QJsonObject& object)
+{
+    if (!object.contains("property") || !object.contains("value")) return false;
+    for (auto it = object.constBegin(); it != object.constEnd(); ++it) {
+        const QString& key = it.key();
+        if (key != "property" && key != "value" && key != "unit" && key != "type") return false;
+    }
+    return true;
+}
+
+QString rowText(const QJsonObject& row)
+{
+    const QString value = row.value("value").toString();
+    const QString unit = row.value("unit").toString();
+    return unit.isEmpty() ? value : value + ' ' + unit;
+}
+
+QString scalarText(const QJsonValue& value)
+{
+    switch (value.type()) {
+    case QJsonValue::String:
+        return value.toString();
+    case QJsonValue::Double: {
+        const double d = value.toDouble();
+        if (d == double(qint64(d))) return QString::number(qint64(d));
+        return QString::number(d, 'g', 15);
+    }
+    case QJsonValue::Bool:
+        return value.toBool() ? QStringLiteral("true") : QStringLiteral("false");
+    case QJsonValue::Null:
+        return QStringLiteral("null");
+    default:
+        return QString();
+    }
+}
+
+// Key of array element index: what identifies it across runs, so a new
+// interface or volume in the middle does not shift all that follow.
+QString elementKey(const QJsonValue& element, int index)
+{
+    if (element.isObject()) {
+        const QJsonObject object = element.toObject();
+        for (const char* name : {"property", "device", "mount_point", "name", "id"}) {
+            const QString key = object.value(QLatin1String(name)).toString().trimmed();
+            if (!key.isEmpty()) return key;
+        }
+    }
+    return QString("[%1]").arg(index);
+}
+
+struct Child {
+    QString key;
+    QJsonValue value;
+};
+
+} // namespace
+
+SnapshotTree SnapshotTree::fromDocument(const QJsonObject& document, const QRegularExpression& ignore)
+{
+    SnapshotTree tree;
+    tree.m_hostname = document.value("hostname").toString();
+    tree.m_generated = document.value("generated").toString();
+    tree.m_nodes.append(Node());
+    const QJsonValue sections = document.value("sections");
+    const bool filtered = ignore.isValid() && !ignore.pattern().isEmpty();
+    tree.build(0, QString(), sections.isObject() ? sections : QJsonValue(QJsonObject()), filtered ? &ignore : nullptr);
+    return tree;
+}
+
+int SnapshotTree::build(int index, const QString& key, const QJsonValue& value, const QRegularExpression* ignore)
+{
+    auto ignored = [ignore](const QString& childKey) { return ignore && ignore->match(childKey).hasMatch(); };
+    QVector<Child> children;
+    bool leaf = false;
+    QString text;
+    if (value.isObject()) {
+        const QJsonObject object = value.toObject();
+        if (isRow(object)) {
+            leaf = true;
+            text = rowText(object);
+        } else {
+            children.reserve(object.size());
+            for (auto it = object.constBegin(); it != object.constEnd(); ++it) {
+                if (!ignored(it.key())) children.append({it.key(), it.value()});
+            }
+        }
+    } else if (value.isArray()) {
+        const QJsonArray array = value.toArray();
+        children.reserve(array.size());
+        QHash<QString, int> seen;
+        for (int i = 0; i < array.size(); ++i) {
+            QString childKey = elementKey(array.at(i), i);
+            const int n = ++seen[childKey];
+            if (n > 1) childKey += QString(" #%1").arg(n);
+            if (!ignored(childKey)) children.append({childKey, array.at(i)});
+        }
+    } else {
+        leaf = true;
+        text = scalarText(value);
+    }
+
+    // Reserve the children's slots first so they stay next to each other;
+    // their own subtrees follow.
+    const int first = children.isEmpty() ? -1 : int(m_nodes.size());
+    m_nodes.resize(m_nodes.size() + children.size());
+    quint64 hash = hashText(hashText(FnvOffset, key) ^ (leaf ? 1 : 2), text);
+    for (int i = 0; i < children.size(); ++i) {
+        hash = combine(hash, m_nodes[build(first + i, children[i].key, children[i].value, ignore)].hash);
+    }
+
+    Node& node = m_nodes[index];
+    node.key = key;
+    node.value = text;
+    node.leaf = leaf;
+    node.firstChild = first;
+    node.childCount = int(children.size());
+    node.hash = hash;
+    return index;
+}
+
+namespace {
+
+class Differ
+{
+public:
+    Differ(const SnapshotTree& before, const SnapshotTree& after, SnapshotDiff* out)
+        : m_before(before), m_after(after), m_out(out)
+    {
+    }
+
+    void run()
+    {
+        forEachPair(0, 0, [this](int b, int a, const QString& key) {
+            if (b < 0) {
+                report(SnapshotChange::Added, key, QString(), QString(), describe(m_after, a));
+            } else if (a < 0) {
+                report(SnapshotChange::Removed, key, QString(), describe(m_before, b), QString());
+            } else {
+                const int changes = m_out->changes.size();
+                compare(b, a, key, QString());
+                if (m_out->changes.size() == changes) m_out->unchangedSections.append(key);
+            }
+        });
+    }
+
+private:
+    void compare(int b, int a, const QString& section, const QString& path)
+    {
+        ++m_out->nodesCompared;
+        const SnapshotTree::Node& nb = m_before.node(b);
+        const SnapshotTree::Node& na = m_after.node(a);
+        if (nb.hash == na.hash) {
+            ++m_out->subtreesSkipped;
+            return;
+        }
+        if (nb.leaf || na.leaf) {
+            if (nb.leaf && na.leaf && nb.value == na.value) return;
+            report(SnapshotChange::Changed, section, path, describe(m_before, b), describe(m_after, a));
+            return;
+        }
+        forEachPair(b, a, [&](int cb, int ca, const QString& key) {
+            const QString childPath = path.isEmpty() ? key : path + '/' + key;
+            if (cb < 0) {
+                report(SnapshotChange::Added, section, childPath, QString(), describe(m_after, ca));
+            } else if (ca < 0) {
+                report(SnapshotChange::Removed, section, childPath, describe(m_before, cb), QString());
+            } else {
+                compare(cb, ca, section, childPath);
+            }
+        });
+    }
+
+    // Calls f(before child, after child, key) for the children of b and a
+    // matched by key, with -1 for a side that lacks the key. Children in the
+    // same order need no lookup table.
+    template <typename F>
+    void forEachPair(int b, int a, F f)
+    {
+        const SnapshotTree::Node& nb = m_before.node(b);
+        const SnapshotTree::Node& na = m_after.node(a);
+        bool sameKeys = nb.childCount == na.childCount;
+        for (int i = 0; sameKeys && i < nb.childCount; ++i) {
+            sameKeys = m_before.node(nb.firstChild + i).key == m_after.node(na.firstChild + i).key;
+        }
+        if (sameKeys) {
+            for (int i = 0; i < nb.childCount; ++i) {
+                f(nb.firstChild + i, na.firstChild + i, m_before.node(nb.firstChild + i).key);
+            }
+            return;
+        }
+
+        QHash<QString, int> afterByKey;
+        afterByKey.reserve(na.childCount);
+        for (int i = 0; i < na.childCount; ++i) afterByKey.insert(m_after.node(na.firstChild + i).key, na.firstChild + i);
+        for (int i = 0; i < nb.childCount; ++i) {
+            const QString& key = m_before.node(nb.firstChild + i).key;
+            const auto match = afterByKey.find(key);
+            if (match == afterByKey.end()) {
+                f(nb.firstChild + i, -1, key);
+            } else {
+                const int ca = match.value();
+                afterByKey.erase(match);
+                f(nb.firstChild + i, ca, key);
+            }
+        }
+        // What is left in afterByKey is new.
+        for (int i = 0; i < na.childCount; ++i) {
+            const QString& key = m_after.node(na.firstChild + i).key;
+            if (afterByKey.contains(key)) f(-1, na.firstChild + i, key);
+        }
+    }
+
+    static QString describe(const SnapshotTree& tree, int index)
+    {
+        const SnapshotTree::Node& node = tree.node(index);
+        if (node.leaf) return node.value;
+        return QString("(%1 entries)").arg(node.childCount);
+    }
+
+    void report(SnapshotChange::Kind kind, const QString& section, const QString& path,
+                const QString& before, const QString& after)
+    {
+        SnapshotChange change;
+        change.kind = kind;
+        change.section = section;
+        change.path = path;
+        change.before = before;
+        change.after = after;
+        m_out->changes.append(change);
+    }
+
+    const SnapshotTree& m_before;
+    const SnapshotTree& m_after;
+    SnapshotDiff* m_out;
+};
+
+} // namespace
+
+QRegularExpression defaultDiffIgnore()
+{
+    static const QRegularExpression ignore(
+        "^(Uptime|Current freq \\(GHz\\)|.+ [RT]X (Bytes|Packets|Errors|Dropped)|used_bytes|usage_percent)$");
+    return ignore;
+}
+
+SnapshotDiff diffSnapshots(const SnapshotTree& before, const SnapshotTree& after)
+{
+    QElapsedTimer clock;
+    clock.start();
+    SnapshotDiff diff;
+    Differ(before, after, &diff).run();
+    diff.elapsedUs = clock.nsecsElapsed() / 1000;
+    return diff;
+}
+
+const char* snapshotChangeKindName(SnapshotChange::Kind kind)
+{
+    switch (kind) {
+    case SnapshotChange::Added: return "added";
+    case SnapshotChange::Removed: return "removed";
+    case SnapshotChange::Changed: return "changed";
+    }
+    return "changed";
+}
+
+QJsonObject diffToJson(const SnapshotDiff& diff, const SnapshotTree& before, const SnapshotTree& after)
+{
+    auto origin = [](const SnapshotTree& tree) {
+        QJsonObject object;
+        object.insert("hostname", tree.hostname());
+        object.insert("generated", tree.generated());
+        return object;
+    };
+
+    QJsonArray changes;
+    for (const SnapshotChange& change : diff.changes) {
+        QJsonObject object;
+        object.insert("kind", QLatin1String(snapshotChangeKindName(change.kind)));
+        object.insert("section", change.section);
+        object.insert("path", change.path);
+        if (change.kind != SnapshotChange::Added) object.insert("before", change.before);
+        if (change.kind != SnapshotChange::Removed) object.insert("after", change.after);
+        changes.append(object);
+    }
+
+    QJsonObject root;
+    root.insert("before", origin(before));
+    root.insert("after", origin(after));
+    root.insert("diff_us", double(diff.elapsedUs));
+    root.insert("nodes_compared", diff.nodesCompared);
+    root.insert("subtrees_skipped", diff.subtreesSkipped);
+    root.insert("unchanged_sections", QJsonArray::fromStringList(diff.unchangedSections));
+    root.insert("changes", changes);
+    return root;
+}
+
+bool loadSnapshotDocument(const QString& path, QJsonObject* document, QString* error)
+{
+    if (SnapshotFile::isSnapshotFile(path)) {
+        SnapshotFile snapshot;
+        if (!snapshot.open(path, error)) return false;
+        *document = snapshot.toDocument();
+        return true;
+    }
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        *error = QString("cannot read %1: %2").arg(path, file.errorString());
+        return false;
+    }
+    QJsonParseError parseError;
+    const QJsonDocument json = QJsonDocument::fromJson(file.readAll(), &parseError);
+    if (!json.isObject()) {
+        *error = QString("%1: %2").arg(path, parseError.error != QJsonParseError::NoError ? parseError.errorString()
+                                                                                         : QString("not an object"));
+        return false;
+    }
+    if (!json.object().value("sections").isObject()) {
+        *error = QString("%1: no \"sections\" (not written by lsv --json)").arg(path);
+        return false;
+    }
+    *document = json.object();
+    return true;
+}
@@ -0,0 +1,97 @@
+#ifndef SNAPSHOT_DIFF_H
+#define SNAPSHOT_DIFF_H
+
+#include <QJsonObject>
+#include <QJsonValue>
+#include <QRegularExpression>
+#include <QString>
+#include <QVector>
+
+// Typed tree of one `lsv --json` document ("sections" only), for comparing
+// two runs of the same machine or two machines.
+//
+// Every node has a key (section name, object key, or the identity of an
+// array element: its "property", "device", "mount_point", "name" or "id",
+// else its index) and either a value (leaves) or children. A row object
+// {property, value, unit, type} is one leaf holding "value unit".
+//
+// Nodes are stored parent first with the children of a node next to each
+// other, and every node carries a 64 bit hash of its key, value and the
+// hashes of its children. Two subtrees with the same hash are taken as
+// equal without being looked at, so a diff only walks the parts that did
+// change. Keys left out of the comparison (uptime, counters) are left out
+// of the tree, so they do not keep a section's hash from matching either.
+class SnapshotTree
+{
+public:
+    struct Node {
+        QString key;
+        QString value;          // leaves only
+        quint64 hash = 0;
+        int firstChild = -1;
+        int childCount = 0;
+        bool leaf = false;
+    };
+
+    // The tree of document["sections"]; node 0 is the root. Nodes whose
+    // key matches ignore (when it is valid and not empty) are left out
+    // together with their subtrees.
+    static SnapshotTree fromDocument(const QJsonObject& document,
+                                     const QRegularExpression& ignore = QRegularExpression());
+
+    const QVector<Node>& nodes() const { return m_nodes; }
+    const Node& node(int index) const { return m_nodes[index]; }
+    bool isEmpty() const { return m_nodes.size() <= 1; }
+
+    // Summary of the document the tree was taken from.
+    QString hostname() const { return m_hostname; }
+    QString generated() const { return m_generated; }
+
+private:
+    int build(int index, const QString& key, const QJsonValue& value, const QRegularExpression* ignore);
+
+    QVector<Node> m_nodes;
+    QString m_hostname;
+    QString m_generated;
+};
+
+struct SnapshotChange {
+    enum Kind { Added, Removed, Changed };
+
+    Kind kind = Changed;
+    QString section;
+    QString path;       // keys below the section, joined by '/'
+    QString before;     // empty for Added
+    QString after;      // empty for Removed
+};
+
+struct SnapshotDiff {
+    QVector<SnapshotChange> changes;
+    QStringList unchangedSections;
+    int nodesCompared = 0;
+    int subtreesSkipped = 0;    // equal hashes, not descended into
+    qint64 elapsedUs = 0;
+
+    bool isEmpty() const { return changes.isEmpty(); }
+};
+
+// Keys of values that change on every run (uptime, the current clock,
+// traffic counters, volume usage). Matched against the key of each node.
+QRegularExpression defaultDiffIgnore();
+
+// Changes from before to after. Compare trees built with the same ignore
+// expression.
+SnapshotDiff diffSnapshots(const SnapshotTree& before, const SnapshotTree& after);
+
+// {before: {hostname, generated}, after: {...}, diff_us, nodes_compared,
+// subtrees_skipped, unchanged_sections, changes: [{kind, section, path,
+// before, after}]}
+QJsonObject diffToJson(const SnapshotDiff& diff, const SnapshotTree& before, const SnapshotTree& after);
+
+const char* snapshotChangeKindName(SnapshotChange::Kind kind);
+
+// Read a document written by `lsv --json`, or the one stored in a
+// snapshot file (snapshot_file.h). On failure error says why.
+bool loadSnapshotDocument(const QString& path, QJsonObject* document, QString* error);
+
+#endif // SNAPSHOT_DIFF_H
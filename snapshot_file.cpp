@@ -0,0 +1,558 @@
+#include "snapshot_file.h"
+#include <QDir>
+#include <QDirIterator>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QSaveFile>
+#include <QtEndian>
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <unistd.h>
+
+namespace {
+
+const char Magic[8] = {'L', 'S', 'V', 'S', 'N', 'A', 'P', '\0'};
+constexpr qint64 HeaderSize = 8 + 4 * 4 + 8 * 2;
+constexpr qint64 EntrySize = 4 * 4 + 8 * 3;
+constexpr quint32 Compressed = 1;
+// Blocks smaller than this are not worth a qCompress header.
+constexpr int MinCompressBytes = 256;
+// Largest inflated section a reader accepts, and the most zlib can inflate
+// a byte to (about 1032:1), so a crafted size cannot make qUncompress()
+// allocate gigabytes.
+constexpr quint64 MaxSectionBytes = 256ull << 20;
+constexpr quint64 MaxCompressionRatio = 1040;
+
+const char* RowKeys[] = {"property", "value", "unit", "type"};
+// Rows sections written by this code have at most four cells; more than
+// this is a damaged or crafted file.
+constexpr quint32 MaxColumns = 64;
+
+quint32 u32(const uchar* p) { return qFromLittleEndian<quint32>(p); }
+quint64 u64(const uchar* p) { return qFromLittleEndian<quint64>(p); }
+
+void put32(QByteArray& out, quint32 value)
+{
+    char bytes[4];
+    qToLittleEndian(value, bytes);
+    out.append(bytes, 4);
+}
+
+void put64(QByteArray& out, quint64 value)
+{
+    char bytes[8];
+    qToLittleEndian(value, bytes);
+    out.append(bytes, 8);
+}
+
+// An array of {property, value[, unit][, type]} objects as rowsToJson()
+// writes them, which the Rows kind stores without loss.
+bool isRowArray(const QJsonValue& value)
+{
+    if (!value.isArray()) return false;
+    for (const QJsonValue& element : value.toArray()) {
+        if (!element.isObject()) return false;
+        const QJsonObject row = element.toObject();
+        if (!row.value("property").isString() || !row.value("value").isString()) return false;
+        for (auto it = row.constBegin(); it != row.constEnd(); ++it) {
+            if (!it.value().isString()) return false;
+            const QString key = it.key();
+            if (key != "property" && key != "value" && key != "unit" && key != "type") return false;
+            if ((key == "unit" || key == "type") && it.value().toString().isEmpty()) return false;
+        }
+    }
+    return true;
+}
+
+// The text stored in the symlink at path, relative or not (symLinkTarget()
+// makes it absolute); empty if path is not a symlink.
+QString readLinkText(const QString& path)
+{
+    QByteArray buffer(PATH_MAX, Qt::Uninitialized);
+    const ssize_t n = ::readlink(QFile::encodeName(path).constData(), buffer.data(), size_t(buffer.size()));
+    return n <= 0 ? QString() : QFile::decodeName(buffer.left(qsizetype(n)));
+}
+
+bool isInside(const QString& root, const QString& path)
+{
+    return path == root || path.startsWith(root + '/');
+}
+
+// Create relative below the canonical directory root one component at a
+// time and return its canonical path, or an empty string if a component
+// is not a directory or leads out of root (through a symlink the archive
+// itself made). QDir::mkpath() would follow such a link and create the
+// rest of the path wherever it points.
+QString makeDirectoryInside(const QString& root, const QString& relative)
+{
+    QString path = root;
+    for (const QString& part : relative.split('/', Qt::SkipEmptyParts)) {
+        path += '/' + part;
+        if (!QFileInfo::exists(path) && !QDir().mkdir(path)) return QString();
+        path = QFileInfo(path).canonicalFilePath();
+        if (path.isEmpty() || !isInside(root, path) || !QFileInfo(path).isDir()) return QString();
+    }
+    return path;
+}
+
+bool fail(QString* error, const QString& message)
+{
+    if (error) *error = message;
+    return false;
+}
+
+} // namespace
+
+// ---- reading ---------------------------------------------------------------
+
+bool SnapshotFile::isSnapshotFile(const QString& path)
+{
+    // Regular files only: peeking at a pipe would eat its first bytes.
+    if (!QFileInfo(path).isFile()) return false;
+    QFile f(path);
+    if (!f.open(QIODevice::ReadOnly)) return false;
+    return f.read(8) == QByteArray(Magic, 8);
+}
+
+bool SnapshotFile::open(const QString& path, QString* error)
+{
+    close();
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::ReadOnly)) return fail(error, QString("cannot read %1: %2").arg(path, m_file.errorString()));
+    m_size = m_file.size();
+    if (m_size < HeaderSize) {
+        close();
+        return fail(error, QString("%1: too short for a snapshot").arg(path));
+    }
+    const uchar* base = m_file.map(0, m_size);
+    if (!base) {
+        const QString reason = m_file.errorString();
+        close();
+        return fail(error, QString("cannot map %1: %2").arg(path, reason));
+    }
+    auto invalid = [&](const QString& what) {
+        close();
+        return fail(error, QString("%1: %2").arg(path, what));
+    };
+    if (std::memcmp(base, Magic, 8) != 0) return invalid("not an LSV snapshot");
+    const quint32 version = u32(base + 8);
+    if (version != Version) return invalid(QString("snapshot version %1 is not supported").arg(version));
+
+    const quint32 sections = u32(base + 16);
+    const quint32 strings = u32(base + 20);
+    const quint64 stringsOffset = u64(base + 24);
+    const quint64 stringsSize = u64(base + 32);
+    const quint64 size = quint64(m_size);
+    if (quint64(HeaderSize) + quint64(sections) * EntrySize > size) return invalid("truncated directory");
+    if (stringsOffset > size || stringsSize > size - stringsOffset || quint64(strings) * 4 > stringsSize) {
+        return invalid("truncated string table");
+    }
+
+    m_base = base;
+    m_sectionCount = sections;
+    m_stringCount = strings;
+    m_stringEnds = base + stringsOffset;
+    m_stringBytes = m_stringEnds + quint64(strings) * 4;
+    m_stringBytesSize = stringsSize - quint64(strings) * 4;
+    for (int i = 0; i < int(sections); ++i) {
+        const Entry e = entry(i);
+        if (e.offset > size || e.storedSize > size - e.offset || e.name >= strings) return invalid("section out of bounds");
+        if ((e.flags & Compressed) && (e.size > MaxSectionBytes || e.size > e.storedSize * MaxCompressionRatio)) {
+            return invalid("compressed section too large");
+        }
+    }
+    return true;
+}
+
+void SnapshotFile::close()
+{
+    if (m_base) m_file.unmap(const_cast<uchar*>(m_base));
+    m_base = nullptr;
+    m_file.close();
+    m_size = 0;
+    m_sectionCount = 0;
+    m_stringCount = 0;
+    m_stringEnds = nullptr;
+    m_stringBytes = nullptr;
+    m_stringBytesSize = 0;
+}
+
+SnapshotFile::Entry SnapshotFile::entry(int index) const
+{
+    const uchar* p = m_base + HeaderSize + qint64(index) * EntrySize;
+    return Entry{u32(p), u32(p + 4), u32(p + 8), u64(p + 16), u64(p + 24), u64(p + 32)};
+}
+
+QByteArray SnapshotFile::nameBytes(quint32 id) const
+{
+    if (id >= m_stringCount) return QByteArray();
+    const quint64 begin = id == 0 ? 0 : u32(m_stringEnds + (id - 1) * 4);
+    const quint64 end = u32(m_stringEnds + id * 4);
+    if (begin > end || end > m_stringBytesSize) return QByteArray();
+    return QByteArray::fromRawData(reinterpret_cast<const char*>(m_stringBytes + begin), qsizetype(end - begin));
+}
+
+QString SnapshotFile::string(quint32 id) const
+{
+    return QString::fromUtf8(nameBytes(id));
+}
+
+QString SnapshotFile::sectionName(int index) const
+{
+    if (index < 0 || index >= sectionCount()) return QString();
+    return string(entry(index).name);
+}
+
+SnapshotFile::Kind SnapshotFile::sectionKind(int index) const
+{
+    if (index < 0 || index >= sectionCount()) return Blob;
+    return Kind(entry(index).kind);
+}
+
+int SnapshotFile::indexOf(const QString& name) const
+{
+    const QByteArray wanted = name.toUtf8();
+    int low = 0;
+    int high = sectionCount() - 1;
+    while (low <= high) {
+        const int middle = (low + high) / 2;
+        const int order = nameBytes(entry(middle).name).compare(wanted);
+        if (order == 0) return middle;
+        if (order < 0) low = middle + 1;
+        else high = middle - 1;
+    }
+    return -1;
+}
+
+QByteArray SnapshotFile::data(int index) const
+{
+    if (index < 0 || index >= sectionCount()) return QByteArray();
+    const Entry e = entry(index);
+    const QByteArray stored = QByteArray::fromRawData(reinterpret_cast<const char*>(m_base + e.offset),
+                                                      qsizetype(e.storedSize));
+    if (!(e.flags & Compressed)) return stored;
+    // qUncompress() allocates what the stream's big-endian size prefix
+    // says; only inflate when that is the size open() checked.
+    if (stored.size() < 4 || qFromBigEndian<quint32>(stored.constData()) != e.size) return QByteArray();
+    const QByteArray body = qUncompress(stored);
+    return quint64(body.size()) == e.size ? body : QByteArray();
+}
+
+QHash<QString, QString> SnapshotFile::meta() const
+{
+    QHash<QString, QString> values;
+    const int index = indexOf("meta");
+    if (index < 0 || sectionKind(index) != Meta) return values;
+    const QByteArray body = data(index);
+    const uchar* p = reinterpret_cast<const uchar*>(body.constData());
+    if (body.size() < 4) return values;
+    const quint32 count = u32(p);
+    if (quint64(count) * 8 + 4 > quint64(body.size())) return values;
+    for (quint32 i = 0; i < count; ++i) values.insert(string(u32(p + 4 + i * 8)), string(u32(p + 8 + i * 8)));
+    return values;
+}
+
+InfoRows SnapshotFile::rows(const QString& name) const
+{
+    InfoRows rows;
+    const int index = indexOf(name);
+    if (index < 0 || sectionKind(index) != Rows) return rows;
+    const QByteArray body = data(index);
+    const uchar* p = reinterpret_cast<const uchar*>(body.constData());
+    if (body.size() < 8) return rows;
+    const quint32 count = u32(p);
+    const quint32 columns = u32(p + 4);
+    // By division: count * columns * 4 can wrap for a crafted header. That
+    // also keeps the reserve below within what the body holds.
+    if (count == 0 || columns == 0 || columns > MaxColumns) return rows;
+    if (count > quint64(body.size() - 8) / (quint64(columns) * 4)) return rows;
+    rows.reserve(count);
+    p += 8;
+    for (quint32 r = 0; r < count; ++r) {
+        QStringList cells;
+        cells.reserve(columns);
+        for (quint32 c = 0; c < columns; ++c, p += 4) cells.append(string(u32(p)));
+        rows.append(cells);
+    }
+    return rows;
+}
+
+QCborValue SnapshotFile::cbor(const QString& name) const
+{
+    const int index = indexOf(name);
+    if (index < 0 || sectionKind(index) != Cbor) return QCborValue();
+    return QCborValue::fromCbor(data(index));
+}
+
+QJsonObject SnapshotFile::toDocument() const
+{
+    QJsonObject document;
+    const QHash<QString, QString> values = meta();
+    document.insert("lsv_version", values.value("lsv_version"));
+    document.insert("generated", values.value("generated"));
+    if (values.contains("hostname")) document.insert("hostname", values.value("hostname"));
+    document.insert("collect_ms", values.value("collect_ms").toDouble());
+
+    QJsonObject sections;
+    const QString prefix = "section/";
+    for (int i = 0; i < sectionCount(); ++i) {
+        const QString name = sectionName(i);
+        if (!name.startsWith(prefix)) continue;
+        const QString section = name.mid(prefix.size());
+        if (sectionKind(i) == Rows) {
+            QJsonArray array;
+            for (const QStringList& cells : rows(name)) {
+                QJsonObject row;
+                for (int col = 0; col < cells.size() && col < 4; ++col) {
+                    if (col >= 2 && cells[col].isEmpty()) continue;
+                    row.insert(RowKeys[col], cells[col]);
+                }
+                array.append(row);
+            }
+            sections.insert(section, array);
+        } else if (sectionKind(i) == Cbor) {
+            sections.insert(section, cbor(name).toJsonValue());
+        }
+    }
+    document.insert("sections", sections);
+    return document;
+}
+
+bool SnapshotFile::extractArchive(const QString& directory, QString* error) const
+{
+    // Nothing is written outside directory: parents are created and
+    // resolved one step at a time, links must stay inside it, and files are
+    // never written through a link.
+    const QString root = QFileInfo(directory).canonicalFilePath();
+    if (root.isEmpty()) return fail(error, QString("%1: no such directory").arg(directory));
+    const QString prefix = "archive/";
+    bool any = false;
+    for (int i = 0; i < sectionCount(); ++i) {
+        const QString name = sectionName(i);
+        if (!name.startsWith(prefix)) continue;
+        const QString relative = name.mid(prefix.size());
+        const QStringList parts = relative.split('/');
+        if (relative.isEmpty() || relative.startsWith('/') || parts.contains("..") || parts.contains(".") || parts.contains(QString())) continue;
+        const QString parent = makeDirectoryInside(root, parts.mid(0, parts.size() - 1).join('/'));
+        if (parent.isEmpty()) return fail(error, QString("%1: %2 leads outside the archive").arg(m_file.fileName(), relative));
+        const QString target = parent + '/' + parts.last();
+        any = true;
+        switch (sectionKind(i)) {
+        case Directory:
+            if (makeDirectoryInside(root, relative).isEmpty()) {
+                return fail(error, QString("%1: %2 leads outside the archive").arg(m_file.fileName(), relative));
+            }
+            break;
+        case Link: {
+            const QByteArray body = data(i);
+            if (body.size() < 4) break;
+            const QString text = string(u32(reinterpret_cast<const uchar*>(body.constData())));
+            // Absolute targets (as snapshots before relative links stored
+            // them) and targets outside directory are left out.
+            if (text.isEmpty() || QDir::isAbsolutePath(text) || !isInside(root, QDir::cleanPath(parent + '/' + text))) break;
+            QFile::link(text, target);
+            break;
+        }
+        case Blob: {
+            if (QFileInfo(target).isSymLink()) {
+                return fail(error, QString("%1: %2 is a link").arg(m_file.fileName(), relative));
+            }
+            QFile f(target);
+            const QByteArray body = data(i);
+            if (!f.open(QIODevice::WriteOnly | QIODevice::Truncate) || f.write(body) != body.size()) {
+                return fail(error, QString("cannot write %1: %2").arg(target, f.errorString()));
+            }
+            break;
+        }
+        default:
+            break;
+        }
+    }
+    if (!any) return fail(error, QString("%1: snapshot holds no capture archive").arg(m_file.fileName()));
+    return true;
+}
+
+// ---- writing ---------------------------------------------------------------
+
+quint32 SnapshotFileWriter::intern(const QString& text)
+{
+    const auto it = m_stringIds.constFind(text);
+    if (it != m_stringIds.constEnd()) return it.value();
+    const quint32 id = quint32(m_strings.size());
+    m_strings.append(text.toUtf8());
+    m_stringIds.insert(text, id);
+    return id;
+}
+
+void SnapshotFileWriter::add(const QString& name, quint32 kind, const QByteArray& body)
+{
+    m_sections.append(Section{intern(name), kind, body});
+}
+
+void SnapshotFileWriter::addMeta(const QString& key, const QString& value)
+{
+    if (m_meta.isEmpty()) intern("meta");
+    m_meta.append(qMakePair(intern(key), intern(value)));
+}
+
+void SnapshotFileWriter::addRows(const QString& name, const InfoRows& rows)
+{
+    int columns = 0;
+    for (const QStringList& cells : rows) columns = qMax(columns, int(cells.size()));
+    QByteArray body;
+    body.reserve(8 + rows.size() * columns * 4);
+    put32(body, quint32(rows.size()));
+    put32(body, quint32(columns));
+    for (const QStringList& cells : rows) {
+        for (int c = 0; c < columns; ++c) put32(body, intern(cells.value(c)));
+    }
+    add(name, SnapshotFile::Rows, body);
+}
+
+void SnapshotFileWriter::addCbor(const QString& name, const QCborValue& value)
+{
+    add(name, SnapshotFile::Cbor, value.toCbor());
+}
+
+void SnapshotFileWriter::addBlob(const QString& name, const QByteArray& data)
+{
+    add(name, SnapshotFile::Blob, data);
+}
+
+void SnapshotFileWriter::addLink(const QString& name, const QString& target)
+{
+    QByteArray body;
+    put32(body, intern(target));
+    add(name, SnapshotFile::Link, body);
+}
+
+void SnapshotFileWriter::addDirectory(const QString& name)
+{
+    add(name, SnapshotFile::Directory, QByteArray());
+}
+
+void SnapshotFileWriter::addDocument(const QJsonObject& document)
+{
+    addMeta("lsv_version", document.value("lsv_version").toString());
+    addMeta("generated", document.value("generated").toString());
+    if (document.contains("hostname")) addMeta("hostname", document.value("hostname").toString());
+    addMeta("collect_ms", QString::number(document.value("collect_ms").toDouble()));
+
+    const QJsonObject sections = document.value("sections").toObject();
+    for (auto it = sections.constBegin(); it != sections.constEnd(); ++it) {
+        const QString name = "section/" + it.key();
+        if (isRowArray(it.value())) {
+            InfoRows rows;
+            for (const QJsonValue& element : it.value().toArray()) {
+                const QJsonObject row = element.toObject();
+                QStringList cells;
+                for (const char* key : RowKeys) cells.append(row.value(QLatin1String(key)).toString());
+                rows.append(cells);
+            }
+            addRows(name, rows);
+        } else {
+            addCbor(name, QCborValue::fromJsonValue(it.value()));
+        }
+    }
+}
+
+bool SnapshotFileWriter::addArchive(const QString& directory, QString* error)
+{
+    const QDir root(directory);
+    if (!root.exists("manifest.json")) return fail(error, QString("%1: no capture manifest").arg(directory));
+    QDirIterator it(directory, QDir::AllEntries | QDir::NoDotAndDotDot | QDir::Hidden | QDir::System,
+                    QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        it.next();
+        const QFileInfo info = it.fileInfo();
+        const QString name = "archive/" + root.relativeFilePath(info.filePath());
+        if (info.isSymLink()) {
+            // The link as written, relative to where it is; extractArchive()
+            // refuses absolute targets. Captures link to live paths such as
+            // /usr/share/zoneinfo/..., which the archive mirrors under root/.
+            QString text = readLinkText(info.filePath());
+            if (QDir::isAbsolutePath(text)) {
+                text = QDir(info.absolutePath()).relativeFilePath(root.absoluteFilePath("root") + text);
+            }
+            addLink(name, text);
+        } else if (info.isDir()) {
+            addDirectory(name);
+        } else {
+            QFile f(info.filePath());
+            if (!f.open(QIODevice::ReadOnly)) return fail(error, QString("cannot read %1: %2").arg(info.filePath(), f.errorString()));
+            addBlob(name, f.readAll());
+        }
+    }
+    return true;
+}
+
+bool SnapshotFileWriter::save(const QString& path, bool compress, QString* error) const
+{
+    QVector<Section> sections = m_sections;
+    if (!m_meta.isEmpty()) {
+        QByteArray body;
+        put32(body, quint32(m_meta.size()));
+        for (const auto& pair : m_meta) {
+            put32(body, pair.first);
+            put32(body, pair.second);
+        }
+        sections.append(Section{m_stringIds.value("meta"), SnapshotFile::Meta, body});
+    }
+    // Sorted by name so readers can binary search the directory.
+    std::stable_sort(sections.begin(), sections.end(), [this](const Section& a, const Section& b) {
+        return m_strings[a.name] < m_strings[b.name];
+    });
+
+    QByteArray blocks;
+    QByteArray directory;
+    const quint64 blocksOffset = quint64(HeaderSize) + quint64(sections.size()) * EntrySize;
+    for (const Section& section : sections) {
+        QByteArray stored = section.body;
+        quint32 flags = 0;
+        // Readers refuse to inflate more than MaxSectionBytes; larger
+        // sections stay uncompressed.
+        if (compress && section.body.size() >= MinCompressBytes && quint64(section.body.size()) <= MaxSectionBytes) {
+            const QByteArray packed = qCompress(section.body);
+            if (packed.size() < section.body.size()) {
+                stored = packed;
+                flags |= Compressed;
+            }
+        }
+        while (blocks.size() % 8) blocks.append('\0');
+        put32(directory, section.name);
+        put32(directory, section.kind);
+        put32(directory, flags);
+        put32(directory, 0);
+        put64(directory, blocksOffset + quint64(blocks.size()));
+        put64(directory, quint64(stored.size()));
+        put64(directory, quint64(section.body.size()));
+        blocks.append(stored);
+    }
+    while (blocks.size() % 8) blocks.append('\0');
+
+    QByteArray strings;
+    quint32 end = 0;
+    for (const QByteArray& s : m_strings) {
+        end += quint32(s.size());
+        put32(strings, end);
+    }
+    for (const QByteArray& s : m_strings) strings.append(s);
+
+    QByteArray header(Magic, 8);
+    put32(header, SnapshotFile::Version);
+    put32(header, compress ? Compressed : 0);
+    put32(header, quint32(sections.size()));
+    put32(header, quint32(m_strings.size()));
+    put64(header, blocksOffset + quint64(blocks.size()));
+    put64(header, quint64(strings.size()));
+
+    QSaveFile f(path);
+    if (!f.open(QIODevice::WriteOnly)) return fail(error, QString("cannot write %1: %2").arg(path, f.errorString()));
+    f.write(header);
+    f.write(directory);
+    f.write(blocks);
+    f.write(strings);
+    if (!f.commit()) return fail(error, QString("cannot write %1: %2").arg(path, f.errorString()));
+    return true;
+}
@@ -0,0 +1,143 @@
+#ifndef SNAPSHOT_FILE_H
+#define SNAPSHOT_FILE_H
+
+#include <QByteArray>
+#include <QCborValue>
+#include <QFile>
+#include <QHash>
+#include <QJsonObject>
+#include <QString>
+#include <QVector>
+#include "info_rows.h"
+
+// Single-file LSV snapshot (*.lsvsnap): the `--json` document of a host
+// plus the capture archive (capture.h) of every file and command output
+// the collectors read, for archiving many hosts and for opening one later.
+//
+// Layout, all integers little endian:
+//
+//   Header     char magic[8] "LSVSNAP\0", quint32 version, quint32 flags,
+//              quint32 sectionCount, quint32 stringCount,
+//              quint64 stringsOffset, quint64 stringsSize
+//   Directory  sectionCount entries sorted by the UTF-8 bytes of their name:
+//              quint32 name, quint32 kind, quint32 flags, quint32 reserved,
+//              quint64 offset, quint64 storedSize, quint64 size
+//   Blocks     section bodies, 8 byte aligned; with the Compressed flag a
+//              body is qCompress()ed and size is its inflated length
+//   Strings    quint32 end[stringCount] (offset after string i), then the
+//              UTF-8 bytes of all strings back to back
+//
+// Names, row cells, metadata and link targets are string ids into the one
+// interned string table. Section bodies by kind:
+//
+//   Meta       quint32 count, count x {quint32 key, quint32 value}
+//   Rows       quint32 rows, quint32 columns, rows x columns quint32 cells
+//   Cbor       a QCborValue (sections that are not plain rows)
+//   Blob       raw bytes (archived files and command output)
+//   Link       quint32 target (archived symlinks, relative to the link)
+//   Directory  empty
+//
+// The `--json` sections are stored as "section/<name>", the capture
+// archive as "archive/<path relative to the archive>".
+//
+// SnapshotFile maps the file and only checks the header, the directory and
+// the string table bounds; a section is decoded when asked for.
+class SnapshotFile
+{
+public:
+    enum Kind : quint32 { Meta = 1, Rows = 2, Cbor = 3, Blob = 4, Link = 5, Directory = 6 };
+
+    static constexpr quint32 Version = 1;
+
+    SnapshotFile() = default;
+    ~SnapshotFile() { close(); }
+    SnapshotFile(const SnapshotFile&) = delete;
+    SnapshotFile& operator=(const SnapshotFile&) = delete;
+
+    // True if path is a regular file starting with the snapshot magic.
+    static bool isSnapshotFile(const QString& path);
+
+    bool open(const QString& path, QString* error = nullptr);
+    void close();
+    bool isOpen() const { return m_base != nullptr; }
+
+    int sectionCount() const { return int(m_sectionCount); }
+    QString sectionName(int index) const;
+    Kind sectionKind(int index) const;
+    // Index of the section called name (binary search), or -1.
+    int indexOf(const QString& name) const;
+
+    // Body of section index, inflated if needed. Uncompressed bodies are
+    // not copied: the array points into the mapping and is only valid
+    // while the file is open.
+    QByteArray data(int index) const;
+
+    QString string(quint32 id) const;
+    QHash<QString, QString> meta() const;
+    InfoRows rows(const QString& name) const;
+    QCborValue cbor(const QString& name) const;
+
+    // The document `lsv --json` printed when the snapshot was taken.
+    QJsonObject toDocument() const;
+    // Write the capture archive back out into directory, for replay. Fails
+    // on entries or links that would reach outside directory.
+    bool extractArchive(const QString& directory, QString* error = nullptr) const;
+
+private:
+    struct Entry {
+        quint32 name;
+        quint32 kind;
+        quint32 flags;
+        quint64 offset;
+        quint64 storedSize;
+        quint64 size;
+    };
+    Entry entry(int index) const;
+    QByteArray nameBytes(quint32 id) const;
+
+    QFile m_file;
+    const uchar* m_base = nullptr;
+    qint64 m_size = 0;
+    quint32 m_sectionCount = 0;
+    quint32 m_stringCount = 0;
+    const uchar* m_stringEnds = nullptr;
+    const uchar* m_stringBytes = nullptr;
+    quint64 m_stringBytesSize = 0;
+};
+
+// Builds a snapshot in memory and writes it in one go.
+class SnapshotFileWriter
+{
+public:
+    void addMeta(const QString& key, const QString& value);
+    void addRows(const QString& name, const InfoRows& rows);
+    void addCbor(const QString& name, const QCborValue& value);
+    void addBlob(const QString& name, const QByteArray& data);
+    void addLink(const QString& name, const QString& target);
+    void addDirectory(const QString& name);
+
+    // Metadata and "section/..." entries of a `lsv --json` document.
+    void addDocument(const QJsonObject& document);
+    // Every file, symlink and directory below a capture archive.
+    bool addArchive(const QString& directory, QString* error = nullptr);
+
+    // Blocks are compressed when compress is set and that makes them
+    // smaller.
+    bool save(const QString& path, bool compress, QString* error = nullptr) const;
+
+private:
+    struct Section {
+        quint32 name;
+        quint32 kind;
+        QByteArray body;
+    };
+    quint32 intern(const QString& text);
+    void add(const QString& name, quint32 kind, const QByteArray& body);
+
+    QVector<QByteArray> m_strings;          // UTF-8, by id
+    QHash<QString, quint32> m_stringIds;
+    QVector<Section> m_sections;
+    QVector<QPair<quint32, quint32>> m_meta;
+};
+
+#endif // SNAPSHOT_FILE_H
@@ -1,36 +1,52 @@
 #ifndef STORAGE_H
 #define STORAGE_H
 
-#include <QTableWidget>
-#include <QTableWidgetItem>
-#include <QProgressBar>
-#include <QHBoxLayout>
-#include <QVBoxLayout>
-#include <QWidget>
-#include <QFont>
-#include <QColor>
 #include <QJsonObject>
 #include <QFile>
 #include <QTextStream>
 #include <QRegularExpression>
 #include <QDebug>
-#include <QLabel>
 #include <QDir>
 #include <QStorageInfo>
-#include <QProcess>
+#include "info_rows.h"
+#include "procfs_parser.h"
+#ifndef LSV_CORE_ONLY
+#include <QTableWidget>
+#include <QTableWidgetItem>
+#include <QWidget>
+#include <QFont>
+#include <QColor>
 #include "gui_helpers.h"
+#include "usage_bar.h"
+#endif
+
+// One mounted, writable, non-virtual filesystem
+struct StorageVolume {
+    QString device;
+    QString mountPoint;
+    QString fsType;
+    long long usedBytes = 0;
+    long long totalBytes = 0;
+    double usagePercent = 0.0;
+};
 
 // Storage information functions
+QList<StorageVolume> collectStorageVolumes();
+InfoRows collectDiskCapacities();
+InfoRows collectStorageInformation();
+QString getStorageInfo();
+#ifndef LSV_CORE_ONLY
 void loadStorageInformation(QTableWidget* table, const QJsonObject& data);
 void loadLiveStorageInformation(QTableWidget* table);
 void styleStorageTable(QTableWidget* table);
-QString getStorageInfo();
 
 // Enhanced progress bar creation for storage
 QWidget* createStorageProgressBar(const QString& device, const QString& mountPoint, double percentage, long long used, long long total, const QString& unit, const QString& fsType);
+#endif
 
+#ifndef LSV_CORE_ONLY
 // Storage Table Styling
-void styleStorageTable(QTableWidget* table)
+inline void styleStorageTable(QTableWidget* table)
 {
     // Set column widths
     table->setColumnWidth(0, 200);  // Property
@@ -50,132 +66,40 @@ void styleStorageTable(QTableWidget* table)
     );
 }
 
-// Enhanced progress bar widget creation for storage
-QWidget* createStorageProgressBar(const QString& device, const QString& mountPoint, double percentage, long long used, long long total, const QString& unit, const QString& fsType)
+// Usage bar for one mounted volume: device and size with the percentage,
+// the bar, then mount point / filesystem and used / free. One painted
+// widget per mount instead of a container of labels and layouts.
+inline QWidget* createStorageProgressBar(const QString& device, const QString& mountPoint, double percentage, long long used, long long total, const QString& unit, const QString& fsType)
 {
-    QWidget* container = new QWidget();
-    QVBoxLayout* mainLayout = new QVBoxLayout(container);
-    mainLayout->setContentsMargins(5, 5, 5, 8); // More bottom margin
-    mainLayout->setSpacing(4);
-    
-    // Top layout with device name and percentage
-    QHBoxLayout* topLayout = new QHBoxLayout();
-    
-    // Create title with device and total size
-    QString titleText = QString("%1 - Tot: %2 %3").arg(device).arg(QString::number(total / (1024.0 * 1024.0 * 1024.0), 'f', 1)).arg(unit);
-    QLabel* nameLabel = new QLabel(titleText);
-    nameLabel->setFont(QFont(nameLabel->font().family(), nameLabel->font().pointSize(), QFont::Bold));
-    nameLabel->setStyleSheet("color: #2c3e50;");
-    
-    QLabel* percentLabel = new QLabel(QString("%1%").arg(QString::number(percentage, 'f', 1)));
-    percentLabel->setFont(QFont(percentLabel->font().family(), percentLabel->font().pointSize(), QFont::Bold));
-    percentLabel->setAlignment(Qt::AlignRight);
-    
-    // Color code the percentage for storage (different thresholds than memory)
-    if (percentage < 80) {
-        percentLabel->setStyleSheet("color: #27ae60;"); // Green
-    } else if (percentage < 95) {
-        percentLabel->setStyleSheet("color: #f39c12;"); // Orange
-    } else {
-        percentLabel->setStyleSheet("color: #e74c3c;"); // Red
-    }
-    
-    topLayout->addWidget(nameLabel);
-    topLayout->addStretch();
-    topLayout->addWidget(percentLabel);
-    
-    // Progress bar
-    QProgressBar* progressBar = new QProgressBar();
-    progressBar->setMinimum(0);
-    progressBar->setMaximum(100);
-    progressBar->setValue(static_cast<int>(percentage));
-    progressBar->setFixedHeight(24); // Slightly taller progress bar
-    progressBar->setTextVisible(false); // We'll show custom text below
-    
-    // Style progress bar based on usage (storage-specific colors)
-    QString progressStyle;
-    if (percentage < 80) {
-        progressStyle = 
-            "QProgressBar { "
-            "border: 2px solid #bdc3c7; "
-            "border-radius: 12px; "
-            "background-color: #ecf0f1; "
-            "} "
-            "QProgressBar::chunk { "
-            "background: qlineargradient(x1:0, y1:0, x2:1, y2:0, stop:0 #3498db, stop:1 #2980b9); "
-            "border-radius: 10px; "
-            "}";
-    } else if (percentage < 95) {
-        progressStyle = 
-            "QProgressBar { "
-            "border: 2px solid #bdc3c7; "
-            "border-radius: 12px; "
-            "background-color: #ecf0f1; "
-            "} "
-            "QProgressBar::chunk { "
-            "background: qlineargradient(x1:0, y1:0, x2:1, y2:0, stop:0 #f39c12, stop:1 #e67e22); "
-            "border-radius: 10px; "
-            "}";
-    } else {
-        progressStyle = 
-            "QProgressBar { "
-            "border: 2px solid #bdc3c7; "
-            "border-radius: 12px; "
-            "background-color: #ecf0f1; "
-            "} "
-            "QProgressBar::chunk { "
-            "background: qlineargradient(x1:0, y1:0, x2:1, y2:0, stop:0 #e74c3c, stop:1 #c0392b); "
-            "border-radius: 10px; "
-            "}";
-    }
-    progressBar->setStyleSheet(progressStyle);
-    
-    // Middle layout with mount point and filesystem type
-    QHBoxLayout* middleLayout = new QHBoxLayout();
-    
-    QString mountText = mountPoint.isEmpty() ? "Not mounted" : QString("Mounted: %1").arg(mountPoint);
-    QLabel* mountLabel = new QLabel(mountText);
-    mountLabel->setFont(QFont(mountLabel->font().family(), mountLabel->font().pointSize() - 1));
-    mountLabel->setStyleSheet("color: #7f8c8d;");
-    
-    QLabel* fsLabel = new QLabel(QString("FS: %1").arg(fsType.isEmpty() ? "Unknown" : fsType));
-    fsLabel->setFont(QFont(fsLabel->font().family(), fsLabel->font().pointSize() - 1));
-    fsLabel->setStyleSheet("color: #7f8c8d;");
-    fsLabel->setAlignment(Qt::AlignRight);
-    
-    middleLayout->addWidget(mountLabel);
-    middleLayout->addStretch();
-    middleLayout->addWidget(fsLabel);
-    
-    // Bottom layout with usage details
-    QHBoxLayout* bottomLayout = new QHBoxLayout();
-    
-    QLabel* usageLabel = new QLabel(QString("Used: %1 %2").arg(QString::number(used / (1024.0 * 1024.0 * 1024.0), 'f', 2)).arg(unit));
-    usageLabel->setFont(QFont(usageLabel->font().family(), usageLabel->font().pointSize() - 1));
-    usageLabel->setStyleSheet("color: #7f8c8d;");
-    
-    QLabel* availableLabel = new QLabel(QString("Free: %1 %2").arg(QString::number((total - used) / (1024.0 * 1024.0 * 1024.0), 'f', 2)).arg(unit));
-    availableLabel->setFont(QFont(availableLabel->font().family(), availableLabel->font().pointSize() - 1));
-    availableLabel->setStyleSheet("color: #7f8c8d;");
-    availableLabel->setAlignment(Qt::AlignRight);
-    
-    bottomLayout->addWidget(usageLabel);
-    bottomLayout->addStretch();
-    bottomLayout->addWidget(availableLabel);
-    
-    // Add all layouts to main container
-    mainLayout->addLayout(topLayout);
-    mainLayout->addWidget(progressBar);
-    mainLayout->addLayout(middleLayout);
-    mainLayout->addLayout(bottomLayout);
-    
-    container->setFixedHeight(95); // Slightly taller than memory for extra info line
-    return container;
+    const double gib = 1024.0 * 1024.0 * 1024.0;
+    UsageBar* bar = new UsageBar();
+    bar->setContentsMargins(5, 5, 5, 8);
+    bar->setBarHeight(24);
+
+    // Storage thresholds differ from memory: blue until 80 %, orange until 95 %
+    bar->setWarningAt(80);
+    bar->setCriticalAt(95);
+    bar->setNormalColor(QColor(0x34, 0x98, 0xdb));    // #3498db
+    bar->setWarningColor(QColor(0xf3, 0x9c, 0x12));   // #f39c12
+    bar->setCriticalColor(QColor(0xe7, 0x4c, 0x3c));  // #e74c3c
+    bar->setTrackColor(QColor(0xec, 0xf0, 0xf1));     // #ecf0f1
+    bar->setBorderColor(QColor(0xbd, 0xc3, 0xc7));    // #bdc3c7
+    bar->setValue(percentage);
+
+    bar->setTitle(QString("%1 - Tot: %2 %3").arg(device).arg(QString::number(total / gib, 'f', 1)).arg(unit));
+    bar->setDetails(
+        QStringList() << (mountPoint.isEmpty() ? QString("Not mounted") : QString("Mounted: %1").arg(mountPoint))
+                      << QString("Used: %1 %2").arg(QString::number(used / gib, 'f', 2)).arg(unit),
+        QStringList() << QString("FS: %1").arg(fsType.isEmpty() ? "Unknown" : fsType)
+                      << QString("Free: %1 %2").arg(QString::number((total - used) / gib, 'f', 2)).arg(unit));
+    return bar;
 }
 
-void loadLiveStorageInformation(QTableWidget* table)
+#endif // LSV_CORE_ONLY
+
+inline QList<StorageVolume> collectStorageVolumes()
 {
-    table->setRowCount(0);
+    QList<StorageVolume> volumes;
     
     // Get mounted filesystems using QStorageInfo
     QList<QStorageInfo> mountedVolumes = QStorageInfo::mountedVolumes();
@@ -206,35 +130,96 @@ void loadLiveStorageInformation(QTableWidget* table)
         
         long long totalBytes = storage.bytesTotal();
         long long availableBytes = storage.bytesAvailable();
-        long long usedBytes = totalBytes - availableBytes;
         
         if (totalBytes > 0) {
-            double usagePercent = (static_cast<double>(usedBytes) / totalBytes) * 100.0;
-            
-            int row = table->rowCount();
-            table->insertRow(row);
-            
-            // Property name (device)
-            QString propertyName = QString("Disk: %1").arg(device);
-            QTableWidgetItem* propertyItem = new QTableWidgetItem(propertyName);
-            propertyItem->setForeground(QColor(44, 62, 80));
-            propertyItem->setFont(QFont(propertyItem->font().family(), propertyItem->font().pointSize(), QFont::Bold));
-            table->setItem(row, 0, propertyItem);
-            
-            // Progress bar widget
-            QWidget* progressWidget = createStorageProgressBar(device, mountPoint, usagePercent, usedBytes, totalBytes, "GB", fsType);
-            table->setCellWidget(row, 1, progressWidget);
-            table->setRowHeight(row, 95); // Taller for storage info
-            
-            // Empty unit column
-            table->setItem(row, 2, new QTableWidgetItem(""));
-            
-            // Type column
-            QTableWidgetItem* typeItem = new QTableWidgetItem("Storage");
-            typeItem->setForeground(QColor(52, 152, 219));
-            table->setItem(row, 3, typeItem);
+            StorageVolume volume;
+            volume.device = device;
+            volume.mountPoint = mountPoint;
+            volume.fsType = fsType;
+            volume.totalBytes = totalBytes;
+            volume.usedBytes = totalBytes - availableBytes;
+            volume.usagePercent = (static_cast<double>(volume.usedBytes) / totalBytes) * 100.0;
+            volumes.append(volume);
         }
     }
+    return volumes;
+}
+
+// Whole-disk capacities from /proc/partitions
+inline InfoRows collectDiskCapacities()
+{
+    InfoRows rows;
+    procfs::FileBuffer buffer;
+    if (!buffer.read("/proc/partitions")) return rows;
+
+    procfs::parsePartitions(buffer.view(), [&rows](const procfs::PartitionLine& p) {
+        const std::string_view name = p.name;
+        // Only show actual disk devices, not partitions for summary
+        const bool diskPrefix = procfs::startsWith(name, "sd") || procfs::startsWith(name, "nvme") || procfs::startsWith(name, "hd");
+        const bool endsWithDigit = !name.empty() && name.back() >= '0' && name.back() <= '9';
+        if (name.size() >= 3 && diskPrefix && !endsWithDigit) { // No numbers at end = main device
+            const long long sizeBytes = (long long)p.blocks * 1024;
+            rows.append(QStringList()
+                << QString("Total Capacity: %1").arg(procfs::toQString(name))
+                << QString::number(sizeBytes / (1024.0 * 1024.0 * 1024.0), 'f', 1)
+                << "GB"
+                << "Storage");
+        }
+    });
+    return rows;
+}
+
+// Text-only form of the storage table (volumes as "used of total" rows)
+inline InfoRows collectStorageInformation()
+{
+    InfoRows rows;
+    const double gb = 1024.0 * 1024.0 * 1024.0;
+    for (const StorageVolume& v : collectStorageVolumes()) {
+        rows.append(QStringList()
+            << QString("Disk: %1").arg(v.device)
+            << QString("%1 of %2 used (%3%) on %4 [%5]")
+                   .arg(QString::number(v.usedBytes / gb, 'f', 1), QString::number(v.totalBytes / gb, 'f', 1),
+                        QString::number(v.usagePercent, 'f', 1), v.mountPoint, v.fsType)
+            << "GB"
+            << "Storage");
+    }
+    if (rows.isEmpty()) {
+        rows.append(QStringList() << "No Storage" << "No mounted storage devices found" << "" << "Storage");
+    }
+    rows.append(collectDiskCapacities());
+    return rows;
+}
+
+#ifndef LSV_CORE_ONLY
+inline void loadLiveStorageInformation(QTableWidget* table)
+{
+    table->setRowCount(0);
+    
+    for (const StorageVolume& volume : collectStorageVolumes()) {
+        int row = table->rowCount();
+        table->insertRow(row);
+        
+        // Property name (device)
+        QString propertyName = QString("Disk: %1").arg(volume.device);
+        QTableWidgetItem* propertyItem = new QTableWidgetItem(propertyName);
+        propertyItem->setForeground(QColor(44, 62, 80));
+        propertyItem->setFont(QFont(propertyItem->font().family(), propertyItem->font().pointSize(), QFont::Bold));
+        table->setItem(row, 0, propertyItem);
+        
+        // Progress bar widget
+        QWidget* progressWidget = createStorageProgressBar(volume.device, volume.mountPoint, volume.usagePercent,
+                                                           volume.usedBytes, volume.totalBytes, "GB", volume.fsType);
+        table->setCellWidget(row, 1, progressWidget);
+        table->setRowHeight(row, 95); // Taller for storage info
+        
+        // Empty unit column
+        table->setItem(row, 2, new QTableWidgetItem(""));
+        
+        // Type column
+        QTableWidgetItem* typeItem = new QTableWidgetItem("Storage");
+        typeItem->setForeground(QColor(52, 152, 219));
+        table->setItem(row, 3, typeItem);
+    }
     
     // If no storage devices found, add a message
     if (table->rowCount() == 0) {
@@ -242,46 +227,18 @@ void loadLiveStorageInformation(QTableWidget* table)
     }
     
     // Add additional disk information from /proc/partitions
-    QFile partitionsFile("/proc/partitions");
-    if (partitionsFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        QTextStream stream(&partitionsFile);
-        QStringList lines = stream.readAll().split('\n');
-        partitionsFile.close();
-        
-        // Skip first two header lines
-        for (int i = 2; i < lines.size(); ++i) {
-            QString line = lines[i].trimmed();
-            if (line.isEmpty()) continue;
-            
-            QStringList parts = line.split(QRegularExpression("\\s+"));
-            if (parts.size() >= 4) {
-                QString deviceName = parts[3];
-                long long sizeKB = parts[2].toLongLong();
-                
-                // Only show actual disk devices, not partitions for summary
-                if (deviceName.length() >= 3 && 
-                    (deviceName.startsWith("sd") || deviceName.startsWith("nvme") || deviceName.startsWith("hd")) &&
-                    !deviceName.contains(QRegularExpression("\\d$"))) { // No numbers at end = main device
-                    
-                    long long sizeBytes = sizeKB * 1024;
-                    addRowToTable(table, QStringList() 
-                        << QString("Total Capacity: %1").arg(deviceName) 
-                        << QString::number(sizeBytes / (1024.0 * 1024.0 * 1024.0), 'f', 1) 
-                        << "GB" 
-                        << "Storage");
-                }
-            }
-        }
-    }
+    addRowsToTable(table, collectDiskCapacities());
 }
 
-void loadStorageInformation(QTableWidget* table, const QJsonObject& data)
+inline void loadStorageInformation(QTableWidget* table, const QJsonObject& data)
 {
+    Q_UNUSED(data);
     // Use the live storage information instead of JSON data
     loadLiveStorageInformation(table);
 }
+#endif // LSV_CORE_ONLY
 
-QString getStorageInfo()
+inline QString getStorageInfo()
 {
     QList<QStorageInfo> mountedVolumes = QStorageInfo::mountedVolumes();
     
@@ -1,4 +1,5 @@
 #include "summary_tab.h"
+#include "lsv_style.h"
 #include "tabs_config.h"
 #include <QVBoxLayout>
 #include <QHBoxLayout>
@@ -15,6 +16,7 @@ SummaryTab::SummaryTab(QWidget* parent)
     : TabWidgetBase("Summary", "lshw -short", true, "lshw", parent)
 {
     qDebug() << "SummaryTab: Constructor called - base constructor done";
+    useLshwProbe();
     initializeTab();
     qDebug() << "SummaryTab: Constructor finished";
 }
@@ -44,29 +46,7 @@ QWidget* SummaryTab::createUserFriendlyView()
     );
     mainLayout->addWidget(titleLabel);
     
-    m_systemOverview = new QGroupBox("System Overview");
-    m_systemOverview->setStyleSheet(
-        "QGroupBox {"
-        "  font-weight: bold;"
-        "  border: 2px solid #bdc3c7;"
-        "  border-radius: 8px;"
-        "  margin-top: 10px;"
-        "  padding-top: 10px;"
-        "}"
-        "QGroupBox::title {"
-        "  subcontrol-origin: margin;"
-        "  left: 10px;"
-        "  padding: 0 10px 0 10px;"
-        "}"
-    );
-    
-    QVBoxLayout* overviewLayout = new QVBoxLayout(m_systemOverview);
-    m_overviewContent = new QLabel("Loading system information...");
-    m_overviewContent->setWordWrap(true);
-    m_overviewContent->setStyleSheet("QLabel { padding: 10px; background-color: #f8f9fa; border-radius: 4px; }");
-    overviewLayout->addWidget(m_overviewContent);
-    
-    mainLayout->addWidget(m_systemOverview);
+    m_systemOverview = ::createInfoSection("System Overview", &m_overviewContent, mainLayout, "Loading system information...");
     
     createHardwareSection("Processor", &m_cpuSection, &m_cpuContent, mainLayout);
     createHardwareSection("Memory", &m_memorySection, &m_memoryContent, mainLayout);
@@ -84,29 +64,7 @@ QWidget* SummaryTab::createUserFriendlyView()
 
 void SummaryTab::createHardwareSection(const QString& title, QGroupBox** groupBox, QLabel** contentLabel, QVBoxLayout* parentLayout)
 {
-    *groupBox = new QGroupBox(title);
-    (*groupBox)->setStyleSheet(
-        "QGroupBox {"
-        "  font-weight: bold;"
-        "  border: 2px solid #bdc3c7;"
-        "  border-radius: 8px;"
-        "  margin-top: 10px;"
-        "  padding-top: 10px;"
-        "}"
-        "QGroupBox::title {"
-        "  subcontrol-origin: margin;"
-        "  left: 10px;"
-        "  padding: 0 10px 0 10px;"
-        "}"
-    );
-    
-    QVBoxLayout* sectionLayout = new QVBoxLayout(*groupBox);
-    *contentLabel = new QLabel("Loading " + title.toLower() + " information...");
-    (*contentLabel)->setWordWrap(true);
-    (*contentLabel)->setStyleSheet("QLabel { padding: 10px; background-color: #f8f9fa; border-radius: 4px; }");
-    sectionLayout->addWidget(*contentLabel);
-    
-    parentLayout->addWidget(*groupBox);
+    *groupBox = ::createInfoSection(title, contentLabel, parentLayout, "Loading " + title.toLower() + " information...");
 }
 
 void SummaryTab::parseOutput(const QString& output)
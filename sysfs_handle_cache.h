@@ -0,0 +1,139 @@
+#ifndef SYSFS_HANDLE_CACHE_H
+#define SYSFS_HANDLE_CACHE_H
+
+// Open-once handles for small attributes that are read on every tick.
+//
+// FileBuffer::read() costs open, read until EOF and close for every value;
+// for the per-cpu cpufreq files on a 384-thread machine that is well over a
+// thousand syscalls a second. sysfs (kernfs) regenerates an attribute when
+// it is read at offset 0, so a descriptor can be kept open and re-read with
+// a single pread(). A tick then costs one syscall per value.
+//
+// Paths follow procfs::rootDirectory() and reads are reported to the
+// capture hook like FileBuffer reads. Files that cannot be opened are
+// remembered as missing until clear(); a read that fails (the attribute of
+// a cpu that went offline returns ENODEV or EIO) closes the handle and
+// marks it missing as well. Callers watch whatever tells them the set
+// changed (cpu/online for cpus) and clear() and add() again.
+//
+// Not thread-safe; one cache per reading thread.
+
+#include "procfs_parser.h"
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace procfs {
+
+class HandleCache
+{
+public:
+    HandleCache() = default;
+    HandleCache(const HandleCache&) = delete;
+    HandleCache& operator=(const HandleCache&) = delete;
+    ~HandleCache() { clear(); }
+
+    // Register an attribute; returns its slot. It is opened on first read.
+    int add(std::string_view path)
+    {
+        Handle handle;
+        handle.path.assign(path);
+        m_handles.push_back(std::move(handle));
+        return int(m_handles.size()) - 1;
+    }
+
+    // Close every handle and forget the slots.
+    void clear()
+    {
+        for (Handle& handle : m_handles) {
+            if (handle.fd >= 0) ::close(handle.fd);
+        }
+        m_handles.clear();
+    }
+
+    int size() const { return int(m_handles.size()); }
+
+    // Current contents of a slot, trimmed; the view is valid until the
+    // next read. False when the attribute is missing or unreadable.
+    bool read(int slot, std::string_view& value)
+    {
+        if (slot < 0 || slot >= int(m_handles.size())) return false;
+        Handle& handle = m_handles[size_t(slot)];
+        if (handle.missing) return false;
+
+        const auto start = std::chrono::steady_clock::now();
+        ssize_t n = -1;
+        if (handle.fd < 0 && !open(handle)) {
+            // Out of descriptors: read this one the slow way, keep trying
+            // to hold it open on later ticks.
+            if (handle.missing) return false;
+            const int fd = ::open(hostPath(handle).c_str(), O_RDONLY | O_CLOEXEC);
+            if (fd < 0) return false;
+            n = preadAll(fd);
+            ::close(fd);
+        } else {
+            n = preadAll(handle.fd);
+            if (n < 0) {
+                ::close(handle.fd);
+                handle.fd = -1;
+                handle.missing = true;
+                return false;
+            }
+        }
+        if (n < 0) return false;
+        if (ReadHook hook = readHook()) {
+            hook(handle.path.c_str(), m_data, size_t(n),
+                 std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+        }
+        value = trim(std::string_view(m_data, size_t(n)));
+        return true;
+    }
+
+    bool readU64(int slot, uint64_t& value)
+    {
+        std::string_view text;
+        return read(slot, text) && parseNumber(text, value);
+    }
+
+private:
+    struct Handle {
+        std::string path;       // as asked for, without rootDirectory()
+        int fd = -1;
+        bool missing = false;
+    };
+
+    std::string hostPath(const Handle& handle) const
+    {
+        const std::string& root = rootDirectory();
+        return root.empty() ? handle.path : root + handle.path;
+    }
+
+    // False when the file is not there (missing) or no descriptor is free.
+    bool open(Handle& handle)
+    {
+        handle.fd = ::open(hostPath(handle).c_str(), O_RDONLY | O_CLOEXEC);
+        if (handle.fd >= 0) return true;
+        handle.missing = errno != EMFILE && errno != ENFILE;
+        return false;
+    }
+
+    ssize_t preadAll(int fd)
+    {
+        for (;;) {
+            const ssize_t n = ::pread(fd, m_data, sizeof(m_data), 0);
+            if (n >= 0 || errno != EINTR) return n;
+        }
+    }
+
+    std::vector<Handle> m_handles;
+    char m_data[256];       // single values; longer contents are cut
+};
+
+} // namespace procfs
+
+#endif // SYSFS_HANDLE_CACHE_H
@@ -15,6 +15,7 @@
 #include <QSysInfo>
 #include <QDateTime>
 #include "gui_helpers.h"
+#include "procfs_parser.h"
 
 // System information functions
 void loadSystemInformation(QTableWidget* table, const QJsonObject& data);
@@ -67,16 +68,13 @@ void loadSystemInformation(QTableWidget* table, const QJsonObject& data)
         addRowToTable(table, QStringList() << "Kernel Info" << version << "" << "System");
     }
     
-    // Read uptime
-    QFile uptimeFile("/proc/uptime");
-    if (uptimeFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        QTextStream stream(&uptimeFile);
-        QString uptimeStr = stream.readLine();
-        uptimeFile.close();
-        
-        QStringList parts = uptimeStr.split(' ');
-        if (!parts.isEmpty()) {
-            double uptimeSeconds = parts[0].toDouble();
+    // Read uptime and load average
+    procfs::FileBuffer buffer;
+    if (buffer.read("/proc/uptime")) {
+        std::string_view rest = buffer.view();
+        std::string_view field;
+        double uptimeSeconds = 0;
+        if (procfs::nextField(rest, field) && procfs::parseNumber(field, uptimeSeconds)) {
             int days = static_cast<int>(uptimeSeconds / 86400);
             int hours = static_cast<int>((uptimeSeconds - days * 86400) / 3600);
             int minutes = static_cast<int>((uptimeSeconds - days * 86400 - hours * 3600) / 60);
@@ -87,16 +85,13 @@ void loadSystemInformation(QTableWidget* table, const QJsonObject& data)
         }
     }
     
-    // Read load average
-    QFile loadAvgFile("/proc/loadavg");
-    if (loadAvgFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        QTextStream stream(&loadAvgFile);
-        QString loadLine = stream.readLine();
-        loadAvgFile.close();
-        
-        QStringList loadParts = loadLine.split(' ');
-        if (loadParts.size() >= 3) {
-            addRowToTable(table, QStringList() << "Load Average" << QString("%1, %2, %3").arg(loadParts[0], loadParts[1], loadParts[2]) << "" << "System");
+    if (buffer.read("/proc/loadavg")) {
+        std::string_view rest = buffer.view();
+        std::string_view load1, load5, load15;
+        if (procfs::nextField(rest, load1) && procfs::nextField(rest, load5) && procfs::nextField(rest, load15)) {
+            addRowToTable(table, QStringList() << "Load Average"
+                << QString("%1, %2, %3").arg(procfs::toQString(load1), procfs::toQString(load5), procfs::toQString(load15))
+                << "" << "System");
         }
     }
     
@@ -1,9 +1,30 @@
 #include "tab_widget_base.h"
 #include <QDebug>
 #include "log_helper.h"
+#include "lshw_probe.h"
+#include "snapshot_cache.h"
+#include "trace.h"
+#include "search_index.h"
 #include <QLabel>
 #include <QMovie>
 #include <QApplication>
+#include <QShowEvent>
+
+namespace {
+
+// FNV-1a: output that arrives in chunks hashes the same as in one piece.
+constexpr quint64 OutputHashSeed = 0xcbf29ce484222325ull;
+
+quint64 hashOutput(quint64 h, const QByteArray& bytes)
+{
+    for (char c : bytes) {
+        h ^= uchar(c);
+        h *= 0x100000001b3ull;
+    }
+    return h;
+}
+
+} // namespace
 
 TabWidgetBase::TabWidgetBase(const QString& tabName, const QString& command, 
                             bool hasGeekMode, const QString& geekCommand, 
@@ -13,12 +34,27 @@ TabWidgetBase::TabWidgetBase(const QString& tabName, const QString& command,
     , m_command(command)
     , m_hasGeekMode(hasGeekMode)
     , m_geekCommand(geekCommand)
-    , m_process(nullptr)
+    , m_userFriendlyWidget(nullptr)
+    , m_commandTicket(0)
     , m_isLoading(false)
+    , m_cacheable(false)
+    , m_outputHash(0)
+    , m_hasOutput(false)
+    , m_streaming(false)
+    , m_streamStarted(false)
+    , m_useLshwProbe(false)
+    , m_lshwGeneration(0)
 {
     setupUI();
 }
 
+TabWidgetBase::~TabWidgetBase()
+{
+    // Drop our subscription so the engine can skip or kill the job if no
+    // other tab is waiting for the same command.
+    CollectorEngine::instance()->cancelAll(this);
+}
+
 void TabWidgetBase::setupUI()
 {
     m_mainLayout = new QVBoxLayout(this);
@@ -55,8 +91,23 @@ void TabWidgetBase::initializeTab()
     executeCommand();
 }
 
+void TabWidgetBase::useLshwProbe(const QString& className)
+{
+    m_useLshwProbe = true;
+    m_lshwClass = className;
+    // When another tab refreshes the tree, re-render from the new one.
+    connect(LshwProbe::instance(), &LshwProbe::treeUpdated, this, [this]() {
+        if (!m_isLoading && m_lshwGeneration != LshwProbe::instance()->generation()) {
+            onLshwReady();
+        }
+    });
+}
+
 void TabWidgetBase::refreshData()
 {
+    if (m_useLshwProbe) {
+        LshwProbe::instance()->refresh();
+    }
     executeCommand();
 }
 
@@ -70,77 +121,213 @@ void TabWidgetBase::executeCommand()
         m_command = "true"; // fallback to dummy command
     }
 
-    showLoadingMessage();
+    CollectorEngine::Priority priority = isVisible() ? CollectorEngine::Visible : CollectorEngine::Normal;
+
+    QByteArray cached;
+    bool fromCache = false;
+    if (m_cacheable && !m_hasOutput && SnapshotCache::instance()->lookup(m_command, &cached)) {
+        // Stale-while-revalidate: show what the previous run saw right away
+        // and re-run the command quietly behind it.
+        LSV_LOG_DEBUG("tabs", QString("TabWidgetBase: %1 painted from snapshot cache, revalidating").arg(m_tabName));
+        renderOutput(cached, QStringLiteral("cache"));
+        m_outputHash = hashOutput(OutputHashSeed, cached);
+        m_hasOutput = true;
+        hideLoadingMessage();
+        priority = CollectorEngine::Background;
+        fromCache = true;
+    } else {
+        showLoadingMessage();
+    }
     emit loadingStarted();
 
-    m_process = new QProcess(this);
-    connect(m_process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
-            this, &TabWidgetBase::onProcessFinished);
-    connect(m_process, &QProcess::errorOccurred, this, &TabWidgetBase::onProcessError);
-    connect(m_process, &QProcess::started, this, [this]() {
-        appendLog(QString("TabWidgetBase: Process started for %1 command: %2").arg(m_tabName, m_command));
-        appendLog(QString("ENV PATH: %1").arg(QString::fromLocal8Bit(qgetenv("PATH"))));
-    });
-    connect(m_process, &QProcess::readyReadStandardOutput, this, [this]() {
-        appendLog(QString("TabWidgetBase: readyReadStandardOutput for %1").arg(m_tabName));
-    });
-    connect(m_process, &QProcess::readyReadStandardError, this, [this]() {
-        appendLog(QString("TabWidgetBase: readyReadStandardError for %1").arg(m_tabName));
-    });
+    // One load per tab at a time (m_isLoading), so the tab identifies it.
+    if (Trace::isEnabled()) {
+        Trace::asyncBegin("tab", "load " + m_tabName, quintptr(this),
+                          QJsonObject{{"command", m_useLshwProbe ? QString("lshw tree") : m_command}});
+    }
 
-    m_process->start("bash", QStringList() << "-c" << m_command);
+    if (m_useLshwProbe) {
+        m_isLoading = true;
+        LshwProbe::instance()->request(this, [this]() { onLshwReady(); }, priority);
+        return;
+    }
+
+    // The command is queued in the shared collector engine rather than spawned
+    // here; identical commands from other tabs are merged and the tab that is
+    // on screen is served first.
     m_isLoading = true;
+    LSV_LOG_DEBUG("tabs", QString("TabWidgetBase: Queueing command for %1: %2").arg(m_tabName, m_command));
+    auto finished = [this](const CollectorResult& result) { onCommandFinished(result); };
+    // Behind a cached paint the new output is compared first and replaces
+    // it in one go; otherwise a streaming tab fills in as lines arrive.
+    m_streaming = streamsOutput() && !fromCache;
+    if (m_streaming) {
+        m_streamStarted = false;
+        m_outputHash = OutputHashSeed;
+        m_commandTicket = CollectorEngine::instance()->submitShellStreaming(m_command, this,
+            [this](const QByteArray& chunk) { onCommandOutput(chunk); }, finished, priority);
+    } else {
+        m_commandTicket = CollectorEngine::instance()->submitShell(m_command, this, finished, priority);
+    }
+}
+
+void TabWidgetBase::parseOutput(const QString& output)
+{
+    beginStream();
+    parseLines(output.split('\n'));
+    endStream();
+}
+
+void TabWidgetBase::renderOutput(const QByteArray& output, const QString& source)
+{
+    TraceSpan span("tab", "parseOutput");
+    span.addArg("tab", m_tabName);
+    span.addArg("source", source);
+    span.addArg("bytes", qint64(output.size()));
+    parseOutput(QString::fromLocal8Bit(output));
+    SearchIndex::instance()->publish(m_tabName, m_userFriendlyWidget);
 }
 
-void TabWidgetBase::onProcessFinished(int exitCode, QProcess::ExitStatus exitStatus)
+void TabWidgetBase::onCommandOutput(const QByteArray& chunk)
 {
-    if (m_process) {
-        QString output = QString::fromLocal8Bit(m_process->readAllStandardOutput());
-        QString errorOutput = QString::fromLocal8Bit(m_process->readAllStandardError());
+    m_outputHash = hashOutput(m_outputHash, chunk);
+    if (m_cacheable) m_cacheOutput += chunk;
 
-        // Filter known noisy warnings (e.g., lshw warning about super-user) before logging stderr
-        auto filterStderr = [](const QString& in) {
-            if (in.trimmed().isEmpty()) return QString();
-            QStringList lines = in.split('\n');
-            QStringList out;
-            for (const QString& l : lines) {
-                QString t = l.trimmed();
-                // ignore lshw warnings about running as super-user
-                if (t.contains("you should run this program as super-user", Qt::CaseInsensitive)) continue;
-                if (t.contains("output may be incomplete or inaccurate", Qt::CaseInsensitive)) continue;
-                out << l;
-            }
-            return out.join('\n').trimmed();
-        };
+    // Only complete lines are parsed; a line ends at a '\n' byte, which
+    // never occurs inside a multibyte character.
+    const qsizetype end = chunk.lastIndexOf('\n');
+    if (end < 0) {
+        m_partialLine += chunk;
+        return;
+    }
+    m_partialLine += chunk.left(end);
+    feedLines(m_partialLine);
+    m_partialLine = chunk.mid(end + 1);
+    hideLoadingMessage();
+}
 
-        QString filteredErr = filterStderr(errorOutput);
+void TabWidgetBase::feedLines(const QByteArray& bytes)
+{
+    if (!m_streamStarted) {
+        m_streamStarted = true;
+        beginStream();
+    }
+    TraceSpan span("tab", "parseLines");
+    span.addArg("tab", m_tabName);
+    span.addArg("bytes", qint64(bytes.size()));
+    parseLines(QString::fromLocal8Bit(bytes).split('\n'));
+}
 
-        appendLog(QString("TabWidgetBase: Process finished for %1 exitCode: %2 exitStatus: %3").arg(m_tabName).arg(exitCode).arg((int)exitStatus));
-        appendLog(QString("TabWidgetBase: Output length: %1 Err length: %2").arg(QString::number(output.size())).arg(QString::number(filteredErr.size())));
-        if (!filteredErr.isEmpty()) appendLog(QString("TabWidgetBase: Process stderr: %1").arg(filteredErr));
+void TabWidgetBase::showEvent(QShowEvent* event)
+{
+    QWidget::showEvent(event);
+    if (m_isLoading) {
+        if (m_useLshwProbe) {
+            LshwProbe::instance()->promote(CollectorEngine::Visible);
+        } else {
+            CollectorEngine::instance()->promote(this, CollectorEngine::Visible);
+        }
+    }
+}
 
-        m_lastOutput = output;
-        parseOutput(output);
+void TabWidgetBase::onCommandFinished(const CollectorResult& result)
+{
+    m_isLoading = false;
+    m_commandTicket = 0;
+    if (Trace::isEnabled()) {
+        Trace::asyncEnd("tab", "load " + m_tabName, quintptr(this),
+                        QJsonObject{{"exitCode", result.exitCode}, {"elapsedMs", result.elapsedMs},
+                                    {"timedOut", result.timedOut}, {"bytes", result.outputBytes}});
+    }
 
-        m_process->deleteLater();
-        m_process = nullptr;
+    if (result.failedToStart) {
+        LSV_LOG_DEBUG("tabs", QString("TabWidgetBase: Command failed to start for %1: %2").arg(m_tabName, QString::fromLocal8Bit(result.standardError)));
+        m_loadingLabel->setText(QString("Error loading %1 information").arg(m_tabName));
+        m_partialLine.clear();
+        m_cacheOutput.clear();
+        emit loadingFinished();
+        return;
+    }
+
+    QString errorOutput = QString::fromLocal8Bit(result.standardError);
+
+    // Filter known noisy warnings (e.g., lshw warning about super-user) before logging stderr
+    auto filterStderr = [](const QString& in) {
+        if (in.trimmed().isEmpty()) return QString();
+        QStringList lines = in.split('\n');
+        QStringList out;
+        for (const QString& l : lines) {
+            QString t = l.trimmed();
+            // ignore lshw warnings about running as super-user
+            if (t.contains("you should run this program as super-user", Qt::CaseInsensitive)) continue;
+            if (t.contains("output may be incomplete or inaccurate", Qt::CaseInsensitive)) continue;
+            out << l;
+        }
+        return out.join('\n').trimmed();
+    };
+
+    QString filteredErr = filterStderr(errorOutput);
+
+    LSV_LOG_DEBUG("tabs", QString("TabWidgetBase: Command finished for %1 exitCode: %2 elapsed: %3 ms%4").arg(m_tabName).arg(result.exitCode).arg(result.elapsedMs).arg(result.timedOut ? " (deadline exceeded)" : ""));
+    LSV_LOG_DEBUG("tabs", QString("TabWidgetBase: Output length: %1 Err length: %2").arg(QString::number(result.outputBytes)).arg(QString::number(filteredErr.size())));
+    if (!filteredErr.isEmpty()) LSV_LOG_DEBUG("tabs", QString("TabWidgetBase: Process stderr: %1").arg(filteredErr));
+
+    const bool complete = result.exitCode == 0 && !result.timedOut;
+    if (m_streaming) {
+        // Everything but a last line without a newline is on screen already.
+        if (!m_partialLine.isEmpty()) feedLines(m_partialLine);
+        m_partialLine = QByteArray();
+        if (!m_streamStarted) beginStream();
+        endStream();
+        m_streamStarted = false;
+        m_hasOutput = true;
+        SearchIndex::instance()->publish(m_tabName, m_userFriendlyWidget);
+        if (m_cacheable && complete) SnapshotCache::instance()->store(m_command, m_cacheOutput);
+        m_cacheOutput = QByteArray();
+    } else {
+        if (m_cacheable && complete) {
+            SnapshotCache::instance()->store(m_command, result.standardOutput);
+        }
+
+        // Labels and tables only need touching when something actually
+        // changed, e.g. after revalidating a cached snapshot.
+        const quint64 hash = hashOutput(OutputHashSeed, result.standardOutput);
+        if (m_hasOutput && hash == m_outputHash) {
+            LSV_LOG_DEBUG("tabs", QString("TabWidgetBase: %1 output unchanged").arg(m_tabName));
+        } else {
+            m_outputHash = hash;
+            m_hasOutput = true;
+            renderOutput(result.standardOutput, QStringLiteral("command"));
+        }
     }
 
     hideLoadingMessage();
     emit loadingFinished();
-    m_isLoading = false;
 }
 
-void TabWidgetBase::onProcessError(QProcess::ProcessError error)
+void TabWidgetBase::onLshwReady()
 {
-    if (m_process) {
-        m_process->deleteLater();
-        m_process = nullptr;
+    // Also called when another tab refreshed the tree; only a request of
+    // our own has a load span open.
+    if (m_isLoading && Trace::isEnabled()) Trace::asyncEnd("tab", "load " + m_tabName, quintptr(this));
+    m_isLoading = false;
+    LshwProbe* probe = LshwProbe::instance();
+    m_lshwGeneration = probe->generation();
+
+    QString output = probe->shortListing(m_lshwClass);
+    LSV_LOG_DEBUG("tabs", QString("TabWidgetBase: %1 served from lshw tree (class '%2', %3 chars)").arg(m_tabName, m_lshwClass).arg(output.size()));
+
+    m_hasOutput = true;
+    {
+        TraceSpan span("tab", "parseOutput");
+        span.addArg("tab", m_tabName);
+        span.addArg("source", QStringLiteral("lshw"));
+        parseOutput(output);
     }
+    SearchIndex::instance()->publish(m_tabName, m_userFriendlyWidget);
 
-    m_loadingLabel->setText(QString("Error loading %1 information").arg(m_tabName));
+    hideLoadingMessage();
     emit loadingFinished();
-    m_isLoading = false;
 }
 
 void TabWidgetBase::showLoadingMessage()
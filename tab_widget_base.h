@@ -5,7 +5,9 @@
 #include <QVBoxLayout>
 #include <QStackedWidget>
 #include <QLabel>
-#include <QProcess>
+#include "collector_engine.h"
+
+class QShowEvent;
 
 class TabWidgetBase : public QWidget
 {
@@ -16,7 +18,7 @@ public:
                            bool hasGeekMode,
                            const QString& geekCommand,
                            QWidget* parent = nullptr);
-    virtual ~TabWidgetBase() = default;
+    virtual ~TabWidgetBase();
 
     QString getTabName() const { return m_tabName; }
     void refreshData();
@@ -27,17 +29,35 @@ signals:
 
 protected:
     virtual QWidget* createUserFriendlyView() = 0;
-    virtual void parseOutput(const QString& output) = 0;
+    // The whole output of m_command (or the lshw listing). The default
+    // feeds it through the streaming interface below.
+    virtual void parseOutput(const QString& output);
+
+    // Incremental parsing. A tab whose streamsOutput() returns true gets
+    // m_command's output while the command runs: beginStream(), then
+    // parseLines() with each batch of complete lines as it arrives, then
+    // endStream(). Sections can be filled in as soon as their lines are in,
+    // and only the current chunk is held in memory.
+    virtual bool streamsOutput() const { return false; }
+    virtual void beginStream() {}
+    virtual void parseLines(const QStringList& lines) { Q_UNUSED(lines); }
+    virtual void endStream() {}
 
     void initializeTab();
     void executeCommand();
+    // Serve this tab from the shared lshw tree instead of running m_command.
+    // parseOutput() then receives the `lshw -short` listing, restricted to
+    // className when one is given. Call before initializeTab().
+    void useLshwProbe(const QString& className = QString());
+    // Output of m_command rarely changes between runs: paint from the
+    // snapshot cache first and revalidate in the background.
+    void setCacheable(bool cacheable) { m_cacheable = cacheable; }
 
     // Members for derived classes
     QString m_tabName;
     QString m_command;
     bool m_showHeader;
     QString m_headerText;
-    QString m_lastOutput;
 
     // Geek mode members
     bool m_hasGeekMode;
@@ -50,14 +70,35 @@ protected:
     QWidget* m_loadingWidget;
     QLabel* m_loadingLabel;
 
-    QProcess* m_process;
+    quint64 m_commandTicket;
     bool m_isLoading;
 
-private slots:
-    void onProcessFinished(int exitCode, QProcess::ExitStatus exitStatus);
-    void onProcessError(QProcess::ProcessError error);
+    bool m_cacheable;
+
+    // Hash of the output on screen, to skip repainting identical output
+    quint64 m_outputHash;
+    bool m_hasOutput;
+
+    // Streaming state (see streamsOutput())
+    bool m_streaming;
+    bool m_streamStarted;
+    QByteArray m_partialLine;
+    QByteArray m_cacheOutput;   // whole output for the snapshot cache
+
+    // Shared lshw tree source (see useLshwProbe)
+    bool m_useLshwProbe;
+    QString m_lshwClass;
+    int m_lshwGeneration;
+
+    void showEvent(QShowEvent* event) override;
 
 private:
+    void onCommandOutput(const QByteArray& chunk);
+    void onCommandFinished(const CollectorResult& result);
+    void feedLines(const QByteArray& bytes);
+    void renderOutput(const QByteArray& output, const QString& source);
+    void onLshwReady();
+
     void setupUI();
     void showLoadingMessage();
     void hideLoadingMessage();
@@ -0,0 +1,330 @@
+#include "timeseries_store.h"
+#include "sampler.h"
+#include "log_helper.h"
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QMutexLocker>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+constexpr double NoValue = std::numeric_limits<double>::quiet_NaN();
+constexpr qint64 TenSecondsMs = 10 * 1000;
+constexpr qint64 OneMinuteMs = 60 * 1000;
+
+} // namespace
+
+TimeSeriesStore* TimeSeriesStore::instance()
+{
+    static TimeSeriesStore* store = new TimeSeriesStore(QCoreApplication::instance());
+    return store;
+}
+
+TimeSeriesStore::TimeSeriesStore(QObject* parent)
+    : QObject(parent)
+{
+    configure(Config());
+}
+
+void TimeSeriesStore::Ring::allocate(int points, qint64 bucket, bool rollup)
+{
+    bucketMs = bucket;
+    capacity = qMax(1, points);
+    head = 0;
+    count = 0;
+    const size_t cells = size_t(MetricCount) * size_t(capacity);
+    time.assign(size_t(capacity), 0);
+    avg.assign(cells, NoValue);
+    // Raw points are single values; min/max would only duplicate avg.
+    min.assign(rollup ? cells : 0, NoValue);
+    max.assign(rollup ? cells : 0, NoValue);
+    samples.assign(rollup ? cells : 0, 0);
+    resetAccumulator();
+    openBucket = -1;
+}
+
+void TimeSeriesStore::Ring::resetAccumulator()
+{
+    for (int m = 0; m < MetricCount; ++m) {
+        accMin[m] = std::numeric_limits<double>::infinity();
+        accMax[m] = -std::numeric_limits<double>::infinity();
+        accSum[m] = 0;
+        accCount[m] = 0;
+    }
+}
+
+void TimeSeriesStore::Ring::push(qint64 timestampMs, const double* mins, const double* maxs, const double* avgs,
+                                 const int* counts)
+{
+    time[size_t(head)] = timestampMs;
+    for (int m = 0; m < MetricCount; ++m) {
+        const size_t cell = size_t(m) * size_t(capacity) + size_t(head);
+        avg[cell] = avgs[m];
+        if (!min.empty()) {
+            min[cell] = mins[m];
+            max[cell] = maxs[m];
+            samples[cell] = quint16(qMin(counts ? counts[m] : 1, 0xffff));
+        }
+    }
+    head = (head + 1) % capacity;
+    if (count < capacity) ++count;
+}
+
+void TimeSeriesStore::configure(const Config& config)
+{
+    QMutexLocker lock(&m_mutex);
+    m_config = config;
+    m_firstRecordMs = 0;
+    m_lastRecordMs = 0;
+    m_rings[Raw].allocate(config.rawPoints, 0, false);
+    m_rings[TenSeconds].allocate(config.tenSecondPoints, TenSecondsMs, true);
+    m_rings[OneMinute].allocate(config.oneMinutePoints, OneMinuteMs, true);
+}
+
+TimeSeriesStore::Config TimeSeriesStore::config() const
+{
+    QMutexLocker lock(&m_mutex);
+    return m_config;
+}
+
+qint64 TimeSeriesStore::memoryBytes() const
+{
+    QMutexLocker lock(&m_mutex);
+    qint64 bytes = 0;
+    for (const Ring& r : m_rings) {
+        bytes += qint64(r.time.capacity() * sizeof(qint64));
+        bytes += qint64((r.min.capacity() + r.max.capacity() + r.avg.capacity()) * sizeof(double));
+        bytes += qint64(r.samples.capacity() * sizeof(quint16));
+    }
+    return bytes;
+}
+
+qint64 TimeSeriesStore::recordedSpanMs() const
+{
+    QMutexLocker lock(&m_mutex);
+    return m_lastRecordMs - m_firstRecordMs;
+}
+
+void TimeSeriesStore::startRecording()
+{
+    // LSV_HISTORY_HOURS sizes the 1 min roll-up (the longest history kept).
+    bool ok = false;
+    const int hours = qEnvironmentVariableIntValue("LSV_HISTORY_HOURS", &ok);
+    if (ok && hours > 0) {
+        Config c = config();
+        c.oneMinutePoints = qMin(hours, 24 * 7) * 60;
+        configure(c);
+    }
+
+    Sampler::instance()->setHistoryStore(this);
+    // History is kept whether or not a tab showing these values is visible.
+    Sampler::instance()->subscribe(this, Sampler::Cpu | Sampler::Memory | Sampler::CpuFreq, Sampler::Background);
+    appendLog(QString("TimeSeriesStore: recording, %1 KiB reserved").arg(memoryBytes() / 1024));
+}
+
+void TimeSeriesStore::record(const Sample& sample)
+{
+    double values[MetricCount];
+    for (double& v : values) v = NoValue;
+
+    if (sample.channels & Sampler::Memory) {
+        values[RamUsedBytes] = double(sample.memTotal - qMin(sample.memFree, sample.memTotal));
+        values[RamFreeBytes] = double(sample.memFree);
+        values[RamAvailableBytes] = double(sample.memAvailable);
+        values[SwapUsedBytes] = double(sample.swapTotal - qMin(sample.swapFree, sample.swapTotal));
+        values[SwapFreeBytes] = double(sample.swapFree);
+    }
+    if (sample.channels & Sampler::Cpu) {
+        values[CpuBusyPercent] = sample.cpuBusyPercent;
+    }
+    if (sample.channels & Sampler::CpuFreq) {
+        double sum = 0;
+        int n = 0;
+        for (qint64 kHz : sample.curFreqKHz) {
+            if (kHz > 0) {
+                sum += double(kHz);
+                ++n;
+            }
+        }
+        if (sample.curFreqKHz.value(0) > 0) values[CpuFreqKHz] = double(sample.curFreqKHz[0]);
+        if (n > 0) values[CpuFreqAvgKHz] = sum / n;
+    }
+
+    QMutexLocker lock(&m_mutex);
+    if (m_firstRecordMs == 0) m_firstRecordMs = sample.timestampMs;
+    m_lastRecordMs = sample.timestampMs;
+    m_rings[Raw].push(sample.timestampMs, values, values, values);
+    accumulate(m_rings[TenSeconds], sample.timestampMs, values);
+    accumulate(m_rings[OneMinute], sample.timestampMs, values);
+}
+
+void TimeSeriesStore::accumulate(Ring& ring, qint64 timestampMs, const double* values)
+{
+    const qint64 bucket = timestampMs - timestampMs % ring.bucketMs;
+    if (ring.openBucket != bucket) {
+        // A gap (suspend, no subscribers) just leaves no bucket behind.
+        if (ring.openBucket >= 0) flushBucket(ring);
+        ring.openBucket = bucket;
+    }
+    for (int m = 0; m < MetricCount; ++m) {
+        const double v = values[m];
+        if (std::isnan(v)) continue;
+        ring.accMin[m] = qMin(ring.accMin[m], v);
+        ring.accMax[m] = qMax(ring.accMax[m], v);
+        ring.accSum[m] += v;
+        ++ring.accCount[m];
+    }
+}
+
+void TimeSeriesStore::flushBucket(Ring& ring)
+{
+    double mins[MetricCount], maxs[MetricCount], avgs[MetricCount];
+    for (int m = 0; m < MetricCount; ++m) {
+        if (ring.accCount[m] == 0) {
+            mins[m] = maxs[m] = avgs[m] = NoValue;
+        } else {
+            mins[m] = ring.accMin[m];
+            maxs[m] = ring.accMax[m];
+            avgs[m] = ring.accSum[m] / ring.accCount[m];
+        }
+    }
+    ring.push(ring.openBucket, mins, maxs, avgs, ring.accCount);
+    ring.resetAccumulator();
+}
+
+TimeSeriesStore::Dump TimeSeriesStore::dump() const
+{
+    QMutexLocker lock(&m_mutex);
+    Dump out;
+    out.firstRecordMs = m_firstRecordMs;
+    out.lastRecordMs = m_lastRecordMs;
+    for (int res = 0; res < ResolutionCount; ++res) {
+        const Ring& r = m_rings[res];
+        Dump::Series& series = out.series[res];
+        series.bucketMs = r.bucketMs;
+        series.time.resize(r.count);
+        series.avg.resize(MetricCount * r.count);
+        if (!r.min.empty()) {
+            series.min.resize(MetricCount * r.count);
+            series.max.resize(MetricCount * r.count);
+            series.samples.resize(MetricCount * r.count);
+        }
+        if (r.count == 0) continue;
+        const int first = (r.head - r.count + r.capacity) % r.capacity;
+        for (int i = 0; i < r.count; ++i) {
+            const size_t slot = size_t((first + i) % r.capacity);
+            series.time[i] = r.time[slot];
+            for (int m = 0; m < MetricCount; ++m) {
+                const size_t cell = size_t(m) * size_t(r.capacity) + slot;
+                series.avg[m * r.count + i] = r.avg[cell];
+                if (!r.min.empty()) {
+                    series.min[m * r.count + i] = r.min[cell];
+                    series.max[m * r.count + i] = r.max[cell];
+                    series.samples[m * r.count + i] = r.samples[cell];
+                }
+            }
+        }
+    }
+    return out;
+}
+
+void TimeSeriesStore::restore(const Dump& dump)
+{
+    QMutexLocker lock(&m_mutex);
+    for (int res = 0; res < ResolutionCount; ++res) {
+        Ring& r = m_rings[res];
+        const Dump::Series& series = dump.series[res];
+        const int points = series.time.size();
+        const bool rollup = !r.min.empty();
+        if (series.bucketMs != r.bucketMs || series.avg.size() != MetricCount * points
+            || (rollup && (series.min.size() != series.avg.size() || series.max.size() != series.avg.size()
+                           || series.samples.size() != series.avg.size()))) {
+            continue; // not a dump of this layout; keep what we have
+        }
+        r.allocate(r.capacity, r.bucketMs, rollup);
+        double mins[MetricCount], maxs[MetricCount], avgs[MetricCount];
+        int counts[MetricCount];
+        for (int i = qMax(0, points - r.capacity); i < points; ++i) {
+            for (int m = 0; m < MetricCount; ++m) {
+                avgs[m] = series.avg[m * points + i];
+                mins[m] = rollup ? series.min[m * points + i] : avgs[m];
+                maxs[m] = rollup ? series.max[m * points + i] : avgs[m];
+                counts[m] = rollup ? series.samples[m * points + i] : 1;
+            }
+            r.push(series.time[i], mins, maxs, avgs, counts);
+        }
+    }
+    m_firstRecordMs = dump.firstRecordMs;
+    m_lastRecordMs = dump.lastRecordMs;
+}
+
+QVector<SeriesPoint> TimeSeriesStore::query(Metric metric, Resolution resolution, qint64 sinceMs) const
+{
+    QVector<SeriesPoint> points;
+    if (metric < 0 || metric >= MetricCount || resolution < 0 || resolution >= ResolutionCount) return points;
+
+    QMutexLocker lock(&m_mutex);
+    const Ring& r = ring(resolution);
+    points.reserve(r.count + 1);
+    const int first = (r.head - r.count + r.capacity) % r.capacity;
+    const size_t base = size_t(metric) * size_t(r.capacity);
+    // A bucket that starts before sinceMs but ends after it still overlaps
+    // the window; raw points have no extent.
+    const qint64 earliest = r.bucketMs > 0 ? sinceMs - r.bucketMs + 1 : sinceMs;
+    for (int i = 0; i < r.count; ++i) {
+        const int slot = (first + i) % r.capacity;
+        if (r.time[size_t(slot)] < earliest) continue;
+        const double a = r.avg[base + size_t(slot)];
+        if (std::isnan(a)) continue;
+        SeriesPoint p;
+        p.timestampMs = r.time[size_t(slot)];
+        p.avg = a;
+        p.min = r.min.empty() ? a : r.min[base + size_t(slot)];
+        p.max = r.max.empty() ? a : r.max[base + size_t(slot)];
+        p.samples = r.samples.empty() ? 1 : r.samples[base + size_t(slot)];
+        points.append(p);
+    }
+    // Include the bucket still being filled so roll-ups reach "now".
+    if (r.bucketMs > 0 && r.openBucket >= earliest && r.accCount[metric] > 0) {
+        SeriesPoint p;
+        p.timestampMs = r.openBucket;
+        p.min = r.accMin[metric];
+        p.max = r.accMax[metric];
+        p.avg = r.accSum[metric] / r.accCount[metric];
+        p.samples = r.accCount[metric];
+        points.append(p);
+    }
+    return points;
+}
+
+SeriesSummary TimeSeriesStore::summarize(Metric metric, qint64 windowMs) const
+{
+    const qint64 since = QDateTime::currentMSecsSinceEpoch() - windowMs;
+
+    // Pick the finest ring whose span covers the window.
+    Resolution resolution = OneMinute;
+    {
+        QMutexLocker lock(&m_mutex);
+        // The sampler's interval changes with what is on screen, so the raw
+        // ring's span is read from its oldest point rather than computed.
+        const Ring& raw = m_rings[Raw];
+        const bool rawCovers = raw.capacity > 0
+            && (raw.count < raw.capacity || raw.time[size_t(raw.head)] <= since);
+        if (rawCovers) resolution = Raw;
+        else if (windowMs <= qint64(m_rings[TenSeconds].capacity) * TenSecondsMs) resolution = TenSeconds;
+    }
+
+    SeriesSummary summary;
+    double sum = 0;
+    qint64 samples = 0;
+    for (const SeriesPoint& p : query(metric, resolution, since)) {
+        summary.min = summary.points == 0 ? p.min : qMin(summary.min, p.min);
+        summary.max = summary.points == 0 ? p.max : qMax(summary.max, p.max);
+        sum += p.avg * p.samples;
+        samples += p.samples;
+        ++summary.points;
+    }
+    if (samples > 0) summary.avg = sum / double(samples);
+    return summary;
+}
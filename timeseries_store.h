@@ -0,0 +1,153 @@
+#ifndef TIMESERIES_STORE_H
+#define TIMESERIES_STORE_H
+
+#include <QObject>
+#include <QVector>
+#include <QMutex>
+#include <vector>
+
+struct Sample;
+
+// One point of a series. Raw points have min == max == avg.
+struct SeriesPoint {
+    qint64 timestampMs = 0;     // start of the bucket, ms since epoch
+    double min = 0;
+    double max = 0;
+    double avg = 0;
+    int samples = 1;            // ticks averaged into the point
+};
+
+// Aggregate over a time window.
+struct SeriesSummary {
+    int points = 0;             // 0: no data in the window
+    double min = 0;
+    double max = 0;
+    double avg = 0;
+};
+
+// Fixed-size, in-memory history of the values the sampler produces, so the
+// UI can show what happened before the current second.
+//
+// Three ring buffers are kept per metric: raw 1 s values for a short window,
+// and min/max/avg roll-ups over 10 s and 1 min buckets for hours. Storage is
+// columnar (one contiguous array per metric and field) and allocated once in
+// configure(); record() only writes into those arrays. Appends happen on the
+// sampler thread, queries on the GUI thread, under one short mutex.
+class TimeSeriesStore : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Metric {
+        RamUsedBytes,
+        RamFreeBytes,
+        RamAvailableBytes,
+        SwapUsedBytes,
+        SwapFreeBytes,
+        CpuBusyPercent,
+        CpuFreqKHz,             // cpu0, the value shown on the CPU tab
+        CpuFreqAvgKHz,          // mean over all cpus with cpufreq
+        MetricCount
+    };
+
+    enum Resolution {
+        Raw,                    // one point per sampler tick
+        TenSeconds,
+        OneMinute,
+        ResolutionCount
+    };
+
+    // Number of points kept per resolution. The defaults keep 10 minutes of
+    // raw data, 2 hours at 10 s and 24 hours at 1 min in under 0.5 MB.
+    struct Config {
+        int rawPoints = 600;
+        int tenSecondPoints = 720;
+        int oneMinutePoints = 1440;
+    };
+
+    static TimeSeriesStore* instance();
+
+    // Reallocate for a new size; clears the history.
+    void configure(const Config& config);
+    Config config() const;
+    // Bytes held by the ring buffers.
+    qint64 memoryBytes() const;
+    // Time between the first and the latest recorded tick.
+    qint64 recordedSpanMs() const;
+
+    // Subscribe to the sampler and record its ticks from now on.
+    void startRecording();
+
+    // Called by the sampler thread for every tick; does not allocate.
+    void record(const Sample& sample);
+
+    // Every ring, oldest point first, for handing the history to another
+    // process (lsv-agentd to its clients). Values are metric-major,
+    // [MetricCount * points]; raw series have no min/max/samples. Buckets
+    // still being filled are not included.
+    struct Dump {
+        struct Series {
+            qint64 bucketMs = 0;
+            QVector<qint64> time;
+            QVector<double> min;
+            QVector<double> max;
+            QVector<double> avg;
+            QVector<int> samples;
+        };
+        qint64 firstRecordMs = 0;
+        qint64 lastRecordMs = 0;
+        Series series[ResolutionCount];
+    };
+    Dump dump() const;
+    // Replace the history with a dump. Ring sizes stay as configured; the
+    // newest points that fit are kept.
+    void restore(const Dump& dump);
+
+    // Points of one series whose bucket reaches past sinceMs, oldest first.
+    QVector<SeriesPoint> query(Metric metric, Resolution resolution, qint64 sinceMs) const;
+    // Summary over the last windowMs, from the finest resolution that
+    // still covers the whole window. The average is weighted by the ticks
+    // behind each point.
+    SeriesSummary summarize(Metric metric, qint64 windowMs) const;
+
+private:
+    explicit TimeSeriesStore(QObject* parent = nullptr);
+
+    // Ring of min/max/avg buckets. Raw data uses the same layout with a
+    // bucket of one tick; only the avg column is kept for it.
+    struct Ring {
+        qint64 bucketMs = 0;            // 0: one point per record() call
+        int capacity = 0;
+        int head = 0;                   // next slot to write
+        int count = 0;
+        std::vector<qint64> time;       // [capacity]
+        std::vector<double> min;        // [MetricCount * capacity], metric-major
+        std::vector<double> max;
+        std::vector<double> avg;
+        std::vector<quint16> samples;   // ticks per bucket, roll-ups only
+
+        // Bucket being accumulated (roll-ups only)
+        qint64 openBucket = -1;
+        double accMin[MetricCount];
+        double accMax[MetricCount];
+        double accSum[MetricCount];
+        int accCount[MetricCount];
+
+        void allocate(int points, qint64 bucket, bool rollup);
+        void resetAccumulator();
+        void push(qint64 timestampMs, const double* mins, const double* maxs, const double* avgs,
+                  const int* counts = nullptr);
+    };
+
+    void accumulate(Ring& ring, qint64 timestampMs, const double* values);
+    static void flushBucket(Ring& ring);
+    const Ring& ring(Resolution resolution) const { return m_rings[resolution]; }
+
+    mutable QMutex m_mutex;
+    Config m_config;
+    qint64 m_firstRecordMs = 0;
+    qint64 m_lastRecordMs = 0;
+    Ring m_rings[ResolutionCount];
+};
+
+#endif // TIMESERIES_STORE_H
@@ -0,0 +1,189 @@
+#include "trace.h"
+#include "log_helper.h"
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QJsonDocument>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+#include <QVector>
+#include <cstdio>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+std::atomic<bool> Trace::s_enabled{false};
+
+namespace {
+
+// Upper bound on buffered events (a few hundred MB of JSON at most); a
+// session left running for days keeps its first events.
+constexpr int MaxEvents = 2000000;
+
+struct TraceEvent {
+    char phase;
+    const char* category;
+    QString name;
+    qint64 timeNs;
+    qint64 durationNs;
+    quint64 id;
+    int tid;
+    QJsonObject args;
+};
+
+struct TraceState {
+    QMutex mutex;
+    QElapsedTimer clock;
+    QString path;
+    QVector<TraceEvent> events;
+    QHash<int, QString> threadNames;
+    qint64 dropped = 0;
+};
+
+TraceState& state()
+{
+    static TraceState s;
+    return s;
+}
+
+int currentTid()
+{
+    static thread_local int tid = int(::syscall(SYS_gettid));
+    return tid;
+}
+
+QString currentThreadName()
+{
+    QThread* thread = QThread::currentThread();
+    if (QCoreApplication::instance() && thread == QCoreApplication::instance()->thread()) return QStringLiteral("GUI");
+    if (!thread->objectName().isEmpty()) return thread->objectName();
+    return QString::fromLatin1(thread->metaObject()->className());
+}
+
+QString defaultPath()
+{
+    return QDir(QDir::tempPath()).filePath(
+        QString("lsv-trace-%1.json").arg(QDateTime::currentDateTime().toString("yyyyMMdd-hhmmss")));
+}
+
+} // namespace
+
+QString Trace::requestedPath(const QStringList& arguments)
+{
+    for (const QString& arg : arguments) {
+        if (arg == "--trace") return defaultPath();
+        if (arg.startsWith("--trace=")) return QFileInfo(arg.mid(8)).absoluteFilePath();
+    }
+    const QString env = qEnvironmentVariable("LSV_TRACE");
+    if (env.isEmpty() || env == "0" || env == "false") return QString();
+    if (env == "1" || env == "true") return defaultPath();
+    return QFileInfo(env).absoluteFilePath();
+}
+
+void Trace::start(const QString& path)
+{
+    TraceState& s = state();
+    {
+        QMutexLocker lock(&s.mutex);
+        if (s_enabled.load()) return;
+        s.path = path;
+        s.events.reserve(16384);
+        s.clock.start();
+    }
+    s_enabled.store(true);
+    QObject::connect(QCoreApplication::instance(), &QCoreApplication::aboutToQuit, [] { Trace::stop(); });
+    appendLog(QString("Trace: recording to %1").arg(path));
+    std::fprintf(stderr, "LSV: recording trace to %s\n", qPrintable(path));
+}
+
+qint64 Trace::nowNs()
+{
+    return state().clock.nsecsElapsed();
+}
+
+void Trace::complete(const char* category, const QString& name, qint64 startNs, qint64 endNs, const QJsonObject& args)
+{
+    record('X', category, name, startNs, endNs - startNs, 0, args);
+}
+
+void Trace::asyncBegin(const char* category, const QString& name, quint64 id, const QJsonObject& args)
+{
+    record('b', category, name, nowNs(), 0, id, args);
+}
+
+void Trace::asyncEnd(const char* category, const QString& name, quint64 id, const QJsonObject& args)
+{
+    record('e', category, name, nowNs(), 0, id, args);
+}
+
+void Trace::record(char phase, const char* category, const QString& name, qint64 timeNs,
+                   qint64 durationNs, quint64 id, const QJsonObject& args)
+{
+    if (!isEnabled()) return;
+    const int tid = currentTid();
+    static thread_local bool named = false;
+    const QString threadName = named ? QString() : currentThreadName();
+
+    TraceState& s = state();
+    QMutexLocker lock(&s.mutex);
+    if (!named) {
+        s.threadNames.insert(tid, threadName);
+        named = true;
+    }
+    if (s.events.size() >= MaxEvents) {
+        ++s.dropped;
+        return;
+    }
+    s.events.append(TraceEvent{phase, category, name, timeNs, durationNs, id, tid, args});
+}
+
+void Trace::stop()
+{
+    if (!s_enabled.exchange(false)) return;
+
+    TraceState& s = state();
+    QMutexLocker lock(&s.mutex);
+    QFile file(s.path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        appendLog(QString("Trace: cannot write %1").arg(s.path));
+        std::fprintf(stderr, "LSV: cannot write trace %s\n", qPrintable(s.path));
+        return;
+    }
+
+    const qint64 pid = QCoreApplication::applicationPid();
+    auto writeEvent = [&file](const QJsonObject& event, bool first) {
+        if (!first) file.write(",\n");
+        file.write(QJsonDocument(event).toJson(QJsonDocument::Compact));
+    };
+
+    file.write("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    writeEvent(QJsonObject{{"ph", "M"}, {"name", "process_name"}, {"pid", pid}, {"tid", 0},
+                           {"args", QJsonObject{{"name", "LSV"}}}}, true);
+    for (auto it = s.threadNames.cbegin(); it != s.threadNames.cend(); ++it) {
+        writeEvent(QJsonObject{{"ph", "M"}, {"name", "thread_name"}, {"pid", pid}, {"tid", it.key()},
+                               {"args", QJsonObject{{"name", it.value()}}}}, false);
+    }
+    for (const TraceEvent& e : s.events) {
+        QJsonObject event{{"ph", QString(QChar::fromLatin1(e.phase))},
+                          {"cat", QString::fromLatin1(e.category)},
+                          {"name", e.name},
+                          {"ts", double(e.timeNs) / 1000.0},   // microseconds
+                          {"pid", pid},
+                          {"tid", e.tid}};
+        if (e.phase == 'X') event.insert("dur", double(e.durationNs) / 1000.0);
+        if (e.phase == 'b' || e.phase == 'e') event.insert("id", QString("0x%1").arg(e.id, 0, 16));
+        if (!e.args.isEmpty()) event.insert("args", e.args);
+        writeEvent(event, false);
+    }
+    file.write("\n]}\n");
+    file.close();
+
+    appendLog(QString("Trace: wrote %1 events to %2 (%3 dropped)").arg(s.events.size()).arg(s.path).arg(s.dropped));
+    std::fprintf(stderr, "LSV: wrote %lld trace events to %s\n", static_cast<long long>(s.events.size()), qPrintable(s.path));
+    s.events.clear();
+    s.events.squeeze();
+}
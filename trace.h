@@ -0,0 +1,80 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <QString>
+#include <QStringList>
+#include <QJsonObject>
+#include <atomic>
+
+// Optional recording of where the time goes: command runs, parsing, table
+// fills, tab creation and sampler ticks. Events are kept in memory and
+// written on exit as Chrome trace-event JSON, which Perfetto
+// (ui.perfetto.dev) and chrome://tracing open directly.
+//
+// Enabled with LSV_TRACE=1 (or LSV_TRACE=<file>) or --trace[=<file>]. When
+// off, a span costs one relaxed atomic load.
+class Trace
+{
+public:
+    // Output file asked for by LSV_TRACE or --trace, or an empty string.
+    // "1"/"true" and a bare --trace pick a file in the temp directory.
+    static QString requestedPath(const QStringList& arguments);
+
+    // Start recording; the file is written when the application quits.
+    // Needs a QCoreApplication.
+    static void start(const QString& path);
+    static void stop();
+
+    static bool isEnabled() { return s_enabled.load(std::memory_order_relaxed); }
+
+    // Nanoseconds since start(), on a monotonic clock.
+    static qint64 nowNs();
+
+    // A finished span ("X" event).
+    static void complete(const char* category, const QString& name, qint64 startNs, qint64 endNs,
+                         const QJsonObject& args = QJsonObject());
+    // Spans that start and end in different call stacks, e.g. a command
+    // queued by a tab and delivered later ("b"/"e" events, matched by id).
+    static void asyncBegin(const char* category, const QString& name, quint64 id,
+                           const QJsonObject& args = QJsonObject());
+    static void asyncEnd(const char* category, const QString& name, quint64 id,
+                         const QJsonObject& args = QJsonObject());
+
+private:
+    static void record(char phase, const char* category, const QString& name, qint64 timeNs,
+                       qint64 durationNs, quint64 id, const QJsonObject& args);
+
+    static std::atomic<bool> s_enabled;
+};
+
+// Records the lifetime of the enclosing scope as one span:
+//
+//     TraceSpan span("tab", "parseOutput");
+//     span.addArg("tab", m_tabName);
+class TraceSpan
+{
+public:
+    TraceSpan(const char* category, const char* name)
+        : m_category(category), m_name(name), m_startNs(Trace::isEnabled() ? Trace::nowNs() : -1) {}
+
+    ~TraceSpan()
+    {
+        if (m_startNs >= 0) {
+            Trace::complete(m_category, QString::fromLatin1(m_name), m_startNs, Trace::nowNs(), m_args);
+        }
+    }
+
+    void addArg(const char* key, const QString& value) { if (m_startNs >= 0) m_args.insert(QLatin1String(key), value); }
+    void addArg(const char* key, qint64 value) { if (m_startNs >= 0) m_args.insert(QLatin1String(key), value); }
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+private:
+    const char* m_category;
+    const char* m_name;
+    qint64 m_startNs;
+    QJsonObject m_args;
+};
+
+#endif // TRACE_H
@@ -0,0 +1,142 @@
+#include "usage_bar.h"
+#include <QPainter>
+#include <QPainterPath>
+
+namespace {
+constexpr int Spacing = 4;
+const QColor TitleColor(0x2c, 0x3e, 0x50);     // #2c3e50
+const QColor DetailColor(0x7f, 0x8c, 0x8d);    // #7f8c8d
+}
+
+UsageBar::UsageBar(QWidget* parent)
+    : QWidget(parent)
+{
+    setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Fixed);
+}
+
+void UsageBar::setValue(double percent)
+{
+    percent = qBound(0.0, percent, 100.0);
+    if (percent == m_value) return;
+    m_value = percent;
+    update();
+}
+
+void UsageBar::setBarHeight(int pixels)
+{
+    m_barHeight = qMax(2, pixels);
+    updateGeometry();
+    update();
+}
+
+void UsageBar::setTitle(const QString& title, bool showPercent)
+{
+    const bool resized = m_title.isEmpty() != title.isEmpty();
+    m_title = title;
+    m_showPercent = showPercent;
+    if (resized) updateGeometry();
+    update();
+}
+
+void UsageBar::setDetails(const QStringList& left, const QStringList& right)
+{
+    const bool resized = qMax(left.size(), right.size()) != qMax(m_detailsLeft.size(), m_detailsRight.size());
+    m_detailsLeft = left;
+    m_detailsRight = right;
+    if (resized) updateGeometry();
+    update();
+}
+
+QColor UsageBar::levelColor() const
+{
+    if (m_value < m_warningAt) return m_normalColor;
+    if (m_value < m_criticalAt) return m_warningColor;
+    return m_criticalColor;
+}
+
+QFont UsageBar::detailFont() const
+{
+    QFont small = font();
+    if (small.pointSize() > 1) small.setPointSize(small.pointSize() - 1);
+    return small;
+}
+
+int UsageBar::headerHeight() const
+{
+    if (m_title.isEmpty()) return 0;
+    QFont bold = font();
+    bold.setBold(true);
+    return QFontMetrics(bold).height() + Spacing;
+}
+
+int UsageBar::detailLineHeight() const
+{
+    return QFontMetrics(detailFont()).height();
+}
+
+QSize UsageBar::sizeHint() const
+{
+    const int lines = qMax(m_detailsLeft.size(), m_detailsRight.size());
+    const QMargins margins = contentsMargins();
+    int height = headerHeight() + m_barHeight + margins.top() + margins.bottom();
+    if (lines > 0) height += Spacing + lines * detailLineHeight();
+    return QSize(200, height);
+}
+
+QSize UsageBar::minimumSizeHint() const
+{
+    return QSize(40, sizeHint().height());
+}
+
+void UsageBar::paintEvent(QPaintEvent*)
+{
+    QPainter painter(this);
+    painter.setRenderHint(QPainter::Antialiasing);
+    const QRect area = contentsRect();
+    int y = area.top();
+
+    if (!m_title.isEmpty()) {
+        QFont bold = font();
+        bold.setBold(true);
+        painter.setFont(bold);
+        const QRect line(area.left(), y, area.width(), QFontMetrics(bold).height());
+        painter.setPen(TitleColor);
+        painter.drawText(line, Qt::AlignLeft | Qt::AlignVCenter, m_title);
+        if (m_showPercent) {
+            painter.setPen(levelColor().darker(115));
+            painter.drawText(line, Qt::AlignRight | Qt::AlignVCenter, QString("%1%").arg(m_value, 0, 'f', 1));
+        }
+        y += headerHeight();
+    }
+
+    // Track, then the filled part clipped to the rounded track.
+    const QRectF bar(area.left() + 0.5, y + 0.5, area.width() - 1.0, m_barHeight - 1.0);
+    const qreal radius = bar.height() / 2.0;
+    QPainterPath track;
+    track.addRoundedRect(bar, radius, radius);
+    painter.setPen(Qt::NoPen);
+    painter.fillPath(track, m_trackColor);
+    if (m_value > 0) {
+        painter.save();
+        painter.setClipPath(track);
+        painter.fillRect(QRectF(bar.left(), bar.top(), bar.width() * m_value / 100.0, bar.height()), levelColor());
+        painter.restore();
+    }
+    painter.setPen(QPen(m_borderColor, 1.0));
+    painter.setBrush(Qt::NoBrush);
+    painter.drawPath(track);
+    y += m_barHeight;
+
+    const int lines = qMax(m_detailsLeft.size(), m_detailsRight.size());
+    if (lines > 0) {
+        y += Spacing;
+        painter.setFont(detailFont());
+        painter.setPen(DetailColor);
+        const int lineHeight = detailLineHeight();
+        for (int i = 0; i < lines; ++i, y += lineHeight) {
+            const QRect line(area.left(), y, area.width(), lineHeight);
+            painter.drawText(line, Qt::AlignLeft | Qt::AlignVCenter, m_detailsLeft.value(i));
+            painter.drawText(line, Qt::AlignRight | Qt::AlignVCenter, m_detailsRight.value(i));
+        }
+    }
+}
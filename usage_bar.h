@@ -0,0 +1,91 @@
+#ifndef USAGE_BAR_H
+#define USAGE_BAR_H
+
+#include <QColor>
+#include <QString>
+#include <QStringList>
+#include <QWidget>
+
+// A usage level (0..100 %) painted as a rounded bar, optionally with a
+// bold title and the percentage above it and pairs of grey detail lines
+// (left / right aligned) below it.
+//
+// The fill colour follows the level: normalColor below warningAt,
+// warningColor below criticalAt, criticalColor from there on. Thresholds
+// and colours are plain properties, so a new value is one update() of
+// this widget: no style sheet is parsed and nothing is re-polished.
+class UsageBar : public QWidget
+{
+    Q_OBJECT
+    Q_PROPERTY(double value READ value WRITE setValue)
+    Q_PROPERTY(double warningAt READ warningAt WRITE setWarningAt)
+    Q_PROPERTY(double criticalAt READ criticalAt WRITE setCriticalAt)
+    Q_PROPERTY(QColor normalColor READ normalColor WRITE setNormalColor)
+    Q_PROPERTY(QColor warningColor READ warningColor WRITE setWarningColor)
+    Q_PROPERTY(QColor criticalColor READ criticalColor WRITE setCriticalColor)
+    Q_PROPERTY(QColor trackColor READ trackColor WRITE setTrackColor)
+    Q_PROPERTY(QColor borderColor READ borderColor WRITE setBorderColor)
+    Q_PROPERTY(int barHeight READ barHeight WRITE setBarHeight)
+
+public:
+    explicit UsageBar(QWidget* parent = nullptr);
+
+    double value() const { return m_value; }
+    void setValue(double percent);
+
+    double warningAt() const { return m_warningAt; }
+    void setWarningAt(double percent) { m_warningAt = percent; update(); }
+    double criticalAt() const { return m_criticalAt; }
+    void setCriticalAt(double percent) { m_criticalAt = percent; update(); }
+
+    QColor normalColor() const { return m_normalColor; }
+    void setNormalColor(const QColor& color) { m_normalColor = color; update(); }
+    QColor warningColor() const { return m_warningColor; }
+    void setWarningColor(const QColor& color) { m_warningColor = color; update(); }
+    QColor criticalColor() const { return m_criticalColor; }
+    void setCriticalColor(const QColor& color) { m_criticalColor = color; update(); }
+    QColor trackColor() const { return m_trackColor; }
+    void setTrackColor(const QColor& color) { m_trackColor = color; update(); }
+    QColor borderColor() const { return m_borderColor; }
+    void setBorderColor(const QColor& color) { m_borderColor = color; update(); }
+
+    int barHeight() const { return m_barHeight; }
+    void setBarHeight(int pixels);
+
+    // Title on the left above the bar; the percentage is shown on the
+    // right when showPercent is set.
+    void setTitle(const QString& title, bool showPercent = true);
+    // Detail lines below the bar: left[i] and right[i] share line i.
+    void setDetails(const QStringList& left, const QStringList& right);
+
+    // Colour for the current value.
+    QColor levelColor() const;
+
+    QSize sizeHint() const override;
+    QSize minimumSizeHint() const override;
+
+protected:
+    void paintEvent(QPaintEvent* event) override;
+
+private:
+    int headerHeight() const;
+    int detailLineHeight() const;
+    QFont detailFont() const;
+
+    double m_value = 0;
+    double m_warningAt = 75;
+    double m_criticalAt = 90;
+    QColor m_normalColor {0x4c, 0xaf, 0x50};      // #4caf50
+    QColor m_warningColor {0xff, 0xeb, 0x3b};     // #ffeb3b
+    QColor m_criticalColor {0xf4, 0x43, 0x36};    // #f44336
+    QColor m_trackColor {0xee, 0xee, 0xee};
+    QColor m_borderColor {0x34, 0x49, 0x5e};
+    int m_barHeight = 10;
+
+    QString m_title;
+    bool m_showPercent = false;
+    QStringList m_detailsLeft;
+    QStringList m_detailsRight;
+};
+
+#endif // USAGE_BAR_H